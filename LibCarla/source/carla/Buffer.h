@@ -300,6 +300,9 @@ namespace carla {
     void reset(size_type size) {
       if (_capacity < size) {
         log_debug("allocating buffer of", size, "bytes");
+        if ((_capacity > 0u) && !_parent_pool.expired()) {
+          ReportReallocation();
+        }
         _data = std::make_unique<value_type[]>(size);
         _capacity = size;
       }
@@ -440,6 +443,9 @@ namespace carla {
     void ReuseThisBuffer();
     // 私有函数，用于重新使用此缓冲区资源，具体实现未给出
 
+    /// 通知所属的缓冲区池，池中的缓冲区因容量不足而重新分配了内存。
+    void ReportReallocation();
+
 
     friend class BufferPool;
 // 声明BufferPool类为友元类，这意味着BufferPool类可以访问Buffer类的私有和保护成员
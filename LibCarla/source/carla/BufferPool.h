@@ -17,43 +17,187 @@
 #  pragma clang diagnostic pop  // 恢复之前保存的编译警告状态
 #endif
 
+#include <array>  // 包含固定大小数组，用于存放各个尺寸等级的队列
+#include <atomic>  // 包含原子操作，用于统计计数
+#include <limits>  // 包含数值上限，用于表示不限制内存
 #include <memory>  // 包含内存管理相关的头文件
 
 namespace carla {
 
   /// 一个缓冲区池。 从这个池中弹出的缓冲区在销毁时会自动返回到池中，
   /// 这样分配的内存可以被重用。
+  ///
+  /// 缓冲区按容量分到以2的幂为界的尺寸等级中，容量在 [2^k, 2^(k+1)) 之间的
+  /// 缓冲区放在第 k 个等级。Pop(size) 只从能容纳 @a size 字节的等级中取缓冲区，
+  /// 因此共享同一个池的大消息和小消息不会互相导致重新分配内存。
+  ///
+  /// 池中保存的内存总量可以通过 SetMaxPooledBytes 限制，超出时优先释放最大的
+  /// 缓冲区。
   /// @warning 缓冲区仅通过增长来调整其大小，除非明确地清除它们，否则不会缩小。
-  /// 分配的内存在此池被销毁时才会被删除。
+  /// 分配的内存在此池被销毁或被裁剪时才会被删除。
 
   class BufferPool : public std::enable_shared_from_this<BufferPool> {  // 定义 BufferPool 类，支持共享指针
   public:
 
-    BufferPool() = default;  // 默认构造函数
+    /// 缓冲区池的统计信息快照。
+    struct Statistics {
+      /// 从池中取到了足够大的缓冲区的次数。
+      size_t hits = 0u;
+      /// 池中没有合适的缓冲区，需要分配新内存的次数。
+      size_t misses = 0u;
+      /// 从池中取出的缓冲区容量不足，之后被重新分配内存的次数。
+      size_t reallocations = 0u;
+      /// 因超出内存上限而被释放的缓冲区数量。
+      size_t buffers_trimmed = 0u;
+      /// 当前保存在池中的缓冲区容量总和（字节）。
+      size_t pooled_bytes = 0u;
+    };
 
-    explicit BufferPool(size_t estimated_size) : _queue(estimated_size) {}  // 带参数的构造函数，初始化队列大小
+    BufferPool() = default;  // 默认构造函数，不限制池中保存的内存总量
 
-  /// 从队列中弹出一个缓冲区，如果队列为空，则创建一个新的缓冲区。
+    /// 创建一个最多保存 @a max_pooled_bytes 字节的缓冲区池。
+    explicit BufferPool(size_t max_pooled_bytes) : _max_pooled_bytes(max_pooled_bytes) {}
+
+    /// 从队列中弹出一个缓冲区，如果队列为空，则创建一个新的缓冲区。
+    /// 返回的缓冲区可以是任意大小，已知所需大小时应使用 Pop(size)。
     Buffer Pop() {
       Buffer item; // 创建一个 Buffer 实例
-      _queue.try_dequeue(item); // 尝试从队列中弹出，失败则不处理
+      bool found = false;
+      for (auto &bucket : _buckets) {
+        if (bucket.queue.try_dequeue(item)) {
+          found = true;
+          break;
+        }
+      }
+      return Prepare(std::move(item), found);
+    }
+
+    /// 弹出一个容量至少为 @a size 字节的缓冲区，并将其大小设置为 @a size。
+    /// 池中没有合适的缓冲区时分配一个新的缓冲区。
+    Buffer Pop(Buffer::size_type size) {
+      Buffer item;
+      bool found = false;
+      if (size > 0u) {
+        const auto index = GetBucketIndex(size);
+        // 同一等级中的缓冲区可能比 size 小，取出后检查容量，不够则放回去。
+        if (_buckets[index].queue.try_dequeue(item)) {
+          if (item.capacity() >= size) {
+            found = true;
+          } else {
+            _buckets[index].queue.enqueue(std::move(item));
+            item = Buffer();
+          }
+        }
+        // 更高一个等级中的缓冲区一定足够大。
+        if (!found && (index + 1u < _buckets.size())) {
+          found = _buckets[index + 1u].queue.try_dequeue(item);
+        }
+      }
+      auto result = Prepare(std::move(item), found);
+      result.reset(size);
+      return result;
+    }
+
+    /// 设置池中最多保存的内存总量，超出的部分立即被释放。
+    void SetMaxPooledBytes(size_t max_pooled_bytes) {
+      _max_pooled_bytes = max_pooled_bytes;
+      Trim(max_pooled_bytes);
+    }
+
+    size_t GetMaxPooledBytes() const {
+      return _max_pooled_bytes;
+    }
+
+    /// 释放池中的缓冲区，从最大的等级开始，直到池中保存的内存不超过 @a max_bytes。
+    void Trim(size_t max_bytes) {
+      for (auto it = _buckets.rbegin(); it != _buckets.rend(); ++it) {
+        Buffer item;
+        while ((_pooled_bytes > max_bytes) && it->queue.try_dequeue(item)) {
+          _pooled_bytes -= item.capacity();
+          ++_buffers_trimmed;
+          // 断开与池的关联，否则析构时缓冲区会被放回池中。
+          item._parent_pool.reset();
+          item = Buffer();
+        }
+      }
+    }
+
+    /// 返回统计信息的快照，可以从任意线程调用。
+    Statistics GetStatistics() const {
+      Statistics stats;
+      stats.hits = _hits;
+      stats.misses = _misses;
+      stats.reallocations = _reallocations;
+      stats.buffers_trimmed = _buffers_trimmed;
+      stats.pooled_bytes = _pooled_bytes;
+      return stats;
+    }
+
+  private:
+
+    friend class Buffer;  // 允许 Buffer 类访问私有成员
+
+    /// Buffer 的大小是32位的，所以最多需要32个等级。
+    static constexpr size_t number_of_buckets = 32u;
+
+    /// 返回容量为 @a capacity 的缓冲区所在的等级，即 floor(log2(capacity))。
+    static size_t GetBucketIndex(Buffer::size_type capacity) {
+      size_t index = 0u;
+      while (capacity > 1u) {
+        capacity >>= 1u;
+        ++index;
+      }
+      return index;
+    }
+
+    Buffer Prepare(Buffer &&item, bool found) {
+      if (found) {
+        ++_hits;
+        _pooled_bytes -= item.capacity();
+      } else {
+        ++_misses;
+      }
 #if __cplusplus >= 201703L // 检查是否支持 C++17
       item._parent_pool = weak_from_this();  // 设置父池为弱引用
 #else
       item._parent_pool = shared_from_this();  // 设置父池为共享引用
 #endif
-      return item;  // 返回弹出的 Buffer
+      return std::move(item);  // 返回弹出的 Buffer
     }
 
-  private:
-
-    friend class Buffer;  // 允许 Buffer 类访问私有成员
-
     void Push(Buffer &&buffer) {  // 定义 Push 方法，接受一个右值引用的 Buffer
-      _queue.enqueue(std::move(buffer));  // 将 Buffer 移动到队列中
+      const auto capacity = buffer.capacity();
+      if (capacity > _max_pooled_bytes) {
+        ++_buffers_trimmed;
+        buffer._parent_pool.reset();
+        return;
+      }
+      if (_pooled_bytes + capacity > _max_pooled_bytes) {
+        Trim(_max_pooled_bytes - capacity);
+      }
+      _pooled_bytes += capacity;
+      _buckets[GetBucketIndex(capacity)].queue.enqueue(std::move(buffer));  // 将 Buffer 移动到对应等级的队列中
     }
 
-    moodycamel::ConcurrentQueue<Buffer> _queue;  // 定义并发队列用于存储 Buffer
+    /// 一个尺寸等级的并发队列。初始容量为零，只有用到的等级才会分配内存。
+    struct Bucket {
+      moodycamel::ConcurrentQueue<Buffer> queue{0u};
+    };
+
+    /// 每个尺寸等级一个并发队列，用于存储 Buffer。
+    std::array<Bucket, number_of_buckets> _buckets;
+
+    std::atomic_size_t _max_pooled_bytes{std::numeric_limits<size_t>::max()};
+
+    std::atomic_size_t _pooled_bytes{0u};
+
+    std::atomic_size_t _hits{0u};
+
+    std::atomic_size_t _misses{0u};
+
+    std::atomic_size_t _reallocations{0u};
+
+    std::atomic_size_t _buffers_trimmed{0u};
   };
 
 } // namespace carla
@@ -0,0 +1,85 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef> // 引入 size_t 的头文件
+#include <functional> // 引入 std::hash 和 std::equal_to
+#include <list> // 引入链表的头文件
+#include <unordered_map> // 引入无序映射的头文件
+#include <utility> // 引入 std::pair 的头文件
+
+namespace carla {
+
+  /// 固定容量的最近最少使用（LRU）缓存，容量满时淘汰最久未访问的元素。
+  ///
+  /// @warning 不是线程安全的。
+  template <
+      typename KeyT,
+      typename ValueT,
+      typename HashT = std::hash<KeyT>,
+      typename EqualT = std::equal_to<KeyT>>
+  class LruCache {
+  public:
+
+    explicit LruCache(size_t capacity) : _capacity(capacity) {}
+
+    size_t GetCapacity() const {
+      return _capacity;
+    }
+
+    size_t size() const {
+      return _index.size();
+    }
+
+    /// 查找 @a key，命中时将其标记为最近使用并复制到 @a value。
+    bool Get(const KeyT &key, ValueT &value) {
+      const auto it = _index.find(key);
+      if (it == _index.end()) {
+        return false;
+      }
+      _entries.splice(_entries.begin(), _entries, it->second);
+      value = it->second->second;
+      return true;
+    }
+
+    /// 插入或替换 @a key 对应的值。
+    void Put(const KeyT &key, ValueT value) {
+      if (_capacity == 0u) {
+        return;
+      }
+      const auto it = _index.find(key);
+      if (it != _index.end()) {
+        it->second->second = std::move(value);
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return;
+      }
+      if (_index.size() >= _capacity) {
+        _index.erase(_entries.back().first);
+        _entries.pop_back();
+      }
+      _entries.emplace_front(key, std::move(value));
+      _index.emplace(key, _entries.begin());
+    }
+
+    void Clear() {
+      _index.clear();
+      _entries.clear();
+    }
+
+  private:
+
+    using Entry = std::pair<KeyT, ValueT>;
+
+    size_t _capacity;
+
+    /// 按最近访问顺序排列，最近使用的在前面
+    std::list<Entry> _entries;
+
+    std::unordered_map<KeyT, typename std::list<Entry>::iterator, HashT, EqualT> _index;
+  };
+
+} // namespace carla
@@ -8,6 +8,7 @@
 
 #include "carla/StringUtil.h" // 引入字符串工具类的头文件
 #include "carla/client/detail/ActorFactory.h" // 引入参与者工厂类的头文件
+#include "carla/client/detail/Simulator.h"
 
 #include <iterator> // 引入迭代器相关的标准库
 
@@ -39,6 +40,15 @@ namespace client {
     return filtered; // 返回过滤后的参与者列表
   }
 
+  ActorSnapshotColumns ActorList::GetSnapshotColumns() const {
+    std::vector<ActorId> ids;
+    ids.reserve(_actors.size());
+    for (auto &&actor : _actors) {
+      ids.push_back(actor.GetId());
+    }
+    return _episode.Lock()->GetWorldSnapshot().GetActorSnapshotColumns(ids);
+  }
+
 } // namespace client
 } // namespace carla
 
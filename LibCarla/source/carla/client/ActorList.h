@@ -6,6 +6,7 @@
 
 #pragma once // 确保该头文件只被包含一次
 
+#include "carla/client/ActorSnapshotColumns.h" // 引入按列保存的参与者快照
 #include "carla/client/detail/ActorVariant.h" // 引入 ActorVariant 类定义
 
 #include <boost/iterator/transform_iterator.hpp> // 引入 Boost 库中的 transform_iterator，用于创建变换迭代器
@@ -35,6 +36,10 @@ namespace client { // 开始 client 命名空间
     /// 根据提供的通配符模式（wildcard_pattern）过滤符合条件的参与者列表。
     SharedPtr<ActorList> Filter(const std::string &wildcard_pattern) const; // 根据通配符模式过滤参与者列表
 
+    /// 按列复制列表中所有参与者在当前帧的快照，顺序与列表相同。
+    /// 已经不在当前帧中的参与者状态为 rpc::ActorState::Invalid。
+    ActorSnapshotColumns GetSnapshotColumns() const;
+
     /// 重载 [] 运算符，返回指定位置的参与者（Actor）。
     SharedPtr<Actor> operator[](size_t pos) const { 
       return _actors[pos].Get(_episode); // 获取指定位置的 Actor
@@ -0,0 +1,87 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/client/ActorSnapshot.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace client {
+
+  /// 按列保存多个参与者的快照，每个字段是一个连续的数组，第 i 个参与者的
+  /// 数据位于每个数组的第 i 个元素（或第 i 组元素）。
+  ///
+  /// 用于一次性导出大量参与者的状态（例如导出为 numpy 数组），避免为每个
+  /// 参与者和每个字段分别创建对象。
+  struct ActorSnapshotColumns {
+
+    /// 每个变换的元素数：x, y, z, pitch, yaw, roll
+    static constexpr size_t TRANSFORM_SIZE = 6u;
+
+    /// 每个向量的元素数：x, y, z
+    static constexpr size_t VECTOR_SIZE = 3u;
+
+    std::vector<ActorId> ids;
+
+    std::vector<float> transforms;
+
+    std::vector<float> velocities;
+
+    std::vector<float> angular_velocities;
+
+    std::vector<float> accelerations;
+
+    /// rpc::ActorState 的数值
+    std::vector<uint8_t> actor_states;
+
+    size_t size() const {
+      return ids.size();
+    }
+
+    void Reserve(size_t count) {
+      ids.reserve(count);
+      transforms.reserve(TRANSFORM_SIZE * count);
+      velocities.reserve(VECTOR_SIZE * count);
+      angular_velocities.reserve(VECTOR_SIZE * count);
+      accelerations.reserve(VECTOR_SIZE * count);
+      actor_states.reserve(count);
+    }
+
+    void Append(const ActorSnapshot &snapshot) {
+      ids.push_back(snapshot.id);
+      const auto &location = snapshot.transform.location;
+      const auto &rotation = snapshot.transform.rotation;
+      transforms.insert(transforms.end(), {
+          location.x, location.y, location.z,
+          rotation.pitch, rotation.yaw, rotation.roll});
+      AppendVector(velocities, snapshot.velocity);
+      AppendVector(angular_velocities, snapshot.angular_velocity);
+      AppendVector(accelerations, snapshot.acceleration);
+      actor_states.push_back(static_cast<uint8_t>(snapshot.actor_state));
+    }
+
+    /// 添加一个不在快照中的参与者，所有数值为零，状态为 rpc::ActorState::Invalid
+    void AppendMissing(ActorId id) {
+      ids.push_back(id);
+      transforms.insert(transforms.end(), TRANSFORM_SIZE, 0.0f);
+      velocities.insert(velocities.end(), VECTOR_SIZE, 0.0f);
+      angular_velocities.insert(angular_velocities.end(), VECTOR_SIZE, 0.0f);
+      accelerations.insert(accelerations.end(), VECTOR_SIZE, 0.0f);
+      actor_states.push_back(static_cast<uint8_t>(rpc::ActorState::Invalid));
+    }
+
+  private:
+
+    static void AppendVector(std::vector<float> &column, const geom::Vector3D &vector) {
+      column.insert(column.end(), {vector.x, vector.y, vector.z});
+    }
+  };
+
+} // namespace client
+} // namespace carla
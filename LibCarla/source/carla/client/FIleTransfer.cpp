@@ -89,5 +89,15 @@ namespace client {
     return content;
   }
 
+  // 构建缓存文件的完整路径，供需要直接打开或映射文件的调用者使用
+  std::string FileTransfer::GetFullPath(const std::string &path) {
+    std::string fullpath = _filesBaseFolder;
+    fullpath += "/";
+    fullpath += ::carla::version(); // 加入当前的Carla版本号
+    fullpath += "/";
+    fullpath += path; // 添加目标文件路径
+    return fullpath;
+  }
+
 } // namespace client
 } // namespace carla
@@ -34,6 +34,8 @@ namespace client {   // 定义client命名空间
 
     static std::vector<uint8_t> ReadFile(std::string path);   // 读取文件内容，返回字节向量
 
+    static std::string GetFullPath(const std::string &path);   // 获取缓存文件在本地磁盘上的完整路径
+
   private:
 
     static std::string _filesBaseFolder;   // 存储文件基础目录的静态变量
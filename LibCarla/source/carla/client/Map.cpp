@@ -6,6 +6,9 @@
 
 #include "carla/client/Map.h"
 
+#include "carla/FileSystem.h"
+#include "carla/Logging.h"
+#include "carla/client/FileTransfer.h"
 #include "carla/client/Junction.h"
 #include "carla/client/Waypoint.h"
 #include "carla/opendrive/OpenDriveParser.h"
@@ -18,12 +21,24 @@
 namespace carla {
 // 命名空间 client
 namespace client {
-// 静态函数 MakeMap，根据输入的 opendrive 内容生成地图  
-static auto MakeMap(const std::string &opendrive_contents) {
-// 创建输入字符串流   
- auto stream = std::istringstream(opendrive_contents);
+// 返回地图 @a name 的R树缓存文件路径，缓存目录不可用时返回空字符串
+static std::string GetMapCachePath(const std::string &name) {
+    if (name.empty()) {
+      return {};
+    }
+    try {
+      std::string path = FileTransfer::GetFullPath(name + ".roadcache");
+      FileSystem::ValidateFilePath(path);
+      return path;
+    } catch (const std::exception &e) {
+      log_warning("road map cache disabled:", e.what());
+      return {};
+    }
+  }
+// 静态函数 MakeMap，根据输入的 opendrive 内容生成地图，R树从缓存文件读取
+static auto MakeMap(const std::string &opendrive_contents, const std::string &cache_filename) {
  // 调用 OpenDriveParser 类的 Load 函数加载地图，返回 boost::optional<carla::road::Map>
-    auto map = opendrive::OpenDriveParser::Load(stream.str());
+    auto map = opendrive::OpenDriveParser::Load(opendrive_contents, cache_filename);
  // 如果 map 为空，抛出运行时异常    
     if (!map.has_value()) {
       throw_exception(std::runtime_error("failed to generate map"));
@@ -34,7 +49,7 @@ static auto MakeMap(const std::string &opendrive_contents) {
  // Map 类的构造函数，接受 rpc::MapInfo 和 xodr 内容
   Map::Map(rpc::MapInfo description, std::string xodr_content)
     : _description(std::move(description)),
-      _map(MakeMap(xodr_content)){
+      _map(MakeMap(xodr_content, GetMapCachePath(_description.name))){
 // 存储 xodr 内容
     open_drive_file = xodr_content;
   }
@@ -65,6 +80,23 @@ static auto MakeMap(const std::string &opendrive_contents) {
     SharedPtr<Waypoint>(new Waypoint{shared_from_this(), *waypoint}) :
     nullptr;
   }
+// 批量获取 Waypoint 的函数，查询在 road::Map 中并行执行
+  std::vector<SharedPtr<Waypoint>> Map::GetWaypoints(
+      const std::vector<geom::Location> &locations,
+      bool project_to_road,
+      int32_t lane_type) const {
+    const auto waypoints = project_to_road ?
+        _map.GetClosestWaypointsOnRoad(locations, lane_type) :
+        _map.GetWaypoints(locations, lane_type);
+    std::vector<SharedPtr<Waypoint>> result;
+    result.reserve(waypoints.size());
+    for (const auto &waypoint : waypoints) {
+      result.emplace_back(waypoint.has_value() ?
+          SharedPtr<Waypoint>(new Waypoint{shared_from_this(), *waypoint}) :
+          nullptr);
+    }
+    return result;
+  }
 // 根据道路 ID、车道 ID 和 s 坐标获取 Waypoint 的函数
   SharedPtr<Waypoint> Map::GetWaypointXODR(
       carla::road::RoadId road_id,
@@ -119,6 +119,18 @@ namespace client {
         const geom::Location &location,
         bool project_to_road = true,
         int32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving)) const;
+    /**
+         * @brief GetWaypoint 的批量版本，一次查询多个位置。
+         *
+         * @param locations 地理位置列表。
+         * @param project_to_road 是否将位置投影到最近的道路上（默认为true）。
+         * @param lane_type 车道类型（默认为驾驶车道）。
+         * @return 与 @a locations 一一对应的路点，找不到路点的位置为 nullptr。
+         */
+    std::vector<SharedPtr<Waypoint>> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        bool project_to_road = true,
+        int32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving)) const;
     /**
          * @brief 根据OpenDRIVE ID获取路点。
          *
@@ -0,0 +1,82 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/SensorSynchronizer.h"
+
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+
+#include <exception>
+#include <stdexcept>
+
+namespace carla {
+namespace client {
+
+  SensorSynchronizer::SensorSynchronizer(
+      std::vector<SharedPtr<Sensor>> sensors,
+      time_duration timeout,
+      PartialBundlePolicy policy,
+      size_t max_pending_frames)
+    : _sensors(std::move(sensors)),
+      _timeout(timeout),
+      _policy(policy),
+      _max_pending_frames(max_pending_frames) {
+    for (auto &&sensor : _sensors) {
+      if (sensor == nullptr) {
+        throw_exception(std::invalid_argument("sensor synchronizer: null sensor"));
+      }
+    }
+  }
+
+  SensorSynchronizer::~SensorSynchronizer() {
+    try {
+      Stop();
+    } catch (const std::exception &e) {
+      log_error("exception trying to stop sensor synchronizer:", e.what());
+    }
+  }
+
+  void SensorSynchronizer::Listen(Callback callback) {
+    Stop();
+    _synchronizer = std::make_shared<sensor::FrameSynchronizer>(
+        _sensors.size(),
+        _timeout,
+        _policy,
+        std::move(callback),
+        _max_pending_frames);
+    _listening = true;
+    std::weak_ptr<sensor::FrameSynchronizer> weak = _synchronizer;
+    for (size_t i = 0u; i < _sensors.size(); ++i) {
+      _sensors[i]->Listen([weak, i](SharedPtr<sensor::SensorData> data) {
+        auto synchronizer = weak.lock();
+        if (synchronizer != nullptr) {
+          synchronizer->Push(i, std::move(data));
+        }
+      });
+    }
+  }
+
+  void SensorSynchronizer::Stop() {
+    if (!_listening) {
+      return;
+    }
+    _listening = false;
+    for (auto &&sensor : _sensors) {
+      if (sensor->IsListening()) {
+        sensor->Stop();
+      }
+    }
+    _synchronizer->Stop();
+  }
+
+  sensor::FrameSynchronizerMetrics SensorSynchronizer::GetMetrics() const {
+    return _synchronizer != nullptr ?
+        _synchronizer->GetMetrics() :
+        sensor::FrameSynchronizerMetrics{};
+  }
+
+} // namespace client
+} // namespace carla
@@ -0,0 +1,79 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/NonCopyable.h"
+#include "carla/Time.h"
+#include "carla/client/Sensor.h"
+#include "carla/sensor/FrameSynchronizer.h"
+
+#include <memory>
+#include <vector>
+
+namespace carla {
+namespace client {
+
+  /// 同时监听多个传感器，把同一帧的数据合并成一个 sensor::SensorBundle，
+  /// 每帧只调用一次回调。
+  ///
+  /// 各传感器的数据仍然在各自的流线程上到达，这里只把它们交给
+  /// sensor::FrameSynchronizer 按帧收集；回调在它的交付线程上执行。
+  /// 同步模式下用它代替为每个传感器分别注册回调，可以避免在 Python 中
+  /// 自己用队列按帧收集数据，每帧也只需要获取一次 GIL。
+  class SensorSynchronizer : private NonCopyable {
+  public:
+
+    using Callback = sensor::FrameSynchronizer::Callback;
+
+    using PartialBundlePolicy = sensor::FrameSynchronizer::PartialBundlePolicy;
+
+    SensorSynchronizer(
+        std::vector<SharedPtr<Sensor>> sensors,
+        time_duration timeout,
+        PartialBundlePolicy policy = PartialBundlePolicy::Deliver,
+        size_t max_pending_frames = 8u);
+
+    /// 停止监听所有传感器
+    ~SensorSynchronizer();
+
+    /// 开始监听所有传感器，数据包中数据的顺序与构造时传入的传感器顺序相同。
+    /// 如果已经在监听，先停止之前的监听。
+    void Listen(Callback callback);
+
+    /// 停止监听所有传感器，丢弃还没有交付的帧
+    void Stop();
+
+    bool IsListening() const {
+      return _listening;
+    }
+
+    const std::vector<SharedPtr<Sensor>> &GetSensors() const {
+      return _sensors;
+    }
+
+    /// 最近一次监听的统计数据
+    sensor::FrameSynchronizerMetrics GetMetrics() const;
+
+  private:
+
+    const std::vector<SharedPtr<Sensor>> _sensors;
+
+    const time_duration _timeout;
+
+    const PartialBundlePolicy _policy;
+
+    const size_t _max_pending_frames;
+
+    /// 传感器的回调只持有它的弱引用，停止之后到达的数据会被忽略
+    std::shared_ptr<sensor::FrameSynchronizer> _synchronizer;
+
+    bool _listening = false;
+  };
+
+} // namespace client
+} // namespace carla
@@ -8,6 +8,7 @@
 
 #include "carla/client/Timestamp.h" // 引入时间戳相关的头文件
 #include "carla/client/ActorSnapshot.h" // 引入参与者快照相关的头文件
+#include "carla/client/ActorSnapshotColumns.h" // 引入按列保存的参与者快照
 #include "carla/client/detail/EpisodeState.h" // 引入剧集状态相关的头文件
 
 
@@ -51,6 +52,16 @@ namespace client {
       return _state->size();
     }
 
+    // 按列复制所有参与者的快照，顺序与迭代顺序相同
+    ActorSnapshotColumns GetActorSnapshotColumns() const {
+      return _state->GetActorSnapshotColumns();
+    }
+
+    // 按列复制指定参与者的快照，不在快照中的参与者状态为 Invalid
+    ActorSnapshotColumns GetActorSnapshotColumns(const std::vector<ActorId> &ids) const {
+      return _state->GetActorSnapshotColumns(ids);
+    }
+
     // 获取指向世界快照中所有参与者快照列表的开始迭代器
     auto begin() const {
       return _state->begin();
@@ -0,0 +1,84 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Exception.h"
+#include "carla/NonCopyable.h"
+#include "carla/client/detail/Client.h"
+#include "carla/rpc/CallBatch.h"
+#include "carla/rpc/Response.h"
+
+#include <future>
+#include <stdexcept>
+#include <string>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  /// 把多个 RPC 调用排队，在 Flush 时通过一次请求发送给服务器。
+  ///
+  /// 逐个调用 Client 的方法时每个调用都要等待一次网络往返和一次游戏线程
+  /// 调度；查询大量参与者时把调用放到同一个流水线中，只需要等待一次。
+  /// 服务器按照调用添加的顺序执行它们。
+  ///
+  /// @code
+  /// CallPipeline pipeline(client);
+  /// std::vector<std::future<rpc::VehicleLightState>> states;
+  /// for (auto id : vehicles) {
+  ///   states.emplace_back(pipeline.Call<rpc::VehicleLightState>("get_vehicle_light_state", id));
+  /// }
+  /// pipeline.Flush();
+  /// @endcode
+  ///
+  /// @warning 在 Flush 之前对返回的 future 调用 get() 会一直阻塞。
+  class CallPipeline : private NonCopyable {
+  public:
+
+    explicit CallPipeline(Client &client) : _client(client) {}
+
+    /// 排队一个调用，返回的 future 在 Flush 之后就绪。服务器返回的错误以
+    /// std::runtime_error 的形式在 get() 中抛出，与 Client 的同步调用一致。
+    template <typename T, typename... Args>
+    std::future<T> Call(const std::string &function, Args &&... args) {
+      auto result = _batch.Add(function, std::forward<Args>(args)...);
+      return std::async(std::launch::deferred, [result=std::move(result)]() mutable {
+        auto response = result.get().template as<rpc::Response<T>>();
+        if (response.HasError()) {
+          throw_exception(std::runtime_error(response.GetError().What()));
+        }
+        return Get(response);
+      });
+    }
+
+    /// 排队的调用数
+    size_t size() const {
+      return _batch.size();
+    }
+
+    /// 发送所有排队的调用并等待结果，之后流水线可以继续使用
+    void Flush() {
+      _client.SendBatch(_batch);
+    }
+
+  private:
+
+    template <typename T>
+    static T Get(rpc::Response<T> &response) {
+      return std::move(response.Get());
+    }
+
+    static void Get(rpc::Response<void> &) {}
+
+    Client &_client;
+
+    rpc::CallBatch _batch;
+  };
+
+} // namespace detail
+} // namespace client
+} // namespace carla
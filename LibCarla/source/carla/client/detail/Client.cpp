@@ -9,10 +9,12 @@
 #include "carla/Exception.h"
 #include "carla/Version.h"
 #include "carla/client/FileTransfer.h"
+#include "carla/profiler/Profiler.h"
 #include "carla/client/TimeoutException.h"
 #include "carla/rpc/AckermannControllerSettings.h"
 #include "carla/rpc/ActorDescription.h"
 #include "carla/rpc/BoneTransformDataIn.h"
+#include "carla/rpc/CallBatch.h"
 #include "carla/rpc/Client.h"
 #include "carla/rpc/DebugShape.h"
 #include "carla/rpc/Response.h"
@@ -59,6 +61,7 @@ namespace detail {
 
     template <typename ... Args>
     auto RawCall(const std::string &function, Args && ... args) {
+      CARLA_PROFILE_DYNAMIC_SCOPE(rpc, function);
       try {
         return rpc_client.call(function, std::forward<Args>(args) ...);
       } catch (const ::rpc::timeout &) {
@@ -77,8 +80,18 @@ namespace detail {
       return Get(response);
     }
 
+    void SendBatch(rpc::CallBatch &batch) {
+      CARLA_PROFILE_SCOPE(rpc, call_batch);
+      try {
+        rpc_client.call_batch(batch);
+      } catch (const ::rpc::timeout &) {
+        throw_exception(TimeoutException(endpoint, GetTimeout()));
+      }
+    }
+
     template <typename ... Args>
     void AsyncCall(const std::string &function, Args && ... args) {
+      CARLA_PROFILE_DYNAMIC_SCOPE(rpc_async, function);
       // Discard returned future.
       rpc_client.async_call(function, std::forward<Args>(args) ...);
     }
@@ -760,6 +773,10 @@ namespace detail {
     return _pimpl->CallAndWait<return_t>("cast_ray", start_location, end_location);
   }
 
+  void Client::SendBatch(rpc::CallBatch &batch) {
+    _pimpl->SendBatch(batch);
+  }
+
 } // namespace detail
 } // namespace client
 } // namespace carla
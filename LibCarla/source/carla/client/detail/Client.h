@@ -48,6 +48,7 @@ namespace carla {
 namespace rpc {
   class AckermannControllerSettings;
   class ActorDescription;
+  class CallBatch;
   class DebugShape;
   class VehicleAckermannControl;
   class VehicleControl;
@@ -470,6 +471,9 @@ namespace detail {
     std::vector<rpc::LabelledPoint> CastRay(
         geom::Location start_location, geom::Location end_location) const;
 
+    /// 把批量中排队的所有调用放在一个请求中发送，见 CallPipeline。
+    void SendBatch(rpc::CallBatch &batch);
+
   private:
 
     class Pimpl;
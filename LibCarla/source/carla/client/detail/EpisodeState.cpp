@@ -45,6 +45,29 @@ namespace detail {
     }
   }
 
+  ActorSnapshotColumns EpisodeState::GetActorSnapshotColumns() const {
+    ActorSnapshotColumns columns;
+    columns.Reserve(_actors.size());
+    for (auto &&pair : _actors) {
+      columns.Append(pair.second);
+    }
+    return columns;
+  }
+
+  ActorSnapshotColumns EpisodeState::GetActorSnapshotColumns(const std::vector<ActorId> &ids) const {
+    ActorSnapshotColumns columns;
+    columns.Reserve(ids.size());
+    for (auto id : ids) {
+      auto it = _actors.find(id);
+      if (it != _actors.end()) {
+        columns.Append(it->second);
+      } else {
+        columns.AppendMissing(id);
+      }
+    }
+    return columns;
+  }
+
 } // namespace detail
 } // namespace client
 } // namespace carla
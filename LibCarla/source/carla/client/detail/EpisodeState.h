@@ -10,6 +10,7 @@
 #include "carla/ListView.h" // 引入列表视图头文件
 #include "carla/NonCopyable.h" // 引入不可复制类的头文件
 #include "carla/client/ActorSnapshot.h" // 引入参与者快照头文件
+#include "carla/client/ActorSnapshotColumns.h" // 引入按列保存的参与者快照头文件
 #include "carla/client/Timestamp.h" // 引入时间戳头文件
 #include "carla/geom/Vector3DInt.h" // 引入三维整数向量头文件
 #include "carla/sensor/data/RawEpisodeState.h" // 引入原始剧集状态数据头文件
@@ -18,6 +19,7 @@
 
 #include <memory> // 引入智能指针头文件
 #include <unordered_map> // 引入无序映射头文件
+#include <vector>
 
 namespace carla { // 定义carla命名空间
 namespace client { // 定义client子命名空间
@@ -94,6 +96,12 @@ namespace detail { // 定义detail子命名空间
           iterator::make_map_keys_const_iterator(_actors.end())); // 获取参与者ID迭代器
     }
 
+    // 按列复制所有参与者的快照
+    ActorSnapshotColumns GetActorSnapshotColumns() const;
+
+    // 按列复制指定参与者的快照，顺序与 @a ids 相同，不存在的参与者状态为 Invalid
+    ActorSnapshotColumns GetActorSnapshotColumns(const std::vector<ActorId> &ids) const;
+
     // 获取参与者数量
     size_t size() const {
       return _actors.size(); // 返回参与者数量
@@ -48,34 +48,34 @@ namespace detail {
     // 更新导航模块中的人群
     _nav.UpdateCrowd(*state);
 
-    carla::geom::Transform trans;
+    // 一次性读取所有行人的状态并生成命令
+    _nav.GetWalkerStates(_walker_states);
     using Cmd = rpc::Command;
     std::vector<Cmd> commands;
-    commands.reserve(walkers->size());
-    for (auto handle : *walkers) {
-      // 获取行人的变换
-      if (_nav.GetWalkerTransform(handle.walker, trans)) {
-        float speed = _nav.GetWalkerSpeed(handle.walker);
-        commands.emplace_back(Cmd::ApplyWalkerState{ handle.walker, trans, speed });
-      }
+    commands.reserve(_walker_states.size());
+    for (size_t i = 0u; i < _walker_states.size(); ++i) {
+      commands.emplace_back(Cmd::ApplyWalkerState{
+          _walker_states.ids[i],
+          _walker_states.transforms[i],
+          _walker_states.speeds[i]});
     }
     _simulator.lock()->ApplyBatchSync(std::move(commands), false);
 
-    // 检查是否所有代理已被杀死
-    bool alive;
-    for (auto handle : *walkers) {
-      // 获取代理状态
-      if (_nav.IsWalkerAlive(handle.walker, alive)) {
-        if (!alive) {
-          _simulator.lock()->SetActorCollisions(handle.walker, true);
-          _simulator.lock()->SetActorDead(handle.walker);
-          // 从人群中移除
-          _nav.RemoveAgent(handle.walker);
-          // 销毁控制器
-          _simulator.lock()->DestroyActor(handle.controller);
-          // 从列表中取消注册
-          UnregisterWalker(handle.walker, handle.controller);
+    // 处理被杀死的代理
+    for (const auto walker_id : _walker_states.dead) {
+      for (auto handle : *walkers) {
+        if (handle.walker != walker_id) {
+          continue;
         }
+        _simulator.lock()->SetActorCollisions(handle.walker, true);
+        _simulator.lock()->SetActorDead(handle.walker);
+        // 从人群中移除
+        _nav.RemoveAgent(handle.walker);
+        // 销毁控制器
+        _simulator.lock()->DestroyActor(handle.controller);
+        // 从列表中取消注册
+        UnregisterWalker(handle.walker, handle.controller);
+        break;
       }
     }
   }
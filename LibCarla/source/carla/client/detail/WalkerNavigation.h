@@ -100,6 +100,9 @@ namespace detail { // 定义detail子命名空间
 
     AtomicList<WalkerHandle> _walkers;
 
+    /// 每次 Tick 重复使用，避免重新分配
+    carla::nav::WalkerStates _walker_states;
+
     /// 检查一些行人，如果不存在，则将其从人群中移除
     void CheckIfWalkerExist(std::vector<WalkerHandle> walkers, const EpisodeState &state);
     /// 添加/更新/删除人群中的所有车辆
@@ -77,9 +77,21 @@ namespace geom {
       return _rtree.size();
     } // 成员函数，返回 R-tree 的大小。
 
+    /// 以任意顺序返回 R-tree 中的所有元素。
+    std::vector<TreeElement> GetElements() const {
+      return std::vector<TreeElement>(_rtree.begin(), _rtree.end());
+    }
+
+    /// 用 @a elements 替换 R-tree 的全部内容。一次性打包构建，比逐个插入快得多。
+    void SetElements(const std::vector<TreeElement> &elements) {
+      _rtree = RtreeType(elements.begin(), elements.end());
+    }
+
   private:
 
-    boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>> _rtree;
+    using RtreeType = boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>>;
+
+    RtreeType _rtree;
     // 私有成员变量，R-tree 数据结构实例。
   };
 
@@ -117,12 +129,24 @@ namespace geom {
         Filter filter,
         size_t number_neighbours = 1) const {
       std::vector<TreeElement> query_result;
+      GetNearestNeighboursWithFilter(geometry, filter, query_result, number_neighbours);
+      return query_result;
+    } // 成员函数模板，返回最近邻元素，可以应用用户定义的过滤器。
+
+    /// 与上面相同，但结果写入调用者提供的 @a query_result（先清空），
+    /// 连续查询时可以重复使用同一块内存。
+    template <typename Geometry, typename Filter>
+    void GetNearestNeighboursWithFilter(
+        const Geometry &geometry,
+        Filter filter,
+        std::vector<TreeElement> &query_result,
+        size_t number_neighbours = 1) const {
+      query_result.clear();
       _rtree.query(
           boost::geometry::index::nearest(geometry, static_cast<unsigned int>(number_neighbours)) &&
               boost::geometry::index::satisfies(filter),
           std::back_inserter(query_result));
-      return query_result;
-    } // 成员函数模板，返回最近邻元素，可以应用用户定义的过滤器。
+    }
 
     template<typename Geometry>
     std::vector<TreeElement> GetNearestNeighbours(const Geometry &geometry, size_t number_neighbours = 1) const {
@@ -148,9 +172,21 @@ namespace geom {
       return _rtree.size();
     } // 成员函数，返回 R-tree 的大小。
 
+    /// 以任意顺序返回 R-tree 中的所有元素。
+    std::vector<TreeElement> GetElements() const {
+      return std::vector<TreeElement>(_rtree.begin(), _rtree.end());
+    }
+
+    /// 用 @a elements 替换 R-tree 的全部内容。一次性打包构建，比逐个插入快得多。
+    void SetElements(const std::vector<TreeElement> &elements) {
+      _rtree = RtreeType(elements.begin(), elements.end());
+    }
+
   private:
 
-    boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>> _rtree;
+    using RtreeType = boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>>;
+
+    RtreeType _rtree;
     // 私有成员变量，R-tree 数据结构实例。
   };
 
@@ -7,6 +7,7 @@
 #pragma once // 确保头文件只被包含一次
 
 #include "carla/image/ImageView.h" // 引入ImageView头文件
+#include "carla/image/RawColorConverter.h"
 
 namespace carla { // carla命名空间
 namespace image { // image子命名空间
@@ -28,6 +29,35 @@ namespace image { // image子命名空间
           ImageView::MakeColorConvertedView<MutableImageView, DstPixelT>(image_view, converter), // 创建颜色转换后的视图
           image_view); // 目标为原始图像视图
     }
+
+    /// 传感器图像使用的 BGRA8 视图直接在原始缓冲区上转换，结果与上面的
+    /// 通用实现相同
+    static void ConvertInPlace(boost::gil::bgra8_view_t &image_view, ColorConverter::Depth converter) {
+      ConvertRawInPlace(image_view, converter);
+    }
+
+    static void ConvertInPlace(boost::gil::bgra8_view_t &image_view, ColorConverter::LogarithmicDepth converter) {
+      ConvertRawInPlace(image_view, converter);
+    }
+
+    static void ConvertInPlace(boost::gil::bgra8_view_t &image_view, ColorConverter::CityScapesPalette converter) {
+      ConvertRawInPlace(image_view, converter);
+    }
+
+  private:
+
+    template <typename ColorConverter>
+    static void ConvertRawInPlace(boost::gil::bgra8_view_t &image_view, ColorConverter converter) {
+      if (image_view.width() <= 0 || image_view.height() <= 0) {
+        return;
+      }
+      RawColorConverter::ConvertInPlace(
+          reinterpret_cast<uint8_t *>(&image_view(0, 0)),
+          static_cast<size_t>(image_view.width()),
+          static_cast<size_t>(image_view.height()),
+          static_cast<size_t>(image_view.pixels().row_size()),
+          converter);
+    }
   };
 
 } // namespace image
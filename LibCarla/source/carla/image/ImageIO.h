@@ -8,6 +8,8 @@
 
 #include "carla/image/ImageIOConfig.h"  // 包含图像输入输出配置的头文件
 
+#include <algorithm>
+
 namespace carla {  // 定义命名空间 carla
 namespace image {  // 定义命名空间 image
 
@@ -26,6 +28,20 @@ namespace image {  // 定义命名空间 image
       IO::write_view(out_filename, image_view);  // 调用 IO 类的 write_view 方法写入图像视图
       return out_filename;  // 返回输出文件名
     }
+
+    /// 与上面相同，但是 PNG 文件使用 @a png_compression_level（0-9）压缩，
+    /// 小于 0 时使用 libpng 的默认级别。其他格式忽略这个参数
+    template <typename ViewT>
+    static std::string WriteView(std::string out_filename, const ViewT &image_view, int png_compression_level) {
+#if LIBCARLA_IMAGE_WITH_PNG_SUPPORT
+      if (png_compression_level >= 0 && io::detail::io_png::match_extension(out_filename)) {
+        FileSystem::ValidateFilePath(out_filename, io::detail::io_png::get_default_extension());
+        io::detail::io_png::write_view(out_filename, image_view, std::min(png_compression_level, 9));
+        return out_filename;
+      }
+#endif // LIBCARLA_IMAGE_WITH_PNG_SUPPORT
+      return WriteView(std::move(out_filename), image_view);
+    }
   };
 
 } // namespace image
@@ -123,6 +123,14 @@ namespace detail {  // 定义命名空间detail
       boost::gil::write_view(std::forward<Str>(out_filename), view, boost::gil::png_tag()); // 使用boost库写入PNG视图
     }
 
+    // 使用指定的 zlib 压缩级别（0-9）写入，较低的级别编码快得多，文件稍大
+    template <typename Str, typename ViewT>
+    static void write_view(Str &&out_filename, const ViewT &view, int compression_level) {
+      boost::gil::image_write_info<boost::gil::png_tag> info;
+      info._compression_level = compression_level;
+      boost::gil::write_view(std::forward<Str>(out_filename), view, info);
+    }
+
 #endif // LIBCARLA_IMAGE_WITH_PNG_SUPPORT // 结束PNG支持条件编译
 
   };
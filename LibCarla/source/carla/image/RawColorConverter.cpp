@@ -0,0 +1,424 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/image/RawColorConverter.h"
+
+#include "carla/ThreadPool.h"
+#include "carla/image/CityScapesPalette.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#  define LIBCARLA_IMAGE_WITH_SSE2
+#  include <emmintrin.h>
+#endif
+
+#if defined(LIBCARLA_IMAGE_WITH_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#  define LIBCARLA_IMAGE_WITH_AVX2
+#  include <immintrin.h>
+#endif
+
+namespace carla {
+namespace image {
+
+  // ===========================================================================
+  // -- 标量实现 ---------------------------------------------------------------
+  // ===========================================================================
+
+  // 24 位深度的最大值
+  static constexpr float MAX_DEPTH = static_cast<float>(256 * 256 * 256 - 1);
+
+  // 每个并行任务至少处理的像素数
+  static constexpr size_t MIN_PIXELS_PER_TASK = 1u << 18;
+
+  // 与 Boost.GIL 相同，将 [0, 1] 的浮点通道转换为 8 位通道
+  static inline uint8_t ToChannel(float value) {
+    return static_cast<uint8_t>(static_cast<uint32_t>(value * 255.0f + 0.5f));
+  }
+
+  // 读取像素 R + G * 256 + B * 256 * 256 编码的深度
+  static inline uint32_t GetDepth(const uint8_t *pixel) {
+    return pixel[2u] + (pixel[1u] * 256u) + (pixel[0u] * 256u * 256u);
+  }
+
+  static inline void SetGray(uint8_t *pixel, uint8_t value) {
+    pixel[0u] = value;
+    pixel[1u] = value;
+    pixel[2u] = value;
+    pixel[3u] = 255u;
+  }
+
+  // 与 ColorConverter::Depth 相同
+  static inline uint8_t DepthToChannel(uint32_t depth) {
+    return ToChannel(static_cast<float>(depth) / MAX_DEPTH);
+  }
+
+  // 与 ColorConverter::Depth 加上 ColorConverter::LogarithmicLinear 相同
+  static inline uint8_t LogarithmicDepthToChannel(uint32_t depth) {
+    const float normalized = static_cast<float>(depth) / MAX_DEPTH;
+    const float value = 1.0f + std::log(normalized) / 5.70378f;
+    const float clamped = std::max(std::min(value, 1.0f), 0.005f);
+    return ToChannel(clamped);
+  }
+
+  /// 对数深度的查找表。
+  ///
+  /// 按深度的高 16 位分桶，每个桶保存桶起点的输出值 base 和桶内输出变为
+  /// base + 1 的位置 split（没有变化时为 256），打包为 base | split << 8。
+  /// 对数变化足够平缓，每个桶内的输出最多增加 1；如果不满足，查找表无效，
+  /// 退回逐像素计算。
+  class LogarithmicDepthTable {
+  public:
+
+    static const LogarithmicDepthTable &Get() {
+      static const LogarithmicDepthTable table;
+      return table;
+    }
+
+    bool IsValid() const {
+      return _valid;
+    }
+
+    const uint32_t *data() const {
+      return _entries.data();
+    }
+
+    uint8_t operator()(uint32_t depth) const {
+      const uint32_t entry = _entries[depth >> 8u];
+      return static_cast<uint8_t>((entry & 0xffu) + ((depth & 0xffu) >= (entry >> 8u) ? 1u : 0u));
+    }
+
+  private:
+
+    LogarithmicDepthTable() : _entries(1u << 16u) {
+      for (uint32_t bucket = 0u; bucket < _entries.size(); ++bucket) {
+        const uint32_t first = bucket << 8u;
+        const uint32_t last = first + 0xffu;
+        const uint32_t base = LogarithmicDepthToChannel(first);
+        const uint32_t top = LogarithmicDepthToChannel(last);
+        uint32_t split = 256u;
+        if (top == base + 1u) {
+          // 二分查找输出第一次变为 base + 1 的位置
+          uint32_t low = first + 1u;
+          uint32_t high = last;
+          while (low < high) {
+            const uint32_t middle = low + (high - low) / 2u;
+            if (LogarithmicDepthToChannel(middle) > base) {
+              high = middle;
+            } else {
+              low = middle + 1u;
+            }
+          }
+          split = low - first;
+        } else if (top != base) {
+          _valid = false;
+        }
+        _entries[bucket] = base | (split << 8u);
+      }
+    }
+
+    std::vector<uint32_t> _entries;
+
+    bool _valid = true;
+  };
+
+  /// CityScapes 调色板的查找表，每个标签对应一个 BGRA 像素。
+  class CityScapesPaletteTable {
+  public:
+
+    static const CityScapesPaletteTable &Get() {
+      static const CityScapesPaletteTable table;
+      return table;
+    }
+
+    const uint32_t *data() const {
+      return _entries.data();
+    }
+
+    const uint8_t *operator[](uint8_t tag) const {
+      return reinterpret_cast<const uint8_t *>(&_entries[tag]);
+    }
+
+  private:
+
+    CityScapesPaletteTable() {
+      for (uint32_t tag = 0u; tag < _entries.size(); ++tag) {
+        const auto color = CityScapesPalette::GetColor(static_cast<uint8_t>(tag));
+        const uint8_t pixel[4u] = {color[2u], color[1u], color[0u], 255u};
+        std::memcpy(&_entries[tag], pixel, sizeof(pixel));
+      }
+    }
+
+    std::array<uint32_t, 256u> _entries;
+  };
+
+  static void DepthRow(uint8_t *row, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      uint8_t *pixel = row + 4u * i;
+      SetGray(pixel, DepthToChannel(GetDepth(pixel)));
+    }
+  }
+
+  static void LogarithmicDepthRow(uint8_t *row, size_t begin, size_t end) {
+    const auto &table = LogarithmicDepthTable::Get();
+    if (table.IsValid()) {
+      for (size_t i = begin; i < end; ++i) {
+        uint8_t *pixel = row + 4u * i;
+        SetGray(pixel, table(GetDepth(pixel)));
+      }
+    } else {
+      for (size_t i = begin; i < end; ++i) {
+        uint8_t *pixel = row + 4u * i;
+        SetGray(pixel, LogarithmicDepthToChannel(GetDepth(pixel)));
+      }
+    }
+  }
+
+  static void CityScapesPaletteRow(uint8_t *row, size_t begin, size_t end) {
+    const auto &table = CityScapesPaletteTable::Get();
+    for (size_t i = begin; i < end; ++i) {
+      uint8_t *pixel = row + 4u * i;
+      std::memcpy(pixel, table[pixel[2u]], 4u);
+    }
+  }
+
+  // ===========================================================================
+  // -- SSE2 和 AVX2 实现 ------------------------------------------------------
+  // ===========================================================================
+
+#ifdef LIBCARLA_IMAGE_WITH_SSE2
+
+  static void DepthRowSse2(uint8_t *row, size_t width) {
+    const __m128i mask = _mm_set1_epi32(0xff);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xff000000u));
+    const __m128 max_depth = _mm_set1_ps(MAX_DEPTH);
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    size_t i = 0u;
+    for (; i + 4u <= width; i += 4u) {
+      __m128i *pixels = reinterpret_cast<__m128i *>(row + 4u * i);
+      const __m128i bgra = _mm_loadu_si128(pixels);
+      const __m128i b = _mm_and_si128(bgra, mask);
+      const __m128i g = _mm_and_si128(_mm_srli_epi32(bgra, 8), mask);
+      const __m128i r = _mm_and_si128(_mm_srli_epi32(bgra, 16), mask);
+      const __m128i depth = _mm_or_si128(r, _mm_or_si128(_mm_slli_epi32(g, 8), _mm_slli_epi32(b, 16)));
+      // 与标量实现相同，先除法再乘加，不使用倒数以保证结果一致
+      const __m128 normalized = _mm_div_ps(_mm_cvtepi32_ps(depth), max_depth);
+      const __m128i value = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(normalized, scale), half));
+      const __m128i gray = _mm_or_si128(
+          _mm_or_si128(value, _mm_slli_epi32(value, 8)),
+          _mm_or_si128(_mm_slli_epi32(value, 16), alpha));
+      _mm_storeu_si128(pixels, gray);
+    }
+    DepthRow(row, i, width);
+  }
+
+#endif // LIBCARLA_IMAGE_WITH_SSE2
+
+#ifdef LIBCARLA_IMAGE_WITH_AVX2
+
+  static bool HasAvx2() {
+    static const bool result = __builtin_cpu_supports("avx2") != 0;
+    return result;
+  }
+
+  __attribute__((target("avx2")))
+  static inline __m256i GetDepthAvx2(__m256i bgra) {
+    const __m256i mask = _mm256_set1_epi32(0xff);
+    const __m256i b = _mm256_and_si256(bgra, mask);
+    const __m256i g = _mm256_and_si256(_mm256_srli_epi32(bgra, 8), mask);
+    const __m256i r = _mm256_and_si256(_mm256_srli_epi32(bgra, 16), mask);
+    return _mm256_or_si256(r, _mm256_or_si256(_mm256_slli_epi32(g, 8), _mm256_slli_epi32(b, 16)));
+  }
+
+  __attribute__((target("avx2")))
+  static inline __m256i SetGrayAvx2(__m256i value) {
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xff000000u));
+    return _mm256_or_si256(
+        _mm256_or_si256(value, _mm256_slli_epi32(value, 8)),
+        _mm256_or_si256(_mm256_slli_epi32(value, 16), alpha));
+  }
+
+  __attribute__((target("avx2")))
+  static void DepthRowAvx2(uint8_t *row, size_t width) {
+    const __m256 max_depth = _mm256_set1_ps(MAX_DEPTH);
+    const __m256 scale = _mm256_set1_ps(255.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    size_t i = 0u;
+    for (; i + 8u <= width; i += 8u) {
+      __m256i *pixels = reinterpret_cast<__m256i *>(row + 4u * i);
+      const __m256i depth = GetDepthAvx2(_mm256_loadu_si256(pixels));
+      // 不使用 FMA，与标量实现的舍入保持一致
+      const __m256 normalized = _mm256_div_ps(_mm256_cvtepi32_ps(depth), max_depth);
+      const __m256i value = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(normalized, scale), half));
+      _mm256_storeu_si256(pixels, SetGrayAvx2(value));
+    }
+    DepthRow(row, i, width);
+  }
+
+  __attribute__((target("avx2")))
+  static void LogarithmicDepthRowAvx2(uint8_t *row, size_t width) {
+    const auto &table = LogarithmicDepthTable::Get();
+    const int *entries = reinterpret_cast<const int *>(table.data());
+    const __m256i low_mask = _mm256_set1_epi32(0xff);
+    const __m256i one = _mm256_set1_epi32(1);
+    size_t i = 0u;
+    for (; i + 8u <= width; i += 8u) {
+      __m256i *pixels = reinterpret_cast<__m256i *>(row + 4u * i);
+      const __m256i depth = GetDepthAvx2(_mm256_loadu_si256(pixels));
+      const __m256i entry = _mm256_i32gather_epi32(entries, _mm256_srli_epi32(depth, 8), 4);
+      const __m256i base = _mm256_and_si256(entry, low_mask);
+      const __m256i split = _mm256_srli_epi32(entry, 8);
+      // 桶内位置不小于 split 时加一，比较结果为 -1
+      const __m256i step = _mm256_cmpgt_epi32(
+          _mm256_and_si256(depth, low_mask),
+          _mm256_sub_epi32(split, one));
+      _mm256_storeu_si256(pixels, SetGrayAvx2(_mm256_sub_epi32(base, step)));
+    }
+    LogarithmicDepthRow(row, i, width);
+  }
+
+  __attribute__((target("avx2")))
+  static void CityScapesPaletteRowAvx2(uint8_t *row, size_t width) {
+    const int *entries = reinterpret_cast<const int *>(CityScapesPaletteTable::Get().data());
+    const __m256i mask = _mm256_set1_epi32(0xff);
+    size_t i = 0u;
+    for (; i + 8u <= width; i += 8u) {
+      __m256i *pixels = reinterpret_cast<__m256i *>(row + 4u * i);
+      const __m256i tag = _mm256_and_si256(_mm256_srli_epi32(_mm256_loadu_si256(pixels), 16), mask);
+      _mm256_storeu_si256(pixels, _mm256_i32gather_epi32(entries, tag, 4));
+    }
+    CityScapesPaletteRow(row, i, width);
+  }
+
+#endif // LIBCARLA_IMAGE_WITH_AVX2
+
+  // ===========================================================================
+  // -- 按行并行 ---------------------------------------------------------------
+  // ===========================================================================
+
+  using RowFunction = void (*)(uint8_t *row, size_t width);
+
+  static void DepthRowScalar(uint8_t *row, size_t width) {
+    DepthRow(row, 0u, width);
+  }
+
+  static void LogarithmicDepthRowScalar(uint8_t *row, size_t width) {
+    LogarithmicDepthRow(row, 0u, width);
+  }
+
+  static void CityScapesPaletteRowScalar(uint8_t *row, size_t width) {
+    CityScapesPaletteRow(row, 0u, width);
+  }
+
+  // 所有转换共用的线程池，第一次转换大图像时启动
+  static ThreadPool &GetThreadPool(size_t &number_of_workers) {
+    static const size_t workers = std::max(1u, std::thread::hardware_concurrency()) - 1u;
+    static ThreadPool pool;
+    static std::once_flag started;
+    std::call_once(started, []() {
+      if (workers > 0u) {
+        pool.AsyncRun(workers);
+      }
+    });
+    number_of_workers = workers;
+    return pool;
+  }
+
+  static void ConvertRows(
+      uint8_t *data, size_t width, size_t height, size_t row_stride,
+      RowFunction convert_row) {
+    if (data == nullptr || width == 0u || height == 0u) {
+      return;
+    }
+    auto convert = [=](size_t begin, size_t end) {
+      for (size_t y = begin; y < end; ++y) {
+        convert_row(data + y * row_stride, width);
+      }
+    };
+
+    // 小图像直接在调用线程上转换
+    const size_t pixels = width * height;
+    if (pixels < 2u * MIN_PIXELS_PER_TASK) {
+      convert(0u, height);
+      return;
+    }
+    size_t number_of_workers = 0u;
+    ThreadPool &pool = GetThreadPool(number_of_workers);
+    const size_t number_of_tasks = std::min(
+        {number_of_workers + 1u, pixels / MIN_PIXELS_PER_TASK, height});
+    if (number_of_tasks <= 1u) {
+      convert(0u, height);
+      return;
+    }
+    const size_t rows_per_task = (height + number_of_tasks - 1u) / number_of_tasks;
+    std::vector<std::future<void>> futures;
+    futures.reserve(number_of_tasks - 1u);
+    for (size_t task = 1u; task < number_of_tasks; ++task) {
+      const size_t begin = task * rows_per_task;
+      const size_t end = std::min(height, begin + rows_per_task);
+      if (begin < end) {
+        futures.emplace_back(pool.Post([=]() { convert(begin, end); }));
+      }
+    }
+    convert(0u, std::min(height, rows_per_task));
+    for (auto &future : futures) {
+      future.get();
+    }
+  }
+
+  // ===========================================================================
+  // -- RawColorConverter ------------------------------------------------------
+  // ===========================================================================
+
+  void RawColorConverter::ConvertInPlace(
+      uint8_t *data, size_t width, size_t height, size_t row_stride,
+      ColorConverter::Depth) {
+    RowFunction convert_row = DepthRowScalar;
+#ifdef LIBCARLA_IMAGE_WITH_SSE2
+    convert_row = DepthRowSse2;
+#endif
+#ifdef LIBCARLA_IMAGE_WITH_AVX2
+    if (HasAvx2()) {
+      convert_row = DepthRowAvx2;
+    }
+#endif
+    ConvertRows(data, width, height, row_stride, convert_row);
+  }
+
+  void RawColorConverter::ConvertInPlace(
+      uint8_t *data, size_t width, size_t height, size_t row_stride,
+      ColorConverter::LogarithmicDepth) {
+    RowFunction convert_row = LogarithmicDepthRowScalar;
+#ifdef LIBCARLA_IMAGE_WITH_AVX2
+    if (HasAvx2() && LogarithmicDepthTable::Get().IsValid()) {
+      convert_row = LogarithmicDepthRowAvx2;
+    }
+#endif
+    ConvertRows(data, width, height, row_stride, convert_row);
+  }
+
+  void RawColorConverter::ConvertInPlace(
+      uint8_t *data, size_t width, size_t height, size_t row_stride,
+      ColorConverter::CityScapesPalette) {
+    RowFunction convert_row = CityScapesPaletteRowScalar;
+#ifdef LIBCARLA_IMAGE_WITH_AVX2
+    if (HasAvx2()) {
+      convert_row = CityScapesPaletteRowAvx2;
+    }
+#endif
+    ConvertRows(data, width, height, row_stride, convert_row);
+  }
+
+} // namespace image
+} // namespace carla
@@ -0,0 +1,42 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/image/ColorConverter.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace carla {
+namespace image {
+
+  /// 直接在 BGRA8 缓冲区上原地执行 ColorConverter 的转换，结果与通过
+  /// Boost.GIL 颜色转换视图逐像素转换完全相同。
+  ///
+  /// 支持 AVX2 的处理器上使用 AVX2，深度转换在其他 x86-64 处理器上使用
+  /// SSE2，其余情况使用标量实现；较大的图像按行分块在多个线程上转换。对数
+  /// 深度和调色板使用查找表，不需要逐像素计算对数。
+  class RawColorConverter {
+  public:
+
+    /// 转换 @a height 行、每行 @a width 个像素的图像，@a row_stride 为相邻
+    /// 两行起始位置之间的字节数
+    static void ConvertInPlace(
+        uint8_t *data, size_t width, size_t height, size_t row_stride,
+        ColorConverter::Depth);
+
+    static void ConvertInPlace(
+        uint8_t *data, size_t width, size_t height, size_t row_stride,
+        ColorConverter::LogarithmicDepth);
+
+    static void ConvertInPlace(
+        uint8_t *data, size_t width, size_t height, size_t row_stride,
+        ColorConverter::CityScapesPalette);
+  };
+
+} // namespace image
+} // namespace carla
@@ -13,9 +13,12 @@
 #include "carla/nav/WalkerManager.h"
 #include "carla/geom/Math.h"
 
+#include <algorithm>
 #include <iterator>
 #include <fstream>
+#include <future>
 #include <mutex>
+#include <thread>
 
 namespace carla {
 namespace nav {
@@ -30,7 +33,7 @@ namespace nav {
 
   // 这些设置与 RecastBuilder 中的设置相同，因此如果您更改代理的高度，则应该在 RecastBuilder 中执行相同的操作
   static const int   MAX_POLYS = 256; // 定义最大多边形数量为256
-  static const int   MAX_AGENTS = 500; // 定义最大代理（Agent）数量为500
+  static const int   MAX_AGENTS = 8192; // 定义最大代理（Agent）数量，包括行人和需要避让的车辆
   static const int   MAX_QUERY_SEARCH_NODES = 2048; // 定义最大查询搜索节点数量为2048
   static const float AGENT_HEIGHT = 1.8f; // 定义代理的高度为1.8米
   static const float AGENT_RADIUS = 0.3f; // 定义代理的半径为0.3米
@@ -47,7 +50,96 @@ namespace nav {
     return static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
   }
 
-  Navigation::Navigation() {
+  // 每个并行任务至少处理的代理数，代理较少时在调用线程上直接计算
+  static const size_t MIN_AGENTS_PER_TASK = 1024u;
+
+  // 根据代理的速度计算其在虚幻坐标中的变换和速度，偏航角从 @a previous_yaw
+  // 向行进方向平滑转动
+  static void ComputeAgentState(
+      const dtCrowdAgent &agent,
+      float previous_yaw,
+      double delta_seconds,
+      AgentState &state) {
+    state.active = agent.active;
+    state.is_walker = !agent.params.useObb;
+    state.alive = !agent.dead;
+    state.speed = sqrtf(agent.vel[0] * agent.vel[0] + agent.vel[1] * agent.vel[1] + agent.vel[2] * agent.vel[2]);
+
+    // 在虚幻坐标中设置其位置
+    state.transform.location.x = agent.npos[0];
+    state.transform.location.y = agent.npos[2];
+    state.transform.location.z = agent.npos[1];
+
+    // 设置其旋转
+    float yaw;
+    float speed = 0.0f;
+    float min = 0.1f;
+    if (agent.vel[0] < -min || agent.vel[0] > min ||
+        agent.vel[2] < -min || agent.vel[2] > min) {
+      yaw = atan2f(agent.vel[2], agent.vel[0]) * (180.0f / static_cast<float>(M_PI));
+      speed = state.speed;
+    } else {
+      yaw = atan2f(agent.dvel[2], agent.dvel[0]) * (180.0f / static_cast<float>(M_PI));
+      speed = sqrtf(agent.dvel[0] * agent.dvel[0] + agent.dvel[1] * agent.dvel[1] + agent.dvel[2] * agent.dvel[2]);
+    }
+
+    // 插入当前角度和目标角度
+    float shortest_angle = fmod(yaw - previous_yaw + 540.0f, 360.0f) - 180.0f;
+    float per = (speed / 1.5f);
+    if (per > 1.0f) per = 1.0f;
+    float rotation_speed = per * 6.0f;
+    state.transform.rotation.yaw = previous_yaw +
+    (shortest_angle * rotation_speed * static_cast<float>(delta_seconds));
+  }
+
+  // 把 [0, count) 分成连续的区间，在线程池和调用线程上并行执行 func(begin, end)
+  template <typename FuncT>
+  static void RunInChunks(ThreadPool &pool, size_t number_of_workers, size_t count, FuncT &&func) {
+    const size_t number_of_chunks = std::max<size_t>(
+        1u,
+        std::min(number_of_workers + 1u, count / MIN_AGENTS_PER_TASK));
+    const size_t chunk_size = (count + number_of_chunks - 1u) / number_of_chunks;
+    std::vector<std::future<void>> futures;
+    futures.reserve(number_of_chunks - 1u);
+    for (size_t chunk = 1u; chunk < number_of_chunks; ++chunk) {
+      const size_t begin = chunk * chunk_size;
+      const size_t end = std::min(count, begin + chunk_size);
+      futures.emplace_back(pool.Post([&func, begin, end]() { func(begin, end); }));
+    }
+    try {
+      func(0u, std::min(count, chunk_size));
+    } catch (...) {
+      // 其他任务还在使用 func，必须等它们结束
+      for (auto &future : futures) {
+        future.wait();
+      }
+      throw;
+    }
+    for (auto &future : futures) {
+      future.get();
+    }
+  }
+
+  // GetPath 没有指定过滤器时使用的过滤器，可以经过马路和草地但代价更高
+  static dtQueryFilter MakeDefaultFilter() {
+    dtQueryFilter filter;
+    filter.setAreaCost(CARLA_AREA_ROAD, AREA_ROAD_COST); // 设置道路区域的成本
+    filter.setAreaCost(CARLA_AREA_GRASS, AREA_GRASS_COST); // 设置草地区域的成本
+    filter.setIncludeFlags(CARLA_TYPE_WALKABLE);  // 设置包含的标志（可通行区域）
+    filter.setExcludeFlags(CARLA_TYPE_NONE);    // 设置排除的标志（无不可通行区域）
+    return filter;
+  }
+
+  // 返回一个已经就绪的 future
+  template <typename T>
+  static std::future<T> MakeReadyFuture(T value) {
+    std::promise<T> promise;
+    promise.set_value(std::move(value));
+    return promise.get_future();
+  }
+
+  Navigation::Navigation()
+    : _number_of_workers(std::max(1u, std::thread::hardware_concurrency()) - 1u) {
     // 指定行人管理器
     _walker_manager.SetNav(this);
   }
@@ -59,8 +151,9 @@ namespace nav {
     _mapped_vehicles_id.clear(); // 清空_mapped_vehicles_id列表，该列表存储了映射的车辆ID
     _mapped_by_index.clear(); // 清空_mapped_by_index列表，该列表可能存储了按索引映射的对象
     _walkers_blocked_position.clear(); // 清空_walkers_blocked_position列表，该列表存储了被阻塞步行者的位置
-    _yaw_walkers.clear(); // 清空_yaw_walkers列表，该列表可能存储了步行者的朝向信息
+    _agent_yaw.clear(); // 清空_agent_yaw列表，该列表存储了每个代理的朝向信息
     _binary_mesh.clear(); // 清空_binary_mesh，该变量可能存储了二进制网格数据
+    _path_planner.reset(); // 先销毁路径规划器，它使用_nav_mesh
     dtFreeCrowd(_crowd); // 释放_crowd资源，_crowd是用于人群模拟的动态组件
     dtFreeNavMeshQuery(_nav_query); // 释放_nav_query资源，_nav_query是用于路径查询的组件
     dtFreeNavMesh(_nav_mesh); // 释放_nav_mesh资源，_nav_mesh是用于路径规划的导航网格
@@ -197,9 +290,14 @@ namespace nav {
       tile_header.tile_ref, 0);
     }
 
-    // 交换
+    // 交换，旧的规划器还在使用旧的网格，必须先销毁
+    _path_planner.reset();
     dtFreeNavMesh(_nav_mesh);
     _nav_mesh = mesh;
+    _path_planner = std::make_unique<PathPlanner>(
+        *_nav_mesh,
+        MAX_QUERY_SEARCH_NODES,
+        std::max<size_t>(1u, _number_of_workers));
 
     // 准备查询对象
     dtFreeNavMeshQuery(_nav_query);
@@ -289,213 +387,82 @@ namespace nav {
                            dtQueryFilter * filter,    // 用于路径查询的过滤器，可以筛选路径通过的区域类型
                            std::vector<carla::geom::Location> &path, // 用于存储计算出的路径点的向量
                            std::vector<unsigned char> &area) {  // 用于存储路径点所属区域类型的向量
-    // 找到路径
-    float straight_path[MAX_POLYS * 3];
-    unsigned char straight_path_flags[MAX_POLYS];
-    dtPolyRef straight_path_polys[MAX_POLYS];
-    int num_straight_path;   // 直线路径中的点数量
-    int straight_path_options = DT_STRAIGHTPATH_AREA_CROSSINGS;  // 直线路径查询的选项
-
-    // 路径中的多边形
-    dtPolyRef polys[MAX_POLYS];
-    int num_polys; // 路径中的多边形数量
-
     // 检查是否一切就绪
     if (!_ready) {
       return false;
     }
 
-     // 确保导航查询对象不为空
-    DEBUG_ASSERT(_nav_query != nullptr);
-
-    // 点的延伸
-    float poly_pick_ext[3];
-    poly_pick_ext[0] = 2;
-    poly_pick_ext[1] = 4;
-    poly_pick_ext[2] = 2;
-
-    // 筛选
-    dtQueryFilter filter2;
-    if (filter == nullptr) {
-      filter2.setAreaCost(CARLA_AREA_ROAD, AREA_ROAD_COST); // 设置道路区域的成本
-      filter2.setAreaCost(CARLA_AREA_GRASS, AREA_GRASS_COST); // 设置草地区域的成本
-      filter2.setIncludeFlags(CARLA_TYPE_WALKABLE);  // 设置包含的标志（可通行区域）
-      filter2.setExcludeFlags(CARLA_TYPE_NONE);    // 设置排除的标志（无不可通行区域）
-      filter = &filter2;   // 使用默认过滤器
-    }
-
-    // 设置点
-    dtPolyRef start_ref = 0;
-    dtPolyRef end_ref = 0;
-    float start_pos[3] = { from.x, from.z, from.y };  // 转换为Detour库的坐标顺序（x, z, y）
-    float end_pos[3] = { to.x, to.z, to.y };
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->findNearestPoly(start_pos, poly_pick_ext, filter, &start_ref, 0);
-      _nav_query->findNearestPoly(end_pos, poly_pick_ext, filter, &end_ref, 0);
-    }
-    // 如果未找到起始或目标多边形，则返回失败
-    if (!start_ref || !end_ref) {
-      return false;
-    }
-
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      // 获取节点的路径
-      _nav_query->findPath(start_ref, end_ref, start_pos, end_pos, filter, polys, &num_polys, MAX_POLYS);
-    }
+    DEBUG_ASSERT(_path_planner != nullptr);
 
-    // 获得点的路径
-    num_straight_path = 0;
-    if (num_polys == 0) {
+    NavPath result;
+    if (!_path_planner->FindPath(from, to, filter != nullptr ? *filter : MakeDefaultFilter(), result)) {
       return false;
     }
+    path = std::move(result.path);
+    area = std::move(result.area);
+    return true;// 成功找到路径
+  }
 
-    // 如果是部分路径，请确保终点与最后一个多边形相接
-    float end_pos2[3];
-    dtVcopy(end_pos2, end_pos);
-    if (polys[num_polys - 1] != end_ref) {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->closestPointOnPoly(polys[num_polys - 1], end_pos, end_pos2, 0);
-    }
-
-    // 获得点
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->findStraightPath(start_pos, end_pos2, polys, num_polys,
-      straight_path, straight_path_flags,
-      straight_path_polys, &num_straight_path, MAX_POLYS, straight_path_options);
-    }
-
-    // 将路径复制到输出缓冲区
-    path.clear();
-    path.reserve(static_cast<unsigned long>(num_straight_path));
-    unsigned char area_type;
-    for (int i = 0, j = 0; j < num_straight_path; i += 3, ++j) {
-      // 保存虚幻轴的坐标（x，z，y）
-      path.emplace_back(straight_path[i], straight_path[i + 2], straight_path[i + 1]);
-      // 保存区域类型
-      {
-        // 关键部分，强制单线程运行这里
-        std::lock_guard<std::mutex> lock(_mutex);
-        _nav_mesh->getPolyArea(straight_path_polys[j], &area_type);// 获取路径点所属的多边形的区域类型
-      }
-      area.emplace_back(area_type);
+  std::future<boost::optional<NavPath>> Navigation::GetPathAsync(
+      carla::geom::Location from,
+      carla::geom::Location to,
+      const dtQueryFilter *filter) {
+    if (!_ready) {
+      return MakeReadyFuture(boost::optional<NavPath>());
     }
 
-    return true;// 成功找到路径
+    DEBUG_ASSERT(_path_planner != nullptr);
+    return _path_planner->FindPathAsync(from, to, filter != nullptr ? *filter : MakeDefaultFilter());
   }
 
   bool Navigation::GetAgentRoute(ActorId id, carla::geom::Location from, carla::geom::Location to,
   std::vector<carla::geom::Location> &path, std::vector<unsigned char> &area) {
-    // 找到路径
-    float straight_path[MAX_POLYS * 3];
-    unsigned char straight_path_flags[MAX_POLYS];
-    dtPolyRef straight_path_polys[MAX_POLYS];
-    int num_straight_path = 0;
-    int straight_path_options = DT_STRAIGHTPATH_AREA_CROSSINGS;
-
-    // 路径中的多边形
-    dtPolyRef polys[MAX_POLYS];
-    int num_polys;
-
-    // 检查是否一切就绪
-    if (!_ready) {
+    // 从代理获取当前过滤器
+    dtQueryFilter filter;
+    if (!GetAgentFilter(id, filter)) {
       return false;
     }
 
-    DEBUG_ASSERT(_nav_query != nullptr);
-
-    // 点的扩展
-    float poly_pick_ext[3] = {2,4,2};
+    DEBUG_ASSERT(_path_planner != nullptr);
 
-    // 从代理获取当前过滤器
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end())
+    NavPath result;
+    if (!_path_planner->FindPath(from, to, filter, result)) {
       return false;
-
-    
-// 定义一个指向查询过滤器的指针，用于后续的路径查询。
-    const dtQueryFilter *filter;
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-       // 根据代理的参数获取对应的过滤器。
-      filter = _crowd->getFilter(_crowd->getAgent(it->second)->params.queryFilterType);
     }
+    path = std::move(result.path);
+    area = std::move(result.area);
+    return true;
+  }
 
-    // 设置点
-    dtPolyRef start_ref = 0;
-    dtPolyRef end_ref = 0;
-    // 定义起点和终点的位置数组，注意这里z和y的顺序被交换了，这取决于导航网格的坐标系
-    float start_pos[3] = { from.x, from.z, from.y };
-    float end_pos[3] = { to.x, to.z, to.y };
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      // 查询离起点最近的多边形。
-      _nav_query->findNearestPoly(start_pos, poly_pick_ext, filter, &start_ref, 0);
-       // 查询离终点最近的多边形。
-      _nav_query->findNearestPoly(end_pos, poly_pick_ext, filter, &end_ref, 0);
-    }
-    if (!start_ref || !end_ref) {
-      return false;
+  std::future<boost::optional<NavPath>> Navigation::GetAgentRouteAsync(
+      ActorId id,
+      carla::geom::Location from,
+      carla::geom::Location to) {
+    // 从代理获取当前过滤器
+    dtQueryFilter filter;
+    if (!GetAgentFilter(id, filter)) {
+      return MakeReadyFuture(boost::optional<NavPath>());
     }
 
-    // 获取点的路径
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      // 使用导航查询对象查询路径。
-      _nav_query->findPath(start_ref, end_ref, start_pos, end_pos, filter, polys, &num_polys, MAX_POLYS);
-    }
+    DEBUG_ASSERT(_path_planner != nullptr);
+    return _path_planner->FindPathAsync(from, to, filter);
+  }
 
-    // 获取点的路径
-    if (num_polys == 0) {
+  bool Navigation::GetAgentFilter(ActorId id, dtQueryFilter &filter) {
+    // 检查是否一切就绪
+    if (!_ready) {
       return false;
     }
 
-    // 如果是部分路径，请确保终点与最后一个多边形相接
-    float end_pos2[3];
-    dtVcopy(end_pos2, end_pos);  // 先复制终点位置
-    if (polys[num_polys - 1] != end_ref) {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      // 在最后一个多边形上找到最接近终点的点
-      _nav_query->closestPointOnPoly(polys[num_polys - 1], end_pos, end_pos2, 0);
-    }
-
-    // 获取点
-    {
-      // 关键部分，强制单线程运行这里
-       // 锁定互斥锁，确保直线路径查询是单线程执行的。
-      std::lock_guard<std::mutex> lock(_mutex);
-      // 使用导航查询对象获取直线路径。
-      _nav_query->findStraightPath(start_pos, end_pos2, polys, num_polys,
-      straight_path, straight_path_flags,
-      straight_path_polys, &num_straight_path, MAX_POLYS, straight_path_options);
-    }
-
-    // 将路径复制到输出缓冲区
-    path.clear();
-    path.reserve(static_cast<unsigned long>(num_straight_path));
-    unsigned char area_type;
-    for (int i = 0, j = 0; j < num_straight_path; i += 3, ++j) {
-      // 保存虚幻轴的坐标（x，z，y）
-      path.emplace_back(straight_path[i], straight_path[i + 2], straight_path[i + 1]);
-      // 保存面积类型
-      {
-        // 关键部分，强制单线程运行这里
-        std::lock_guard<std::mutex> lock(_mutex);
-        _nav_mesh->getPolyArea(straight_path_polys[j], &area_type);
-      }
-      area.emplace_back(area_type);
+    auto it = _mapped_walkers_id.find(id);
+    if (it == _mapped_walkers_id.end()) {
+      return false;
     }
 
+    // 关键部分，强制单线程运行这里
+    std::lock_guard<std::mutex> lock(_mutex);
+    // 根据代理的参数获取对应的过滤器
+    filter = *_crowd->getFilter(_crowd->getAgent(it->second)->params.queryFilterType);
     return true;
   }
 
@@ -544,15 +511,17 @@ namespace nav {
       if (index == -1) {
         return false;
       }
+      // 初始化偏航角，UpdateCrowd 也会修改 _agent_yaw，所以同样在锁内
+      if (_agent_yaw.size() <= static_cast<size_t>(index)) {
+        _agent_yaw.resize(static_cast<size_t>(index) + 1u, 0.0f);
+      }
+      _agent_yaw[static_cast<size_t>(index)] = 0.0f;
     }
 
     // 保存 id
     _mapped_walkers_id[id] = index;
     _mapped_by_index[index] = id;
 
-    // 初始化偏航角
-    _yaw_walkers[id] = 0.0f;
-
     // 添加行人进行路线规划
     _walker_manager.AddWalker(id);
 
@@ -709,8 +678,8 @@ namespace nav {
       }
       _walker_manager.RemoveWalker(id);  // 从其他管理系统中移除行人
       // remove from mapping
-      _mapped_walkers_id.erase(it);
       _mapped_by_index.erase(it->second);
+      _mapped_walkers_id.erase(it);
 
       return true;
     }
@@ -725,8 +694,8 @@ namespace nav {
         _crowd->removeAgent(it->second);  // 从人群中移除对应的代理
       }  
       // 从映射中移除
-      _mapped_vehicles_id.erase(it);
       _mapped_by_index.erase(it->second);
+      _mapped_vehicles_id.erase(it);
 
       return true;
     }
@@ -861,6 +830,10 @@ namespace nav {
 
   // 更新人群中的所有行人
   void Navigation::UpdateCrowd(const client::detail::EpisodeState &state) {
+    UpdateCrowd(state.GetTimestamp().delta_seconds);
+  }
+
+  void Navigation::UpdateCrowd(double delta_seconds) {
 
     // 检查是否一切就绪
     if (!_ready) {
@@ -869,87 +842,91 @@ namespace nav {
 
     DEBUG_ASSERT(_crowd != nullptr);
 
-    // 更新人群代理
-    _delta_seconds = state.GetTimestamp().delta_seconds;
+    // 更新检查被堵塞代理的时间
+    _delta_seconds = delta_seconds;
+    _time_to_unblock += _delta_seconds;
+    const bool check_blocked = (_time_to_unblock >= AGENT_UNBLOCK_TIME);
+
+    // 更新人群代理并发布所有代理的新状态。转向和避障都在 dtCrowd::update
+    // 中完成，它是外部 Recast 库的一次调用，所有代理共用同一个邻近网格和
+    // 避障查询对象，不能按代理分段并行，所以这一步仍然是串行的；
+    // 只有之后逐个代理计算状态的部分在线程池上并行
+    std::vector<int> blocked;
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex);
       _crowd->update(static_cast<float>(_delta_seconds), nullptr);
+      PublishAgentSnapshot(check_blocked, blocked);
     }
 
     // 更新行人路线
     _walker_manager.Update(_delta_seconds);
 
-    // 更新检查被堵塞代理的时间
-    _time_to_unblock += _delta_seconds;
-
-    // 查看所有活跃代理
-    int total_unblocked = 0;
-    int total_agents;
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      total_agents = _crowd->getAgentCount();
+    // 为被堵住的行人设置新的随机目标
+    for (const int index : blocked) {
+      carla::geom::Location location;
+      GetRandomLocation(location, nullptr);
+      _walker_manager.SetWalkerRoute(_mapped_by_index[index], location);
     }
-    const dtCrowdAgent *ag;
-    for (int i = 0; i < total_agents; ++i) {
-      {
-        // 关键部分，强制单线程运行这里
-        std::lock_guard<std::mutex> lock(_mutex);
-        ag = _crowd->getAgent(i);
-      }
 
-      if (!ag->active || ag->paused || ag->dead) {
-        continue;
-      }
+    // 检查重置时间
+    if (check_blocked) {
+      _time_to_unblock = 0.0f;
+    }
+  }
 
-      // 仅检查未暂停的行人，不检查车辆
-      if (!ag->params.useObb && !ag->paused) {
-        bool reset_target_pos = false;
-        bool use_same_filter = false;
+  void Navigation::PublishAgentSnapshot(bool check_blocked, std::vector<int> &blocked) {
+    const size_t total_agents = static_cast<size_t>(_crowd->getAgentCount());
+    _agent_yaw.resize(total_agents, 0.0f);
+    _walkers_blocked_position.resize(total_agents);
+    auto snapshot = std::make_shared<std::vector<AgentState>>(total_agents);
+    std::vector<uint8_t> is_blocked(check_blocked ? total_agents : 0u, 0u);
+
+    // 每个代理只读写自己下标处的数据，可以按下标分段并行计算
+    auto compute = [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const dtCrowdAgent *agent = _crowd->getAgent(static_cast<int>(i));
+        AgentState &state = (*snapshot)[i];
+        const auto it = _mapped_by_index.find(static_cast<int>(i));
+        state.id = (it != _mapped_by_index.end()) ? it->second : 0u;
+        ComputeAgentState(*agent, _agent_yaw[i], _delta_seconds, state);
+        if (!agent->active) {
+          continue;
+        }
+        _agent_yaw[i] = state.transform.rotation.yaw;
 
-        // 检查参与者是否解除堵塞
-        if (_time_to_unblock >= AGENT_UNBLOCK_TIME) {
+        // 检查未暂停的行人是否被堵住，不检查车辆
+        if (check_blocked && !agent->params.useObb && !agent->paused && !agent->dead) {
           // 获取每个参与者移动的距离
-          carla::geom::Vector3D previous = _walkers_blocked_position[i];
-          carla::geom::Vector3D current = carla::geom::Vector3D(ag->npos[0], ag->npos[1], ag->npos[2]);
-          carla::geom::Vector3D distance = current - previous;
-          float d = distance.SquaredLength();
-          if (d < AGENT_UNBLOCK_DISTANCE_SQUARED) {
-            ++total_unblocked;
-            reset_target_pos = true;
-            use_same_filter = true;
+          const carla::geom::Vector3D current(agent->npos[0], agent->npos[1], agent->npos[2]);
+          const carla::geom::Vector3D distance = current - _walkers_blocked_position[i];
+          if (distance.SquaredLength() < AGENT_UNBLOCK_DISTANCE_SQUARED) {
+            is_blocked[i] = 1u;
           }
           // 更新当前位置
           _walkers_blocked_position[i] = current;
-
-          // check to assign a new target position
-          if (reset_target_pos) {
-            // set if the agent can cross roads or not
-            if (!use_same_filter) {
-              if (frand() <= _probability_crossing) {
-                SetAgentFilter(i, 1);
-              } else {
-                SetAgentFilter(i, 0);
-              }
-            }
-            // 设置新的随机目标
-            carla::geom::Location location;
-            GetRandomLocation(location, nullptr);
-            _walker_manager.SetWalkerRoute(_mapped_by_index[i], location);
-          }
         }
       }
+    };
+    if (total_agents >= 2u * MIN_AGENTS_PER_TASK && _number_of_workers > 0u) {
+      if (!_thread_pool_started) {
+        _thread_pool.AsyncRun(_number_of_workers);
+        _thread_pool_started = true;
+      }
+      RunInChunks(_thread_pool, _number_of_workers, total_agents, compute);
+    } else {
+      compute(0u, total_agents);
     }
 
-    // 检查重置时间
-    if (_time_to_unblock >= AGENT_UNBLOCK_TIME) {
-      _time_to_unblock = 0.0f;
+    for (size_t i = 0u; i < is_blocked.size(); ++i) {
+      if (is_blocked[i] != 0u) {
+        blocked.push_back(static_cast<int>(i));
+      }
     }
+    _agent_snapshot.store(std::move(snapshot));
   }
 
-  // 获取行人当前变换
-  bool Navigation::GetWalkerTransform(ActorId id, carla::geom::Transform &trans) {
+  bool Navigation::GetAgentState(ActorId id, AgentState &state) {
 
     // 检查是否一切就绪
     if (!_ready) {
@@ -970,121 +947,81 @@ namespace nav {
       return false;
     }
 
-    // 获得行人
-    const dtCrowdAgent *agent;
+    // 读取上一次更新发布的快照，不需要加锁
+    const auto snapshot = _agent_snapshot.load();
+    if (snapshot != nullptr &&
+        static_cast<size_t>(index) < snapshot->size() &&
+        (*snapshot)[static_cast<size_t>(index)].id == id) {
+      state = (*snapshot)[static_cast<size_t>(index)];
+      return true;
+    }
+
+    // 上一次更新之后才加入的行人，直接读取代理
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getAgent(index);
+      const float previous_yaw = static_cast<size_t>(index) < _agent_yaw.size() ?
+          _agent_yaw[static_cast<size_t>(index)] : 0.0f;
+      ComputeAgentState(*_crowd->getAgent(index), previous_yaw, _delta_seconds, state);
     }
+    state.id = id;
+    return true;
+  }
 
-    if (!agent->active) {
+  // 获取行人当前变换
+  bool Navigation::GetWalkerTransform(ActorId id, carla::geom::Transform &trans) {
+    AgentState state;
+    if (!GetAgentState(id, state) || !state.active) {
       return false;
     }
-
-    // 在虚幻坐标中设置其位置
-    trans.location.x = agent->npos[0];
-    trans.location.y = agent->npos[2];
-    trans.location.z = agent->npos[1];
-
-    // 设置其旋转
-    float yaw;
-    float speed = 0.0f;
-    float min = 0.1f;
-    if (agent->vel[0] < -min || agent->vel[0] > min ||
-        agent->vel[2] < -min || agent->vel[2] > min) {
-      yaw = atan2f(agent->vel[2], agent->vel[0]) * (180.0f / static_cast<float>(M_PI));
-      speed = sqrtf(agent->vel[0] * agent->vel[0] + agent->vel[1] * agent->vel[1] + agent->vel[2] * agent->vel[2]);
-    } else {
-      yaw = atan2f(agent->dvel[2], agent->dvel[0]) * (180.0f / static_cast<float>(M_PI));
-      speed = sqrtf(agent->dvel[0] * agent->dvel[0] + agent->dvel[1] * agent->dvel[1] + agent->dvel[2] * agent->dvel[2]);
-    }
-
-    // 插入当前角度和目标角度
-    float shortest_angle = fmod(yaw - _yaw_walkers[id] + 540.0f, 360.0f) - 180.0f;
-    float per = (speed / 1.5f);
-    if (per > 1.0f) per = 1.0f;
-    float rotation_speed = per * 6.0f;
-    trans.rotation.yaw = _yaw_walkers[id] +
-    (shortest_angle * rotation_speed * static_cast<float>(_delta_seconds));
-    _yaw_walkers[id] = trans.rotation.yaw;
-
+    trans = state.transform;
     return true;
   }
 
-  // 获取行人的当前位置
-  bool Navigation::GetWalkerPosition(ActorId id, carla::geom::Location &location) {
-
-    // 检查是否一切就绪
+  // 一次性获取所有活跃行人的状态
+  void Navigation::GetWalkerStates(WalkerStates &states) const {
+    states.clear();
     if (!_ready) {
-      return false;
-    }
-
-    DEBUG_ASSERT(_crowd != nullptr);
-
-    // 获取内部索引
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end()) {
-      return false;
+      return;
     }
 
-    // 找到索引
-    int index = it->second;
-    if (index == -1) {
-      return false;
+    // 读取上一次更新发布的快照，不需要加锁
+    const auto snapshot = _agent_snapshot.load();
+    if (snapshot == nullptr) {
+      return;
     }
-
-    // 获得行人
-    const dtCrowdAgent *agent;
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getAgent(index);
+    states.ids.reserve(snapshot->size());
+    states.transforms.reserve(snapshot->size());
+    states.speeds.reserve(snapshot->size());
+    for (const auto &state : *snapshot) {
+      if (!state.active || !state.is_walker || state.id == 0u) {
+        continue;
+      }
+      states.ids.push_back(state.id);
+      states.transforms.push_back(state.transform);
+      states.speeds.push_back(state.speed);
+      if (!state.alive) {
+        states.dead.push_back(state.id);
+      }
     }
+  }
 
-    if (!agent->active) {
+  // 获取行人的当前位置
+  bool Navigation::GetWalkerPosition(ActorId id, carla::geom::Location &location) {
+    AgentState state;
+    if (!GetAgentState(id, state) || !state.active) {
       return false;
     }
-
-    // 在虚幻坐标中设置其位置
-    location.x = agent->npos[0];
-    location.y = agent->npos[2];
-    location.z = agent->npos[1];
-
+    location = state.transform.location;
     return true;
   }
 
   float Navigation::GetWalkerSpeed(ActorId id) {
-
-    // 检查是否一切就绪
-    if (!_ready) {
-      return 0.0f;
-    }
-
-    DEBUG_ASSERT(_crowd != nullptr);
-
-    // 获取内部索引
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end()) {
-      return 0.0f;
-    }
-
-    // 找到索引
-    int index = it->second;
-    if (index == -1) {
+    AgentState state;
+    if (!GetAgentState(id, state)) {
       return 0.0f;
     }
-
-    // 获得行人
-    const dtCrowdAgent *agent;
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getAgent(index);
-    }
-
-    return sqrt(agent->vel[0] * agent->vel[0] + agent->vel[1] * agent->vel[1] + agent->vel[2] *
-    agent->vel[2]);
+    return state.speed;
   }
 
   // 获取随机的导航位置
@@ -1240,35 +1177,13 @@ namespace nav {
   }
 
   bool Navigation::IsWalkerAlive(ActorId id, bool &alive) {
-    // 检查是否所有都就绪
-    if (!_ready) {
-      return false;
-    }
-
-    DEBUG_ASSERT(_crowd != nullptr);
-
-    // 获取内部索引
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end()) {
+    AgentState state;
+    if (!GetAgentState(id, state)) {
       return false;
     }
 
-    // 找到索引
-    int index = it->second;
-    if (index == -1) {
-      return false;
-    }
-
-    // 获取行人
-    const dtCrowdAgent *agent;
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getAgent(index);
-    }
-
     // 标记
-    alive = !agent->dead;
+    alive = state.alive;
 
     return true;
   }
@@ -7,12 +7,15 @@
 #pragma once
 
 #include "carla/AtomicList.h"
+#include "carla/AtomicSharedPtr.h"
+#include "carla/ThreadPool.h"
 #include "carla/client/detail/EpisodeState.h"
 #include "carla/geom/BoundingBox.h"
 
 // 使用几何库相关功能
 #include "carla/geom/Location.h"
 #include "carla/geom/Transform.h"
+#include "carla/nav/PathPlanner.h"
 #include "carla/nav/WalkerManager.h" 
 
 // 使用远程过程调用相关功能
@@ -33,6 +36,9 @@
 #include <recast/DetourCommon.h>
 // 可能包含Recast/Detour库中使用的通用定义、枚举和数据结构
 
+#include <future>
+#include <memory>
+
 namespace carla {
 // 定义命名空间carla，它是CARLA自动驾驶仿真平台的命名空间
 namespace nav {
@@ -80,6 +86,42 @@ namespace nav {
     carla::geom::BoundingBox bounding;
   };
 
+  /// 人群中一个代理在上一次 UpdateCrowd 之后的状态
+  struct AgentState {
+    carla::rpc::ActorId id;
+    /// 虚幻坐标中的变换，偏航角已经做过平滑
+    carla::geom::Transform transform;
+    float speed;
+    /// 代理是否活跃
+    bool active;
+    /// 是否是行人（否则是让行人避让的车辆）
+    bool is_walker;
+    /// 行人是否没有被车辆撞到
+    bool alive;
+  };
+
+  /// 所有活跃行人在上一次 UpdateCrowd 之后的状态，按列连续存放，第 i 个
+  /// 行人的数据在每个数组的第 i 个位置
+  struct WalkerStates {
+    std::vector<carla::rpc::ActorId> ids;
+    std::vector<carla::geom::Transform> transforms;
+    std::vector<float> speeds;
+    /// 被车辆撞死的行人
+    std::vector<carla::rpc::ActorId> dead;
+
+    size_t size() const {
+      return ids.size();
+    }
+
+    /// 清空所有数组，保留已分配的容量
+    void clear() {
+      ids.clear();
+      transforms.clear();
+      speeds.clear();
+      dead.clear();
+    }
+  };
+
   /// 管理行人导航，使用 Recast & Detour 库进行低层计算。
   ///
   /// 该类从服务器获取地图的二进制内容，这是查找路径所必需的。然后，这个类可以添加或删除行人，并为每个行人设置目标步行点。
@@ -135,6 +177,12 @@ namespace nav {
 //   - 与GetPath函数相比，GetAgentRoute函数可能考虑了更多的因素，如代理的类型、尺寸、速度限制等，以生成更适合代理的路由。
 //   - 在实际使用中，这些函数可能会依赖于CARLA仿真平台中的导航系统和地图数据来执行查询。
     std::vector<carla::geom::Location> &path, std::vector<unsigned char> &area);
+    /// 与 GetPath 相同，在路径规划线程池上执行，不阻塞调用线程
+    std::future<boost::optional<NavPath>> GetPathAsync(carla::geom::Location from, carla::geom::Location to,
+        const dtQueryFilter *filter = nullptr);
+    /// 与 GetAgentRoute 相同，在路径规划线程池上执行，不阻塞调用线程
+    std::future<boost::optional<NavPath>> GetAgentRouteAsync(ActorId id, carla::geom::Location from,
+        carla::geom::Location to);
 
     /// 引用模拟器来访问API函数
     void SetSimulator(std::weak_ptr<carla::client::detail::Simulator> simulator);
@@ -163,8 +211,17 @@ namespace nav {
     bool GetWalkerPosition(ActorId id, carla::geom::Location &location);
     /// 获取步行人速度
     float GetWalkerSpeed(ActorId id);
-    /// 更新人群中的所有步行者
+    /// 一次性读取所有活跃行人的 id、变换和速度，不需要逐个查找。@a states
+    /// 先被清空，重复使用同一个对象可以避免每次重新分配内存
+    void GetWalkerStates(WalkerStates &states) const;
+    /// 更新人群中的所有步行者。
+    ///
+    /// 转向和避障由 dtCrowd::update 串行完成；之后在线程池上按代理分段并行
+    /// 计算所有代理的变换和速度，并发布为一个快照；GetWalkerTransform、GetWalkerPosition、GetWalkerSpeed
+    /// 和 IsWalkerAlive 读取这个快照，不需要加锁。
     void UpdateCrowd(const client::detail::EpisodeState &state);
+    /// 与上面相同，直接指定时间步长
+    void UpdateCrowd(double delta_seconds);
     /// 获取导航的随机位置
     bool GetRandomLocation(carla::geom::Location &location, dtQueryFilter * filter = nullptr) const;
     /// 设置行人代理在路径跟随过程中穿过马路的概率
@@ -191,6 +248,8 @@ namespace nav {
     /// 网格
     dtNavMesh *_nav_mesh { nullptr };
     dtNavMeshQuery *_nav_query { nullptr };
+    /// 路径规划器，GetPath 和 GetAgentRoute 使用它自己的查询对象，不需要 _mutex
+    std::unique_ptr<PathPlanner> _path_planner;
     /// crowd
     dtCrowd *_crowd { nullptr };
     /// mapping Id
@@ -198,10 +257,12 @@ namespace nav {
     std::unordered_map<ActorId, int> _mapped_vehicles_id;
     // 也可以通过索引进行映射
     std::unordered_map<int, ActorId> _mapped_by_index;
-    /// 存储上一个节拍的行人偏航角
-    std::unordered_map<ActorId, float> _yaw_walkers;
-    /// 每隔一段时间保存每个参与者的位置，并检查是否有参与者被阻挡
-    std::unordered_map<int, carla::geom::Vector3D> _walkers_blocked_position;
+    /// 上一次更新后每个代理的偏航角，按代理下标存放，读写时必须持有 _mutex
+    std::vector<float> _agent_yaw;
+    /// 每隔一段时间保存每个参与者的位置，并检查是否有参与者被阻挡，按代理下标存放
+    std::vector<carla::geom::Vector3D> _walkers_blocked_position;
+    /// 上一次 UpdateCrowd 发布的所有代理状态，按代理下标存放，发布后不再修改
+    AtomicSharedPtr<const std::vector<AgentState>> _agent_snapshot;
     double _time_to_unblock { 0.0 };
 
     /// 行人管理器负责带事件的路线规划
@@ -213,8 +274,22 @@ namespace nav {
 
     float _probability_crossing { 0.0f };
 
+    /// 并行计算代理状态的线程池，代理足够多时才启动
+    ThreadPool _thread_pool;
+    size_t _number_of_workers { 0u };
+    bool _thread_pool_started { false };
+
     /// 为代理分配过滤索引
     void SetAgentFilter(int agent_index, int filter_index);
+
+    /// 计算所有代理的状态并发布快照，同时找出被堵住的行人，调用时必须持有 _mutex
+    void PublishAgentSnapshot(bool check_blocked, std::vector<int> &blocked);
+
+    /// 复制行人 @a id 当前使用的过滤器，行人不存在时返回 false
+    bool GetAgentFilter(ActorId id, dtQueryFilter &filter);
+
+    /// 获取行人 @a id 的状态，行人不存在时返回 false
+    bool GetAgentState(ActorId id, AgentState &state);
   };
 
 } // namespace nav
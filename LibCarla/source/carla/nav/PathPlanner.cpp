@@ -0,0 +1,238 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/nav/PathPlanner.h"
+
+#include "carla/Exception.h"
+
+#include <recast/DetourCommon.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <new>
+
+namespace carla {
+namespace nav {
+
+  // 与 Navigation 中的设置相同
+  static const int MAX_POLYS = 256;
+
+  // 查找起点和终点所在多边形时的搜索范围
+  static const float POLY_PICK_EXTENTS[3] = { 2.0f, 4.0f, 2.0f };
+
+  // 计算过滤器的包含、排除标志和所有区域代价的哈希（FNV-1a）
+  static uint64_t HashFilter(const dtQueryFilter &filter) {
+    constexpr uint64_t prime = 1099511628211ull;
+    uint64_t hash = 14695981039346656037ull;
+    auto combine = [&](uint32_t value) {
+      hash = (hash ^ value) * prime;
+    };
+    combine(filter.getIncludeFlags());
+    combine(filter.getExcludeFlags());
+    for (int i = 0; i < DT_MAX_AREAS; ++i) {
+      const float cost = filter.getAreaCost(i);
+      uint32_t bits;
+      std::memcpy(&bits, &cost, sizeof(bits));
+      combine(bits);
+    }
+    return hash;
+  }
+
+  // 把坐标量化到 CACHE_RESOLUTION 的格子。调用前已经在坐标附近找到了多边形，
+  // 坐标一定是有限的，并且在导航网格的范围内
+  static void QuantizePosition(const float pos[3], int32_t cell[3]) {
+    for (int i = 0; i < 3; ++i) {
+      cell[i] = static_cast<int32_t>(std::floor(pos[i] / PathPlanner::CACHE_RESOLUTION));
+    }
+  }
+
+  size_t PathPlanner::CacheKeyHash::operator()(const CacheKey &key) const {
+    uint64_t hash = key.filter;
+    auto combine = [&](uint64_t value) {
+      hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    };
+    combine(static_cast<uint64_t>(key.start));
+    combine(static_cast<uint64_t>(key.end));
+    for (int i = 0; i < 3; ++i) {
+      combine(static_cast<uint32_t>(key.start_cell[i]));
+      combine(static_cast<uint32_t>(key.end_cell[i]));
+    }
+    return static_cast<size_t>(hash);
+  }
+
+  bool PathPlanner::CacheKeyEqual::operator()(const CacheKey &lhs, const CacheKey &rhs) const {
+    return lhs.start == rhs.start && lhs.end == rhs.end && lhs.filter == rhs.filter &&
+        std::equal(lhs.start_cell, lhs.start_cell + 3, rhs.start_cell) &&
+        std::equal(lhs.end_cell, lhs.end_cell + 3, rhs.end_cell);
+  }
+
+  PathPlanner::PathPlanner(
+      const dtNavMesh &mesh,
+      int max_search_nodes,
+      size_t number_of_workers,
+      size_t cache_capacity)
+    : _mesh(mesh),
+      _cache(cache_capacity) {
+    // 每个工作线程一个查询对象，另外两个留给同步调用的线程
+    const size_t number_of_queries = number_of_workers + 2u;
+    _queries.reserve(number_of_queries);
+    for (size_t i = 0u; i < number_of_queries; ++i) {
+      dtNavMeshQuery *query = dtAllocNavMeshQuery();
+      if (query == nullptr) {
+        for (auto *allocated : _queries) {
+          dtFreeNavMeshQuery(allocated);
+        }
+        throw_exception(std::bad_alloc());
+      }
+      query->init(&_mesh, max_search_nodes);
+      _queries.push_back(query);
+    }
+    _free_queries = _queries;
+    if (number_of_workers > 0u) {
+      _thread_pool.AsyncRun(number_of_workers);
+    }
+  }
+
+  PathPlanner::~PathPlanner() {
+    // 先停止线程池，确保没有线程还在使用查询对象
+    _thread_pool.Stop();
+    for (auto *query : _queries) {
+      dtFreeNavMeshQuery(query);
+    }
+  }
+
+  dtNavMeshQuery *PathPlanner::AcquireQuery() {
+    std::unique_lock<std::mutex> lock(_queries_mutex);
+    _queries_available.wait(lock, [this]() { return !_free_queries.empty(); });
+    dtNavMeshQuery *query = _free_queries.back();
+    _free_queries.pop_back();
+    return query;
+  }
+
+  void PathPlanner::ReleaseQuery(dtNavMeshQuery *query) {
+    {
+      std::lock_guard<std::mutex> lock(_queries_mutex);
+      _free_queries.push_back(query);
+    }
+    _queries_available.notify_one();
+  }
+
+  bool PathPlanner::FindPath(
+      carla::geom::Location from,
+      carla::geom::Location to,
+      const dtQueryFilter &filter,
+      NavPath &result) {
+    dtNavMeshQuery *query = AcquireQuery();
+    bool found = false;
+    try {
+      found = FindPath(*query, from, to, filter, result);
+    } catch (...) {
+      ReleaseQuery(query);
+      throw;
+    }
+    ReleaseQuery(query);
+    return found;
+  }
+
+  std::future<boost::optional<NavPath>> PathPlanner::FindPathAsync(
+      carla::geom::Location from,
+      carla::geom::Location to,
+      const dtQueryFilter &filter) {
+    return _thread_pool.Post([this, from, to, filter]() -> boost::optional<NavPath> {
+      NavPath result;
+      if (!FindPath(from, to, filter, result)) {
+        return boost::none;
+      }
+      return result;
+    });
+  }
+
+  bool PathPlanner::FindPath(
+      dtNavMeshQuery &query,
+      carla::geom::Location from,
+      carla::geom::Location to,
+      const dtQueryFilter &filter,
+      NavPath &result) {
+    result.path.clear();
+    result.area.clear();
+
+    // 找到起点和终点所在的多边形，转换为 Detour 的坐标顺序（x, z, y）
+    dtPolyRef start_ref = 0;
+    dtPolyRef end_ref = 0;
+    float start_pos[3] = { from.x, from.z, from.y };
+    float end_pos[3] = { to.x, to.z, to.y };
+    query.findNearestPoly(start_pos, POLY_PICK_EXTENTS, &filter, &start_ref, 0);
+    query.findNearestPoly(end_pos, POLY_PICK_EXTENTS, &filter, &end_ref, 0);
+    if (!start_ref || !end_ref) {
+      return false;
+    }
+
+    // 获取多边形通道，起止多边形、量化后的端点和过滤器都相同时直接使用缓存
+    const bool use_cache = _cache.GetCapacity() > 0u;
+    CacheKey key;
+    std::vector<dtPolyRef> polys;
+    bool cached = false;
+    if (use_cache) {
+      key.start = start_ref;
+      key.end = end_ref;
+      QuantizePosition(start_pos, key.start_cell);
+      QuantizePosition(end_pos, key.end_cell);
+      key.filter = HashFilter(filter);
+      std::lock_guard<std::mutex> lock(_cache_mutex);
+      cached = _cache.Get(key, polys);
+    }
+    if (cached) {
+      ++_cache_hits;
+    } else {
+      ++_cache_misses;
+      int num_polys = 0;
+      polys.resize(MAX_POLYS);
+      query.findPath(start_ref, end_ref, start_pos, end_pos, &filter, polys.data(), &num_polys, MAX_POLYS);
+      polys.resize(static_cast<size_t>(num_polys));
+      if (use_cache) {
+        std::lock_guard<std::mutex> lock(_cache_mutex);
+        _cache.Put(key, polys);
+      }
+    }
+    if (polys.empty()) {
+      return false;
+    }
+    const int num_polys = static_cast<int>(polys.size());
+
+    // 如果是部分路径，请确保终点与最后一个多边形相接
+    float end_pos2[3];
+    dtVcopy(end_pos2, end_pos);
+    if (polys.back() != end_ref) {
+      query.closestPointOnPoly(polys.back(), end_pos, end_pos2, 0);
+    }
+
+    // 拉直路径
+    float straight_path[MAX_POLYS * 3];
+    unsigned char straight_path_flags[MAX_POLYS];
+    dtPolyRef straight_path_polys[MAX_POLYS];
+    int num_straight_path = 0;
+    query.findStraightPath(start_pos, end_pos2, polys.data(), num_polys,
+        straight_path, straight_path_flags,
+        straight_path_polys, &num_straight_path, MAX_POLYS, DT_STRAIGHTPATH_AREA_CROSSINGS);
+
+    // 将路径复制到输出缓冲区
+    result.path.reserve(static_cast<size_t>(num_straight_path));
+    result.area.reserve(static_cast<size_t>(num_straight_path));
+    for (int i = 0, j = 0; j < num_straight_path; i += 3, ++j) {
+      // 保存虚幻轴的坐标（x，z，y）
+      result.path.emplace_back(straight_path[i], straight_path[i + 2], straight_path[i + 1]);
+      // 保存区域类型
+      unsigned char area_type = 0u;
+      _mesh.getPolyArea(straight_path_polys[j], &area_type);
+      result.area.emplace_back(area_type);
+    }
+
+    return true;
+  }
+
+} // namespace nav
+} // namespace carla
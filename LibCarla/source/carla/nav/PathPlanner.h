@@ -0,0 +1,145 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/LruCache.h"
+#include "carla/NonCopyable.h"
+#include "carla/ThreadPool.h"
+#include "carla/geom/Location.h"
+
+#include <recast/DetourNavMesh.h>
+#include <recast/DetourNavMeshQuery.h>
+
+#include <boost/optional.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <vector>
+
+namespace carla {
+namespace nav {
+
+  /// 导航网格上的一条路径
+  struct NavPath {
+    /// 虚幻坐标中的路径点
+    std::vector<carla::geom::Location> path;
+    /// 每个路径点所在多边形的区域类型
+    std::vector<unsigned char> area;
+  };
+
+  /// 在导航网格上规划路径，可以在调用线程上同步执行，也可以提交到线程池。
+  ///
+  /// 每个线程使用自己的 dtNavMeshQuery，不同的查询之间不需要加锁。
+  ///
+  /// findPath 得到的多边形通道按起点和终点所在的多边形、量化到
+  /// CACHE_RESOLUTION 的起点和终点坐标以及过滤器缓存起来，命中时只需要
+  /// 用确切的端点重新拉直路径。findPath 的代价与端点的确切位置有关，所以
+  /// 复用的通道可能与重新搜索得到的通道略有不同，只有端点完全相同的查询
+  /// 才保证得到相同的结果。cache_capacity 为 0 时不使用缓存。
+  ///
+  /// 导航网格在规划器的整个生命周期内不能修改。
+  class PathPlanner : private NonCopyable {
+  public:
+
+    PathPlanner(
+        const dtNavMesh &mesh,
+        int max_search_nodes,
+        size_t number_of_workers,
+        size_t cache_capacity = DEFAULT_CACHE_CAPACITY);
+
+    ~PathPlanner();
+
+    /// 在调用线程上规划从 @a from 到 @a to 的路径，找不到时返回 false
+    bool FindPath(
+        carla::geom::Location from,
+        carla::geom::Location to,
+        const dtQueryFilter &filter,
+        NavPath &result);
+
+    /// 在线程池上规划路径，找不到路径时 future 的结果为空。规划器销毁时
+    /// 尚未执行的请求会以 std::future_error 结束
+    std::future<boost::optional<NavPath>> FindPathAsync(
+        carla::geom::Location from,
+        carla::geom::Location to,
+        const dtQueryFilter &filter);
+
+    /// 命中缓存的查询数
+    size_t GetCacheHits() const {
+      return _cache_hits;
+    }
+
+    /// 没有命中缓存的查询数
+    size_t GetCacheMisses() const {
+      return _cache_misses;
+    }
+
+    static constexpr size_t DEFAULT_CACHE_CAPACITY = 4096u;
+
+    /// 缓存键中起点和终点坐标的量化精度（米）
+    static constexpr float CACHE_RESOLUTION = 0.25f;
+
+  private:
+
+    /// 从空闲列表中借出一个查询对象，全部在使用时等待
+    dtNavMeshQuery *AcquireQuery();
+
+    void ReleaseQuery(dtNavMeshQuery *query);
+
+    /// 用 @a query 规划路径
+    bool FindPath(
+        dtNavMeshQuery &query,
+        carla::geom::Location from,
+        carla::geom::Location to,
+        const dtQueryFilter &filter,
+        NavPath &result);
+
+    /// 多边形通道缓存的键
+    struct CacheKey {
+      dtPolyRef start;
+      dtPolyRef end;
+      /// 按 CACHE_RESOLUTION 量化的起点和终点坐标（Detour 的坐标顺序）
+      int32_t start_cell[3];
+      int32_t end_cell[3];
+      /// 过滤器标志和区域代价的哈希
+      uint64_t filter;
+    };
+
+    struct CacheKeyHash {
+      size_t operator()(const CacheKey &key) const;
+    };
+
+    struct CacheKeyEqual {
+      bool operator()(const CacheKey &lhs, const CacheKey &rhs) const;
+    };
+
+    const dtNavMesh &_mesh;
+
+    /// 所有查询对象，以及当前没有被使用的
+    std::vector<dtNavMeshQuery *> _queries;
+
+    std::vector<dtNavMeshQuery *> _free_queries;
+
+    std::mutex _queries_mutex;
+
+    std::condition_variable _queries_available;
+
+    std::mutex _cache_mutex;
+
+    LruCache<CacheKey, std::vector<dtPolyRef>, CacheKeyHash, CacheKeyEqual> _cache;
+
+    std::atomic_size_t _cache_hits { 0u };
+
+    std::atomic_size_t _cache_misses { 0u };
+
+    ThreadPool _thread_pool;
+  };
+
+} // namespace nav
+} // namespace carla
@@ -66,6 +66,22 @@ namespace nav {
             // 获取行人信息
             WalkerInfo &info = it.second;
 
+            // 等待中的路径规划完成后生成路线
+            if (info.pending_route.valid()) {
+                if (info.pending_route.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                    continue;
+                NavPath path;
+                try {
+                    auto result = info.pending_route.get();
+                    if (result)
+                        path = std::move(*result);
+                } catch (const std::exception &e) {
+                    log_warning("walker route planning failed:", e.what());
+                }
+                BuildWalkerRoute(it.first, info, path);
+                continue;
+            }
+
             // 根据状态执行不同的操作
             switch (info.state) {
                 case WALKER_IDLE:
@@ -137,28 +153,32 @@ namespace nav {
 
         // 获取行人信息
         WalkerInfo &info = it->second;
-        std::vector<carla::geom::Location> path;
-        std::vector<unsigned char> area;// 存储区域信息
 
         // 保存起点和终点
         _nav->GetWalkerPosition(id, info.from);
         info.to = to;
         info.currentIndex = 0;
-        info.state = WALKER_IDLE;// 初始化状态为闲置
+        info.state = WALKER_IDLE;// 等待路径规划完成前保持闲置
+        info.route.clear();
 
-        // 从导航中获取路径
-        _nav->GetAgentRoute(id, info.from, to, path, area);
+        // 在路径规划线程池上获取路径，完成后在 Update 中生成路线
+        info.pending_route = _nav->GetAgentRouteAsync(id, info.from, to);
+        return true;
+    }
 
+    // 用规划好的路径生成行人的路线
+    void WalkerManager::BuildWalkerRoute(ActorId id, WalkerInfo &info, NavPath &path) {
         // 创建每个路径点
         info.route.clear();// 清空现有路线
-        info.route.reserve(path.size());// 预留空间
+        info.route.reserve(path.path.size());// 预留空间
         unsigned char previous_area = CARLA_AREA_SIDEWALK;// 记录前一个区域类型
-        for (unsigned int i=0; i<path.size(); ++i) {
+        for (unsigned int i=0; i<path.path.size(); ++i) {
+            const unsigned char area = path.area[i];
             // 获取区域类型
-            switch (area[i]) {
+            switch (area) {
                 // 忽略侧道
                 case CARLA_AREA_SIDEWALK:
-                    info.route.emplace_back(WalkerEventIgnore(), std::move(path[i]), area[i]);
+                    info.route.emplace_back(WalkerEventIgnore(), std::move(path.path[i]), area);
                     break;
 
                 // 在道路或人行道上停止并检查
@@ -166,18 +186,17 @@ namespace nav {
                 case CARLA_AREA_CROSSWALK:
                     // 仅当来自安全区域（人行道、草地或人行横道）时
                     if (previous_area != CARLA_AREA_CROSSWALK && previous_area != CARLA_AREA_ROAD)
-                        info.route.emplace_back(WalkerEventStopAndCheck(60), std::move(path[i]), area[i]);
+                        info.route.emplace_back(WalkerEventStopAndCheck(60), std::move(path.path[i]), area);
                     break;
 
                 default:
-                    info.route.emplace_back(WalkerEventIgnore(), std::move(path[i]), area[i]);
+                    info.route.emplace_back(WalkerEventIgnore(), std::move(path.path[i]), area);
             }
-            previous_area = area[i];
+            previous_area = area;
         }
 
         // 分配下一个要走的点
         SetWalkerNextPoint(id);
-        return true;
     }
 
     // 设置路线中的下一个点
@@ -279,6 +298,9 @@ namespace nav {
         static bool AlreadyCalculated = false;
         if (AlreadyCalculated) return;
 
+        // 没有连接模拟器时（例如单独使用导航）没有交通灯
+        if (_simulator.expired()) return;
+
         // 获取世界对象
         carla::client::World world = _simulator.lock()->GetWorld();
 
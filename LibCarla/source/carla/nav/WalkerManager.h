@@ -12,6 +12,7 @@
 #include "carla/client/TrafficLight.h" // 包含Carla客户端中与整个虚拟世界（World）相关的头文件，可能用于访问世界中的各种实体、获取世界相关的属性等操作
 #include "carla/client/World.h"// 包含Carla项目中几何位置（Location）相关的头文件，用于表示虚拟世界中的点坐标等几何信息，比如行人、车辆等的位置
 #include "carla/geom/Location.h"// 包含Carla项目中导航（nav）相关的行人事件（WalkerEvent）头文件，可能用于定义行人在行走过程中遇到的各种事件类型
+#include "carla/nav/PathPlanner.h"
 #include "carla/nav/WalkerEvent.h"// 包含Carla项目中远程过程调用（RPC）相关的演员（Actor）标识符（ActorId）头文件，用于唯一标识虚拟世界中的各种实体（如行人、车辆等）
 #include "carla/rpc/ActorId.h"// 包含Carla项目中远程过程调用（RPC）相关的交通信号灯状态（TrafficLightState）头文件，用于表示交通信号灯的不同状态（如红灯、绿灯等）
 #include "carla/rpc/TrafficLightState.h"
@@ -57,6 +58,7 @@ namespace nav {
         std::vector<WalkerRoutePoint> route;    // route 成员变量，表示行人的路线。
     // 它是一个 std::vector<WalkerRoutePoint> 类型的容器，其中 WalkerRoutePoint 是一个结构体或类，用于存储路线上的单个点（或事件）的信息。
     // std::vector 是C++标准库中的一个动态数组容器，能够根据需要自动调整其大小。
+        std::future<boost::optional<NavPath>> pending_route; // 正在规划的路径，规划完成后生成 route
     };
 
   // 定义 WalkerManager 类用于管理行人及其路径
@@ -135,6 +137,8 @@ namespace nav {
         // 函数会根据行人当前遇到的事件以及相关状态，执行相应的处理逻辑，比如等待交通灯、通过路口等操作，返回处理结果（EventResult类型，具体类型定义可能在别处）
   
     EventResult ExecuteEvent(ActorId id, WalkerInfo &info, double delta);
+    // 用规划好的路径 path 生成行人的路线，并开始走向第一个点
+    void BuildWalkerRoute(ActorId id, WalkerInfo &info, NavPath &path);
 // 使用无序映射（unordered_map）数据结构来存储每个行人（以ActorId作为键）对应的行人信息（WalkerInfo结构体），
         // 方便快速查找、添加、删除和更新每个行人的相关信息
     std::unordered_map<ActorId, WalkerInfo> _walkers;// 使用向量（vector）数据结构来存储交通灯相关的信息，每个元素是一个包含交通灯共享指针（SharedPtr<carla::client::TrafficLight>）
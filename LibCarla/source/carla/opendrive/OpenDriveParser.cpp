@@ -17,18 +17,129 @@
 #include "carla/opendrive/parser/ProfilesParser.h"
 #include "carla/opendrive/parser/RoadParser.h"
 #include "carla/opendrive/parser/SignalParser.h"
+#include "carla/opendrive/parser/TopLevelElementReader.h"
 #include "carla/opendrive/parser/TrafficGroupParser.h"
 #include "carla/road/MapBuilder.h"
+#include "carla/road/MapCache.h"
 // 引入CARLA项目中其他相关头文件，这些文件提供了日志记录、OpenDrive解析的各个部分（如控制器、地理参考、几何形状等）以及地图构建的功能。
 #include <pugixml/pugixml.hpp>
 
+#include <exception>
+#include <streambuf>
+
 // 引入pugixml库的头文件，这是一个用于处理XML的轻量级C++库。
 
 namespace carla {
 namespace opendrive {
 // 声明CARLA的命名空间，以便在代码中使用简短的类名而不需要前缀。
 
+namespace {
+
+  // 超过这个大小的 OpenDRIVE 字符串改用流式解析，避免在字符串之外再保存整个 DOM
+  constexpr size_t STREAMING_THRESHOLD = 32u * 1024u * 1024u;
+
+  // 直接读取字符串内容的输入缓冲区，不复制数据
+  class StringBuffer : public std::streambuf {
+  public:
+
+    explicit StringBuffer(const std::string &str) {
+      char *begin = const_cast<char *>(str.data());
+      setg(begin, begin, begin + str.size());
+    }
+  };
+
+  // 逐个读取并解析顶层元素，输入格式错误或元素解析失败时返回 false
+  bool ParseStream(std::istream &opendrive, road::MapBuilder &map_builder) {
+    parser::TopLevelElementReader reader(opendrive);
+    pugi::xml_document xml;
+    std::string name;
+    std::string element;
+    bool has_header = false;
+
+    while (reader.Next(name, element)) {
+      if (name != "header" && name != "road" && name != "junction" && name != "controller") {
+        continue;
+      }
+      // 现有的解析器都从 OpenDRIVE 根节点开始查找，所以给单个元素补上根节点
+      element.insert(0u, "<OpenDRIVE>");
+      element.append("</OpenDRIVE>");
+      if (!xml.load_buffer_inplace(&element[0], element.size())) {
+        log_warning("unable to parse the OpenDRIVE element <", name, ">");
+        return false;
+      }
+
+      if (name == "header") {
+        parser::GeoReferenceParser::Parse(xml, map_builder);
+        has_header = true;
+      } else if (name == "road") {
+        // 与整个文档解析时的顺序相同，只是每次只处理一条道路
+        parser::RoadParser::Parse(xml, map_builder);
+        parser::GeometryParser::Parse(xml, map_builder);
+        parser::LaneParser::Parse(xml, map_builder);
+        parser::ProfilesParser::Parse(xml, map_builder);
+        parser::SignalParser::Parse(xml, map_builder);
+        parser::ObjectParser::Parse(xml, map_builder);
+      } else if (name == "junction") {
+        // 交叉口和控制器只按 ID 引用道路和信号，由 MapBuilder::Build 统一解析
+        parser::JunctionParser::Parse(xml, map_builder);
+      } else {
+        parser::ControllerParser::Parse(xml, map_builder);
+      }
+    }
+    if (reader.HasError()) {
+      log_warning("malformed OpenDRIVE input:", reader.GetError());
+      return false;
+    }
+
+    if (!has_header) {
+      // 没有 header 时同样使用默认的地理参考
+      xml.reset();
+      xml.append_child("OpenDRIVE");
+      parser::GeoReferenceParser::Parse(xml, map_builder);
+    }
+    parser::TrafficGroupParser::Parse(xml, map_builder);
+
+    return true;
+  }
+
+  boost::optional<road::Map> BuildMap(
+      road::MapBuilder &map_builder,
+      const std::string &opendrive,
+      const std::string &cache_filename) {
+    if (cache_filename.empty()) {
+      return map_builder.Build();
+    }
+    return map_builder.Build(cache_filename, road::cache::Checksum(opendrive));
+  }
+
+} // namespace
+
   boost::optional<road::Map> OpenDriveParser::Load(const std::string &opendrive) {
+    return Load(opendrive, std::string());
+  }
+
+  boost::optional<road::Map> OpenDriveParser::Load(
+      const std::string &opendrive,
+      const std::string &cache_filename) {
+    if (opendrive.size() >= STREAMING_THRESHOLD) {
+      StringBuffer buffer(opendrive);
+      std::istream stream(&buffer);
+      // 流式解析失败时改用 DOM 解析，由它报告最终的错误
+#ifndef LIBCARLA_NO_EXCEPTIONS
+      try {
+#endif // LIBCARLA_NO_EXCEPTIONS
+        carla::road::MapBuilder map_builder;
+        if (ParseStream(stream, map_builder)) {
+          return BuildMap(map_builder, opendrive, cache_filename);
+        }
+        log_warning("streaming OpenDRIVE parser failed; falling back to DOM parser");
+#ifndef LIBCARLA_NO_EXCEPTIONS
+      } catch (const std::exception &e) {
+        log_warning("streaming OpenDRIVE parser failed:", e.what(), "; falling back to DOM parser");
+      }
+#endif // LIBCARLA_NO_EXCEPTIONS
+    }
+
       // OpenDriveParser类的Load成员函数，用于加载并解析OpenDrive格式的地图数据。
     pugi::xml_document xml;
      // 创建一个pugixml的xml_document对象，用于存储和解析XML数据。
@@ -70,6 +181,15 @@ namespace opendrive {
   // 使用ControllerParser解析器解析XML中可能存在的控制器配置信息  ，并将这些信息添加到map_builder对象中  
     parser::ControllerParser::Parse(xml, map_builder);
 
+    return BuildMap(map_builder, opendrive, cache_filename);
+  }
+
+  boost::optional<road::Map> OpenDriveParser::Load(std::istream &opendrive) {
+    carla::road::MapBuilder map_builder;
+    if (!ParseStream(opendrive, map_builder)) {
+      log_error("unable to parse the OpenDRIVE stream");
+      return {};
+    }
     return map_builder.Build();
   }
 
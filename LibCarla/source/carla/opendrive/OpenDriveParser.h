@@ -10,6 +10,7 @@
 
 #include <boost/optional.hpp> // 引入 Boost 库中的可选类型头文件
 
+#include <istream>
 #include <string>
 // 引入CARLA项目的命名空间，CARLA是一个开源的自动驾驶模拟器
 namespace carla {
@@ -21,6 +22,19 @@ namespace opendrive {
 // 在这里，它表示可能成功解析并生成一个road::Map对象，也可能因为某些原因（如文件不存在、解析错误等）而失败  
 // road::Map是CARLA中定义的一个类，用于表示一个完整的道路网络地图  
     static boost::optional<road::Map> Load(const std::string &opendrive);
+
+// 与上面相同，但R树（生成地图时最耗时的部分）从二进制缓存文件 @a cache_filename
+// 读取。缓存不存在或者不是由同一个 OpenDRIVE 内容生成时，重新生成并写入该文件，
+// 多个进程加载同一张地图时只有第一个需要生成。
+    static boost::optional<road::Map> Load(
+        const std::string &opendrive,
+        const std::string &cache_filename);
+
+// 以流的方式解析 OpenDRIVE：逐个读取根节点下的顶层元素（header、road、junction、
+// controller），每个元素单独解析后立即释放，内存峰值只与最大的单个元素成正比，
+// 而不是与整个文件成正比。适合从 std::ifstream 直接加载很大的地图。
+// 输入格式错误时抛出 std::runtime_error，元素解析失败时返回空值。
+    static boost::optional<road::Map> Load(std::istream &opendrive);
   };
 
 } // namespace opendrive
@@ -0,0 +1,260 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/opendrive/parser/TopLevelElementReader.h"
+
+#include <cctype>
+#include <cstring>
+#include <vector>
+
+namespace carla {
+namespace opendrive {
+namespace parser {
+
+  TopLevelElementReader::TopLevelElementReader(std::istream &input)
+    : _input(input.rdbuf()) {
+    if (_input == nullptr) {
+      Fail("OpenDRIVE input stream has no buffer");
+    }
+  }
+
+  bool TopLevelElementReader::Fail(const std::string &message) {
+    if (_error.empty()) {
+      _error = message;
+    }
+    _done = true;
+    return false;
+  }
+
+  bool TopLevelElementReader::Get(char &c) {
+    const int next = _input->sbumpc();
+    if (next == std::char_traits<char>::eof()) {
+      return Fail("unexpected end of OpenDRIVE input");
+    }
+    c = static_cast<char>(next);
+    if (_capture != nullptr) {
+      _capture->push_back(c);
+    }
+    return true;
+  }
+
+  int TopLevelElementReader::Peek() {
+    return _input->sgetc();
+  }
+
+  bool TopLevelElementReader::SkipUntil(const char *terminator) {
+    const size_t length = std::strlen(terminator);
+    // KMP 失配表：fallback[i] 为 terminator 前 i 个字符中既是真前缀又是
+    // 后缀的最长长度。失配时据此回退，"]]]>" 这样重复前缀的输入也能匹配到
+    // "]]>"
+    std::vector<size_t> fallback(length + 1u, 0u);
+    for (size_t i = 1u, k = 0u; i < length; ++i) {
+      while (k > 0u && terminator[i] != terminator[k]) {
+        k = fallback[k];
+      }
+      if (terminator[i] == terminator[k]) {
+        ++k;
+      }
+      fallback[i + 1u] = k;
+    }
+
+    size_t matched = 0u;
+    char c;
+    while (matched < length) {
+      if (!Get(c)) {
+        return false;
+      }
+      while (matched > 0u && c != terminator[matched]) {
+        matched = fallback[matched];
+      }
+      if (c == terminator[matched]) {
+        ++matched;
+      }
+    }
+    return true;
+  }
+
+  std::string TopLevelElementReader::ReadName(const char first) {
+    std::string name(1u, first);
+    char c;
+    for (int next = Peek();
+         next != std::char_traits<char>::eof() && !std::isspace(next) && next != '>' && next != '/';
+         next = Peek()) {
+      Get(c);
+      name.push_back(c);
+    }
+    return name;
+  }
+
+  bool TopLevelElementReader::ReadRestOfTag(bool &self_closing) {
+    char previous = '\0';
+    char c;
+    while (Get(c)) {
+      if (c == '"' || c == '\'') {
+        const char quote = c;
+        do {
+          if (!Get(c)) {
+            return false;
+          }
+        } while (c != quote);
+        previous = c;
+      } else if (c == '>') {
+        self_closing = (previous == '/');
+        return true;
+      } else if (!std::isspace(static_cast<unsigned char>(c))) {
+        previous = c;
+      }
+    }
+    return false;
+  }
+
+  bool TopLevelElementReader::SkipDeclaration() {
+    char c;
+    if (!Get(c)) {
+      return false;
+    }
+    if (c == '-') {
+      // 注释的第二个 '-'
+      return Get(c) && SkipUntil("-->");
+    } else if (c == '[') {
+      return SkipUntil("]]>");
+    }
+    // DOCTYPE 等声明，可能包含方括号内的内部子集
+    int depth = 0;
+    char next;
+    while (Get(next)) {
+      if (next == '>' && depth <= 0) {
+        return true;
+      } else if (next == '[') {
+        ++depth;
+      } else if (next == ']') {
+        --depth;
+      } else if (next == '"' || next == '\'') {
+        const char quote = next;
+        do {
+          if (!Get(next)) {
+            return false;
+          }
+        } while (next != quote);
+      }
+    }
+    return false;
+  }
+
+  bool TopLevelElementReader::EnterRoot() {
+    char c;
+    while (Get(c)) {
+      if (c != '<') {
+        continue; // 跳过 BOM 和空白
+      }
+      if (!Get(c)) {
+        return false;
+      }
+      if (c == '?') {
+        if (!SkipUntil("?>")) {
+          return false;
+        }
+      } else if (c == '!') {
+        if (!SkipDeclaration()) {
+          return false;
+        }
+      } else {
+        const std::string name = ReadName(c);
+        if (name != "OpenDRIVE") {
+          return Fail("unexpected OpenDRIVE root element <" + name + ">");
+        }
+        _in_root = true;
+        return ReadRestOfTag(_done);
+      }
+    }
+    return false;
+  }
+
+  bool TopLevelElementReader::Next(std::string &name, std::string &element) {
+    const bool found = ReadElement(name, element);
+    _capture = nullptr;
+    return found;
+  }
+
+  bool TopLevelElementReader::ReadElement(std::string &name, std::string &element) {
+    if (_done || (!_in_root && !EnterRoot()) || _done) {
+      return false;
+    }
+
+    // 跳过元素之间的文本、注释和处理指令
+    char c;
+    while (true) {
+      if (!Get(c)) {
+        return false;
+      }
+      if (c != '<') {
+        continue;
+      }
+      if (!Get(c)) {
+        return false;
+      }
+      if (c == '/') { // </OpenDRIVE>
+        bool self_closing;
+        ReadRestOfTag(self_closing);
+        _done = true;
+        return false;
+      } else if (c == '?') {
+        if (!SkipUntil("?>")) {
+          return false;
+        }
+      } else if (c == '!') {
+        if (!SkipDeclaration()) {
+          return false;
+        }
+      } else {
+        break;
+      }
+    }
+
+    // 捕获整个元素，包括起止标签
+    element.assign(1u, '<');
+    element.push_back(c);
+    _capture = &element;
+    name = ReadName(c);
+    bool self_closing;
+    if (!ReadRestOfTag(self_closing)) {
+      return false;
+    }
+    size_t depth = self_closing ? 0u : 1u;
+    while (depth > 0u) {
+      if (!Get(c)) {
+        return false;
+      }
+      if (c != '<') {
+        continue;
+      }
+      if (!Get(c)) {
+        return false;
+      }
+      bool ok = true;
+      if (c == '/') {
+        ok = ReadRestOfTag(self_closing);
+        --depth;
+      } else if (c == '?') {
+        ok = SkipUntil("?>");
+      } else if (c == '!') {
+        ok = SkipDeclaration();
+      } else {
+        ok = ReadRestOfTag(self_closing);
+        if (ok && !self_closing) {
+          ++depth;
+        }
+      }
+      if (!ok) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+} // namespace parser
+} // namespace opendrive
+} // namespace carla
@@ -0,0 +1,83 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <istream>
+#include <string>
+
+namespace carla {
+namespace opendrive {
+namespace parser {
+
+  /// 以流的方式逐个读取 OpenDRIVE 根节点下的顶层元素（header、road、
+  /// junction、controller 等），每次只在内存中保留一个元素的原始 XML 文本。
+  ///
+  /// 读取器只做切分，不解析元素内容：它跳过注释、处理指令、CDATA 和
+  /// DOCTYPE，正确处理属性值中的 '>'，并按嵌套深度找到每个元素的结束标签。
+  /// 服务器在禁用异常的情况下编译，所以格式错误或输入提前结束时不抛出异常，
+  /// 而是让 Next 返回 false，并通过 HasError 和 GetError 报告错误。
+  class TopLevelElementReader {
+  public:
+
+    explicit TopLevelElementReader(std::istream &input);
+
+    /// 读取下一个顶层元素，名称写入 @a name，包括起止标签在内的原始文本
+    /// 写入 @a element。根节点结束或输入格式错误时返回 false。
+    bool Next(std::string &name, std::string &element);
+
+    /// Next 是否因为输入格式错误而返回 false。
+    bool HasError() const {
+      return !_error.empty();
+    }
+
+    const std::string &GetError() const {
+      return _error;
+    }
+
+  private:
+
+    /// 记录第一个错误并返回 false，以下返回 bool 的方法失败时都返回 false
+    bool Fail(const std::string &message);
+
+    /// 读取一个字符到 @a c，正在捕获元素时同时追加到元素文本
+    bool Get(char &c);
+
+    /// 查看下一个字符但不读取，输入结束时返回 EOF
+    int Peek();
+
+    /// 读取直到并包括 @a terminator
+    bool SkipUntil(const char *terminator);
+
+    /// 读取标签名，第一个字符 @a first 已经读取
+    std::string ReadName(char first);
+
+    /// 读取标签剩余部分直到 '>'，@a self_closing 返回是否为自闭合标签
+    bool ReadRestOfTag(bool &self_closing);
+
+    /// 读取 "<!" 之后的注释、CDATA 或 DOCTYPE
+    bool SkipDeclaration();
+
+    /// 找到并进入 OpenDRIVE 根节点，根节点为空时将 @a _done 设为 true
+    bool EnterRoot();
+
+    /// Next 的实现，捕获元素文本期间失败时由 Next 停止捕获
+    bool ReadElement(std::string &name, std::string &element);
+
+    std::streambuf *_input;
+
+    std::string _error;
+
+    std::string *_capture = nullptr;
+
+    bool _in_root = false;
+
+    bool _done = false;
+  };
+
+} // namespace parser
+} // namespace opendrive
+} // namespace carla
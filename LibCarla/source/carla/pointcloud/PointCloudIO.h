@@ -16,6 +16,7 @@
 #include <iterator>
 //包含iostream头文件，用于输入输出操作
 #include <iomanip>
+#include <type_traits>
 
 namespace carla {// 定义命名空间carla，用于组织相关的代码和数据
 namespace pointcloud {// 定义命名空间pointcloud，进一步组织特定于点云处理的代码
@@ -24,6 +25,15 @@ namespace pointcloud {// 定义命名空间pointcloud，进一步组织特定于
 //类的具体实现代码
 
   public:
+
+    /// PLY 文件的格式
+    enum class PlyFormat {
+      /// 文本格式，每个点一行
+      Ascii,
+      /// 小端二进制格式，直接写入点的内存表示，写入和读取都快得多
+      BinaryLittleEndian
+    };
+
   // 模板函数Dump，用于将点云数据写入到输出流中，PointIt是点迭代器类型，用于遍历点云数据，out是输出流对象，begin和end分别是点云数据的起始和结束迭代器
     template <typename PointIt>
     static void Dump(std::ostream &out, PointIt begin, PointIt end) {
@@ -36,25 +46,65 @@ namespace pointcloud {// 定义命名空间pointcloud，进一步组织特定于
       }
     }
 
+    /// 以二进制 PLY 格式写入点云。点的内存布局必须与 WritePlyHeaderInfo
+    /// 写出的属性顺序一致，且没有填充字节
     template <typename PointIt>
-    static std::string SaveToDisk(std::string path, PointIt begin, PointIt end) {
+    static void DumpBinary(std::ostream &out, PointIt begin, PointIt end) {
+      using PointT = typename std::iterator_traits<PointIt>::value_type;
+      static_assert(std::is_trivially_copyable<PointT>::value, "Invalid point type.");
+      WriteHeader(out, begin, end, PlyFormat::BinaryLittleEndian);
+      WritePoints(out, begin, end);
+    }
+
+    template <typename PointIt>
+    static std::string SaveToDisk(
+        std::string path,
+        PointIt begin,
+        PointIt end,
+        PlyFormat format = PlyFormat::Ascii) {
       // 验证文件路径是否以".ply"结尾，确保文件类型为PLY 
       FileSystem::ValidateFilePath(path, ".ply");
-      // 创建输出文件流对象，并打开文件
-      std::ofstream out(path);
-      // 调用Dump函数，将点云数据写入到文件中
-      Dump(out, begin, end);
+      if (format == PlyFormat::BinaryLittleEndian) {
+        std::ofstream out(path, std::ios::binary);
+        DumpBinary(out, begin, end);
+      } else {
+        // 创建输出文件流对象，并打开文件
+        std::ofstream out(path);
+        // 调用Dump函数，将点云数据写入到文件中
+        Dump(out, begin, end);
+      }
        // 返回文件路径
       return path;
     }
 
   private:
-    template <typename PointIt> static void WriteHeader(std::ostream &out, PointIt begin, PointIt end) {
+
+    // 连续存储的点一次写入
+    template <typename PointT>
+    static void WritePoints(std::ostream &out, PointT *begin, PointT *end) {
+      out.write(
+          reinterpret_cast<const char *>(begin),
+          static_cast<std::streamsize>(sizeof(PointT) * static_cast<size_t>(end - begin)));
+    }
+
+    template <typename PointIt>
+    static void WritePoints(std::ostream &out, PointIt begin, PointIt end) {
+      for (; begin != end; ++begin) {
+        const auto &point = *begin;
+        out.write(reinterpret_cast<const char *>(&point), sizeof(point));
+      }
+    }
+
+    template <typename PointIt> static void WriteHeader(
+        std::ostream &out,
+        PointIt begin,
+        PointIt end,
+        PlyFormat format = PlyFormat::Ascii) {
       // 断言确保点云数据的数量非负
       DEBUG_ASSERT(std::distance(begin, end) >= 0);
-      // 写入PLY文件的基本头部信息
+      // 写入PLY文件的基本头部信息，二进制格式假设主机为小端字节序
       out << "ply\n"
-           "format ascii 1.0\n"
+          << (format == PlyFormat::Ascii ? "format ascii 1.0\n" : "format binary_little_endian 1.0\n") <<
            // 写入元素(vertex)的数量，即点云中的点数
            "element vertex " << std::to_string(static_cast<size_t>(std::distance(begin, end))) << "\n";
       // 假设每个点对象都有WritePlyHeaderInfo方法，用于写入特定的头部信息      
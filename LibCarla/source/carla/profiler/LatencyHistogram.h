@@ -0,0 +1,180 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace carla {
+namespace profiler {
+
+  /// 对数-线性分桶的延迟直方图（类似 HDR Histogram），单位为纳秒。
+  ///
+  /// 小于 2^SUB_BUCKET_BITS 的值各占一个桶，精确记录；更大的值按 2 的幂分组，
+  /// 每组再线性地分成 2^SUB_BUCKET_BITS 个桶，因此任意百分位数的相对误差不超过
+  /// 1/32。超过 2^(MAX_EXPONENT+1) 纳秒（约 36 分钟）的值计入最后一个桶。
+  ///
+  /// 直方图大小固定，记录和合并都不需要分配内存。
+  class LatencyHistogram {
+  public:
+
+    static constexpr unsigned SUB_BUCKET_BITS = 5u;
+
+    static constexpr uint64_t SUB_BUCKET_COUNT = uint64_t(1u) << SUB_BUCKET_BITS;
+
+    static constexpr unsigned MAX_EXPONENT = 40u;
+
+    static constexpr size_t NUMBER_OF_BUCKETS =
+        SUB_BUCKET_COUNT + (MAX_EXPONENT - SUB_BUCKET_BITS + 1u) * SUB_BUCKET_COUNT;
+
+    /// 返回 @a value 所在桶的索引
+    static size_t BucketIndex(uint64_t value) {
+      if (value < SUB_BUCKET_COUNT) {
+        return static_cast<size_t>(value);
+      }
+      const unsigned exponent = FloorLog2(value);
+      if (exponent > MAX_EXPONENT) {
+        return NUMBER_OF_BUCKETS - 1u;
+      }
+      const unsigned shift = exponent - SUB_BUCKET_BITS;
+      const uint64_t sub_bucket = (value >> shift) & (SUB_BUCKET_COUNT - 1u);
+      return static_cast<size_t>(SUB_BUCKET_COUNT + shift * SUB_BUCKET_COUNT + sub_bucket);
+    }
+
+    /// 桶内的最小值
+    static uint64_t BucketLowerBound(size_t index) {
+      if (index < SUB_BUCKET_COUNT) {
+        return index;
+      }
+      const uint64_t shift = (index - SUB_BUCKET_COUNT) / SUB_BUCKET_COUNT;
+      const uint64_t sub_bucket = (index - SUB_BUCKET_COUNT) % SUB_BUCKET_COUNT;
+      return (SUB_BUCKET_COUNT + sub_bucket) << shift;
+    }
+
+    /// 桶内的最大值
+    static uint64_t BucketUpperBound(size_t index) {
+      if (index < SUB_BUCKET_COUNT) {
+        return index;
+      }
+      if (index == NUMBER_OF_BUCKETS - 1u) {
+        return std::numeric_limits<uint64_t>::max();
+      }
+      const uint64_t shift = (index - SUB_BUCKET_COUNT) / SUB_BUCKET_COUNT;
+      return BucketLowerBound(index) + (uint64_t(1u) << shift) - 1u;
+    }
+
+    void Record(uint64_t value) {
+      ++_buckets[BucketIndex(value)];
+      AddSummary(1u, value, value, value);
+    }
+
+    void Merge(const LatencyHistogram &rhs) {
+      for (size_t i = 0u; i < NUMBER_OF_BUCKETS; ++i) {
+        _buckets[i] += rhs._buckets[i];
+      }
+      AddSummary(rhs._count, rhs._sum, rhs._min, rhs._max);
+    }
+
+    /// 合并在别处保存的计数（例如每个线程的原子计数器）。调用者需要保证
+    /// 各桶计数之和与 AddSummary 传入的 @a count 一致。
+    void AddBucketCount(size_t index, uint64_t count) {
+      _buckets[index] += count;
+    }
+
+    void AddSummary(uint64_t count, uint64_t sum, uint64_t min, uint64_t max) {
+      if (count == 0u) {
+        return;
+      }
+      _count += count;
+      _sum += sum;
+      _min = std::min(_min, min);
+      _max = std::max(_max, max);
+    }
+
+    void Clear() {
+      *this = LatencyHistogram();
+    }
+
+    uint64_t count() const {
+      return _count;
+    }
+
+    uint64_t sum() const {
+      return _sum;
+    }
+
+    uint64_t min() const {
+      return _count > 0u ? _min : 0u;
+    }
+
+    uint64_t max() const {
+      return _max;
+    }
+
+    double mean() const {
+      return _count > 0u ? static_cast<double>(_sum) / static_cast<double>(_count) : 0.0;
+    }
+
+    uint64_t bucket_count(size_t index) const {
+      return _buckets[index];
+    }
+
+    /// 返回百分位数，@a fraction 取值范围为 [0, 1]，例如 0.99 对应 p99。
+    /// 返回所在桶的中点，并限制在记录到的最小值和最大值之间；p100 返回最大值。
+    uint64_t Percentile(double fraction) const {
+      if (_count == 0u) {
+        return 0u;
+      }
+      fraction = std::min(std::max(fraction, 0.0), 1.0);
+      const uint64_t rank = std::max<uint64_t>(
+          1u,
+          static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(_count))));
+      if (rank >= _count) {
+        return _max;
+      }
+      uint64_t accumulated = 0u;
+      for (size_t i = 0u; i < NUMBER_OF_BUCKETS; ++i) {
+        accumulated += _buckets[i];
+        if (accumulated >= rank) {
+          const uint64_t lower = std::max(BucketLowerBound(i), _min);
+          const uint64_t upper = std::min(BucketUpperBound(i), _max);
+          return lower + (upper - lower) / 2u;
+        }
+      }
+      return _max;
+    }
+
+  private:
+
+    static unsigned FloorLog2(uint64_t value) {
+      unsigned result = 0u;
+      for (unsigned bits = 32u; bits > 0u; bits /= 2u) {
+        if (value >= (uint64_t(1u) << bits)) {
+          value >>= bits;
+          result += bits;
+        }
+      }
+      return result;
+    }
+
+    std::array<uint64_t, NUMBER_OF_BUCKETS> _buckets{};
+
+    uint64_t _count = 0u;
+
+    uint64_t _sum = 0u;
+
+    uint64_t _min = std::numeric_limits<uint64_t>::max();
+
+    uint64_t _max = 0u;
+  };
+
+} // namespace profiler
+} // namespace carla
@@ -10,6 +10,8 @@
 #  define LIBCARLA_ENABLE_PROFILER
 #endif // LIBCARLA_ENABLE_PROFILER
 
+#include "carla/Debug.h"
+
 // 引入Carla日志库的头文件，用于记录日志信息
 #include "carla/Logging.h"
 
@@ -19,6 +21,11 @@
 // 引入Carla性能分析器的头文件，包含性能分析相关的类和函数定义
 #include "carla/profiler/Profiler.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+
 // 引入C++标准库中的文件流处理头文件，用于读写文件
 #include <fstream>
 
@@ -28,14 +35,354 @@
 // 引入C++标准库中的标准输入输出流头文件，用于控制台输入输出
 #include <iostream>
 
+#include <limits>
+#include <memory>
+
 // 引入C++标准库中的互斥锁头文件，用于实现线程同步
 #include <mutex>
 
-// 定义在carla::profiler::detail命名空间下的代码
+#include <unordered_map>
+
+// 定义在carla::profiler命名空间下的代码
 namespace carla {
 namespace profiler {
+
+  constexpr ScopeId Registry::INVALID_SCOPE;
+  constexpr ScopeId Registry::MAX_SCOPES;
+  constexpr size_t Registry::MAX_DEPTH;
+
 namespace detail {
 
+  // ===========================================================================
+  // -- 线程缓冲区 -------------------------------------------------------------
+  // ===========================================================================
+
+  using Counter = std::atomic<uint64_t>;
+
+  // 计数器只由所属线程写入，用读-改-写两次松散操作代替原子加法，
+  // 其他线程读取时只需要看到某个一致的旧值即可。
+  static inline void Add(Counter &counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+  static inline uint64_t Load(const Counter &counter) {
+    return counter.load(std::memory_order_relaxed);
+  }
+
+  static inline uint64_t Now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+  }
+
+  /// 某个线程中某个作用域的计数器
+  struct ScopeCounters {
+    ScopeCounters() {
+      Clear();
+    }
+
+    void Clear() {
+      sum.store(0u, std::memory_order_relaxed);
+      min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+      max.store(0u, std::memory_order_relaxed);
+      self.store(0u, std::memory_order_relaxed);
+      for (auto &bucket : buckets) {
+        bucket.store(0u, std::memory_order_relaxed);
+      }
+    }
+
+    /// 计数器所属的重置轮次，与注册表的轮次不同时表示数据已经过期
+    std::atomic<uint64_t> epoch{0u};
+
+    Counter sum;
+
+    Counter min;
+
+    Counter max;
+
+    Counter self;
+
+    std::array<Counter, LatencyHistogram::NUMBER_OF_BUCKETS> buckets;
+
+    /// 上一次 RecordInterval 的时间，只由所属线程访问
+    uint64_t last_interval_time = 0u;
+  };
+
+  /// 追踪事件的存储槽，字段为原子变量以便其他线程读取
+  struct TraceSlot {
+    std::atomic<uint64_t> scope_and_depth{0u};
+    std::atomic<uint64_t> start{0u};
+    std::atomic<uint64_t> duration{0u};
+  };
+
+  /// 单写者的追踪事件环形缓冲区。写入前先增加 claimed，写完后再增加
+  /// committed；读者复制完数据后重新读取 claimed，丢弃可能被覆盖的事件。
+  struct TraceRing {
+    explicit TraceRing(size_t size)
+      : capacity(std::max<size_t>(size, 1u)),
+        slots(new TraceSlot[capacity]) {}
+
+    const size_t capacity;
+
+    std::unique_ptr<TraceSlot[]> slots;
+
+    std::atomic<uint64_t> claimed{0u};
+
+    std::atomic<uint64_t> committed{0u};
+
+    /// 记录该缓冲区时的追踪轮次
+    uint64_t generation = 0u;
+  };
+
+  struct TraceEvent {
+    ScopeId scope;
+    uint32_t depth;
+    uint32_t thread_id;
+    uint64_t start;
+    uint64_t duration;
+  };
+
+  struct Frame {
+    ScopeId id;
+    uint64_t start;
+    uint64_t children;
+  };
+
+  struct ThreadBuffer;
+
+  /// 已退出线程的数据
+  struct Aggregate {
+    LatencyHistogram histogram;
+    uint64_t self = 0u;
+  };
+
+  /// 注册表的全局状态。故意不释放，使得其他静态对象和线程本地对象在
+  /// 程序退出时仍然可以安全地访问它。
+  struct RegistryState {
+    std::mutex mutex;
+
+    std::vector<std::string> names;
+
+    std::vector<bool> is_interval;
+
+    std::unordered_map<std::string, ScopeId> ids;
+
+    std::vector<ThreadBuffer *> threads;
+
+    std::vector<Aggregate> retired;
+
+    std::vector<TraceEvent> retired_events;
+
+    uint32_t next_thread_id = 1u;
+
+    size_t trace_capacity = 0u;
+
+    std::atomic_bool enabled{true};
+
+    std::atomic_bool tracing{false};
+
+    std::atomic<uint64_t> reset_epoch{1u};
+
+    std::atomic<uint64_t> trace_generation{0u};
+
+    const uint64_t origin = Now();
+  };
+
+  static RegistryState &GetState() {
+    static RegistryState *state = new RegistryState;
+    return *state;
+  }
+
+  // 复制环形缓冲区中仍然有效的事件。需要持有注册表的锁，以免缓冲区被替换。
+  static void CopyEvents(const TraceRing &ring, uint32_t thread_id, std::vector<TraceEvent> &out) {
+    const uint64_t committed = ring.committed.load(std::memory_order_acquire);
+    const uint64_t first = committed > ring.capacity ? committed - ring.capacity : 0u;
+    const size_t begin = out.size();
+    for (uint64_t i = first; i < committed; ++i) {
+      const auto &slot = ring.slots[i % ring.capacity];
+      const uint64_t scope_and_depth = slot.scope_and_depth.load(std::memory_order_relaxed);
+      out.push_back(TraceEvent{
+          static_cast<ScopeId>(scope_and_depth >> 32u),
+          static_cast<uint32_t>(scope_and_depth),
+          thread_id,
+          slot.start.load(std::memory_order_relaxed),
+          slot.duration.load(std::memory_order_relaxed)});
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t claimed = ring.claimed.load(std::memory_order_relaxed);
+    if (claimed > ring.capacity + first) {
+      // 复制的过程中写者已经覆盖了最早的一部分事件。
+      const auto overwritten = std::min<uint64_t>(claimed - ring.capacity - first, out.size() - begin);
+      out.erase(out.begin() + static_cast<std::ptrdiff_t>(begin),
+                out.begin() + static_cast<std::ptrdiff_t>(begin + overwritten));
+    }
+  }
+
+  // 把线程的计数器合并到直方图中，只合并当前轮次的数据。
+  static void MergeCounters(const ScopeCounters &counters, uint64_t epoch, Aggregate &aggregate) {
+    if (counters.epoch.load(std::memory_order_acquire) != epoch) {
+      return;
+    }
+    uint64_t count = 0u;
+    for (size_t i = 0u; i < counters.buckets.size(); ++i) {
+      const uint64_t bucket = Load(counters.buckets[i]);
+      if (bucket > 0u) {
+        aggregate.histogram.AddBucketCount(i, bucket);
+        count += bucket;
+      }
+    }
+    aggregate.histogram.AddSummary(
+        count,
+        Load(counters.sum),
+        Load(counters.min),
+        Load(counters.max));
+    aggregate.self += Load(counters.self);
+  }
+
+  struct ThreadBuffer : private NonCopyable {
+
+    ThreadBuffer() {
+      for (auto &item : counters) {
+        item.store(nullptr, std::memory_order_relaxed);
+      }
+      auto &state = GetState();
+      std::lock_guard<std::mutex> lock(state.mutex);
+      thread_id = state.next_thread_id++;
+      state.threads.push_back(this);
+    }
+
+    ~ThreadBuffer() {
+      auto &state = GetState();
+      std::lock_guard<std::mutex> lock(state.mutex);
+      state.threads.erase(std::find(state.threads.begin(), state.threads.end(), this));
+      const uint64_t epoch = state.reset_epoch.load(std::memory_order_relaxed);
+      for (size_t id = 0u; id < counters.size(); ++id) {
+        std::unique_ptr<ScopeCounters> item(counters[id].load(std::memory_order_relaxed));
+        if (item != nullptr) {
+          if (state.retired.size() <= id) {
+            state.retired.resize(id + 1u);
+          }
+          MergeCounters(*item, epoch, state.retired[id]);
+        }
+      }
+      if ((ring != nullptr) &&
+          (ring->generation == state.trace_generation.load(std::memory_order_relaxed))) {
+        CopyEvents(*ring, thread_id, state.retired_events);
+      }
+    }
+
+    ScopeCounters &GetCounters(ScopeId id) {
+      auto *item = counters[id].load(std::memory_order_relaxed);
+      if (item == nullptr) {
+        item = new ScopeCounters;
+        counters[id].store(item, std::memory_order_release);
+      }
+      const uint64_t epoch = GetState().reset_epoch.load(std::memory_order_relaxed);
+      if (item->epoch.load(std::memory_order_relaxed) != epoch) {
+        item->Clear();
+        item->epoch.store(epoch, std::memory_order_release);
+      }
+      return *item;
+    }
+
+    void Record(ScopeId id, uint64_t duration, uint64_t self_time) {
+      auto &item = GetCounters(id);
+      Add(item.buckets[LatencyHistogram::BucketIndex(duration)], 1u);
+      Add(item.sum, duration);
+      Add(item.self, self_time);
+      if (duration < Load(item.min)) {
+        item.min.store(duration, std::memory_order_relaxed);
+      }
+      if (duration > Load(item.max)) {
+        item.max.store(duration, std::memory_order_relaxed);
+      }
+    }
+
+    void Trace(const Frame &frame, uint64_t duration) {
+      auto &state = GetState();
+      const uint64_t generation = state.trace_generation.load(std::memory_order_acquire);
+      if ((ring == nullptr) || (ring->generation != generation)) {
+        // 新的追踪轮次，在锁内替换缓冲区，此时没有读者在访问旧的缓冲区。
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.tracing.load(std::memory_order_relaxed)) {
+          return;
+        }
+        ring = std::make_unique<TraceRing>(state.trace_capacity);
+        ring->generation = state.trace_generation.load(std::memory_order_relaxed);
+      }
+      const uint64_t index = ring->claimed.load(std::memory_order_relaxed);
+      ring->claimed.store(index + 1u, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      auto &slot = ring->slots[index % ring->capacity];
+      slot.scope_and_depth.store((uint64_t(frame.id) << 32u) | depth, std::memory_order_relaxed);
+      slot.start.store(frame.start, std::memory_order_relaxed);
+      slot.duration.store(duration, std::memory_order_relaxed);
+      ring->committed.store(index + 1u, std::memory_order_release);
+    }
+
+    uint32_t thread_id = 0u;
+
+    std::array<std::atomic<ScopeCounters *>, Registry::MAX_SCOPES> counters;
+
+    std::array<Frame, Registry::MAX_DEPTH> stack;
+
+    uint32_t depth = 0u;
+
+    std::unique_ptr<TraceRing> ring;
+  };
+
+  static ThreadBuffer &GetThreadBuffer() {
+    static thread_local ThreadBuffer buffer;
+    return buffer;
+  }
+
+  bool EnterScope(ScopeId id) {
+    if ((id == Registry::INVALID_SCOPE) ||
+        !GetState().enabled.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    auto &buffer = GetThreadBuffer();
+    if (buffer.depth >= Registry::MAX_DEPTH) {
+      return false;
+    }
+    buffer.stack[buffer.depth++] = Frame{id, Now(), 0u};
+    return true;
+  }
+
+  void ExitScope() {
+    const uint64_t now = Now();
+    auto &buffer = GetThreadBuffer();
+    DEBUG_ASSERT(buffer.depth > 0u);
+    const Frame &frame = buffer.stack[--buffer.depth];
+    const uint64_t duration = now - frame.start;
+    if (buffer.depth > 0u) {
+      buffer.stack[buffer.depth - 1u].children += duration;
+    }
+    const uint64_t self_time = duration > frame.children ? duration - frame.children : 0u;
+    buffer.Record(frame.id, duration, self_time);
+    if (GetState().tracing.load(std::memory_order_relaxed)) {
+      buffer.Trace(frame, duration);
+    }
+  }
+
+  void RecordInterval(ScopeId id) {
+    if ((id == Registry::INVALID_SCOPE) ||
+        !GetState().enabled.load(std::memory_order_relaxed)) {
+      return;
+    }
+    const uint64_t now = Now();
+    auto &counters = GetThreadBuffer().GetCounters(id);
+    const uint64_t last = counters.last_interval_time;
+    counters.last_interval_time = now;
+    if (last > 0u) {
+      const uint64_t interval = now - last;
+      GetThreadBuffer().Record(id, interval, interval);
+    }
+  }
+
+  // ===========================================================================
+  // -- CSV 输出 ---------------------------------------------------------------
+  // ===========================================================================
+
 // 定义一个模板辅助函数，用于将参数写入CSV（逗号分隔值）格式的输出流中
 // 这个函数可以接受一个或多个参数，并将它们按照指定的格式输出到提供的输出流中
 template <typename Arg, typename ... Args>
@@ -44,72 +391,243 @@ static void write_csv_to_stream(std::ostream &out, Arg &&arg, Args &&... args) {
     // 设置左对齐，字段宽度为44个字符
     // 转发第一个参数到输出流中（支持左值引用和右值引用）
     out << std::boolalpha << std::left << std::setw(44) << std::forward<Arg>(arg);
-    
+
     // 设置右对齐，并固定浮点数的小数点位数为2位
     out << std::right << std::fixed << std::setprecision(2);
-    
+
     // 定义一个用于参数包展开的数组类型（这里实际上不会创建数组，只是利用数组初始化语法来展开参数包）
     // 展开参数包，对每个剩余参数执行输出操作，并在参数之间添加逗号和空格作为分隔符
     // 使用逗号表达式来同时执行输出操作和数组初始化（这里数组初始化只是为了产生编译时的副作用，即展开参数包）
     using expander = int[];
     (void)expander{0, (void(out << ", " << std::setw(10) << std::forward<Args>(args)), 0)...};
+    out << std::endl; // 换行
 }
-// 静态性能分析器类
-class StaticProfiler {
-public:
-
-    // 构造函数，接受文件名
-    StaticProfiler(std::string filename)
-      : _filename(std::move(filename)) { // 移动构造文件名
-        logging::log("PROFILER: writing profiling data to", _filename); // 日志记录
-        std::string header = "# LibCarla Profiler "; // CSV头部信息
-        header += carla::version(); // 添加版本信息
+
+  static inline float ms(uint64_t nanoseconds) { // 将纳秒转换为毫秒
+    return 1e-6f * static_cast<float>(nanoseconds);
+  }
+
+  static inline float fps(float milliseconds) { // 根据毫秒计算FPS
+    return milliseconds > 0.0f ? (1e3f / milliseconds) : std::numeric_limits<float>::max();
+  }
+
+  static void WriteCsvHeader(std::ostream &out) {
+    std::string header = "# LibCarla Profiler "; // CSV头部信息
+    header += carla::version(); // 添加版本信息
 #ifdef NDEBUG
-        header += " (release)"; // 如果是发布模式
+    header += " (release)"; // 如果是发布模式
 #else
-        header += " (debug)"; // 如果是调试模式
+    header += " (debug)"; // 如果是调试模式
 #endif // NDEBUG
-        write_to_file(std::ios_base::out, header); // 写入文件头
-        write_line("# context", "average", "maximum", "minimum", "units", "times"); // 写入列名
+    out << header << std::endl;
+    write_csv_to_stream(out, "# context", "average", "maximum", "minimum", "p50", "p99", "p999", "units", "times"); // 写入列名
+  }
+
+  static void WriteCsvLine(std::ostream &out, const ScopeStatistics &stats) {
+    const auto &histogram = stats.histogram;
+    const float average = static_cast<float>(histogram.mean()) * 1e-6f;
+    if (stats.is_interval) {
+      // 间隔越短帧率越高，因此最大帧率对应最小间隔。
+      write_csv_to_stream(out, stats.name,
+          fps(average), fps(ms(histogram.min())), fps(ms(histogram.max())),
+          fps(ms(histogram.Percentile(0.5))), fps(ms(histogram.Percentile(0.99))), fps(ms(histogram.Percentile(0.999))),
+          "FPS", histogram.count());
+    } else {
+      write_csv_to_stream(out, stats.name,
+          average, ms(histogram.max()), ms(histogram.min()),
+          ms(histogram.Percentile(0.5)), ms(histogram.Percentile(0.99)), ms(histogram.Percentile(0.999)),
+          "ms", histogram.count());
     }
+  }
 
-    // 写入一行数据
-    template <typename ... Args>
-    void write_line(Args &&... args) {
-      write_to_file(std::ios_base::app|std::ios_base::out, std::forward<Args>(args)...); // 追加写入数据
+  // 为了兼容之前的行为，程序退出时把统计数据写入 profiler.csv。
+  struct CsvWriterAtExit {
+    ~CsvWriterAtExit() {
+      const auto statistics = Registry::GetStatistics();
+      if (statistics.empty()) {
+        return;
+      }
+      const std::string filename = "profiler.csv";
+      logging::log("PROFILER: writing profiling data to", filename); // 日志记录
+      std::ofstream file(filename);
+      WriteCsvHeader(file);
+      for (auto &&stats : statistics) {
+        WriteCsvLine(file, stats);
+      }
     }
+  };
 
-private:
+  static CsvWriterAtExit CSV_WRITER_AT_EXIT;
 
-    // 向文件写入数据的私有函数
-    template <typename ... Args>
-    void write_to_file(std::ios_base::openmode mode, Args &&... args) {
-      if (!_filename.empty()) { // 确保文件名不为空
-        static std::mutex MUTEX; // 静态互斥锁
-        std::lock_guard<std::mutex> guard(MUTEX); // 加锁，保护文件写入
-        std::ofstream file(_filename, mode); // 打开文件
-        write_csv_to_stream(file, std::forward<Args>(args)...); // 写入CSV格式的数据
-        file << std::endl; // 换行
+  // 转义 JSON 字符串中的特殊字符
+  static void WriteJsonString(std::ostream &out, const std::string &str) {
+    out << '"';
+    for (char c : str) {
+      switch (c) {
+        case '"':  out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\t': out << "\\t"; break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20u) {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                << static_cast<int>(c) << std::dec << std::setfill(' ');
+          } else {
+            out << c;
+          }
       }
     }
+    out << '"';
+  }
+
+} // namespace detail
+
+  // ===========================================================================
+  // -- Registry ---------------------------------------------------------------
+  // ===========================================================================
+
+  void Registry::SetEnabled(bool enabled) {
+    detail::GetState().enabled = enabled;
+  }
+
+  bool Registry::IsEnabled() {
+    return detail::GetState().enabled;
+  }
+
+  ScopeId Registry::RegisterScope(const std::string &name, bool is_interval) {
+    auto &state = detail::GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    auto it = state.ids.find(name);
+    if (it != state.ids.end()) {
+      return it->second;
+    }
+    if (state.names.size() >= MAX_SCOPES) {
+      log_warning("profiler: too many scopes, ignoring", name);
+      return INVALID_SCOPE;
+    }
+    const auto id = static_cast<ScopeId>(state.names.size());
+    state.names.push_back(name);
+    state.is_interval.push_back(is_interval);
+    state.ids.emplace(name, id);
+    return id;
+  }
 
-    const std::string _filename; // 保存文件名
-};
+  ScopeId Registry::FindOrRegisterScope(const char *context, const std::string &name) {
+    static thread_local std::unordered_map<std::string, ScopeId> cache;
+    static thread_local std::string key;
+    key.assign(context);
+    key += '.';
+    key += name;
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+      return it->second;
+    }
+    const ScopeId id = RegisterScope(key);
+    cache.emplace(key, id);
+    return id;
+  }
 
-// 性能数据析构函数
-ProfilerData::~ProfilerData() {
-    static StaticProfiler PROFILER{"profiler.csv"}; // 静态性能分析器实例
-    if (_count > 0u) { // 如果调用次数大于0
-      if (_print_fps) { // 检查是否打印FPS
-        PROFILER.write_line(_name, fps(average()), fps(minimum()), fps(maximum()), "FPS", _count); // 写入FPS数据
-      } else {
-        PROFILER.write_line(_name, average(), maximum(), minimum(), "ms", _count); // 写入时间数据
+  void Registry::Reset() {
+    auto &state = detail::GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    // 各线程在下一次记录时发现轮次变化，自己清空计数器。
+    ++state.reset_epoch;
+    state.retired.clear();
+  }
+
+  std::vector<ScopeStatistics> Registry::GetStatistics() {
+    auto &state = detail::GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    const uint64_t epoch = state.reset_epoch.load(std::memory_order_relaxed);
+    std::vector<detail::Aggregate> aggregates(state.retired);
+    aggregates.resize(state.names.size());
+    for (auto *thread : state.threads) {
+      for (size_t id = 0u; id < aggregates.size(); ++id) {
+        const auto *counters = thread->counters[id].load(std::memory_order_acquire);
+        if (counters != nullptr) {
+          detail::MergeCounters(*counters, epoch, aggregates[id]);
+        }
       }
-    } else {
-      log_error("profiler", _name, " was never run!"); // 日志错误：未运行
     }
-}
+    std::vector<ScopeStatistics> result;
+    for (size_t id = 0u; id < aggregates.size(); ++id) {
+      if (aggregates[id].histogram.count() > 0u) {
+        ScopeStatistics stats;
+        stats.name = state.names[id];
+        stats.is_interval = state.is_interval[id];
+        stats.histogram = aggregates[id].histogram;
+        stats.self_nanoseconds = aggregates[id].self;
+        result.emplace_back(std::move(stats));
+      }
+    }
+    return result;
+  }
+
+  void Registry::StartTrace(size_t events_per_thread) {
+    auto &state = detail::GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.trace_capacity = events_per_thread;
+    state.retired_events.clear();
+    ++state.trace_generation;
+    state.tracing = true;
+  }
+
+  void Registry::StopTrace() {
+    detail::GetState().tracing = false;
+  }
+
+  bool Registry::IsTracing() {
+    return detail::GetState().tracing;
+  }
+
+  void Registry::WriteChromeTrace(std::ostream &out) {
+    auto &state = detail::GetState();
+    std::vector<detail::TraceEvent> events;
+    std::vector<std::string> names;
+    uint64_t origin;
+    {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      const uint64_t generation = state.trace_generation.load(std::memory_order_relaxed);
+      events = state.retired_events;
+      for (auto *thread : state.threads) {
+        if ((thread->ring != nullptr) && (thread->ring->generation == generation)) {
+          detail::CopyEvents(*thread->ring, thread->thread_id, events);
+        }
+      }
+      names = state.names;
+      origin = state.origin;
+    }
+    std::sort(events.begin(), events.end(), [](const auto &lhs, const auto &rhs) {
+      return lhs.start < rhs.start;
+    });
+    // 时间戳和持续时间以微秒为单位。
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    const auto previous_flags = out.flags();
+    const auto previous_precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    bool first = true;
+    for (auto &&event : events) {
+      out << (first ? "\n" : ",\n");
+      first = false;
+      out << "{\"name\":";
+      detail::WriteJsonString(out, names[event.scope]);
+      out << ",\"cat\":\"carla\",\"ph\":\"X\",\"ts\":"
+          << 1e-3 * static_cast<double>(event.start - origin)
+          << ",\"dur\":" << 1e-3 * static_cast<double>(event.duration)
+          << ",\"pid\":1,\"tid\":" << event.thread_id
+          << ",\"args\":{\"depth\":" << event.depth << "}}";
+    }
+    out << "\n]}\n";
+    out.flags(previous_flags);
+    out.precision(previous_precision);
+  }
+
+  void Registry::WriteCsv(std::ostream &out) {
+    detail::WriteCsvHeader(out);
+    for (auto &&stats : GetStatistics()) {
+      detail::WriteCsvLine(out, stats);
+    }
+  }
 
-} // namespace detail
 } // namespace profiler
 } // namespace carla
@@ -8,86 +8,108 @@
 
 #ifndef LIBCARLA_ENABLE_PROFILER // 如果没有启用性能分析器
 #  define CARLA_PROFILE_SCOPE(context, profiler_name) // 定义宏，空操作
+#  define CARLA_PROFILE_DYNAMIC_SCOPE(context, profiler_name) // 定义宏，空操作
 #  define CARLA_PROFILE_FPS(context, profiler_name) // 定义宏，空操作，这里的代码将用于开始或更新一个性能分析器，与给定的上下文和名称相关，它包括获取当前时间戳，更新帧率统计，或者开始一个新的性能分析区间
 #else
 
-#include "carla/StopWatch.h" // 引入计时器头文件
+#include "carla/NonCopyable.h"
+#include "carla/profiler/LatencyHistogram.h" // 延迟直方图
 
-#include <algorithm> // 包含算法库，用于常用算法
-#include <limits> // 包含极限值定义
+#include <cstdint>
+#include <iosfwd>
 #include <string> // 包含字符串库
+#include <vector>
 
 namespace carla { // 开始 carla 命名空间
 namespace profiler { // 开始 profiler 命名空间
-namespace detail { // 开始 detail 命名空间
 
-  class ProfilerData { // 性能数据类
+  /// 已注册作用域的编号
+  using ScopeId = uint32_t;
+
+  /// 某个作用域的汇总统计（所有线程，包括已经退出的线程）
+  struct ScopeStatistics {
+    std::string name;
+    /// 为真时记录的是两次调用之间的间隔（CARLA_PROFILE_FPS），否则是作用域的耗时
+    bool is_interval = false;
+    /// 耗时或间隔的分布，单位纳秒
+    LatencyHistogram histogram;
+    /// 扣除嵌套子作用域后，作用域自身耗时的总和，单位纳秒
+    uint64_t self_nanoseconds = 0u;
+  };
+
+  /// 进程内的性能分析注册表。
+  ///
+  /// 每个线程把数据记录在自己的缓冲区中（单写者的原子计数器，不加锁），只有
+  /// 注册新作用域、线程第一次记录以及线程退出时才会获取全局锁。查询统计和
+  /// 导出追踪可以在任意线程、任意时刻进行。
+  class Registry {
   public:
 
-    explicit ProfilerData(std::string name, bool print_fps = false) // 构造函数，初始化名称和是否打印FPS
-      : _name(std::move(name)), // 移动名称
-        _print_fps(print_fps) {} // 设置打印FPS布尔值
+    static constexpr ScopeId INVALID_SCOPE = ~ScopeId(0u);
 
-    ~ProfilerData(); // 析构函数声明
+    /// 最多可以注册的作用域数
+    static constexpr ScopeId MAX_SCOPES = 1024u;
 
-    void Annotate(const StopWatch &stop_watch) { // 注解方法，记录时间数据
-      const auto elapsed_microseconds = stop_watch.GetElapsedTime<std::chrono::microseconds>(); // 获取经过的微秒数
-      ++_count; // 计数增加
-      _total_microseconds += elapsed_microseconds; // 总时间增加
-      _max_elapsed = std::max(elapsed_microseconds, _max_elapsed); // 更新最大时间
-      _min_elapsed = std::min(elapsed_microseconds, _min_elapsed); // 更新最小时间
-    }
+    /// 作用域最大嵌套深度，更深的作用域不被记录
+    static constexpr size_t MAX_DEPTH = 64u;
 
-    float average() const { // 计算平均时间
-      return ms(_total_microseconds) / static_cast<float>(_count); // 将总时间（微秒）转换为毫秒，然后除以事件发生的次数，得到平均每次事件的毫秒数
-    }
+    /// 在运行时开启或关闭记录（默认开启）。关闭时每个作用域只剩一次原子读取的开销。
+    static void SetEnabled(bool enabled);
 
-    float maximum() const { // 获取最大时间
-      return ms(_max_elapsed); // 返回最大时间（毫秒）
-    }
+    static bool IsEnabled();
 
-    float minimum() const { // 获取最小时间
-      return ms(_min_elapsed); // 返回最小时间（毫秒）
-    }
+    /// 注册一个作用域，同名作用域返回相同的编号
+    static ScopeId RegisterScope(const std::string &name, bool is_interval = false);
 
-  private:
+    /// 与 RegisterScope 相同，但名称在运行时才能确定（例如 RPC 函数名），
+    /// 使用线程本地缓存避免每次加锁
+    static ScopeId FindOrRegisterScope(const char *context, const std::string &name);
 
-    static inline float ms(size_t microseconds) { // 将微秒转换为毫秒
-      return 1e-3f * static_cast<float>(microseconds); // 转换公式
-    }
+    /// 清空目前为止的所有统计数据
+    static void Reset();
 
-    static inline float fps(float milliseconds) { // 根据毫秒计算FPS
-      return milliseconds > 0.0f ? (1e3f / milliseconds) : std::numeric_limits<float>::max(); // 如果 milliseconds 大于 0，则返回其倒数（每秒），否则返回无穷大
-    }
-
-    const std::string _name; // 性能监测名称
+    static std::vector<ScopeStatistics> GetStatistics();
 
-    const bool _print_fps; // 是否打印FPS
+    /// 开始记录追踪事件，每个线程保留最近的 @a events_per_thread 个事件
+    static void StartTrace(size_t events_per_thread = 1u << 16u);
 
-    size_t _count = 0u; // 记录次数
+    /// 停止记录追踪事件，已记录的事件可以继续导出，直到下次 StartTrace
+    static void StopTrace();
 
-    size_t _total_microseconds = 0u; // 总微秒数
+    static bool IsTracing();
 
-    size_t _max_elapsed = 0u; // 最大经历的时间
+    /// 以 Chrome trace-event JSON 格式导出追踪事件（可以在 chrome://tracing
+    /// 或 Perfetto 中打开）
+    static void WriteChromeTrace(std::ostream &out);
 
-    size_t _min_elapsed = std::numeric_limits<size_t>::max(); // 最小经历的时间（初始化为最大值）
+    /// 以 CSV 格式导出统计数据，格式与退出时写入的 profiler.csv 相同
+    static void WriteCsv(std::ostream &out);
   };
 
-  class ScopedProfiler { // 作用域性能分析类
+namespace detail { // 开始 detail 命名空间
+
+  /// 压入当前线程的作用域栈，返回是否需要在离开时调用 ExitScope
+  bool EnterScope(ScopeId id);
+
+  void ExitScope();
+
+  /// 记录与当前线程上一次调用之间的间隔
+  void RecordInterval(ScopeId id);
+
+  class ScopedProfiler : private NonCopyable { // 作用域性能分析类
   public:
 
-    explicit ScopedProfiler(ProfilerData &parent) : _profiler(parent) {} // 构造函数，接受父级性能数据引用
+    explicit ScopedProfiler(ScopeId id) : _active(EnterScope(id)) {}
 
     ~ScopedProfiler() { // 析构函数
-      _stop_watch.Stop(); // 停止计时器
-      _profiler.Annotate(_stop_watch); // 使用_stop_watch对象的信息来标注或更新_profiler的性能分析数据
+      if (_active) {
+        ExitScope();
+      }
     }
 
   private:
 
-    ProfilerData &_profiler; // 引用性能数据对象
-
-    StopWatch _stop_watch; // 计时器对象
+    const bool _active;
   };
 
 } // namespace detail
@@ -100,25 +122,26 @@ namespace detail { // 开始 detail 命名空间
 #  define LIBCARLA_GTEST_GET_TEST_NAME() std::string("") // 定义一个宏，用于获取当前测试的名称，但当前实现仅返回一个空字符串
 #endif // LIBCARLA_WITH_GTEST
 
-#define CARLA_PROFILE_SCOPE(context, profiler_name) \ // 定义性能分析作用域宏
-    static thread_local ::carla::profiler::detail::ProfilerData carla_profiler_ ## context ## _ ## profiler_name ## _data( \ // 创建性能数据实例
-        LIBCARLA_GTEST_GET_TEST_NAME() + "." #context "." #profiler_name); \ // 初始化性能数据名称
-    ::carla::profiler::detail::ScopedProfiler carla_profiler_ ## context ## _ ## profiler_name ## _scoped_profiler( \ // 创建作用域性能分析器，创建一个 ScopedProfiler实例，用于性能分析
-        carla_profiler_ ## context ## _ ## profiler_name ## _data); // 关联到性能数据
-
-#define CARLA_PROFILE_FPS(context, profiler_name) \ // 定义性能分析FPS宏
-    { \ // 开始代码块
-      static thread_local ::carla::StopWatch stop_watch; \ // 创建计时器实例
-      stop_watch.Stop(); \ // 停止计时器
-      static thread_local bool first_time = true; \ // 首次标志变量
-      if (!first_time) { \ // 如果不是第一次
-        static thread_local ::carla::profiler::detail::ProfilerData profiler_data( \ // 创建性能数据实例
-            LIBCARLA_GTEST_GET_TEST_NAME() + "." #context "." #profiler_name, true); \ // 初始化名称并设置打印FPS为真
-        profiler_data.Annotate(stop_watch); \ // 注解计时器数据
-      } else { \ // 如果是第一次
-        first_time = false; \ // 更新首次标志
-      } \
-      stop_watch.Restart(); \ // 重新启动计时器
+// 定义性能分析作用域宏，作用域编号只在第一次执行时注册
+#define CARLA_PROFILE_SCOPE(context, profiler_name) \
+    static const ::carla::profiler::ScopeId carla_profiler_ ## context ## _ ## profiler_name ## _id = \
+        ::carla::profiler::Registry::RegisterScope( \
+            LIBCARLA_GTEST_GET_TEST_NAME() + "." #context "." #profiler_name); \
+    ::carla::profiler::detail::ScopedProfiler carla_profiler_ ## context ## _ ## profiler_name ## _scoped_profiler( \
+        carla_profiler_ ## context ## _ ## profiler_name ## _id);
+
+// 名称在运行时确定的作用域，@a profiler_name 为 std::string 表达式
+#define CARLA_PROFILE_DYNAMIC_SCOPE(context, profiler_name) \
+    ::carla::profiler::detail::ScopedProfiler carla_profiler_ ## context ## _dynamic_scoped_profiler( \
+        ::carla::profiler::Registry::FindOrRegisterScope(#context, profiler_name));
+
+// 定义性能分析FPS宏，记录每个线程两次调用之间的间隔
+#define CARLA_PROFILE_FPS(context, profiler_name) \
+    { \
+      static const ::carla::profiler::ScopeId carla_profiler_fps_id = \
+          ::carla::profiler::Registry::RegisterScope( \
+              LIBCARLA_GTEST_GET_TEST_NAME() + "." #context "." #profiler_name, true); \
+      ::carla::profiler::detail::RecordInterval(carla_profiler_fps_id); \
     }
 
-#endif // LIBCARLA_ENABLE_PROFILER 
+#endif // LIBCARLA_ENABLE_PROFILER
@@ -6,67 +6,151 @@
 
 #pragma once
 
+#include "carla/ListView.h" // 引入列表视图的头文件
 #include "carla/NonCopyable.h" // 引入非拷贝类的头文件
 #include "carla/road/RoadElementSet.h" // 引入道路元素集合的头文件
 #include "carla/road/element/RoadInfo.h" // 引入道路信息元素的头文件
-#include "carla/road/element/RoadInfoIterator.h" // 引入道路信息迭代器的头文件
+#include "carla/road/element/RoadInfoVisitor.h" // 引入道路信息访问者的头文件
 
-#include <vector> // 引入向量的头文件
+#include <algorithm> // 引入二分查找算法的头文件
+#include <iterator> // 引入迭代器的头文件
 #include <memory> // 引入智能指针的头文件
+#include <tuple> // 引入元组的头文件
+#include <vector> // 引入向量的头文件
 
 namespace carla { // carla命名空间
 namespace road { // road命名空间
 
+  /// 道路或车道上的信息集合。
+  ///
+  /// 构建时按类型把信息分到各自的数组中，每个数组保持按 s 排序，
+  /// 查询时只需在对应类型的数组上二分查找，不需要逐个元素做虚函数类型判断。
   class InformationSet : private MovableNonCopyable { // 信息集合类，继承自不可拷贝类
   public:
 
+    /// GetInfos 返回的只读视图，直接引用集合内部的数组，不分配内存。
+    template <typename T>
+    using InfoList = ListView<typename std::vector<const T *>::const_iterator>;
+
     InformationSet() = default; // 默认构造函数
 
     InformationSet(std::vector<std::unique_ptr<element::RoadInfo>> &&vec) // 接受右值向量构造函数
-      : _road_set(std::move(vec)) {} // 移动初始化道路元素集合
+      : _road_set(std::move(vec)) { // 移动初始化道路元素集合
+      // _road_set 已经按 s 排好序，按顺序分区后每个类型的数组也是有序的
+      Partitioner partitioner(_partitions);
+      for (auto &info : _road_set.GetAll()) {
+        info->AcceptVisitor(partitioner);
+      }
+    }
 
     /// 返回从道路起点给定类型的所有信息
     template <typename T>
-    std::vector<const T *> GetInfos() const { // 模板函数，获取指定类型的信息
-      std::vector<const T *> vec; // 创建一个存储指针的向量
-      auto it = element::MakeRoadInfoIterator<T>(_road_set.GetAll()); // 创建道路信息迭代器
-      for (; !it.IsAtEnd(); ++it) { // 遍历迭代器
-        vec.emplace_back(&*it); // 添加迭代器当前指向的元素指针到向量
-      }
-      return vec; // 返回信息向量
+    InfoList<T> GetInfos() const { // 模板函数，获取指定类型的信息
+      return MakeListView(GetPartition<T>());
     }
 
-    /// 返回给定类型和距离s的单一信息
+    /// 返回给定类型和距离s的单一信息，即 s 之前最后一个该类型的信息
     template <typename T>
     const T *GetInfo(const double s) const { // 模板函数，获取指定距离的信息
-      auto it = element::MakeRoadInfoIterator<T>(_road_set.GetReverseSubset(s)); // 创建反向迭代器
-      return it.IsAtEnd() ? nullptr : &*it; // 如果迭代器到达末尾，返回nullptr，否则返回当前元素的指针
+      const auto &infos = GetPartition<T>();
+      auto it = std::upper_bound(infos.begin(), infos.end(), s, UpperComp());
+      return it == infos.begin() ? nullptr : *std::prev(it);
     }
 
-    /// 返回在指定范围内给定类型的所有信息
+    /// 返回在指定范围内给定类型的所有信息，min_s 大于 max_s 时按逆序返回
     template <typename T>
     std::vector<const T *> GetInfos(const double min_s, const double max_s) const { // 模板函数，获取指定范围的信息
+      const auto &infos = GetPartition<T>();
       std::vector<const T *> vec; // 创建一个存储指针的向量
       if(min_s < max_s) { // 如果最小值小于最大值
-        auto it = element::MakeRoadInfoIterator<T>(
-            _road_set.GetSubsetInRange(min_s, max_s)); // 创建范围内迭代器
-        for (; !it.IsAtEnd(); ++it) { // 遍历迭代器
-          vec.emplace_back(&*it); // 添加当前元素指针到向量
-        }
+        auto low_bound = std::lower_bound(infos.begin(), infos.end(), min_s, LowerComp());
+        auto up_bound = std::upper_bound(low_bound, infos.end(), max_s, UpperComp());
+        vec.assign(low_bound, up_bound);
       } else { // 如果最小值大于等于最大值
-        auto it = element::MakeRoadInfoIterator<T>(
-            _road_set.GetReverseSubsetInRange(max_s, min_s)); // 创建反向范围迭代器
-        for (; !it.IsAtEnd(); ++it) { // 遍历迭代器
-          vec.emplace_back(&*it); // 添加当前元素指针到向量
-        }
+        auto low_bound = std::lower_bound(infos.begin(), infos.end(), max_s, LowerComp());
+        auto up_bound = std::upper_bound(low_bound, infos.end(), min_s, UpperComp());
+        vec.assign(std::make_reverse_iterator(up_bound), std::make_reverse_iterator(low_bound));
       }
       return vec; // 返回信息向量
     }
 
   private:
 
-    RoadElementSet<std::unique_ptr<element::RoadInfo>> _road_set; // 私有成员，存储道路元素集合
+    /// 每种信息类型一个按 s 排序的数组。
+    using Partitions = std::tuple<
+        std::vector<const element::RoadInfoCrosswalk *>,
+        std::vector<const element::RoadInfoElevation *>,
+        std::vector<const element::RoadInfoGeometry *>,
+        std::vector<const element::RoadInfoLaneAccess *>,
+        std::vector<const element::RoadInfoLaneBorder *>,
+        std::vector<const element::RoadInfoLaneHeight *>,
+        std::vector<const element::RoadInfoLaneMaterial *>,
+        std::vector<const element::RoadInfoLaneOffset *>,
+        std::vector<const element::RoadInfoLaneRule *>,
+        std::vector<const element::RoadInfoLaneVisibility *>,
+        std::vector<const element::RoadInfoLaneWidth *>,
+        std::vector<const element::RoadInfoMarkRecord *>,
+        std::vector<const element::RoadInfoMarkTypeLine *>,
+        std::vector<const element::RoadInfoSignal *>,
+        std::vector<const element::RoadInfoSpeed *>>;
+
+    /// 构建时使用的访问者，把每个信息追加到对应类型的数组中。
+    class Partitioner final : public element::RoadInfoVisitor {
+    public:
+
+      explicit Partitioner(Partitions &partitions) : _partitions(partitions) {}
+
+      using element::RoadInfoVisitor::Visit;
+
+      void Visit(element::RoadInfoCrosswalk &info) override { Add(info); }
+      void Visit(element::RoadInfoElevation &info) override { Add(info); }
+      void Visit(element::RoadInfoGeometry &info) override { Add(info); }
+      void Visit(element::RoadInfoLaneAccess &info) override { Add(info); }
+      void Visit(element::RoadInfoLaneBorder &info) override { Add(info); }
+      void Visit(element::RoadInfoLaneHeight &info) override { Add(info); }
+      void Visit(element::RoadInfoLaneMaterial &info) override { Add(info); }
+      void Visit(element::RoadInfoLaneOffset &info) override { Add(info); }
+      void Visit(element::RoadInfoLaneRule &info) override { Add(info); }
+      void Visit(element::RoadInfoLaneVisibility &info) override { Add(info); }
+      void Visit(element::RoadInfoLaneWidth &info) override { Add(info); }
+      void Visit(element::RoadInfoMarkRecord &info) override { Add(info); }
+      void Visit(element::RoadInfoMarkTypeLine &info) override { Add(info); }
+      void Visit(element::RoadInfoSignal &info) override { Add(info); }
+      void Visit(element::RoadInfoSpeed &info) override { Add(info); }
+
+    private:
+
+      template <typename T>
+      void Add(T &info) {
+        std::get<std::vector<const T *>>(_partitions).push_back(&info);
+      }
+
+      Partitions &_partitions;
+    };
+
+    struct LowerComp {
+      template <typename T>
+      bool operator()(const T *info, const double s) const {
+        return info->GetDistance() < s;
+      }
+    };
+
+    struct UpperComp {
+      template <typename T>
+      bool operator()(const double s, const T *info) const {
+        return s < info->GetDistance();
+      }
+    };
+
+    template <typename T>
+    const std::vector<const T *> &GetPartition() const {
+      return std::get<std::vector<const T *>>(_partitions);
+    }
+
+    RoadElementSet<std::unique_ptr<element::RoadInfo>> _road_set; // 私有成员，拥有所有道路信息元素
+
+    Partitions _partitions; // 按类型划分的信息指针，指向 _road_set 中的元素
   };
 
 } // road
-} // carla
\ No newline at end of file
+} // carla
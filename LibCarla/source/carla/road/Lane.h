@@ -82,7 +82,7 @@ namespace road { // 定义road命名空间
     }
 
     template <typename T>
-    std::vector<const T*> GetInfos() const { // 获取所有信息
+    InformationSet::InfoList<T> GetInfos() const { // 获取所有信息
       DEBUG_ASSERT(_lane_section != nullptr); // 调试断言：车道段指针不能为空
       return _info.GetInfos<T>(); // 返回所有指定类型的信息
     }
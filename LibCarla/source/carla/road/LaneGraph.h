@@ -0,0 +1,149 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h" // 引入断言宏的头文件
+#include "carla/ListView.h" // 引入列表视图的头文件
+#include "carla/road/RoadTypes.h" // 引入道路类型的头文件
+
+#include <cstdint> // 引入固定宽度整数的头文件
+#include <limits> // 引入数值极限的头文件
+#include <unordered_map> // 引入无序映射的头文件
+#include <vector> // 引入向量的头文件
+
+namespace carla {
+namespace road {
+
+  /// 预先计算的车道连接图。
+  ///
+  /// 每条车道是一个节点，保存沿车道行驶时需要的距离和长度；车道末端到
+  /// 后继车道起点、车道起点到前驱车道末端的连接按节点连续存放在一个数组中。
+  /// 遍历时只需按下标访问节点，不需要再依次查找道路、车道段和车道。
+  class LaneGraph {
+  public:
+
+    using NodeId = uint32_t;
+
+    /// 表示“没有这个节点”的下标。
+    static constexpr NodeId INVALID_NODE = std::numeric_limits<NodeId>::max();
+
+    struct Node {
+      RoadId road_id;
+      SectionId section_id;
+      LaneId lane_id;
+      /// 车道所在车道段起点的 s
+      double distance;
+      /// 车道长度
+      double length;
+      /// 从前驱车道驶入本车道时所在的 s
+      double distance_at_start;
+      /// 从后继车道倒退进入本车道时所在的 s
+      double distance_at_end;
+      /// 后继和前驱在 _edges 中的范围
+      uint32_t successors_begin;
+      uint32_t successors_end;
+      uint32_t predecessors_begin;
+      uint32_t predecessors_end;
+    };
+
+    /// 添加一个没有连接的节点，返回其下标。
+    NodeId AddNode(
+        RoadId road_id,
+        SectionId section_id,
+        LaneId lane_id,
+        double distance,
+        double length,
+        double distance_at_start,
+        double distance_at_end) {
+      const auto id = static_cast<NodeId>(_nodes.size());
+      const auto edge = static_cast<uint32_t>(_edges.size());
+      _nodes.push_back(Node{
+          road_id, section_id, lane_id,
+          distance, length, distance_at_start, distance_at_end,
+          edge, edge, edge, edge});
+      _index.emplace(Key{road_id, section_id, lane_id}, id);
+      return id;
+    }
+
+    /// 设置节点 @a id 的后继和前驱，每个节点只能设置一次。
+    void SetEdges(
+        NodeId id,
+        const std::vector<NodeId> &successors,
+        const std::vector<NodeId> &predecessors) {
+      DEBUG_ASSERT(id < _nodes.size());
+      Node &node = _nodes[id];
+      node.successors_begin = static_cast<uint32_t>(_edges.size());
+      _edges.insert(_edges.end(), successors.begin(), successors.end());
+      node.successors_end = static_cast<uint32_t>(_edges.size());
+      node.predecessors_begin = node.successors_end;
+      _edges.insert(_edges.end(), predecessors.begin(), predecessors.end());
+      node.predecessors_end = static_cast<uint32_t>(_edges.size());
+    }
+
+    /// 返回车道对应的节点下标，车道不存在时返回 INVALID_NODE。
+    NodeId GetNodeId(RoadId road_id, SectionId section_id, LaneId lane_id) const {
+      const auto it = _index.find(Key{road_id, section_id, lane_id});
+      if (it == _index.end()) {
+        return INVALID_NODE;
+      }
+      return it->second;
+    }
+
+    const Node &GetNode(NodeId id) const {
+      DEBUG_ASSERT(id < _nodes.size());
+      return _nodes[id];
+    }
+
+    auto GetSuccessors(NodeId id) const {
+      const Node &node = GetNode(id);
+      return MakeListView(
+          _edges.data() + node.successors_begin,
+          _edges.data() + node.successors_end);
+    }
+
+    auto GetPredecessors(NodeId id) const {
+      const Node &node = GetNode(id);
+      return MakeListView(
+          _edges.data() + node.predecessors_begin,
+          _edges.data() + node.predecessors_end);
+    }
+
+    size_t GetNumberOfNodes() const {
+      return _nodes.size();
+    }
+
+  private:
+
+    struct Key {
+      RoadId road_id;
+      SectionId section_id;
+      LaneId lane_id;
+
+      bool operator==(const Key &rhs) const {
+        return road_id == rhs.road_id &&
+               section_id == rhs.section_id &&
+               lane_id == rhs.lane_id;
+      }
+    };
+
+    struct KeyHash {
+      size_t operator()(const Key &key) const {
+        uint64_t hash = (static_cast<uint64_t>(key.road_id) << 32u) | key.section_id;
+        hash = (hash ^ static_cast<uint32_t>(key.lane_id)) * 1099511628211ull;
+        return static_cast<size_t>(hash ^ (hash >> 29u));
+      }
+    };
+
+    std::vector<Node> _nodes;
+
+    std::vector<NodeId> _edges;
+
+    std::unordered_map<Key, NodeId, KeyHash> _index;
+  };
+
+} // namespace road
+} // namespace carla
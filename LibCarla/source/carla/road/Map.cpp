@@ -6,10 +6,13 @@
 
 #include "carla/road/Map.h" // 导入地图相关的头文件
 #include "carla/Exception.h" // 导入异常处理的头文件
+#include "carla/Logging.h" // 导入日志的头文件
+#include "carla/ThreadPool.h" // 导入线程池的头文件
 #include "carla/geom/Math.h" // 导入数学计算相关的头文件
 #include "carla/geom/Vector3D.h" // 导入三维向量相关的头文件
 #include "carla/road/MeshFactory.h" // 导入网格工厂的头文件
 #include "carla/road/Deformation.h" // 导入变形相关的头文件
+#include "carla/road/MapCache.h" // 导入地图缓存格式的头文件
 #include "carla/road/element/LaneCrossingCalculator.h" // 导入车道交叉计算器的头文件
 #include "carla/road/element/RoadInfoCrosswalk.h" // 导入人行横道信息的头文件
 #include "carla/road/element/RoadInfoElevation.h" // 导入道路高度信息的头文件
@@ -22,13 +25,29 @@
 
 #include "marchingcube/MeshReconstruction.h" // 导入网格重建的头文件
 
+#ifndef _WIN32
+#  include <fcntl.h> // 导入 open
+#  include <sys/mman.h> // 导入 mmap
+#  include <sys/stat.h> // 导入 fstat
+#  include <unistd.h> // 导入 close
+#endif // _WIN32
+
 #include <vector> // 导入向量库
+#include <algorithm> // 导入排序算法库
+#include <atomic> // 导入原子变量库
+#include <future> // 导入异步结果库
+#include <limits> // 导入数值极限库
+#include <mutex> // 导入 std::call_once
 #include <unordered_map> // 导入无序映射库
 #include <stdexcept> // 导入标准异常库
 #include <chrono> // 导入时间相关库
 #include <thread> // 导入线程相关库
 #include <iomanip> // 导入格式化输入输出库
 #include <cmath> // 导入数学库
+#include <cstdio> // 导入文件重命名函数
+#include <cstring> // 导入内存复制函数
+#include <fstream> // 导入文件流库
+#include <random> // 导入随机数库
 
 namespace carla {
 namespace road {
@@ -155,6 +174,195 @@ static void ForEachDrivableLaneAt(const Road &road, double distance, FuncT &&fun
     }
 }
 
+// 每个线程至少处理的批量查询数，少于这个数量时不值得创建线程
+static constexpr size_t MIN_QUERIES_PER_THREAD = 512u;
+
+// 将 16 位整数的各位间隔展开，用于计算 Z 序（Morton）编码
+static uint32_t SpreadBits(uint32_t x) {
+    x &= 0x0000FFFFu;
+    x = (x | (x << 8u)) & 0x00FF00FFu;
+    x = (x | (x << 4u)) & 0x0F0F0F0Fu;
+    x = (x | (x << 2u)) & 0x33333333u;
+    x = (x | (x << 1u)) & 0x55555555u;
+    return x;
+}
+
+// 把坐标映射到 [0, 65535] 的网格坐标。NaN 和无穷大无法比较大小，直接放在 0，
+// 先在浮点数范围内截断再转换，避免越界转换成整数的未定义行为
+static uint32_t QuantizeCoordinate(float value, float min_value, float scale) {
+    if (!std::isfinite(value)) {
+        return 0u;
+    }
+    const float cell = (value - min_value) * scale;
+    return static_cast<uint32_t>(std::min(std::max(cell, 0.0f), 65535.0f));
+}
+
+/// 返回按 Z 序曲线排序的查询下标，空间上相近的位置在结果中也相邻。
+/// 包围盒只统计有限的坐标，坐标为 NaN 或无穷大的查询排在第一个网格里。
+static std::vector<size_t> SortSpatially(const std::vector<geom::Location> &locations) {
+    float min_x = std::numeric_limits<float>::max();
+    float min_y = std::numeric_limits<float>::max();
+    float max_x = std::numeric_limits<float>::lowest();
+    float max_y = std::numeric_limits<float>::lowest();
+    for (const auto &location : locations) {
+        if (std::isfinite(location.x)) {
+            min_x = std::min(min_x, location.x);
+            max_x = std::max(max_x, location.x);
+        }
+        if (std::isfinite(location.y)) {
+            min_y = std::min(min_y, location.y);
+            max_y = std::max(max_y, location.y);
+        }
+    }
+    // 把包围盒量化为 65536 x 65536 的网格。包围盒跨度超出 float 范围时
+    // 跨度为无穷大，缩放系数为 0，所有查询落在同一行或同一列
+    const float scale_x = max_x > min_x ? 65535.0f / (max_x - min_x) : 0.0f;
+    const float scale_y = max_y > min_y ? 65535.0f / (max_y - min_y) : 0.0f;
+
+    std::vector<std::pair<uint32_t, size_t>> codes;
+    codes.reserve(locations.size());
+    for (size_t i = 0u; i < locations.size(); ++i) {
+        const uint32_t x = QuantizeCoordinate(locations[i].x, min_x, scale_x);
+        const uint32_t y = QuantizeCoordinate(locations[i].y, min_y, scale_y);
+        codes.emplace_back(SpreadBits(x) | (SpreadBits(y) << 1u), i);
+    }
+    std::sort(codes.begin(), codes.end());
+
+    std::vector<size_t> order;
+    order.reserve(codes.size());
+    for (const auto &code : codes) {
+        order.emplace_back(code.second);
+    }
+    return order;
+}
+
+// 批量查询和网格生成共用的线程池，第一次需要并行时启动，之后一直复用，
+// 避免每次调用都创建和回收线程。调用线程也参与执行，所以工作线程数比
+// 硬件并发线程数少一个
+static ThreadPool &GetThreadPool(size_t &number_of_workers) {
+    static const size_t workers = std::max(1u, std::thread::hardware_concurrency()) - 1u;
+    static ThreadPool pool;
+    static std::once_flag started;
+    std::call_once(started, []() {
+        if (workers > 0u) {
+            pool.AsyncRun(workers);
+        }
+    });
+    number_of_workers = workers;
+    return pool;
+}
+
+/// 对每个位置执行 @a query(location, buffer)，结果与 @a locations 一一对应。
+/// 查询按空间顺序执行，每个线程处理连续的一段并重复使用自己的
+/// std::vector<ElementT> 缓冲区。
+template <typename ElementT, typename QueryT>
+static std::vector<boost::optional<Waypoint>> RunBatchQuery(
+    const std::vector<geom::Location> &locations,
+    size_t number_of_threads,
+    QueryT &&query) {
+    std::vector<boost::optional<Waypoint>> result(locations.size());
+    const std::vector<size_t> order = SortSpatially(locations);
+
+    auto run_range = [&](size_t begin, size_t end) {
+        std::vector<ElementT> buffer;
+        for (size_t i = begin; i < end; ++i) {
+            const size_t index = order[i];
+            result[index] = query(locations[index], buffer);
+        }
+    };
+
+    size_t number_of_workers = 0u;
+    ThreadPool &pool = GetThreadPool(number_of_workers);
+    if (number_of_threads == 0u) {
+        number_of_threads = number_of_workers + 1u;
+    }
+    number_of_threads = std::min({
+        number_of_threads,
+        number_of_workers + 1u,
+        std::max<size_t>(1u, locations.size() / MIN_QUERIES_PER_THREAD)});
+    if (number_of_threads <= 1u) {
+        run_range(0u, locations.size());
+        return result;
+    }
+
+    // 调用线程处理第一段，其余各段交给共用的线程池
+    const size_t chunk_size = (locations.size() + number_of_threads - 1u) / number_of_threads;
+    std::vector<std::future<void>> futures;
+    futures.reserve(number_of_threads - 1u);
+    for (size_t begin = chunk_size; begin < locations.size(); begin += chunk_size) {
+        const size_t end = std::min(begin + chunk_size, locations.size());
+        futures.emplace_back(pool.Post([&run_range, begin, end]() { run_range(begin, end); }));
+    }
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    try {
+#endif // LIBCARLA_NO_EXCEPTIONS
+        run_range(0u, std::min(chunk_size, locations.size()));
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    } catch (...) {
+        // 其他任务还在通过引用使用 run_range、result 和 locations，必须等它们结束
+        for (auto &future : futures) {
+            future.wait();
+        }
+        throw;
+    }
+#endif // LIBCARLA_NO_EXCEPTIONS
+    // 先等所有任务结束再重新抛出工作线程中的异常，否则未结束的任务会访问已销毁的局部变量
+    for (auto &future : futures) {
+        future.wait();
+    }
+    for (auto &future : futures) {
+        future.get();
+    }
+    return result;
+}
+
+/// 在共用的线程池中执行 @a number_of_tasks 个相互独立的任务 task(i)。
+/// 工作线程和调用线程一起执行，每个线程完成一个任务后从共享计数器领取
+/// 下一个，耗时相差很大的任务也能均匀地分配。
+/// 任务在工作线程中抛出的异常会在调用线程中重新抛出。
+template <typename TaskT>
+static void RunTasksInParallel(const size_t number_of_tasks, TaskT &&task) {
+    std::atomic<size_t> next_task{0u};
+    auto worker = [&]() {
+        for (size_t i = next_task++; i < number_of_tasks; i = next_task++) {
+            task(i);
+        }
+    };
+
+    if (number_of_tasks <= 1u) {
+        worker();
+        return;
+    }
+    size_t number_of_workers = 0u;
+    ThreadPool &pool = GetThreadPool(number_of_workers);
+    number_of_workers = std::min(number_of_workers, number_of_tasks - 1u);
+    std::vector<std::future<void>> futures;
+    futures.reserve(number_of_workers);
+    for (size_t i = 0u; i < number_of_workers; ++i) {
+        futures.emplace_back(pool.Post(worker));
+    }
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    try {
+#endif // LIBCARLA_NO_EXCEPTIONS
+        worker();
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    } catch (...) {
+        // 其他任务还在通过引用使用 next_task 和 task，必须等它们结束
+        for (auto &future : futures) {
+            future.wait();
+        }
+        throw;
+    }
+#endif // LIBCARLA_NO_EXCEPTIONS
+    // 同样先等所有任务结束，再通过 get() 重新抛出工作线程中的异常
+    for (auto &future : futures) {
+        future.wait();
+    }
+    for (auto &future : futures) {
+        future.get();
+    }
+}
+
 /// 假定 road_id 和 section_id 是有效的
 static bool IsLanePresent(const MapData &data, Waypoint waypoint) {
     const auto &section = data.GetRoad(waypoint.road_id).GetLaneSectionById(waypoint.section_id); // 获取指定的车道段
@@ -168,12 +376,20 @@ static bool IsLanePresent(const MapData &data, Waypoint waypoint) {
 boost::optional<Waypoint> Map::GetClosestWaypointOnRoad(
     const geom::Location &pos,
     int32_t lane_type) const {
-    std::vector<Rtree::TreeElement> query_result =
-        _rtree.GetNearestNeighboursWithFilter(Rtree::BPoint(pos.x, pos.y, pos.z), // 获取与位置最近的邻居节点
+    std::vector<Rtree::TreeElement> query_result;
+    return FindClosestWaypointOnRoad(pos, lane_type, query_result);
+}
+
+boost::optional<Waypoint> Map::FindClosestWaypointOnRoad(
+    const geom::Location &pos,
+    int32_t lane_type,
+    std::vector<Rtree::TreeElement> &query_result) const {
+    _rtree.GetNearestNeighboursWithFilter(Rtree::BPoint(pos.x, pos.y, pos.z), // 获取与位置最近的邻居节点
         [&](Rtree::TreeElement const &element) {
             const Lane &lane = GetLane(element.second.first); // 获取车道
             return (lane_type & static_cast<int32_t>(lane.GetType())) > 0; // 检查车道类型是否匹配
-        });
+        },
+        query_result);
 
     if (query_result.size() == 0) { // 如果没有找到结果
         return boost::optional<Waypoint>{}; // 返回空的航点
@@ -215,8 +431,12 @@ boost::optional<Waypoint> Map::GetClosestWaypointOnRoad(
 boost::optional<Waypoint> Map::GetWaypoint(
     const geom::Location &pos,
     int32_t lane_type) const {
-    boost::optional<Waypoint> w = GetClosestWaypointOnRoad(pos, lane_type); // 获取最近的航点
+    return FilterByLaneWidth(pos, GetClosestWaypointOnRoad(pos, lane_type)); // 获取最近的航点并检查是否在车道内
+}
 
+boost::optional<Waypoint> Map::FilterByLaneWidth(
+    const geom::Location &pos,
+    boost::optional<Waypoint> w) const {
     if (!w.has_value()) { // 如果没有找到航点
         return w; // 返回空
     }
@@ -233,6 +453,26 @@ boost::optional<Waypoint> Map::GetWaypoint(
     return boost::optional<Waypoint>{}; // 否则返回空
 }
 
+std::vector<boost::optional<Waypoint>> Map::GetClosestWaypointsOnRoad(
+    const std::vector<geom::Location> &locations,
+    int32_t lane_type,
+    size_t number_of_threads) const {
+    return RunBatchQuery<Rtree::TreeElement>(locations, number_of_threads,
+        [&](const geom::Location &pos, std::vector<Rtree::TreeElement> &query_result) {
+            return FindClosestWaypointOnRoad(pos, lane_type, query_result);
+        });
+}
+
+std::vector<boost::optional<Waypoint>> Map::GetWaypoints(
+    const std::vector<geom::Location> &locations,
+    int32_t lane_type,
+    size_t number_of_threads) const {
+    return RunBatchQuery<Rtree::TreeElement>(locations, number_of_threads,
+        [&](const geom::Location &pos, std::vector<Rtree::TreeElement> &query_result) {
+            return FilterByLaneWidth(pos, FindClosestWaypointOnRoad(pos, lane_type, query_result));
+        });
+}
+
 boost::optional<Waypoint> Map::GetWaypoint(
     RoadId road_id,
     LaneId lane_id,
@@ -464,7 +704,7 @@ std::vector<geom::Location> Map::GetAllCrosswalkZones() const {
 
     for (const auto &pair : _data.GetRoads()) { // 遍历所有道路
         const auto &road = pair.second; // 获取道路信息
-        std::vector<const RoadInfoCrosswalk *> crosswalks = road.GetInfos<RoadInfoCrosswalk>(); // 获取道路上的人行横道信息
+        const auto crosswalks = road.GetInfos<RoadInfoCrosswalk>(); // 获取道路上的人行横道信息
         if (crosswalks.size() > 0) { // 如果存在人行横道
             for (auto crosswalk : crosswalks) { // 遍历每个横道
                 std::vector<geom::Location> points; // 存储点的位置
@@ -519,37 +759,23 @@ std::vector<geom::Location> Map::GetAllCrosswalkZones() const {
 // ===========================================================================
 
 std::vector<Waypoint> Map::GetSuccessors(const Waypoint waypoint) const {
-    const auto &next_lanes = GetLane(waypoint).GetNextLanes(); // 获取下一个车道
+    const auto successors = _lane_graph.GetSuccessors(GetLaneGraphNode(waypoint)); // 获取下一个车道
     std::vector<Waypoint> result; // 存储结果
-    result.reserve(next_lanes.size()); // 预留空间
-    for (auto *next_lane : next_lanes) { // 遍历每个下一个车道
-        RELEASE_ASSERT(next_lane != nullptr); // 确保车道不为空
-        const auto lane_id = next_lane->GetId(); // 获取车道ID
-        RELEASE_ASSERT(lane_id != 0); // 确保车道ID有效
-        const auto *section = next_lane->GetLaneSection(); // 获取车道段
-        RELEASE_ASSERT(section != nullptr); // 确保车道段不为空
-        const auto *road = next_lane->GetRoad(); // 获取道路
-        RELEASE_ASSERT(road != nullptr); // 确保道路不为空
-        const auto distance = GetDistanceAtStartOfLane(*next_lane); // 获取下一个车道起始位置的距离
-        result.emplace_back(Waypoint{road->GetId(), section->GetId(), lane_id, distance}); // 添加航点到结果中
+    result.reserve(successors.size()); // 预留空间
+    for (auto id : successors) { // 遍历每个下一个车道
+        const auto &next = _lane_graph.GetNode(id);
+        result.emplace_back(Waypoint{next.road_id, next.section_id, next.lane_id, next.distance_at_start}); // 添加航点到结果中
     }
     return result; // 返回下一个航点
 }
 
 std::vector<Waypoint> Map::GetPredecessors(const Waypoint waypoint) const {
-    const auto &prev_lanes = GetLane(waypoint).GetPreviousLanes(); // 获取前一个车道
+    const auto predecessors = _lane_graph.GetPredecessors(GetLaneGraphNode(waypoint)); // 获取前一个车道
     std::vector<Waypoint> result; // 存储结果
-    result.reserve(prev_lanes.size()); // 预留空间
-    for (auto *next_lane : prev_lanes) { // 遍历每个前一个车道
-        RELEASE_ASSERT(next_lane != nullptr); // 确保车道不为空
-        const auto lane_id = next_lane->GetId(); // 获取车道ID
-        RELEASE_ASSERT(lane_id != 0); // 确保车道ID有效
-        const auto *section = next_lane->GetLaneSection(); // 获取车道段
-        RELEASE_ASSERT(section != nullptr); // 确保车道段不为空
-        const auto *road = next_lane->GetRoad(); // 获取道路
-        RELEASE_ASSERT(road != nullptr); // 确保道路不为空
-        const auto distance = GetDistanceAtEndOfLane(*next_lane); // 获取前一个车道末端位置的距离
-        result.emplace_back(Waypoint{road->GetId(), section->GetId(), lane_id, distance}); // 添加航点到结果中
+    result.reserve(predecessors.size()); // 预留空间
+    for (auto id : predecessors) { // 遍历每个前一个车道
+        const auto &previous = _lane_graph.GetNode(id);
+        result.emplace_back(Waypoint{previous.road_id, previous.section_id, previous.lane_id, previous.distance_at_end}); // 添加航点到结果中
     }
     return result; // 返回前一个航点
 }
@@ -557,72 +783,118 @@ std::vector<Waypoint> Map::GetPredecessors(const Waypoint waypoint) const {
 std::vector<Waypoint> Map::GetNext(
       const Waypoint waypoint,
       const double distance) const {
+    return GetPath(waypoint, distance, true);
+}
+
+std::vector<Waypoint> Map::GetPrevious(
+      const Waypoint waypoint,
+      const double distance) const {
+    return GetPath(waypoint, distance, false);
+}
+
+std::vector<Waypoint> Map::GetPath(
+      const Waypoint waypoint,
+      const double distance,
+      const bool next) const {
     RELEASE_ASSERT(distance > 0.0); // 确保距离大于0
     if (distance <= EPSILON) { // 如果距离很小（近似为0）
       return {waypoint}; // 返回当前的waypoint
     }
-    const auto &lane = GetLane(waypoint); // 获取当前waypoint所在的车道
-    const bool forward = (waypoint.lane_id <= 0); // 判断移动方向（正向或反向）
-    const double signed_distance = forward ? distance : -distance; // 根据方向确定带符号的距离
-    const double relative_s = waypoint.s - lane.GetDistance(); // 计算相对位置s
-    const double remaining_lane_length = forward ? lane.GetLength() - relative_s : relative_s; // 剩余车道长度
-    DEBUG_ASSERT(remaining_lane_length >= 0.0); // 确保剩余车道长度非负
+    const auto node_id = GetLaneGraphNode(waypoint);
+    const auto &node = _lane_graph.GetNode(node_id);
+    const bool forward = next ? (waypoint.lane_id <= 0) : (waypoint.lane_id > 0); // 判断移动方向（正向或反向）
+    const double relative_s = waypoint.s - node.distance; // 计算相对位置s
+    const double remaining_lane_length = forward ? node.length - relative_s : relative_s; // 剩余车道长度
 
-    // 如果在同一车道内，返回增加了距离的waypoint
+    std::vector<Waypoint> result; // 存储结果的vector
+    // 在同一车道内的查询很便宜，只缓存需要跨越车道末端的结果
     if (distance <= remaining_lane_length) {
-      Waypoint result = waypoint; // 创建结果waypoint
-      result.s += signed_distance; // 更新s值
-      result.s += forward ? -EPSILON : EPSILON; // 调整s值以避免浮点数精度问题
-      RELEASE_ASSERT(result.s > 0.0); // 确保s值大于0
-      return { result }; // 返回结果
+      AppendPath(node_id, waypoint, distance, next, result);
+      return result;
     }
 
-    // 如果没有剩余车道长度，则需要转到后继节点
-    std::vector<Waypoint> result; // 存储结果的vector
-    for (const auto &successor : GetSuccessors(waypoint)) { // 遍历所有后继waypoints
-      DEBUG_ASSERT(
-          successor.road_id != waypoint.road_id || // 确保不在同一路段
-          successor.section_id != waypoint.section_id || // 确保不在同一部分
-          successor.lane_id != waypoint.lane_id); // 确保不在同一车道
-      result = ConcatVectors(result, GetNext(successor, distance - remaining_lane_length)); // 递归获取下一个waypoint
+    const PathCacheKey key{waypoint, distance, next};
+    {
+      std::lock_guard<std::mutex> lock(_path_cache->mutex);
+      if (_path_cache->cache.Get(key, result)) {
+        return result;
+      }
+    }
+    AppendPath(node_id, waypoint, distance, next, result);
+    {
+      std::lock_guard<std::mutex> lock(_path_cache->mutex);
+      _path_cache->cache.Put(key, result);
     }
     return result; // 返回所有找到的waypoints
-  }
+}
 
-  std::vector<Waypoint> Map::GetPrevious(
+void Map::AppendPath(
+      const LaneGraph::NodeId node_id,
       const Waypoint waypoint,
-      const double distance) const {
-    RELEASE_ASSERT(distance > 0.0); // 确保距离大于0
+      const double distance,
+      const bool next,
+      std::vector<Waypoint> &result) const {
     if (distance <= EPSILON) { // 如果距离很小（近似为0）
-      return {waypoint}; // 返回当前的waypoint
+      result.emplace_back(waypoint); // 返回当前的waypoint
+      return;
     }
-    const auto &lane = GetLane(waypoint); // 获取当前waypoint所在的车道
-    const bool forward = !(waypoint.lane_id <= 0); // 判断移动方向（正向或反向）
+    const auto &node = _lane_graph.GetNode(node_id); // 获取当前waypoint所在的车道
+    const bool forward = next ? (waypoint.lane_id <= 0) : (waypoint.lane_id > 0); // 判断移动方向（正向或反向）
     const double signed_distance = forward ? distance : -distance; // 根据方向确定带符号的距离
-    const double relative_s = waypoint.s - lane.GetDistance(); // 计算相对位置s
-    const double remaining_lane_length = forward ? lane.GetLength() - relative_s : relative_s; // 剩余车道长度
+    const double relative_s = waypoint.s - node.distance; // 计算相对位置s
+    const double remaining_lane_length = forward ? node.length - relative_s : relative_s; // 剩余车道长度
     DEBUG_ASSERT(remaining_lane_length >= 0.0); // 确保剩余车道长度非负
 
     // 如果在同一车道内，返回增加了距离的waypoint
     if (distance <= remaining_lane_length) {
-      Waypoint result = waypoint; // 创建结果waypoint
-      result.s += signed_distance; // 更新s值
-      result.s += forward ? -EPSILON : EPSILON; // 调整s值以避免浮点数精度问题
-      RELEASE_ASSERT(result.s > 0.0); // 确保s值大于0
-      return { result }; // 返回结果
-    }
-
-    // 如果没有剩余车道长度，则需要转到前驱节点
-    std::vector<Waypoint> result; // 存储结果的vector
-    for (const auto &successor : GetPredecessors(waypoint)) { // 遍历所有前驱waypoints
+      Waypoint end = waypoint; // 创建结果waypoint
+      end.s += signed_distance; // 更新s值
+      end.s += forward ? -EPSILON : EPSILON; // 调整s值以避免浮点数精度问题
+      RELEASE_ASSERT(end.s > 0.0); // 确保s值大于0
+      result.emplace_back(end); // 返回结果
+      return;
+    }
+
+    // 如果没有剩余车道长度，则需要转到后继（或前驱）车道
+    const auto edges = next ?
+        _lane_graph.GetSuccessors(node_id) :
+        _lane_graph.GetPredecessors(node_id);
+    for (auto id : edges) { // 遍历所有后继（或前驱）车道
+      const auto &other = _lane_graph.GetNode(id);
+      const Waypoint entry{
+          other.road_id,
+          other.section_id,
+          other.lane_id,
+          next ? other.distance_at_start : other.distance_at_end};
       DEBUG_ASSERT(
-          successor.road_id != waypoint.road_id || // 确保不在同一路段
-          successor.section_id != waypoint.section_id || // 确保不在同一部分
-          successor.lane_id != waypoint.lane_id); // 确保不在同一车道
-      result = ConcatVectors(result, GetPrevious(successor, distance - remaining_lane_length)); // 递归获取前一个waypoint
+          entry.road_id != waypoint.road_id || // 确保不在同一路段
+          entry.section_id != waypoint.section_id || // 确保不在同一部分
+          entry.lane_id != waypoint.lane_id); // 确保不在同一车道
+      AppendPath(id, entry, distance - remaining_lane_length, next, result); // 递归获取下一个waypoint
     }
-    return result; // 返回所有找到的waypoints
-  }
+}
+
+void Map::SetPathCacheCapacity(const size_t capacity) {
+    std::lock_guard<std::mutex> lock(_path_cache->mutex);
+    _path_cache->cache = decltype(_path_cache->cache)(capacity);
+}
+
+size_t Map::PathCacheKeyHash::operator()(const PathCacheKey &key) const {
+    uint64_t hash = (static_cast<uint64_t>(key.waypoint.road_id) << 32u) | key.waypoint.section_id;
+    hash = (hash ^ static_cast<uint32_t>(key.waypoint.lane_id)) * 1099511628211ull;
+    hash = (hash ^ std::hash<double>()(key.waypoint.s)) * 1099511628211ull;
+    hash = (hash ^ std::hash<double>()(key.distance)) * 1099511628211ull;
+    return static_cast<size_t>(hash ^ static_cast<uint64_t>(key.next));
+}
+
+bool Map::PathCacheKeyEqual::operator()(const PathCacheKey &lhs, const PathCacheKey &rhs) const {
+    return lhs.waypoint.road_id == rhs.waypoint.road_id &&
+           lhs.waypoint.section_id == rhs.waypoint.section_id &&
+           lhs.waypoint.lane_id == rhs.waypoint.lane_id &&
+           lhs.waypoint.s == rhs.waypoint.s &&
+           lhs.distance == rhs.distance &&
+           lhs.next == rhs.next;
+}
 
   boost::optional<Waypoint> Map::GetRight(Waypoint waypoint) const {
     RELEASE_ASSERT(waypoint.lane_id != 0); // 确保车道ID不为0
@@ -890,6 +1162,57 @@ double GetRemainingLength(const Lane &lane, double current_s) {
 }
 
 // 创建R树
+void Map::CreateLaneGraph() {
+    LaneGraph graph;
+    std::unordered_map<const Lane *, LaneGraph::NodeId> nodes;
+    // 每条车道一个节点
+    for (const auto &pair : _data.GetRoads()) {
+        const auto &road = pair.second;
+        for (const auto &section : road.GetLaneSections()) {
+            for (const auto &lane_pair : section.GetLanes()) {
+                const Lane &lane = lane_pair.second;
+                nodes.emplace(&lane, graph.AddNode(
+                    road.GetId(),
+                    section.GetId(),
+                    lane.GetId(),
+                    lane.GetDistance(),
+                    lane.GetLength(),
+                    GetDistanceAtStartOfLane(lane),
+                    GetDistanceAtEndOfLane(lane)));
+            }
+        }
+    }
+    // 按车道之间的指针连接节点
+    auto to_nodes = [&](const std::vector<Lane *> &lanes) {
+        std::vector<LaneGraph::NodeId> result;
+        result.reserve(lanes.size());
+        for (const auto *lane : lanes) {
+            RELEASE_ASSERT(lane != nullptr); // 确保车道不为空
+            DEBUG_ASSERT(lane->GetId() != 0); // 确保车道ID有效
+            const auto it = nodes.find(lane);
+            RELEASE_ASSERT(it != nodes.end()); // 确保车道属于这张地图
+            result.emplace_back(it->second);
+        }
+        return result;
+    };
+    for (const auto &pair : nodes) {
+        graph.SetEdges(
+            pair.second,
+            to_nodes(pair.first->GetNextLanes()),
+            to_nodes(pair.first->GetPreviousLanes()));
+    }
+    _lane_graph = std::move(graph);
+}
+
+LaneGraph::NodeId Map::GetLaneGraphNode(const Waypoint waypoint) const {
+    const auto id = _lane_graph.GetNodeId(waypoint.road_id, waypoint.section_id, waypoint.lane_id);
+    if (id == LaneGraph::INVALID_NODE) {
+        GetLane(waypoint); // 对不存在的道路或车道抛出与之前相同的异常
+        throw_exception(std::runtime_error("lane graph does not contain the waypoint's lane"));
+    }
+    return id;
+}
+
 void Map::CreateRtree() {
     const double epsilon = 0.000001; // 设置一个小的增量以防止数值误差
     const double min_delta_s = 1;    // 每个段的最小长度为1米
@@ -910,7 +1233,6 @@ void Map::CreateRtree() {
             }
         });
     }
-}
 
 // 段和路点的容器
 std::vector<Rtree::TreeElement> rtree_elements;
@@ -999,6 +1321,166 @@ for (auto &waypoint : topology) {
 
 // 将段添加到R树
 _rtree.InsertElements(rtree_elements);
+}
+
+// ===========================================================================
+// -- 地图: 缓存 -------------------------------------------------------------
+// ===========================================================================
+
+static cache::WaypointRecord ToRecord(const Waypoint &waypoint) {
+    cache::WaypointRecord record;
+    record.s = waypoint.s;
+    record.road_id = waypoint.road_id;
+    record.section_id = waypoint.section_id;
+    record.lane_id = waypoint.lane_id;
+    record.padding = 0u;
+    return record;
+}
+
+static Waypoint FromRecord(const cache::WaypointRecord &record) {
+    return Waypoint{record.road_id, record.section_id, record.lane_id, record.s};
+}
+
+bool Map::SaveCache(const std::string &filename, uint64_t opendrive_checksum) const {
+    const auto elements = _rtree.GetElements();
+
+    std::vector<cache::SegmentRecord> records;
+    records.reserve(elements.size());
+    for (const auto &element : elements) {
+        const auto &segment = element.first;
+        cache::SegmentRecord record;
+        record.start[0] = boost::geometry::get<0, 0>(segment);
+        record.start[1] = boost::geometry::get<0, 1>(segment);
+        record.start[2] = boost::geometry::get<0, 2>(segment);
+        record.end[0] = boost::geometry::get<1, 0>(segment);
+        record.end[1] = boost::geometry::get<1, 1>(segment);
+        record.end[2] = boost::geometry::get<1, 2>(segment);
+        record.start_waypoint = ToRecord(element.second.first);
+        record.end_waypoint = ToRecord(element.second.second);
+        records.push_back(record);
+    }
+
+    cache::Header header;
+    std::memcpy(header.magic, cache::MAGIC, sizeof(header.magic));
+    header.version = cache::VERSION;
+    header.header_size = sizeof(cache::Header);
+    header.record_size = sizeof(cache::SegmentRecord);
+    header.number_of_segments = static_cast<uint32_t>(records.size());
+    header.map_checksum = opendrive_checksum;
+
+    // 先写入同一目录下的临时文件，完整写入后再替换缓存文件
+    const std::string temporary = filename + ".tmp" + std::to_string(std::random_device{}());
+    {
+        std::ofstream out_file(temporary, std::ios::trunc | std::ios::binary);
+        static constexpr char zeros[cache::ALIGNMENT] = {};
+        const size_t offset = cache::Align(sizeof(header));
+        out_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out_file.write(zeros, static_cast<std::streamsize>(offset - sizeof(header)));
+        out_file.write(
+            reinterpret_cast<const char *>(records.data()),
+            static_cast<std::streamsize>(records.size() * sizeof(cache::SegmentRecord)));
+        if (!out_file.good()) {
+            log_warning("Could not write road map cache", temporary);
+            out_file.close();
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    std::remove(filename.c_str()); // Windows 上 rename 不会覆盖已有文件
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+        log_warning("Could not write road map cache", filename);
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool Map::LoadCache(const std::string &filename, uint64_t opendrive_checksum) {
+    // 服务器在禁用异常的情况下编译，这里只使用返回错误码的系统接口，
+    // 任何失败都视为没有缓存
+#ifdef _WIN32
+    std::ifstream in_file(filename, std::ios::binary | std::ios::ate);
+    if (!in_file.good()) {
+        return false;
+    }
+    std::vector<uint8_t> content(static_cast<size_t>(in_file.tellg()));
+    in_file.seekg(0);
+    if (!in_file.read(reinterpret_cast<char *>(content.data()), static_cast<std::streamsize>(content.size()))) {
+        log_warning("Could not read road map cache", filename);
+        return false;
+    }
+    return LoadCache(content.data(), content.size(), opendrive_checksum);
+#else
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat info;
+    if ((::fstat(fd, &info) == -1) || (info.st_size <= 0)) {
+        ::close(fd);
+        return false;
+    }
+    const auto size = static_cast<size_t>(info.st_size);
+    void *address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        log_warning("Could not map road map cache", filename);
+        return false;
+    }
+    // 映射只在加载期间存在，构建完R树后即可释放
+    const bool loaded = LoadCache(static_cast<const uint8_t *>(address), size, opendrive_checksum);
+    ::munmap(address, size);
+    return loaded;
+#endif // _WIN32
+}
+
+bool Map::LoadCache(const uint8_t *data, size_t size, uint64_t opendrive_checksum) {
+    cache::Header header;
+    if (size < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, cache::MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != cache::VERSION ||
+        header.header_size != sizeof(cache::Header) ||
+        header.record_size != sizeof(cache::SegmentRecord)) {
+        log_warning("Road map cache has an incompatible format, regenerating it");
+        return false;
+    }
+    if (header.map_checksum != opendrive_checksum) {
+        log_info("Road map cache was generated for another OpenDRIVE file, regenerating it");
+        return false;
+    }
+    const size_t offset = cache::Align(sizeof(header));
+    const size_t number_of_segments = header.number_of_segments;
+    if (size < offset || (size - offset) / sizeof(cache::SegmentRecord) < number_of_segments) {
+        log_warning("Road map cache is truncated, regenerating it");
+        return false;
+    }
+
+    std::vector<Rtree::TreeElement> elements;
+    elements.reserve(number_of_segments);
+    const uint8_t *records = data + offset;
+    for (size_t i = 0u; i < number_of_segments; ++i) {
+        cache::SegmentRecord record;
+        std::memcpy(&record, records + i * sizeof(record), sizeof(record));
+        const Waypoint start = FromRecord(record.start_waypoint);
+        const Waypoint end = FromRecord(record.end_waypoint);
+        // 即使校验和一致，也不能让损坏的缓存引用不存在的车道
+        if (_lane_graph.GetNodeId(start.road_id, start.section_id, start.lane_id) == LaneGraph::INVALID_NODE ||
+            _lane_graph.GetNodeId(end.road_id, end.section_id, end.lane_id) == LaneGraph::INVALID_NODE) {
+            log_warning("Road map cache references unknown lanes, regenerating it");
+            return false;
+        }
+        elements.emplace_back(
+            Rtree::BSegment(
+                Rtree::BPoint(record.start[0], record.start[1], record.start[2]),
+                Rtree::BPoint(record.end[0], record.end[1], record.end[2])),
+            std::make_pair(start, end));
+    }
+    _rtree.SetElements(elements);
+    return true;
+}
 
 Junction* Map::GetJunction(JuncId id) { // 获取交叉口
     return _data.GetJunction(id); // 返回指定ID的交叉口
@@ -1067,26 +1549,22 @@ geom::Mesh Map::GenerateMesh(
 std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateChunkedMesh(
       const rpc::OpendriveGenerationParameters& params) const {
     geom::MeshFactory mesh_factory(params); // 创建一个网格工厂，用于生成网格
-    std::vector<std::unique_ptr<geom::Mesh>> out_mesh_list; // 定义输出网格列表
 
-    std::unordered_map<JuncId, geom::Mesh> junction_map; // 定义用于存储交叉口网格的哈希映射
+    // 道路和交叉口各作为一个任务并行生成，每个任务写入自己的输出，
+    // 最后按原来的顺序合并，结果与串行生成相同
+    std::vector<const Road *> roads; // 不属于交叉口的道路
     for (auto &&pair : _data.GetRoads()) { // 遍历所有道路
-      const auto &road = pair.second; // 获取当前道路
-      if (!road.IsJunction()) { // 如果该道路不是交叉口
-        std::vector<std::unique_ptr<geom::Mesh>> road_mesh_list =
-            mesh_factory.GenerateAllWithMaxLen(road); // 生成道路的所有网格
-
-        // 将生成的道路网格添加到输出网格列表中
-        out_mesh_list.insert(
-            out_mesh_list.end(),
-            std::make_move_iterator(road_mesh_list.begin()),
-            std::make_move_iterator(road_mesh_list.end()));
+      if (!pair.second.IsJunction()) { // 如果该道路不是交叉口
+        roads.emplace_back(&pair.second);
       }
     }
+    std::vector<const Junction *> junctions; // 所有交叉口
+    for (const auto &junc_pair : _data.GetJunctions()) {
+      junctions.emplace_back(&junc_pair.second);
+    }
 
-    // 生成交叉口内的道路并进行光滑处理
-    for (const auto &junc_pair : _data.GetJunctions()) { // 遍历所有交叉口
-      const auto &junction = junc_pair.second; // 获取当前交叉口
+    std::vector<std::vector<std::unique_ptr<geom::Mesh>>> task_meshes(roads.size() + junctions.size());
+    auto generate_junction = [&](const Junction &junction, std::vector<std::unique_ptr<geom::Mesh>> &out) {
       std::vector<std::unique_ptr<geom::Mesh>> lane_meshes; // 存储车道网格
       std::vector<std::unique_ptr<geom::Mesh>> sidewalk_lane_meshes; // 存储人行道网格
       for(const auto &connection_pair : junction.GetConnections()) { // 遍历交叉口的连接
@@ -1108,7 +1586,7 @@ std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateChunkedMesh(
         for(auto& lane : sidewalk_lane_meshes) { // 遍历人行道网格
           *merged_mesh += *lane; // 将人行道网格添加到合并网格中
         }
-        out_mesh_list.push_back(std::move(merged_mesh)); // 将合并后的网格添加到输出列表
+        out.push_back(std::move(merged_mesh)); // 将合并后的网格添加到输出列表
       } else {
         std::unique_ptr<geom::Mesh> junction_mesh = std::make_unique<geom::Mesh>(); // 创建新的交叉口网格
         for(auto& lane : lane_meshes) { // 遍历车道网格
@@ -1117,8 +1595,24 @@ std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateChunkedMesh(
         for(auto& lane : sidewalk_lane_meshes) { // 遍历人行道网格
           *junction_mesh += *lane; // 将人行道网格添加到交叉口网格中
         }
-        out_mesh_list.push_back(std::move(junction_mesh)); // 将交叉口网格添加到输出列表
+        out.push_back(std::move(junction_mesh)); // 将交叉口网格添加到输出列表
       }
+    };
+    // 耗时较长的交叉口排在前面先领取，避免最后只剩一个线程在处理交叉口
+    RunTasksInParallel(task_meshes.size(), [&](const size_t i) {
+      if (i < junctions.size()) {
+        generate_junction(*junctions[i], task_meshes[roads.size() + i]);
+      } else {
+        task_meshes[i - junctions.size()] = mesh_factory.GenerateAllWithMaxLen(*roads[i - junctions.size()]); // 生成道路的所有网格
+      }
+    });
+
+    std::vector<std::unique_ptr<geom::Mesh>> out_mesh_list; // 定义输出网格列表
+    for (auto &meshes : task_meshes) {
+      out_mesh_list.insert(
+          out_mesh_list.end(),
+          std::make_move_iterator(meshes.begin()),
+          std::make_move_iterator(meshes.end()));
     }
 
     // 找到输出网格的最小和最大位置
@@ -1155,70 +1649,47 @@ Map::GenerateOrderedChunkedMeshInLocations(const rpc::OpendriveGenerationParamet
                                             const geom::Vector3D& minpos,
                                             const geom::Vector3D& maxpos) const
 {
+    using MeshesByType = std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>>;
     geom::MeshFactory mesh_factory(params); // 创建一个网格工厂，用于生成网格
-    std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>> road_out_mesh_list; // 存储道路类型对应的网格列表
-    std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>> junction_out_mesh_list; // 存储交叉口类型对应的网格列表
-
-    // 创建一个线程来生成交叉口的网格
-    std::thread junction_thread(&Map::GenerateJunctions, this, mesh_factory, params,
-                                 minpos, maxpos, &junction_out_mesh_list);
 
-    // 根据位置过滤需要生成的道路ID
+    // 根据位置过滤需要生成的道路和交叉口
     const std::vector<RoadId> RoadsIDToGenerate = FilterRoadsByPosition(minpos, maxpos);
-
-    size_t num_roads = RoadsIDToGenerate.size(); // 获取需要生成的道路数量
-    size_t num_roads_per_thread = 30; // 每个线程处理的道路数量
-    size_t num_threads = (num_roads / num_roads_per_thread) + 1; // 计算所需线程数
-    num_threads = num_threads > 1 ? num_threads : 1; // 确保至少有一个线程
-    std::vector<std::thread> workers; // 存储工作线程
-    std::mutex write_mutex; // 互斥量，用于保护写操作
-    std::cout << "Generating " << std::to_string(num_roads) << " roads" << std::endl; // 输出生成道路数量
-
-    for (size_t i = 0; i < num_threads; ++i) { // 为每个线程创建工作任务
-        std::thread new_worker(
-            [this, &write_mutex, &mesh_factory, &RoadsIDToGenerate, &road_out_mesh_list, i, num_roads_per_thread]() {
-                // 生成当前线程的道路网格
-                std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>> Current =
-                    std::move(GenerateRoadsMultithreaded(mesh_factory, RoadsIDToGenerate, i, num_roads_per_thread));
-                
-                std::lock_guard<std::mutex> guard(write_mutex); // 锁住互斥量以进行安全写入
-                
-                for (auto&& pair : Current) { // 遍历当前线程生成的网格
-                    if (road_out_mesh_list.find(pair.first) != road_out_mesh_list.end()) { // 检查类型是否已存在
-                        // 如果已存在，合并网格
-                        road_out_mesh_list[pair.first].insert(road_out_mesh_list[pair.first].end(),
-                                                              std::make_move_iterator(pair.second.begin()),
-                                                              std::make_move_iterator(pair.second.end()));
-                    } else {
-                        // 如果不存在，直接添加
-                        road_out_mesh_list[pair.first] = std::move(pair.second);
-                    }
-                }
-            });
-        workers.push_back(std::move(new_worker)); // 将新线程添加到工作线程列表中
-    }
-
-    for (size_t i = 0; i < workers.size(); ++i) { // 等待所有工作线程完成
-        workers[i].join(); // 加入线程
-    }
-    workers.clear(); // 清空工作线程列表
-    for (size_t i = 0; i < workers.size(); ++i) { // 再次检查线程并确保它们已加入
-        if (workers[i].joinable()) {
-            workers[i].join(); // 如果可加入则加入
+    const std::vector<JuncId> JunctionsToGenerate = FilterJunctionsByPosition(minpos, maxpos);
+    const size_t num_roads = RoadsIDToGenerate.size(); // 获取需要生成的道路数量
+    const size_t num_junctions = JunctionsToGenerate.size(); // 获取需要生成的交叉口数量
+    std::cout << "Generating " << std::to_string(num_roads) << " roads and "
+              << std::to_string(num_junctions) << " junctions" << std::endl;
+
+    // 每条道路和每个交叉口都是一个任务，写入各自的输出，不需要加锁。
+    // 交叉口的 SDF 网格耗时远多于道路，排在前面先领取
+    std::vector<MeshesByType> task_meshes(num_junctions + num_roads);
+    RunTasksInParallel(task_meshes.size(), [&](const size_t i) {
+      if (i < num_junctions) {
+        GenerateSingleJunction(mesh_factory, JunctionsToGenerate[i], &task_meshes[i]); // 生成单个交叉口
+      } else {
+        const auto &road = _data.GetRoads().at(RoadsIDToGenerate[i - num_junctions]); // 获取当前道路对象
+        if (!road.IsJunction()) { // 如果当前道路不是交叉口
+          mesh_factory.GenerateAllOrderedWithMaxLen(road, task_meshes[i]); // 生成该道路的所有网格
         }
+      }
+    });
+
+    // 按道路、交叉口的顺序合并各任务的输出
+    MeshesByType road_out_mesh_list;
+    auto merge = [&](MeshesByType &meshes) {
+      for (auto &&pair : meshes) {
+        auto &out = road_out_mesh_list[pair.first];
+        out.insert(
+            out.end(),
+            std::make_move_iterator(pair.second.begin()),
+            std::make_move_iterator(pair.second.end()));
+      }
+    };
+    for (size_t i = num_junctions; i < task_meshes.size(); ++i) {
+      merge(task_meshes[i]);
     }
-
-    junction_thread.join(); // 等待交叉口生成线程完成
-    for (auto&& pair : junction_out_mesh_list) { // 遍历交叉口生成的网格
-        if (road_out_mesh_list.find(pair.first) != road_out_mesh_list.end()) { // 检查类型是否已存在
-            // 如果已存在，合并交叉口网格
-            road_out_mesh_list[pair.first].insert(road_out_mesh_list[pair.first].end(),
-                                                  std::make_move_iterator(pair.second.begin()),
-                                                  std::make_move_iterator(pair.second.end()));
-        } else {
-            // 如果不存在，直接添加
-            road_out_mesh_list[pair.first] = std::move(pair.second);
-        }
+    for (size_t i = 0u; i < num_junctions; ++i) {
+      merge(task_meshes[i]);
     }
     std::cout << "Generated " << std::to_string(num_roads) << " roads" << std::endl; // 输出生成完成的信息
 
@@ -1353,90 +1824,6 @@ std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateLineMarkings(
       geom::deformation::GetBumpDeformation(posx,posy);   // 添加隆起变形的值
   }
 
-  std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>>
-      Map::GenerateRoadsMultithreaded( const carla::geom::MeshFactory& mesh_factory,   // 定义生成道路的多线程函数
-                                        const std::vector<RoadId>& RoadsId,   // 输入的道路ID向量
-                                        const size_t index, const size_t number_of_roads_per_thread) const
-  {
-    std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>> out;   // 输出的道路网格
-
-    size_t start = index * number_of_roads_per_thread;  // 计算当前线程的起始索引
-    size_t endoffset = (index+1) * number_of_roads_per_thread;  // 计算当前线程的结束索引
-    size_t end = RoadsId.size();  // 获取道路ID的总数
-
-    for (int i = start; i < endoffset && i < end; ++i) {   // 遍历当前线程负责的道路
-      const auto& road = _data.GetRoads().at(RoadsId[i]);  // 获取当前道路对象
-      if (!road.IsJunction()) {   // 如果当前道路不是交叉口
-        mesh_factory.GenerateAllOrderedWithMaxLen(road, out);   // 生成该道路的所有网格
-      }
-    }
-    std::cout << "Generated roads from " + std::to_string(index * number_of_roads_per_thread) + " to " + std::to_string((index+1) * number_of_roads_per_thread ) << std::endl;   // 输出生成的道路范围
-    return out;   // 返回生成的道路网格
-  }
-
- void Map::GenerateJunctions(const carla::geom::MeshFactory& mesh_factory, // 生成交叉口的函数，接受网格工厂参数
-    const rpc::OpendriveGenerationParameters& params, // Opendrive生成参数
-    const geom::Vector3D& minpos, // 最小位置
-    const geom::Vector3D& maxpos, // 最大位置
-    std::map<road::Lane::LaneType, // 输出的交叉口网格列表
-    std::vector<std::unique_ptr<geom::Mesh>>>* junction_out_mesh_list) const {
-
-    std::vector<JuncId> JunctionsToGenerate = FilterJunctionsByPosition(minpos, maxpos); // 根据位置过滤交叉口
-    size_t num_junctions = JunctionsToGenerate.size(); // 交叉口数量
-    std::cout << "Generating " << std::to_string(num_junctions) << " junctions" << std::endl; // 输出生成的交叉口数
-    size_t junctionindex = 0; // 交叉口索引初始化
-    size_t num_junctions_per_thread = 5; // 每个线程处理的交叉口数量
-    size_t num_threads = (num_junctions / num_junctions_per_thread) + 1; // 计算线程数
-    num_threads = num_threads > 1 ? num_threads : 1; // 至少一个线程
-    std::vector<std::thread> workers; // 线程列表
-    std::mutex write_mutex; // 互斥锁用于保护共享资源
-
-    for ( size_t i = 0; i < num_threads; ++i ) { // 创建并启动多个线程
-      std::thread neworker(
-        [this, &write_mutex, &mesh_factory, &junction_out_mesh_list, JunctionsToGenerate, i, num_junctions_per_thread, num_junctions]() {
-        std::map<road::Lane::LaneType, // 本线程内的交叉口列表
-          std::vector<std::unique_ptr<geom::Mesh>>> junctionsofthisthread;
-
-        size_t minimum = 0; // 初始化最小值
-        if( (i + 1) * num_junctions_per_thread < num_junctions ){ // 如果还有交叉口需要处理
-          minimum = (i + 1) * num_junctions_per_thread; // 更新最小值
-        }else{
-          minimum = num_junctions; // 否则设置为总数量
-        }
-        std::cout << "Generating Junctions between  " << std::to_string(i * num_junctions_per_thread) << " and " << std::to_string(minimum) << std::endl; // 输出当前线程处理的交叉口范围
-
-        for ( size_t junctionindex = i * num_junctions_per_thread; // 遍历本线程处理的交叉口
-                        junctionindex < minimum;
-                        ++junctionindex )
-        {
-          GenerateSingleJunction(mesh_factory, JunctionsToGenerate[junctionindex], &junctionsofthisthread); // 生成单个交叉口
-        }
-        std::cout << "Generated Junctions between  " << std::to_string(i * num_junctions_per_thread) << " and " << std::to_string(minimum) << std::endl; // 输出完成的交叉口范围
-        std::lock_guard<std::mutex> guard(write_mutex); // 保护对共享数据的写操作
-        for ( auto&& pair : junctionsofthisthread ) { // 遍历本线程生成的交叉口
-          if ((*junction_out_mesh_list).find(pair.first) != (*junction_out_mesh_list).end()) { // 如果该类型的交叉口已存在
-            (*junction_out_mesh_list)[pair.first].insert((*junction_out_mesh_list)[pair.first].end(),
-              std::make_move_iterator(pair.second.begin()), // 插入新的交叉口网格
-              std::make_move_iterator(pair.second.end()));
-          } else {
-            (*junction_out_mesh_list)[pair.first] = std::move(pair.second); // 否则直接移动到输出列表
-          }
-        }
-      });
-      workers.push_back(std::move(neworker)); // 将新线程添加到线程列表
-    }
-
-    for (size_t i = 0; i < workers.size(); ++i) { // 等待所有线程完成
-      workers[i].join();
-    }
-    workers.clear(); // 清空线程列表
-    for (size_t i = 0; i < workers.size(); ++i) { // 检查并确保所有线程已加入
-      if (workers[i].joinable()) {
-        workers[i].join();
-      }
-    }
-  }
-
   std::vector<JuncId> Map::FilterJunctionsByPosition( const geom::Vector3D& minpos, // 根据位置过滤交叉口的函数
     const geom::Vector3D& maxpos ) const {
 
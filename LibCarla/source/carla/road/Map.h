@@ -9,10 +9,12 @@
 #include "carla/geom/Mesh.h" // 包含Mesh类的定义
 #include "carla/geom/Rtree.h" // 包含R树类的定义
 #include "carla/geom/Transform.h" // 包含Transform类的定义
+#include "carla/LruCache.h" // 包含LRU缓存类的定义
 #include "carla/NonCopyable.h" // 包含不可复制类的定义
 #include "carla/road/element/LaneMarking.h" // 包含车道标记类的定义
 #include "carla/road/element/RoadInfoMarkRecord.h" // 包含道路信息标记记录类的定义
 #include "carla/road/element/Waypoint.h" // 包含路径点类的定义
+#include "carla/road/LaneGraph.h" // 包含车道连接图类的定义
 #include "carla/road/MapData.h" // 包含地图数据类的定义
 #include "carla/road/RoadTypes.h" // 包含道路类型的定义
 #include "carla/road/MeshFactory.h" // 包含网格工厂类的定义
@@ -21,6 +23,10 @@
 
 #include <boost/optional.hpp> // 包含可选类型的定义
 
+#include <cstdint> // 包含固定宽度整数的定义
+#include <memory> // 包含智能指针的定义
+#include <mutex> // 包含互斥锁的定义
+#include <string> // 包含字符串的定义
 #include <vector> // 包含向量类的定义
 
 namespace carla {
@@ -35,10 +41,34 @@ namespace road {
     /// -- Constructor ---------------------------------------------------------
     /// ========================================================================
 
-    Map(MapData m) : _data(std::move(m)) { // 构造函数，初始化_map数据
+    Map(MapData m)
+      : _data(std::move(m)), // 构造函数，初始化_map数据
+        _path_cache(new PathCache(DEFAULT_PATH_CACHE_CAPACITY)) {
+      CreateLaneGraph(); // 创建车道连接图，生成R树时就会用到
       CreateRtree(); // 创建R树
     }
 
+    /// 与上面相同，但优先从 @a cache_filename 读取预先生成的R树。缓存不存在、
+    /// 版本不同或者不是由同一个 OpenDRIVE 文件（@a opendrive_checksum，见
+    /// cache::Checksum）生成时，重新生成R树并写入缓存。
+    Map(MapData m, const std::string &cache_filename, uint64_t opendrive_checksum)
+      : _data(std::move(m)),
+        _path_cache(new PathCache(DEFAULT_PATH_CACHE_CAPACITY)) {
+      CreateLaneGraph();
+      if (!LoadCache(cache_filename, opendrive_checksum)) {
+        CreateRtree();
+        SaveCache(cache_filename, opendrive_checksum);
+      }
+    }
+
+    /// ========================================================================
+    /// -- Cache ---------------------------------------------------------------
+    /// ========================================================================
+
+    /// 将R树写入 @a filename（格式见 MapCache.h），先写入临时文件再重命名，
+    /// 多个进程同时写入同一个缓存也不会留下不完整的文件。失败时返回 false。
+    bool SaveCache(const std::string &filename, uint64_t opendrive_checksum) const;
+
     /// ========================================================================
     /// -- Georeference --------------------------------------------------------
     /// ========================================================================
@@ -59,6 +89,24 @@ namespace road {
         const geom::Location &location, // 输入位置
         int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving)) const; // 默认车道类型为驾驶车道
 
+    /// GetClosestWaypointOnRoad 的批量版本，结果与 @a locations 一一对应。
+    ///
+    /// 查询先按空间位置（Z 序曲线）排序，使相邻查询访问 R 树的相同节点；
+    /// 每个线程处理排序后连续的一段，并重复使用同一个查询缓冲区。
+    /// 查询数量较少时在调用线程中完成。并行查询使用所有地图共用的线程池，
+    /// @a number_of_threads 为0时使用硬件并发线程数，且不会超过这个数量。
+    std::vector<boost::optional<element::Waypoint>> GetClosestWaypointsOnRoad(
+        const std::vector<geom::Location> &locations,
+        int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving),
+        size_t number_of_threads = 0u) const;
+
+    /// GetWaypoint 的批量版本，与 GetClosestWaypointsOnRoad 相同，
+    /// 但位置不在车道内时对应的结果为空。
+    std::vector<boost::optional<element::Waypoint>> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving),
+        size_t number_of_threads = 0u) const;
+
     boost::optional<element::Waypoint> GetWaypoint( // 根据道路ID和车道ID获取路径点
         RoadId road_id, // 道路ID
         LaneId lane_id, // 车道ID
@@ -122,6 +170,10 @@ namespace road {
     /// 使得车辆可以反向驶向这些路点。
     std::vector<Waypoint> GetPrevious(Waypoint waypoint, double distance) const; // 获取上一个路点
 
+    /// 设置 GetNext/GetPrevious 跨越车道末端时的结果缓存容量（条目数），
+    /// 0 表示不使用缓存。缓存由互斥锁保护，可以在多个线程中同时查询。
+    void SetPathCacheCapacity(size_t capacity);
+
     /// 返回 @a waypoint 右侧车道的路点。
     boost::optional<Waypoint> GetRight(Waypoint waypoint) const; // 获取右侧路点
 
@@ -211,6 +263,70 @@ private:
 
     void CreateRtree();  // 创建R树
 
+    /// 从缓存文件读取R树，文件无效或者已过期时返回 false
+    bool LoadCache(const std::string &filename, uint64_t opendrive_checksum);
+
+    /// 从映射到内存的缓存内容读取R树
+    bool LoadCache(const uint8_t *data, size_t size, uint64_t opendrive_checksum);
+
+    /// 默认缓存的 GetNext/GetPrevious 结果数量
+    static constexpr size_t DEFAULT_PATH_CACHE_CAPACITY = 4096u;
+
+    /// 车道连接图，由构造函数从 _data 生成
+    LaneGraph _lane_graph;
+
+    /// GetNext/GetPrevious 结果缓存的键，路点的 s 按精确值比较
+    struct PathCacheKey {
+      Waypoint waypoint;
+      double distance;
+      bool next;
+    };
+
+    struct PathCacheKeyHash {
+      size_t operator()(const PathCacheKey &key) const;
+    };
+
+    struct PathCacheKeyEqual {
+      bool operator()(const PathCacheKey &lhs, const PathCacheKey &rhs) const;
+    };
+
+    /// 缓存和保护它的互斥锁，放在堆上以保持 Map 可移动
+    struct PathCache {
+      explicit PathCache(size_t capacity) : cache(capacity) {}
+      std::mutex mutex;
+      LruCache<PathCacheKey, std::vector<Waypoint>, PathCacheKeyHash, PathCacheKeyEqual> cache;
+    };
+
+    std::unique_ptr<PathCache> _path_cache;
+
+    void CreateLaneGraph();  // 创建车道连接图
+
+    /// 返回路点所在车道在连接图中的节点，车道不存在时抛出异常
+    LaneGraph::NodeId GetLaneGraphNode(Waypoint waypoint) const;
+
+    /// 沿车道连接图前进（@a next 为 true）或后退 @a distance，
+    /// 把到达的路点追加到 @a result
+    void AppendPath(
+        LaneGraph::NodeId node_id,
+        Waypoint waypoint,
+        double distance,
+        bool next,
+        std::vector<Waypoint> &result) const;
+
+    /// GetNext 和 GetPrevious 的共同实现
+    std::vector<Waypoint> GetPath(Waypoint waypoint, double distance, bool next) const;
+
+    /// 使用 @a query_result 作为查询缓冲区查找道路上最近的路点
+    boost::optional<Waypoint> FindClosestWaypointOnRoad(
+        const geom::Location &location,
+        int32_t lane_type,
+        std::vector<Rtree::TreeElement> &query_result) const;
+
+    /// 位置 @a location 在路点 @a waypoint 所在车道内时返回该路点，否则返回空
+    boost::optional<Waypoint> FilterByLaneWidth(
+        const geom::Location &location,
+        boost::optional<Waypoint> waypoint) const;
+
     // 辅助函数，用于构造R树元素列表
     void AddElementToRtree(  // 将元素添加到R树
         std::vector<Rtree::TreeElement> &rtree_elements,  // R树元素列表
@@ -228,19 +344,6 @@ private:
 public:
     inline float GetZPosInDeformation(float posx, float posy) const;  // 获取变形中的Z轴位置
 
-    std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>>  // 多线程生成道路网格
-      GenerateRoadsMultithreaded( const carla::geom::MeshFactory& mesh_factory,  // 网格工厂
-        const std::vector<RoadId>& RoadsID,  // 道路ID列表
-        const size_t index,  // 当前索引
-        const size_t number_of_roads_per_thread) const;  // 每个线程的道路数量
-
-    void GenerateJunctions(const carla::geom::MeshFactory& mesh_factory,  // 生成交叉口
-      const rpc::OpendriveGenerationParameters& params,  // OpenDRIVE生成参数
-      const geom::Vector3D& minpos,  // 最小位置
-      const geom::Vector3D& maxpos,  // 最大位置
-      std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>>*  // 输出交叉口网格列表
-      juntion_out_mesh_list) const;
-
     void GenerateSingleJunction(const carla::geom::MeshFactory& mesh_factory,  // 生成单个交叉口
       const JuncId Id,  // 交叉口ID
       std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>>*  // 输出交叉口网格列表
@@ -7,6 +7,7 @@
 #include "carla/StringUtil.h" // 引入字符串工具库
 #include "carla/road/MapBuilder.h" // 引入地图构建器
 #include "carla/road/element/RoadInfoElevation.h" // 引入道路高度信息类
+#include "carla/road/element/RoadInfoIterator.h" // 引入道路信息迭代器
 #include "carla/road/element/RoadInfoGeometry.h" // 引入道路几何信息类
 #include "carla/road/element/RoadInfoLaneAccess.h" // 引入车道访问信息类
 #include "carla/road/element/RoadInfoLaneBorder.h" // 引入车道边界信息类
@@ -36,6 +37,10 @@ namespace carla {
 namespace road {
 
   boost::optional<Map> MapBuilder::Build() {
+    return Build(std::string(), 0u);
+  }
+
+  boost::optional<Map> MapBuilder::Build(const std::string &cache_filename, uint64_t opendrive_checksum) {
 
     CreatePointersBetweenRoadSegments(); // 创建路段之间的指针
     RemoveZeroLaneValiditySignalReferences(); // 移除无效车道信号引用
@@ -62,7 +67,9 @@ namespace road {
     // _map_data is a member of MapBuilder so you must especify if
     // you want to keep it (will return copy -> Map(const Map &))
     // or move it (will return move -> Map(Map &&))
-    Map map(std::move(_map_data)); // 移动并创建地图对象
+    Map map = cache_filename.empty() ?
+        Map(std::move(_map_data)) : // 移动并创建地图对象
+        Map(std::move(_map_data), cache_filename, opendrive_checksum); // 使用缓存的R树
     CreateJunctionBoundingBoxes(map); // 创建交叉口的边界框
     ComputeJunctionRoadConflicts(map); // 计算交叉口道路冲突
     CheckSignalsOnRoads(map); // 检查道路上的信号
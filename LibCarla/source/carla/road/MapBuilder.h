@@ -22,6 +22,10 @@ namespace road {
 
     boost::optional<Map> Build(); // 构建地图并返回一个可选的地图对象
 
+    /// 与 Build() 相同，但R树从 @a cache_filename 读取，缓存无效时重新生成并
+    /// 写入该文件，见 Map 的对应构造函数。
+    boost::optional<Map> Build(const std::string &cache_filename, uint64_t opendrive_checksum);
+
     // 从道路解析器调用
     carla::road::Road *AddRoad(
         const RoadId road_id, // 道路ID
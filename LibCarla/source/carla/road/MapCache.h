@@ -0,0 +1,96 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace carla {
+namespace road {
+namespace cache {
+
+  /// road::Map 二进制缓存的文件格式。
+  ///
+  /// 缓存保存 Map::CreateRtree 生成的全部线段。生成这些线段需要沿每条车道
+  /// 反复计算路点变换，是加载大地图时最耗时的部分；道路、车道和交叉口本身
+  /// 仍然由 OpenDRIVE 生成。文件可以整体映射到内存后直接读取：
+  ///
+  ///   Header
+  ///   SegmentRecord     segments[number_of_segments]
+  ///
+  /// 数组起始位置对齐到 ALIGNMENT 字节。
+
+  /// 文件开头的魔数。
+  static constexpr char MAGIC[8] = {'C', 'A', 'R', 'L', 'A', 'R', 'D', '\0'};
+
+  /// 格式版本，布局或者线段的生成方式改变时必须增加。
+  static constexpr uint32_t VERSION = 1u;
+
+  /// 数组起始位置的对齐字节数。
+  static constexpr size_t ALIGNMENT = 8u;
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    /// sizeof(Header)，用于检测不同平台的结构体布局差异。
+    uint32_t header_size;
+    /// sizeof(SegmentRecord)。
+    uint32_t record_size;
+    uint32_t number_of_segments;
+    /// 生成缓存时所用 OpenDRIVE 文件的校验和。
+    uint64_t map_checksum;
+  };
+  static_assert(sizeof(Header) == 32u, "Unexpected cache header layout");
+
+  struct WaypointRecord {
+    double s;
+    uint32_t road_id;
+    uint32_t section_id;
+    int32_t lane_id;
+    uint32_t padding;
+  };
+  static_assert(sizeof(WaypointRecord) == 24u, "Unexpected cache waypoint layout");
+
+  struct SegmentRecord {
+    /// 线段起点和终点的位置。
+    float start[3];
+    float end[3];
+    /// 线段两端对应的路点。
+    WaypointRecord start_waypoint;
+    WaypointRecord end_waypoint;
+  };
+  static_assert(sizeof(SegmentRecord) == 72u, "Unexpected cache record layout");
+
+  /// 将 @a offset 向上对齐到 ALIGNMENT。
+  inline size_t Align(size_t offset) {
+    return (offset + ALIGNMENT - 1u) & ~(ALIGNMENT - 1u);
+  }
+
+  /// OpenDRIVE 内容的 64 位校验和（FNV-1a，按8字节分块以便快速处理大文件），
+  /// 在所有小端平台上结果相同。
+  inline uint64_t Checksum(const std::string &content) {
+    constexpr uint64_t prime = 1099511628211ull;
+    uint64_t hash = 14695981039346656037ull;
+    const char *data = content.data();
+    const size_t size = content.size();
+    size_t i = 0u;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+      uint64_t word;
+      std::memcpy(&word, data + i, sizeof(word));
+      hash = (hash ^ word) * prime;
+    }
+    for (; i < size; ++i) {
+      hash = (hash ^ static_cast<uint8_t>(data[i])) * prime;
+    }
+    return hash ^ static_cast<uint64_t>(size);
+  }
+
+} // namespace cache
+} // namespace road
+} // namespace carla
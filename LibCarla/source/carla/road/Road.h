@@ -108,7 +108,7 @@ namespace road {
       }
 
       template <typename T>
-      std::vector<const T*> GetInfos() const { // 模板函数，获取所有信息的常量指针
+      InformationSet::InfoList<T> GetInfos() const { // 模板函数，获取所有信息的常量指针
           return _info.GetInfos<T>();
       }
       template <typename T>
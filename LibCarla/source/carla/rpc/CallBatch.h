@@ -0,0 +1,125 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/MsgPackAdaptors.h"
+#include "carla/NonCopyable.h"
+#include "carla/rpc/Response.h"
+
+#include <exception>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// 服务器上用于执行批量调用的函数名
+  constexpr const char *BATCH_FUNCTION_NAME = "call_batch";
+
+  /// 批量请求中的一个调用，参数以 msgpack 数组的形式打包
+  struct BatchCall {
+    std::string function;
+
+    std::vector<char> arguments;
+
+    MSGPACK_DEFINE_ARRAY(function, arguments)
+  };
+
+  /// 批量请求中一个调用的结果，与请求中的调用一一对应
+  struct BatchResult {
+    /// 打包后的返回值
+    std::vector<char> data;
+
+    /// 调用失败时（函数不存在、参数不匹配或抛出异常）的错误信息
+    boost::optional<ResponseError> error;
+
+    MSGPACK_DEFINE_ARRAY(data, error)
+  };
+
+  /// 在客户端收集多个 RPC 调用，由 Client::call_batch 在一个请求中发送。
+  ///
+  /// 服务器在游戏线程上按添加的顺序依次执行这些调用，并在一个响应中返回
+  /// 所有结果，因此 N 个调用只需要一次网络往返和一次游戏线程调度。
+  class CallBatch : private MovableNonCopyable {
+  public:
+
+    /// 添加一个调用。返回的 future 在批量请求发送并收到响应后就绪，
+    /// 如果该调用失败或者请求没有发送，则 future 中保存对应的异常。
+    template <typename... Args>
+    std::future<clmdep_msgpack::object_handle> Add(const std::string &function, Args &&... args) {
+      clmdep_msgpack::sbuffer buffer;
+      clmdep_msgpack::pack(buffer, std::make_tuple(std::forward<Args>(args)...));
+      _calls.push_back(BatchCall{function, std::vector<char>(buffer.data(), buffer.data() + buffer.size())});
+      _promises.emplace_back();
+      return _promises.back().get_future();
+    }
+
+    size_t size() const {
+      return _calls.size();
+    }
+
+    bool empty() const {
+      return _calls.empty();
+    }
+
+    /// 取出所有待发送的调用，之后可以继续向批量中添加新的调用
+    std::vector<BatchCall> TakeCalls() {
+      std::vector<BatchCall> calls;
+      calls.swap(_calls);
+      return calls;
+    }
+
+    /// 用服务器返回的结果完成已取出的调用，结果的顺序与调用的顺序相同
+    void SetResults(const std::vector<BatchResult> &results) {
+      auto promises = TakePromises();
+      for (size_t i = 0u; i < promises.size(); ++i) {
+        auto &promise = promises[i];
+        if (i >= results.size()) {
+          promise.set_exception(std::make_exception_ptr(
+              std::runtime_error("rpc batch: missing result")));
+        } else if (results[i].error.has_value()) {
+          promise.set_exception(std::make_exception_ptr(
+              std::runtime_error(results[i].error->What())));
+        } else {
+          const auto &data = results[i].data;
+          promise.set_value(clmdep_msgpack::unpack(data.data(), data.size()));
+        }
+      }
+    }
+
+    /// 请求失败时，所有已取出的调用都收到同一个异常
+    void SetException(std::exception_ptr exception) {
+      for (auto &promise : TakePromises()) {
+        promise.set_exception(exception);
+      }
+    }
+
+  private:
+
+    std::vector<std::promise<clmdep_msgpack::object_handle>> TakePromises() {
+      // 只取出已经随 TakeCalls 发送的调用对应的 promise。
+      const size_t sent = _promises.size() - _calls.size();
+      std::vector<std::promise<clmdep_msgpack::object_handle>> promises;
+      promises.reserve(sent);
+      for (size_t i = 0u; i < sent; ++i) {
+        promises.emplace_back(std::move(_promises[i]));
+      }
+      _promises.erase(_promises.begin(), _promises.begin() + static_cast<std::ptrdiff_t>(sent));
+      return promises;
+    }
+
+    std::vector<BatchCall> _calls;
+
+    std::vector<std::promise<clmdep_msgpack::object_handle>> _promises;
+  };
+
+} // namespace rpc
+} // namespace carla
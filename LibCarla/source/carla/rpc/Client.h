@@ -13,6 +13,9 @@
 // 可能在后续的远程过程调用（RPC）操作中用于传递额外的描述信息、控制调用行为等。
 #include "carla/rpc/Metadata.h"
 
+// 批量调用的请求和结果类型
+#include "carla/rpc/CallBatch.h"
+
 // 包含 <rpc/client.h> 头文件，应该是引入了一个基础的RPC客户端相关的库，
 // 提供了诸如建立连接、发送请求、接收响应等与远程服务交互的底层功能。
 #include <rpc/client.h>
@@ -70,6 +73,24 @@ namespace carla {
                 _client.async_call(function, Metadata::MakeAsync(), std::forward<Args>(args)...);
             }
 
+            // 把批量中的所有调用放在一个请求中发送，并等待服务器返回全部结果。
+            // 每个调用的结果（或错误）通过 CallBatch::Add 返回的 future 获取；
+            // 请求本身失败（例如超时）时，所有 future 都收到同一个异常，并且异常会继续抛出。
+            void call_batch(CallBatch &batch) {
+                if (batch.empty()) {
+                    return;
+                }
+                auto calls = batch.TakeCalls();
+                try {
+                    auto results = _client.call(BATCH_FUNCTION_NAME, Metadata::MakeSync(), calls)
+                        .as<std::vector<BatchResult>>();
+                    batch.SetResults(results);
+                } catch (...) {
+                    batch.SetException(std::current_exception());
+                    throw;
+                }
+            }
+
         private:
             // 定义了一个私有成员变量 _client，类型为 ::rpc::client，
             // 它是底层实际用于和远程服务进行交互的RPC客户端对象，
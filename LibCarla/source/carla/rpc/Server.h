@@ -8,6 +8,7 @@
 
 #include "carla/MoveHandler.h"  // 包含处理移动的头文件
 #include "carla/Time.h"         // 包含时间相关的头文件
+#include "carla/rpc/CallBatch.h" // 包含批量调用相关的头文件
 #include "carla/rpc/Metadata.h" // 包含元数据相关的头文件
 #include "carla/rpc/Response.h" // 包含响应相关的头文件
 
@@ -16,7 +17,14 @@
 
 #include <rpc/server.h>               // 包含RPC服务器的头文件
 
+#include <functional>
 #include <future>                     // 包含future库，用于异步编程
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace carla {
 namespace rpc {
@@ -67,8 +75,22 @@ namespace rpc {
       _server.stop(); // 停止服务器
     }
 
+    /// 在当前线程上按顺序执行批量请求中的调用，每个调用的错误单独返回，
+    /// 不影响后面的调用。
+    ///
+    /// 函数不存在以及参数不是个数正确的数组时，在调用之前就返回该调用的错误。
+    /// @warning 定义了 LIBCARLA_NO_EXCEPTIONS 时（例如在 UE4 中）无法捕获
+    /// 单个调用抛出的异常，函数本身或参数类型转换出错会使整个批量请求失败。
+    std::vector<BatchResult> DispatchBatch(const std::vector<BatchCall> &calls) const;
+
   private:
 
+    /// 参数不是个数正确的数组时返回 false，不调用函数
+    using BatchFunction = std::function<bool(const clmdep_msgpack::object &, clmdep_msgpack::sbuffer &)>;
+
+    /// 所有绑定的函数，供批量调用使用。需要在服务器开始运行之前绑定完毕。
+    std::unordered_map<std::string, BatchFunction> _batch_functions;
+
     boost::asio::io_context _sync_io_context; // 同步IO上下文
 
     ::rpc::server _server; // RPC服务器实例
@@ -144,6 +166,47 @@ static auto WrapAsyncCall(FuncT &&functor) {
     }
   };
 }
+
+    /// 包装为批量调用使用的函数：从 msgpack 数组中解出参数，调用后把返回值打包。
+    /// 先检查参数个数，禁用异常时参数不匹配也只让这一个调用失败
+    template <typename FuncT>
+    static auto WrapBatchCall(FuncT &&functor) {
+      return [functor=std::forward<FuncT>(functor)](
+          const clmdep_msgpack::object &arguments,
+          clmdep_msgpack::sbuffer &result) {
+        if ((arguments.type != clmdep_msgpack::type::ARRAY) ||
+            (arguments.via.array.size != sizeof...(Args))) {
+          return false;
+        }
+        std::tuple<std::decay_t<Args>...> args;
+        arguments.convert(args);
+        CallAndPack(functor, args, result, std::index_sequence_for<Args...>(), std::is_void<R>());
+        return true;
+      };
+    }
+
+  private:
+
+    template <typename FuncT, typename TupleT, size_t... Is>
+    static void CallAndPack(
+        const FuncT &functor,
+        TupleT &args,
+        clmdep_msgpack::sbuffer &result,
+        std::index_sequence<Is...>,
+        std::false_type) {
+      clmdep_msgpack::pack(result, functor(std::get<Is>(args)...));
+    }
+
+    template <typename FuncT, typename TupleT, size_t... Is>
+    static void CallAndPack(
+        const FuncT &functor,
+        TupleT &args,
+        clmdep_msgpack::sbuffer &result,
+        std::index_sequence<Is...>,
+        std::true_type) {
+      functor(std::get<Is>(args)...);
+      clmdep_msgpack::packer<clmdep_msgpack::sbuffer>(result).pack_nil();
+    }
 };
 
 } // namespace detail
@@ -153,12 +216,19 @@ template <typename ... Args>
 inline Server::Server(Args && ... args)
   : _server(std::forward<Args>(args) ...) { // 初始化服务器
   _server.suppress_exceptions(true); // 抑制异常
+  // 批量调用作为一个同步函数绑定，整个批量在游戏线程上的一次调度中执行完。
+  auto dispatch = [this](const std::vector<BatchCall> &calls) {
+    return DispatchBatch(calls);
+  };
+  using Wrapper = detail::FunctionWrapper<decltype(dispatch)>;
+  _server.bind(BATCH_FUNCTION_NAME, Wrapper::WrapSyncCall(_sync_io_context, std::move(dispatch)));
 }
 
 // 绑定一个同步函数
 template <typename FunctorT>
 inline void Server::BindSync(const std::string &name, FunctorT &&functor) {
   using Wrapper = detail::FunctionWrapper<FunctorT>; // 使用函数包装器
+  _batch_functions[name] = Wrapper::WrapBatchCall(functor);
   _server.bind(
       name,
       Wrapper::WrapSyncCall(_sync_io_context, std::forward<FunctorT>(functor))); // 绑定同步函数
@@ -168,10 +238,40 @@ inline void Server::BindSync(const std::string &name, FunctorT &&functor) {
 template <typename FunctorT>
 inline void Server::BindAsync(const std::string &name, FunctorT &&functor) {
   using Wrapper = detail::FunctionWrapper<FunctorT>; // 使用函数包装器
+  _batch_functions[name] = Wrapper::WrapBatchCall(functor);
   _server.bind(
       name,
       Wrapper::WrapAsyncCall(std::forward<FunctorT>(functor))); // 绑定异步函数
 }
 
+inline std::vector<BatchResult> Server::DispatchBatch(const std::vector<BatchCall> &calls) const {
+  std::vector<BatchResult> results(calls.size());
+  for (size_t i = 0u; i < calls.size(); ++i) {
+    const auto &call = calls[i];
+    auto &result = results[i];
+    auto it = _batch_functions.find(call.function);
+    if (it == _batch_functions.end()) {
+      result.error = ResponseError("rpc batch: function not found: " + call.function);
+      continue;
+    }
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    try {
+#endif // LIBCARLA_NO_EXCEPTIONS
+      auto arguments = clmdep_msgpack::unpack(call.arguments.data(), call.arguments.size());
+      clmdep_msgpack::sbuffer buffer;
+      if (it->second(arguments.get(), buffer)) {
+        result.data.assign(buffer.data(), buffer.data() + buffer.size());
+      } else {
+        result.error = ResponseError("rpc batch: " + call.function + ": wrong number of arguments");
+      }
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    } catch (const std::exception &e) {
+      result.error = ResponseError("rpc batch: " + call.function + ": " + e.what());
+    }
+#endif // LIBCARLA_NO_EXCEPTIONS
+  }
+  return results;
+}
+
 } // namespace rpc
 } // namespace carla
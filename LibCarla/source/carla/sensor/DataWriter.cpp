@@ -0,0 +1,157 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/DataWriter.h"
+
+#include "carla/Logging.h"
+#include "carla/StopWatch.h"
+
+#include <algorithm>
+#include <exception>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+
+  constexpr size_t DataWriter::MAX_BATCH_SIZE;
+
+  static double ToSeconds(const StopWatch &watch) {
+    return static_cast<double>(watch.GetElapsedTime<std::chrono::microseconds>()) * 1e-6;
+  }
+
+  DataWriter::DataWriter(
+      size_t number_of_workers,
+      size_t queue_capacity,
+      OverflowPolicy policy)
+    : _number_of_workers(std::max<size_t>(number_of_workers, 1u)),
+      _queue_capacity(std::max<size_t>(queue_capacity, 1u)),
+      _policy(policy) {
+    _workers.CreateThreads(_number_of_workers, [this]() { WorkerLoop(); });
+  }
+
+  DataWriter::~DataWriter() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _jobs_available.notify_all();
+    _space_available.notify_all();
+    _workers.JoinAll();
+  }
+
+  bool DataWriter::Submit(Job job) {
+    Job dropped_job;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      if (_stop) {
+        ++_metrics.dropped;
+        return false;
+      }
+      if (_queue.size() >= _queue_capacity) {
+        switch (_policy) {
+          case OverflowPolicy::Block: {
+            StopWatch watch;
+            _space_available.wait(lock, [this]() {
+              return _stop || _queue.size() < _queue_capacity;
+            });
+            watch.Stop();
+            _metrics.blocked_seconds += ToSeconds(watch);
+            if (_stop) {
+              ++_metrics.dropped;
+              return false;
+            }
+            break;
+          }
+          case OverflowPolicy::DropNewest:
+            ++_metrics.dropped;
+            return false;
+          case OverflowPolicy::DropOldest:
+            // 在锁外销毁被丢弃的任务，它可能持有较大的传感器数据
+            dropped_job = std::move(_queue.front());
+            _queue.pop_front();
+            ++_metrics.dropped;
+            break;
+        }
+      }
+      _queue.emplace_back(std::move(job));
+      ++_metrics.submitted;
+      _metrics.max_queued = std::max(_metrics.max_queued, _queue.size());
+    }
+    _jobs_available.notify_one();
+    return true;
+  }
+
+  void DataWriter::Flush() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idle.wait(lock, [this]() { return _queue.empty() && _in_progress == 0u; });
+  }
+
+  DataWriterMetrics DataWriter::GetMetrics() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    DataWriterMetrics metrics = _metrics;
+    metrics.queued = _queue.size();
+    return metrics;
+  }
+
+  void DataWriter::WorkerLoop() {
+    std::vector<Job> batch;
+    batch.reserve(MAX_BATCH_SIZE);
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _jobs_available.wait(lock, [this]() { return _stop || !_queue.empty(); });
+        if (_queue.empty()) {
+          // 只有在停止并且队列已经清空时才退出
+          return;
+        }
+        // 队列较短时不要一次取走所有任务，让其他工作线程也能分到
+        const size_t count = std::min(
+            MAX_BATCH_SIZE,
+            std::max<size_t>(1u, _queue.size() / _number_of_workers));
+        for (size_t i = 0u; i < count; ++i) {
+          batch.emplace_back(std::move(_queue.front()));
+          _queue.pop_front();
+        }
+        _in_progress += count;
+      }
+      _space_available.notify_all();
+
+      size_t written = 0u;
+      size_t failed = 0u;
+      StopWatch watch;
+      for (auto &job : batch) {
+        try {
+          job();
+          ++written;
+        } catch (const std::exception &e) {
+          log_error("sensor data writer: job failed:", e.what());
+          ++failed;
+        } catch (...) {
+          log_error("sensor data writer: job failed with unknown exception");
+          ++failed;
+        }
+        job = nullptr;
+      }
+      watch.Stop();
+      batch.clear();
+
+      bool idle = false;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _metrics.written += written;
+        _metrics.failed += failed;
+        _metrics.write_seconds += ToSeconds(watch);
+        _in_progress -= written + failed;
+        idle = _queue.empty() && _in_progress == 0u;
+      }
+      if (idle) {
+        _idle.notify_all();
+      }
+    }
+  }
+
+} // namespace sensor
+} // namespace carla
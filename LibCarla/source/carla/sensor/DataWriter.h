@@ -0,0 +1,127 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/ThreadGroup.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace carla {
+namespace sensor {
+
+  /// DataWriter 的运行统计
+  struct DataWriterMetrics {
+    /// 接受的写任务数
+    size_t submitted = 0u;
+    /// 成功完成的写任务数
+    size_t written = 0u;
+    /// 抛出异常的写任务数
+    size_t failed = 0u;
+    /// 因队列已满被丢弃的写任务数
+    size_t dropped = 0u;
+    /// 当前排队等待的写任务数（不含正在执行的）
+    size_t queued = 0u;
+    /// 排队任务数的历史最大值
+    size_t max_queued = 0u;
+    /// 提交线程因队列已满而阻塞的总时间（秒）
+    double blocked_seconds = 0.0;
+    /// 工作线程执行写任务的总时间（秒）
+    double write_seconds = 0.0;
+  };
+
+  /// 在后台线程上执行写磁盘任务（编码图像、写点云等），避免阻塞传感器回调。
+  ///
+  /// 任务放入有界队列，由固定数量的工作线程成批取出执行。队列满时按
+  /// OverflowPolicy 处理：阻塞提交线程，或者丢弃任务，两种情况都会计入
+  /// DataWriterMetrics，用于观察写入速度是否跟得上数据产生的速度。
+  ///
+  /// 任务中抛出的异常会被记录并计为失败，不会终止工作线程。
+  class DataWriter : private NonCopyable {
+  public:
+
+    using Job = std::function<void()>;
+
+    enum class OverflowPolicy {
+      /// 阻塞提交线程，直到队列有空位
+      Block,
+      /// 丢弃新提交的任务
+      DropNewest,
+      /// 丢弃队列中最早的任务，为新任务腾出空位
+      DropOldest
+    };
+
+    DataWriter(
+        size_t number_of_workers,
+        size_t queue_capacity,
+        OverflowPolicy policy = OverflowPolicy::Block);
+
+    /// 执行完所有已提交的任务后停止工作线程
+    ~DataWriter();
+
+    /// 提交一个写任务，任务被丢弃时返回 false
+    bool Submit(Job job);
+
+    /// 等待所有已提交的任务执行完毕
+    void Flush();
+
+    DataWriterMetrics GetMetrics() const;
+
+    size_t GetNumberOfWorkers() const {
+      return _number_of_workers;
+    }
+
+    size_t GetQueueCapacity() const {
+      return _queue_capacity;
+    }
+
+    OverflowPolicy GetOverflowPolicy() const {
+      return _policy;
+    }
+
+    /// 每个工作线程一次最多取出的任务数
+    static constexpr size_t MAX_BATCH_SIZE = 8u;
+
+  private:
+
+    void WorkerLoop();
+
+    const size_t _number_of_workers;
+
+    const size_t _queue_capacity;
+
+    const OverflowPolicy _policy;
+
+    mutable std::mutex _mutex;
+
+    /// 队列非空或者需要停止
+    std::condition_variable _jobs_available;
+
+    /// 队列有空位
+    std::condition_variable _space_available;
+
+    /// 队列为空且没有正在执行的任务
+    std::condition_variable _idle;
+
+    std::deque<Job> _queue;
+
+    /// 已取出但尚未执行完的任务数
+    size_t _in_progress = 0u;
+
+    bool _stop = false;
+
+    DataWriterMetrics _metrics;
+
+    ThreadGroup _workers;
+  };
+
+} // namespace sensor
+} // namespace carla
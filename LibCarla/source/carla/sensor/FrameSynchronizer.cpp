@@ -0,0 +1,216 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/FrameSynchronizer.h"
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+
+#include <algorithm>
+#include <exception>
+#include <iterator>
+
+namespace carla {
+namespace sensor {
+
+  template <typename Duration>
+  static double ToSeconds(Duration duration) {
+    return std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+  }
+
+  FrameSynchronizer::State::State(
+      size_t number_of_sources,
+      time_duration timeout,
+      PartialBundlePolicy policy,
+      Callback callback,
+      size_t max_pending_frames)
+    : number_of_sources(number_of_sources),
+      timeout(timeout),
+      policy(policy),
+      max_pending_frames(std::max<size_t>(max_pending_frames, 1u)),
+      callback(std::move(callback)) {}
+
+  FrameSynchronizer::FrameSynchronizer(
+      size_t number_of_sources,
+      time_duration timeout,
+      PartialBundlePolicy policy,
+      Callback callback,
+      size_t max_pending_frames)
+    : _state(std::make_shared<State>(
+          number_of_sources,
+          timeout,
+          policy,
+          std::move(callback),
+          max_pending_frames)) {
+    DEBUG_ASSERT(_state->callback != nullptr);
+    // 线程持有状态的引用，不依赖 FrameSynchronizer 本身的生命周期
+    auto state = _state;
+    _thread = std::thread([state]() { DeliveryLoop(*state); });
+  }
+
+  FrameSynchronizer::~FrameSynchronizer() {
+    Stop();
+    if (_thread.joinable()) {
+      // 在回调中销毁时不能等待自己结束，线程持有的状态在它退出时释放
+      if (_thread.get_id() == std::this_thread::get_id()) {
+        _thread.detach();
+      } else {
+        _thread.join();
+      }
+    }
+  }
+
+  void FrameSynchronizer::Push(size_t source, SharedPtr<SensorData> data) {
+    if (data == nullptr) {
+      return;
+    }
+    State &state = *_state;
+    if (source >= state.number_of_sources) {
+      log_warning("frame synchronizer: invalid source", source);
+      return;
+    }
+    const auto now = clock::now();
+    const size_t frame = data->GetFrame();
+    // 在锁外销毁被丢弃的数据，它们可能很大
+    std::vector<SensorBundle> discarded;
+    {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      if (state.stop) {
+        return;
+      }
+      if (frame < state.next_frame) {
+        ++state.metrics.late_measurements;
+        return;
+      }
+      auto it = state.pending.find(frame);
+      if (it == state.pending.end()) {
+        it = state.pending.emplace(frame, PendingFrame{}).first;
+        auto &bundle = it->second.bundle;
+        bundle.frame = frame;
+        bundle.data.resize(state.number_of_sources);
+        bundle.missing = state.number_of_sources;
+        it->second.first_arrival = now;
+      }
+      auto &pending = it->second;
+      auto &slot = pending.bundle.data[source];
+      if (slot == nullptr) {
+        --pending.bundle.missing;
+      }
+      slot = std::move(data);
+      pending.last_arrival = now;
+      if (pending.bundle.IsComplete()) {
+        // 每个数据源都按顺序发送，更早的帧不会再收到数据
+        ResolveUntil(state, std::next(it), discarded);
+      }
+      while (state.pending.size() > state.max_pending_frames) {
+        ResolveUntil(state, std::next(state.pending.begin()), discarded);
+      }
+    }
+    state.condition.notify_one();
+  }
+
+  void FrameSynchronizer::Stop() {
+    PendingMap pending;
+    ReadyQueue ready;
+    {
+      std::lock_guard<std::mutex> lock(_state->mutex);
+      _state->stop = true;
+      pending.swap(_state->pending);
+      ready.swap(_state->ready);
+    }
+    _state->condition.notify_all();
+    if (_thread.joinable() && _thread.get_id() != std::this_thread::get_id()) {
+      _thread.join();
+    }
+  }
+
+  FrameSynchronizerMetrics FrameSynchronizer::GetMetrics() const {
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    FrameSynchronizerMetrics metrics = _state->metrics;
+    metrics.pending_frames = _state->pending.size();
+    return metrics;
+  }
+
+  void FrameSynchronizer::ResolveUntil(
+      State &state,
+      PendingMap::iterator end,
+      std::vector<SensorBundle> &discarded) {
+    for (auto it = state.pending.begin(); it != end; it = state.pending.erase(it)) {
+      auto &pending = it->second;
+      state.next_frame = it->first + 1u;
+      if (pending.bundle.IsComplete() || (state.policy == PartialBundlePolicy::Deliver)) {
+        state.ready.emplace_back(std::move(pending.bundle), pending.last_arrival);
+      } else {
+        ++state.metrics.dropped_bundles;
+        discarded.emplace_back(std::move(pending.bundle));
+      }
+    }
+  }
+
+  void FrameSynchronizer::DeliveryLoop(State &state) {
+    std::unique_lock<std::mutex> lock(state.mutex);
+    while (!state.stop) {
+      if (!state.ready.empty()) {
+        ReadyQueue ready;
+        ready.swap(state.ready);
+        lock.unlock();
+        for (auto &item : ready) {
+          const auto start = clock::now();
+          {
+            std::lock_guard<std::mutex> metrics_lock(state.mutex);
+            if (state.stop) {
+              break;
+            }
+            ++(item.first.IsComplete() ? state.metrics.complete_bundles : state.metrics.partial_bundles);
+            const double latency = ToSeconds(start - item.second);
+            state.metrics.total_latency_seconds += latency;
+            state.metrics.max_latency_seconds = std::max(state.metrics.max_latency_seconds, latency);
+          }
+          try {
+            state.callback(std::move(item.first));
+          } catch (const std::exception &e) {
+            log_error("frame synchronizer: callback failed:", e.what());
+          } catch (...) {
+            log_error("frame synchronizer: callback failed with unknown exception");
+          }
+          const double elapsed = ToSeconds(clock::now() - start);
+          std::lock_guard<std::mutex> metrics_lock(state.mutex);
+          state.metrics.callback_seconds += elapsed;
+        }
+        ready.clear();
+        lock.lock();
+        continue;
+      }
+      // 超时的帧连同更早的帧一起处理，保证按帧的顺序交付
+      const auto now = clock::now();
+      auto expired = state.pending.begin();
+      for (auto it = state.pending.begin(); it != state.pending.end(); ++it) {
+        if (it->second.first_arrival + state.timeout.to_chrono() <= now) {
+          expired = std::next(it);
+        }
+      }
+      if (expired != state.pending.begin()) {
+        std::vector<SensorBundle> discarded;
+        ResolveUntil(state, expired, discarded);
+        lock.unlock();
+        discarded.clear();
+        lock.lock();
+        continue;
+      }
+      if (state.pending.empty()) {
+        state.condition.wait(lock);
+      } else {
+        auto deadline = clock::time_point::max();
+        for (auto &&pair : state.pending) {
+          deadline = std::min(deadline, pair.second.first_arrival + state.timeout.to_chrono());
+        }
+        state.condition.wait_until(lock, deadline);
+      }
+    }
+  }
+
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,177 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/NonCopyable.h"
+#include "carla/Time.h"
+#include "carla/sensor/SensorData.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+
+  /// 同一帧内多个传感器的数据
+  struct SensorBundle {
+    size_t frame = 0u;
+
+    /// 按传感器（数据源）的顺序排列，没有收到数据的传感器为空指针
+    std::vector<SharedPtr<SensorData>> data;
+
+    /// 没有收到数据的传感器数
+    size_t missing = 0u;
+
+    bool IsComplete() const {
+      return missing == 0u;
+    }
+  };
+
+  /// FrameSynchronizer 的运行统计
+  struct FrameSynchronizerMetrics {
+    /// 交付的完整数据包数
+    size_t complete_bundles = 0u;
+    /// 交付的不完整数据包数
+    size_t partial_bundles = 0u;
+    /// 因为不完整而丢弃的数据包数
+    size_t dropped_bundles = 0u;
+    /// 所属帧已经交付或丢弃之后才到达的数据数
+    size_t late_measurements = 0u;
+    /// 当前等待中的帧数
+    size_t pending_frames = 0u;
+    /// 从一帧最后一个数据到达到回调开始执行的总时间（秒）
+    double total_latency_seconds = 0.0;
+    /// 上述时间的最大值（秒）
+    double max_latency_seconds = 0.0;
+    /// 执行回调的总时间（秒）
+    double callback_seconds = 0.0;
+  };
+
+  /// 按帧收集多个数据源（传感器）的数据，每帧交付一个 SensorBundle。
+  ///
+  /// 每个数据源的数据按帧的顺序到达，因此某一帧收齐之后，更早的帧不会再
+  /// 收到新的数据，这些帧立即作为不完整的数据包处理；某个数据源不再产生
+  /// 数据时，由 @a timeout 决定一帧从收到第一个数据起最多等待多久。不完整的数据包按照
+  /// PartialBundlePolicy 交付或者丢弃。数据包总是按帧的顺序交付。
+  ///
+  /// 回调在一个专用的线程上依次执行，Push 只做记录，不会等待回调。
+  class FrameSynchronizer : private NonCopyable {
+  public:
+
+    using Callback = std::function<void(SensorBundle)>;
+
+    enum class PartialBundlePolicy {
+      /// 交付不完整的数据包，缺少的数据为空指针
+      Deliver,
+      /// 丢弃不完整的数据包
+      Drop
+    };
+
+    FrameSynchronizer(
+        size_t number_of_sources,
+        time_duration timeout,
+        PartialBundlePolicy policy,
+        Callback callback,
+        size_t max_pending_frames = 8u);
+
+    ~FrameSynchronizer();
+
+    /// 添加数据源 @a source 的一个数据，所属的帧由 SensorData::GetFrame 决定
+    void Push(size_t source, SharedPtr<SensorData> data);
+
+    /// 停止交付，丢弃所有等待中的帧。可以在回调中调用。
+    void Stop();
+
+    FrameSynchronizerMetrics GetMetrics() const;
+
+    size_t GetNumberOfSources() const {
+      return _state->number_of_sources;
+    }
+
+    time_duration GetTimeout() const {
+      return _state->timeout;
+    }
+
+    PartialBundlePolicy GetPartialBundlePolicy() const {
+      return _state->policy;
+    }
+
+  private:
+
+    using clock = std::chrono::steady_clock;
+
+    struct PendingFrame {
+      SensorBundle bundle;
+      clock::time_point first_arrival;
+      clock::time_point last_arrival;
+    };
+
+    using PendingMap = std::map<size_t, PendingFrame>;
+
+    /// 等待交付的数据包和对应帧的最后一个数据到达的时间
+    using ReadyQueue = std::deque<std::pair<SensorBundle, clock::time_point>>;
+
+    /// 交付线程使用的全部状态。交付线程持有一个引用，回调中销毁
+    /// FrameSynchronizer 时，线程在退出之前仍然可以访问这些状态和回调
+    struct State : private NonCopyable {
+      State(
+          size_t number_of_sources,
+          time_duration timeout,
+          PartialBundlePolicy policy,
+          Callback callback,
+          size_t max_pending_frames);
+
+      const size_t number_of_sources;
+
+      const time_duration timeout;
+
+      const PartialBundlePolicy policy;
+
+      const size_t max_pending_frames;
+
+      const Callback callback;
+
+      mutable std::mutex mutex;
+
+      std::condition_variable condition;
+
+      /// 按帧排序的等待中的帧
+      PendingMap pending;
+
+      ReadyQueue ready;
+
+      /// 小于此值的帧已经交付或丢弃，这些帧的数据视为迟到
+      size_t next_frame = 0u;
+
+      bool stop = false;
+
+      FrameSynchronizerMetrics metrics;
+    };
+
+    /// 处理 @a end 之前的所有等待中的帧，需要持有 state.mutex
+    static void ResolveUntil(
+        State &state,
+        PendingMap::iterator end,
+        std::vector<SensorBundle> &discarded);
+
+    static void DeliveryLoop(State &state);
+
+    const std::shared_ptr<State> _state;
+
+    std::thread _thread;
+  };
+
+} // namespace sensor
+} // namespace carla
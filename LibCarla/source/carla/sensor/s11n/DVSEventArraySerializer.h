@@ -39,6 +39,12 @@ namespace s11n {
       return *reinterpret_cast<const DVSHeader *>(data.begin());
     }
 
+    /// 序列化 @a events 所需的字节数，用于从缓冲区池中取出合适大小的缓冲区。
+    static Buffer::size_type GetSerializedSize(const DVSEventArray &events) {
+      return static_cast<Buffer::size_type>(
+          sizeof(DVSHeader) + events.size() * sizeof(data::DVSEvent));
+    }
+
     template <typename Sensor>
     static Buffer Serialize(const Sensor &sensor, const DVSEventArray &events, Buffer &&output);
 
@@ -90,6 +90,12 @@ namespace s11n {
  // 根据获取到的头部视图View中的通道数量（通过View.GetChannelCount()获取）以及data::LidarData::Index::SIZE，计算出头部的偏移量
     }
 
+    /// 序列化 @a data 所需的字节数，用于从缓冲区池中取出合适大小的缓冲区。
+    static Buffer::size_type GetSerializedSize(const data::LidarData &data) {
+      return static_cast<Buffer::size_type>(
+          sizeof(uint32_t) * data._header.size() + sizeof(float) * data._points.size());
+    }
+
     template <typename Sensor>
     static Buffer Serialize(
         const Sensor &sensor,
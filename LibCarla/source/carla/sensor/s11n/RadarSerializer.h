@@ -30,6 +30,12 @@ namespace s11n {
 // 模板函数，用于将雷达传感器数据（data::RadarData类型）按照特定传感器（Sensor类型）的要求进行序列化
     // 参数sensor表示具体的传感器对象，measurement表示要序列化的雷达数据，output表示输出的缓冲区（Buffer类型）
     // 返回序列化后的缓冲区，这里使用了右值引用（Buffer &&output）来避免不必要的拷贝，提高效率，使得数据可以高效地移动到目标缓冲区中
+    /// 序列化 @a measurement 所需的字节数，用于从缓冲区池中取出合适大小的缓冲区。
+    static Buffer::size_type GetSerializedSize(const data::RadarData &measurement) {
+      return static_cast<Buffer::size_type>(
+          sizeof(data::RadarDetection) * measurement._detections.size());
+    }
+
     template <typename Sensor>
     static Buffer Serialize(
         const Sensor &sensor,
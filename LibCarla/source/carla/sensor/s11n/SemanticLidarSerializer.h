@@ -94,6 +94,13 @@ namespace s11n {
     
     }
 
+    /// 序列化 @a measurement 所需的字节数，用于从缓冲区池中取出合适大小的缓冲区。
+    static Buffer::size_type GetSerializedSize(const data::SemanticLidarData &measurement) {
+      return static_cast<Buffer::size_type>(
+          sizeof(uint32_t) * measurement._header.size() +
+          sizeof(data::SemanticLidarDetection) * measurement._ser_points.size());
+    }
+
     template <typename Sensor>
     static Buffer Serialize(
         const Sensor &sensor,
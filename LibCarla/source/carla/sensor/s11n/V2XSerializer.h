@@ -33,6 +33,13 @@ namespace carla
             class CAMDataSerializer
             {
             public:
+                /// 序列化 @a v2x_data 所需的字节数，用于从缓冲区池中取出合适大小的缓冲区。
+                static Buffer::size_type GetSerializedSize(const data::CAMDataS &v2x_data)
+                {
+                    return static_cast<Buffer::size_type>(
+                        sizeof(data::CAMData) * v2x_data.MessageList.size());
+                }
+
                 template <typename Sensor>
                 static Buffer Serialize(
                     const Sensor &sensor,
@@ -60,6 +67,13 @@ namespace carla
             class CustomV2XDataSerializer
             {
             public:
+                /// 序列化 @a v2x_data 所需的字节数，用于从缓冲区池中取出合适大小的缓冲区。
+                static Buffer::size_type GetSerializedSize(const data::CustomV2XDataS &v2x_data)
+                {
+                    return static_cast<Buffer::size_type>(
+                        sizeof(data::CustomV2XData) * v2x_data.MessageList.size());
+                }
+
                 template <typename Sensor>
                 static Buffer Serialize(
                     const Sensor &sensor,
@@ -51,10 +51,22 @@ namespace streaming {
     void SetTimeout(time_duration timeout) {
       _server.SetTimeout(timeout);
     }
+    // 设置会话发送队列的深度和队列满时的丢弃策略，仅对新连接的客户端有效。
+    void SetSendQueueSettings(detail::tcp::SendQueueSettings settings) {
+      _server.SetSendQueueSettings(std::move(settings));
+    }
     // 创建一个新的流。
     Stream MakeStream() {
       return _server.MakeStream();
     }
+    // 启用UDP组播。组播流的数据只发送一次，与订阅的客户端数量无关。
+    void EnableMulticast(detail::udp::MulticastSettings settings = detail::udp::MulticastSettings()) {
+      _server.EnableMulticast(std::move(settings));
+    }
+    // 创建一个通过UDP组播发送数据的流，需要先调用 EnableMulticast。
+    Stream MakeMulticastStream() {
+      return _server.MakeMulticastStream();
+    }
     // 关闭指定 ID 的流。
     void CloseStream(carla::streaming::detail::stream_id_type id) {
       return _server.CloseStream(id);
@@ -71,6 +83,11 @@ namespace streaming {
     void SetSynchronousMode(bool is_synchro) {
       _server.SetSynchronousMode(is_synchro);
     }
+// 为同一主机上的客户端启用共享内存传输。只有之后创建的流的令牌会请求共享内存，
+// 之前创建的令牌继续使用TCP；关闭后请求共享内存的客户端也改用TCP。
+    void SetSharedMemoryEnabled(bool enable) {
+      _server.SetSharedMemoryEnabled(enable);
+    }
 // 获取指定流 ID 的令牌。
     token_type GetToken(stream_id sensor_id) {
       return _server.GetToken(sensor_id);
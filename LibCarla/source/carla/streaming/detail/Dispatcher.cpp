@@ -34,6 +34,10 @@ namespace detail {
       }
 #endif // LIBCARLA_NO_EXCEPTIONS
     }
+    // 组播流可能比服务器存活得更久，停止发送以免之后的写入访问已销毁的 io_context
+    if (_multicast_sender != nullptr) {
+      _multicast_sender->Close();
+    }
   }
 
   // Dispatcher 类成员函数
@@ -67,6 +71,30 @@ namespace detail {
     }
   }
 
+  // 创建一个组播流，令牌中包含这个流使用的组播组的地址和端口
+  carla::streaming::Stream Dispatcher::MakeMulticastStream() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_multicast_sender == nullptr) {
+      throw_exception(std::logic_error("multicast is not enabled on this server"));
+    }
+    ++_cached_token._token.stream_id;
+    const auto stream_id = _cached_token.get_stream_id();
+    log_debug("New multicast stream:", stream_id);
+    token_type token(
+        stream_id,
+        make_endpoint<boost::asio::ip::udp>(_multicast_sender->MakeGroupEndpoint()));
+    auto ptr = std::make_shared<MultiStreamState>(token, _multicast_sender);
+    auto result = _stream_map.emplace(std::make_pair(stream_id, ptr));
+    if (!result.second) {
+      throw_exception(std::runtime_error("failed to create stream!"));
+    }
+    return carla::streaming::Stream(ptr);
+  }
+  // 设置组播流使用的发送者
+  void Dispatcher::SetMulticastSender(std::shared_ptr<udp::MulticastSender> sender) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _multicast_sender = std::move(sender);
+  }
   // 关闭指定ID的流
   void Dispatcher::CloseStream(carla::streaming::detail::stream_id_type id) {
       // 使用互斥锁保护共享资源_stream_map，避免多线程同时访问导致数据竞争
@@ -89,6 +117,10 @@ namespace detail {
     // 从_stream_map中删除该流的状态信息
       _stream_map.erase(search);
     }
+    // 组播流还未发送的消息不再需要
+    if (_multicast_sender != nullptr) {
+      _multicast_sender->RemoveStream(id);
+    }
   }
 
   // 注册会话到指定流
@@ -143,6 +175,13 @@ namespace detail {
       }
     }
   }
+  // 设置之后创建的令牌所使用的协议
+  void Dispatcher::SetSharedMemoryEnabled(const bool enable) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _cached_token._token.protocol = enable ?
+        token_data::protocol::shm :
+        token_data::protocol::tcp;
+  }
   // 根据传感器ID获取令牌的函数
     // 参数：sensor_id - 要获取令牌的传感器ID
     // 返回值：对应的令牌
@@ -11,6 +11,7 @@
 #include "carla/streaming/detail/Session.h"
 #include "carla/streaming/detail/Stream.h"
 #include "carla/streaming/detail/Token.h"
+#include "carla/streaming/detail/udp/MulticastSender.h"
 
 #include <memory>
 #include <mutex>
@@ -37,6 +38,10 @@ namespace detail {
     ~Dispatcher();
 // 创建一个新的流
     carla::streaming::Stream MakeStream();
+// 创建一个通过UDP组播发送数据的流，需要先调用 SetMulticastSender
+    carla::streaming::Stream MakeMulticastStream();
+// 设置组播流使用的发送者
+    void SetMulticastSender(std::shared_ptr<udp::MulticastSender> sender);
 // 关闭指定 ID 的流
     void CloseStream(carla::streaming::detail::stream_id_type id);
 // 注册一个会话
@@ -45,6 +50,8 @@ namespace detail {
     void DeregisterSession(std::shared_ptr<Session> session);
 // 获取指定传感器 ID 的令牌
     token_type GetToken(stream_id_type sensor_id);
+// 设置新创建的流是否提供共享内存传输，只影响之后创建的令牌
+    void SetSharedMemoryEnabled(bool enable);
 // 启用针对 ROS 的功能，通过传感器 ID 找到对应的流并调用其 EnableForROS 方法
     void EnableForROS(stream_id_type sensor_id) {
       auto search = _stream_map.find(sensor_id);
@@ -77,6 +84,8 @@ namespace detail {
     token_type _cached_token;
 // 存储流 ID 和对应的 MultiStreamState 共享指针的哈希表
     StreamMap _stream_map;
+// 所有组播流共享的发送者
+    std::shared_ptr<udp::MulticastSender> _multicast_sender;
   };
 
 } // namespace detail
@@ -13,6 +13,7 @@
 #include "carla/streaming/detail/StreamStateBase.h"
 // 基类，可能提供了一些基本的流状态管理功能
 #include "carla/streaming/detail/tcp/Message.h"
+#include "carla/streaming/detail/udp/MulticastSender.h"
 
 #include <mutex>
 #include <vector>
@@ -34,9 +35,27 @@ namespace detail {
       StreamStateBase(token),
       _session(nullptr)
       {};
+ // 构造一个组播流，数据只发送一次到组播组，与订阅的客户端数量无关
+    MultiStreamState(
+        const token_type &token,
+        std::shared_ptr<udp::MulticastSender> multicast) :
+      StreamStateBase(token),
+      _session(nullptr),
+      _multicast(std::move(multicast))
+      {};
 // 模板函数，用于写入数据到流中
     template <typename... Buffers>
     void Write(Buffers... buffers) {
+      // 组播流：只序列化一次并发送到组播组
+      if (_multicast != nullptr) {
+        auto message = Session::MakeMessage(buffers...);
+        uint32_t sequence = ++_multicast_sequence;
+        if (sequence == 0u) {
+          sequence = ++_multicast_sequence; // 序列号 0 保留
+        }
+        _multicast->Write(token().to_udp_endpoint(), token().get_stream_id(), sequence, std::move(message));
+        return;
+      }
       // try write single stream
       auto session = _session.load();
       if (session != nullptr) {
@@ -79,8 +98,9 @@ namespace detail {
       return _enabled_for_ros;
     }
  // 检查是否有客户端正在监听流
+    // 组播流无法知道有多少客户端订阅，总是认为有客户端在监听
     bool AreClientsListening() {
-      return (_sessions.size() > 0 || _force_active || _enabled_for_ros);
+      return (_sessions.size() > 0 || _force_active || _enabled_for_ros || (_multicast != nullptr));
     }
 // 连接一个新的会话
     void ConnectSession(std::shared_ptr<Session> session) final {
@@ -170,6 +190,10 @@ namespace detail {
     bool _enabled_for_ros {false};    // _enabled_for_ros 是一个布尔变量，用于指示该类或其中的会话是否启用了对 ROS（Robot Operating System）的支持
     // 如果为 true，则可能表示该类或其中的会话能够与 ROS 系统进行交互，例如发送或接收消息
     // 类的其他成员变量、方法和构造函数应该在这里定义
+    // 组播发送者，为空表示普通的TCP流
+    const std::shared_ptr<udp::MulticastSender> _multicast;
+    // 组播消息的序列号，客户端据此统计丢失的消息
+    std::atomic<uint32_t> _multicast_sequence {0u};
     // 注意：这些变量是公开的（public），但在实际设计中，您可能希望将它们设为私有（private）
     // 并通过公共的 getter 和 setter 方法来访问它们，以封装类的内部状态
   };
@@ -43,6 +43,12 @@ namespace detail {  // 定义 detail 子命名空间
       return state->MakeBuffer();  // 返回从共享状态创建的缓冲区
     }
 
+    /// 从池中获取一个大小为 @a size 的缓冲区，优先重用容量合适的缓冲区。
+    Buffer MakeBuffer(Buffer::size_type size) {
+      auto state = _shared_state;
+      return state->MakeBuffer(size);
+    }
+
     /// 将 @a buffers 刷新到流中。不会进行复制。
     template <typename... Buffers>  // 支持多个缓冲区类型
     void Write(Buffers &&... buffers) {  // 写入缓冲区
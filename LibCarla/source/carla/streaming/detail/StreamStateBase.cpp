@@ -30,6 +30,12 @@ namespace detail {    // 开始detail命名空间，通常用于包含实现细
     return pool->Pop();
   }
 
+  // 从缓冲区池中获取一个大小为 size 的缓冲区，优先重用容量合适的缓冲区
+  Buffer StreamStateBase::MakeBuffer(Buffer::size_type size) {
+    auto pool = _buffer_pool;
+    return pool->Pop(size);
+  }
+
 } // namespace detail
 } // namespace streaming
 } // namespace carla
@@ -9,6 +9,7 @@
  * @file
  * @brief 包含StreamStateBase类的定义，它是流状态的基础类。
  */
+#include "carla/Buffer.h"
 #include "carla/NonCopyable.h"
 #include "carla/streaming/detail/Session.h"
 #include "carla/streaming/detail/Token.h"
@@ -57,6 +58,12 @@ namespace detail {
      * @return 返回一个新创建的缓冲区。
      */
     Buffer MakeBuffer();
+    /**
+     * @brief 创建一个大小为 @a size 的缓冲区。
+     *
+     * 缓冲区池按容量分级，已知消息大小时使用这个重载可以避免重新分配内存。
+     */
+    Buffer MakeBuffer(Buffer::size_type size);
     /**
      * @brief 连接到会话。
      *
@@ -49,7 +49,8 @@ namespace detail {
     enum class protocol : uint8_t {
       not_set,///< 未设置协议
       tcp,///< TCP协议
-      udp ///< UDP协议
+      udp, ///< UDP协议
+      shm ///< 同一主机上通过共享内存传输数据，TCP连接只用于通知
     } protocol = protocol::not_set;
     /**
     * @brief 地址类型枚举，指示IP地址的版本。
@@ -123,7 +124,9 @@ namespace detail {
     template <typename P>
     boost::asio::ip::basic_endpoint<P> get_endpoint() const {
       DEBUG_ASSERT(is_valid());// 假设is_valid()是一个检查令牌有效性的成员函数
-      DEBUG_ASSERT(get_protocol<P>() == _token.protocol);// 检查协议是否匹配
+      DEBUG_ASSERT(
+          (get_protocol<P>() == _token.protocol) ||
+          (protocol_is_shm() && (get_protocol<P>() == token_data::protocol::tcp)));// 检查协议是否匹配，共享内存流使用TCP端点
       return {get_address(), _token.port};// 返回端点，包含地址和端口
     }
 
@@ -280,6 +283,16 @@ namespace detail {
       return _token.protocol == token_data::protocol::tcp;
     }
     /**
+ * @brief 检查协议是否为共享内存。
+ *
+ * 共享内存流仍然通过TCP端点建立连接，客户端与服务器在同一主机上时数据通过共享内存传输。
+ *
+ * @return 如果协议是共享内存，则返回true；否则返回false。
+ */
+    bool protocol_is_shm() const {
+      return _token.protocol == token_data::protocol::shm;
+    }
+    /**
  * @brief 检查是否具有相同的协议。
  *
  * 比较当前令牌的协议与给定端点的协议。
@@ -0,0 +1,297 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/shm/SharedMemoryRing.h"
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+
+#include <cerrno>
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif // _WIN32
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  static_assert(
+      sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+      "std::atomic<uint64_t> must be lock-free to live in shared memory.");
+
+  static constexpr uint32_t RING_MAGIC = 0x43524d53u; // "CRMS"
+
+  static constexpr uint32_t RING_VERSION = 1u;
+
+  static constexpr size_t CACHE_LINE_SIZE = 64u;
+
+  static constexpr size_t AlignToCacheLine(size_t size) {
+    return (size + CACHE_LINE_SIZE - 1u) & ~(CACHE_LINE_SIZE - 1u);
+  }
+
+  struct RingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_capacity;
+    std::atomic<uint64_t> write_sequence;
+  };
+
+  struct SlotHeader {
+    /// 写入期间为 2 * sequence - 1，写入完成后为 2 * sequence。
+    std::atomic<uint64_t> sequence;
+    uint32_t size;
+  };
+
+  static constexpr size_t HEADER_SIZE = AlignToCacheLine(sizeof(RingHeader));
+
+  static size_t GetSlotStride(uint32_t slot_capacity) {
+    return AlignToCacheLine(sizeof(SlotHeader) + slot_capacity);
+  }
+
+  static RingHeader &GetHeader(unsigned char *data) {
+    return *reinterpret_cast<RingHeader *>(data);
+  }
+
+  static SlotHeader &GetSlot(unsigned char *data, const uint64_t sequence) {
+    const auto &header = GetHeader(data);
+    const auto index = static_cast<size_t>(sequence % header.slot_count);
+    auto *begin = data + HEADER_SIZE;
+    return *reinterpret_cast<SlotHeader *>(begin + index * GetSlotStride(header.slot_capacity));
+  }
+
+#ifdef _WIN32
+
+  static std::string GetLastErrorMessage() {
+    return "error " + std::to_string(::GetLastError());
+  }
+
+#else
+
+  /// POSIX 共享内存对象的名称必须以 '/' 开头。
+  static std::string MakePosixName(const std::string &name) {
+    return "/" + name;
+  }
+
+  static std::string GetLastErrorMessage() {
+    return std::strerror(errno);
+  }
+
+#endif // _WIN32
+
+  SharedMemoryRing::SharedMemoryRing(
+      std::string name,
+      unsigned char *data,
+      size_t size,
+      void *handle,
+      bool is_owner)
+    : _name(std::move(name)),
+      _data(data),
+      _size(size),
+      _handle(handle),
+      _is_owner(is_owner) {}
+
+  SharedMemoryRing::~SharedMemoryRing() {
+#ifdef _WIN32
+    // 最后一个句柄关闭后系统会自动移除文件映射对象。
+    ::UnmapViewOfFile(_data);
+    ::CloseHandle(_handle);
+#else
+    ::munmap(_data, _size);
+    if (_is_owner) {
+      ::shm_unlink(MakePosixName(_name).c_str());
+    }
+#endif // _WIN32
+  }
+
+  std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Create(
+      const std::string &name,
+      const uint32_t slot_count,
+      const uint32_t slot_capacity) {
+    DEBUG_ASSERT(slot_count > 0u);
+    const size_t size = HEADER_SIZE + slot_count * GetSlotStride(slot_capacity);
+#ifdef _WIN32
+    const auto size64 = static_cast<uint64_t>(size);
+    void *handle = ::CreateFileMappingA(
+        INVALID_HANDLE_VALUE,
+        nullptr,
+        PAGE_READWRITE,
+        static_cast<DWORD>(size64 >> 32u),
+        static_cast<DWORD>(size64 & 0xFFFFFFFFu),
+        name.c_str());
+    if ((handle == nullptr) || (::GetLastError() == ERROR_ALREADY_EXISTS)) {
+      log_error("failed to create shared memory ring", name, ':', GetLastErrorMessage());
+      if (handle != nullptr) {
+        ::CloseHandle(handle);
+      }
+      return nullptr;
+    }
+    auto *data = static_cast<unsigned char *>(
+        ::MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0u, 0u, size));
+    if (data == nullptr) {
+      log_error("failed to map shared memory ring", name, ':', GetLastErrorMessage());
+      ::CloseHandle(handle);
+      return nullptr;
+    }
+#else
+    void *handle = nullptr;
+    const auto posix_name = MakePosixName(name);
+    // 同名的共享内存可能是崩溃的进程留下的。
+    ::shm_unlink(posix_name.c_str());
+    const int fd = ::shm_open(posix_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd == -1) {
+      log_error("failed to create shared memory ring", name, ':', GetLastErrorMessage());
+      return nullptr;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size)) == -1) {
+      log_error("failed to resize shared memory ring", name, ':', GetLastErrorMessage());
+      ::close(fd);
+      ::shm_unlink(posix_name.c_str());
+      return nullptr;
+    }
+    void *address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // 映射建立后就不再需要文件描述符了。
+    ::close(fd);
+    if (address == MAP_FAILED) {
+      log_error("failed to map shared memory ring", name, ':', GetLastErrorMessage());
+      ::shm_unlink(posix_name.c_str());
+      return nullptr;
+    }
+    auto *data = static_cast<unsigned char *>(address);
+#endif // _WIN32
+    std::unique_ptr<SharedMemoryRing> ring(new SharedMemoryRing(name, data, size, handle, true));
+    auto &header = GetHeader(data);
+    header.magic = RING_MAGIC;
+    header.version = RING_VERSION;
+    header.slot_count = slot_count;
+    header.slot_capacity = slot_capacity;
+    header.write_sequence.store(0u, std::memory_order_relaxed);
+    for (auto i = 0u; i < slot_count; ++i) {
+      auto &slot = GetSlot(data, i);
+      slot.sequence.store(0u, std::memory_order_relaxed);
+      slot.size = 0u;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    return ring;
+  }
+
+  std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Open(const std::string &name) {
+#ifdef _WIN32
+    void *handle = ::OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str());
+    if (handle == nullptr) {
+      log_error("failed to open shared memory ring", name, ':', GetLastErrorMessage());
+      return nullptr;
+    }
+    auto *data = static_cast<unsigned char *>(
+        ::MapViewOfFile(handle, FILE_MAP_READ, 0u, 0u, 0u));
+    if (data == nullptr) {
+      log_error("failed to map shared memory ring", name, ':', GetLastErrorMessage());
+      ::CloseHandle(handle);
+      return nullptr;
+    }
+    // 映射视图的大小按页对齐，不小于创建时指定的大小。
+    MEMORY_BASIC_INFORMATION info;
+    const size_t size = ::VirtualQuery(data, &info, sizeof(info)) == 0u ? 0u : info.RegionSize;
+#else
+    void *handle = nullptr;
+    const int fd = ::shm_open(MakePosixName(name).c_str(), O_RDONLY, 0);
+    if (fd == -1) {
+      log_error("failed to open shared memory ring", name, ':', GetLastErrorMessage());
+      return nullptr;
+    }
+    struct stat info;
+    if ((::fstat(fd, &info) == -1) || (info.st_size <= 0)) {
+      log_error("failed to stat shared memory ring", name, ':', GetLastErrorMessage());
+      ::close(fd);
+      return nullptr;
+    }
+    const auto size = static_cast<size_t>(info.st_size);
+    void *address = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+      log_error("failed to map shared memory ring", name, ':', GetLastErrorMessage());
+      return nullptr;
+    }
+    auto *data = static_cast<unsigned char *>(address);
+#endif // _WIN32
+    std::unique_ptr<SharedMemoryRing> ring(new SharedMemoryRing(name, data, size, handle, false));
+    if (size < HEADER_SIZE) {
+      log_error("shared memory ring too small:", name);
+      return nullptr;
+    }
+    const auto &header = GetHeader(data);
+    if ((header.magic != RING_MAGIC) ||
+        (header.version != RING_VERSION) ||
+        (header.slot_count == 0u)) {
+      log_error("invalid shared memory ring:", name);
+      return nullptr;
+    }
+    const auto expected_size =
+        HEADER_SIZE + header.slot_count * GetSlotStride(header.slot_capacity);
+    if (size < expected_size) {
+      log_error("shared memory ring truncated:", name);
+      return nullptr;
+    }
+    return ring;
+  }
+
+  uint32_t SharedMemoryRing::slot_count() const {
+    return GetHeader(_data).slot_count;
+  }
+
+  uint32_t SharedMemoryRing::slot_capacity() const {
+    return GetHeader(_data).slot_capacity;
+  }
+
+  unsigned char *SharedMemoryRing::GetSlotData(const uint64_t sequence) const {
+    return reinterpret_cast<unsigned char *>(&GetSlot(_data, sequence)) + sizeof(SlotHeader);
+  }
+
+  uint64_t SharedMemoryRing::BeginWrite() {
+    const auto sequence = GetHeader(_data).write_sequence.fetch_add(1u, std::memory_order_relaxed) + 1u;
+    GetSlot(_data, sequence).sequence.store(2u * sequence - 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return sequence;
+  }
+
+  void SharedMemoryRing::EndWrite(const uint64_t sequence, const uint32_t size) {
+    auto &slot = GetSlot(_data, sequence);
+    slot.size = size;
+    slot.sequence.store(2u * sequence, std::memory_order_release);
+  }
+
+  bool SharedMemoryRing::Read(const uint64_t sequence, Buffer &buffer) const {
+    const auto &slot = GetSlot(_data, sequence);
+    if (slot.sequence.load(std::memory_order_acquire) != 2u * sequence) {
+      return false;
+    }
+    const auto size = slot.size;
+    if (size > GetHeader(_data).slot_capacity) {
+      return false;
+    }
+    buffer.copy_from(boost::asio::buffer(GetSlotData(sequence), size));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // 拷贝过程中槽位可能已被覆盖。
+    return slot.sequence.load(std::memory_order_relaxed) == 2u * sequence;
+  }
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
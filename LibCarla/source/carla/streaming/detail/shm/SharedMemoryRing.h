@@ -0,0 +1,141 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/Types.h"
+
+#include <boost/asio/buffer.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+#pragma pack(push, 1)
+  /// 共享内存模式下服务器通过 TCP 连接发送的通知消息，告诉客户端哪个槽位有新数据。
+  struct Notification {
+    /// 环形缓冲区的代数，槽位容量不足时服务器会重新创建更大的环形缓冲区。
+    uint32_t generation = 0u;
+    /// 写入数据的序列号。
+    uint64_t sequence = 0u;
+    /// 写入数据的大小，客户端据此从缓冲区池中取出合适大小的缓冲区。
+    uint32_t size = 0u;
+  };
+#pragma pack(pop)
+
+  /// 传输方式。客户端请求共享内存时，服务器回复的第一条消息以实际使用的
+  /// 传输方式开头，使用共享内存时后面跟着环形缓冲区的基础名称。
+  enum class TransportRequest : uint8_t {
+    tcp,
+    shared_memory
+  };
+
+  /// 客户端在发送的流ID中设置此位以请求共享内存传输。不设置此位的客户端
+  /// （包括旧版本的客户端）只发送流ID，服务器直接使用TCP传输。
+  constexpr stream_id_type SHARED_MEMORY_REQUEST_FLAG = 0x80000000u;
+
+  /// 存放在命名共享内存中的固定槽位环形缓冲区。
+  ///
+  /// 服务器是唯一的写入者，每个槽位使用序列锁（seqlock）保护：写入期间
+  /// 槽位序列号为奇数，写入完成后为偶数。客户端拷贝数据后再次检查序列号，
+  /// 如果槽位在拷贝过程中被覆盖则丢弃该消息。
+  ///
+  /// @warning 读取端只能在与服务器相同的主机上使用。
+  class SharedMemoryRing : private NonCopyable {
+  public:
+
+    /// 创建一个新的环形缓冲区（服务器端），析构时移除共享内存对象。
+    ///
+    /// 服务器在禁用异常的情况下编译，因此这里直接使用操作系统的共享内存
+    /// 接口，失败时记录错误并返回 nullptr 而不是抛出异常。
+    static std::unique_ptr<SharedMemoryRing> Create(
+        const std::string &name,
+        uint32_t slot_count,
+        uint32_t slot_capacity);
+
+    /// 打开一个已存在的环形缓冲区（客户端），失败时返回 nullptr。
+    static std::unique_ptr<SharedMemoryRing> Open(const std::string &name);
+
+    ~SharedMemoryRing();
+
+    const std::string &name() const {
+      return _name;
+    }
+
+    uint32_t slot_count() const;
+
+    uint32_t slot_capacity() const;
+
+    /// 将一组缓冲区按顺序写入下一个槽位，返回写入的序列号。
+    ///
+    /// @pre 缓冲区的总大小不能超过 slot_capacity()。
+    template <typename ConstBufferSequence>
+    uint64_t Write(const ConstBufferSequence &buffers) {
+      DEBUG_ASSERT(_is_owner);
+      const auto total = boost::asio::buffer_size(buffers);
+      DEBUG_ASSERT(total <= slot_capacity());
+      const uint64_t sequence = BeginWrite();
+      auto *dst = GetSlotData(sequence);
+      for (auto &&buffer : buffers) {
+        const auto size = boost::asio::buffer_size(buffer);
+        std::memcpy(dst, buffer.data(), size);
+        dst += size;
+      }
+      EndWrite(sequence, static_cast<uint32_t>(total));
+      return sequence;
+    }
+
+    /// 将序列号为 @a sequence 的槽位拷贝到 @a buffer 中。
+    ///
+    /// @return 如果槽位已被新数据覆盖（或仍在写入）则返回 false。
+    bool Read(uint64_t sequence, Buffer &buffer) const;
+
+    /// 根据基础名称和代数生成环形缓冲区的名称。
+    static std::string MakeName(const std::string &base_name, uint32_t generation) {
+      return base_name + "-" + std::to_string(generation);
+    }
+
+  private:
+
+    SharedMemoryRing(
+        std::string name,
+        unsigned char *data,
+        size_t size,
+        void *handle,
+        bool is_owner);
+
+    unsigned char *GetSlotData(uint64_t sequence) const;
+
+    uint64_t BeginWrite();
+
+    void EndWrite(uint64_t sequence, uint32_t size);
+
+    const std::string _name;
+
+    /// 映射到本进程的共享内存。
+    unsigned char *const _data;
+
+    const size_t _size;
+
+    /// 文件映射对象的句柄，只在 Windows 上使用。
+    void *const _handle;
+
+    const bool _is_owner;
+  };
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -11,6 +11,7 @@
 #include "carla/Exception.h"
 #include "carla/Logging.h"
 #include "carla/Time.h"
+#include "carla/profiler/Profiler.h"
 
 // C++ Boost Asio是一个基于事件驱动的网络编程库，提供了异步的、非阻塞的网络编程接口。
 #include <boost/asio/connect.hpp>
@@ -20,7 +21,10 @@
 // 这会导致客户机和服务器之间的不同步，并最终导致泄漏：https://github.com/carla-simulator/carla/pull/8130
 #include <boost/asio/bind_executor.hpp>
 
+#include <algorithm>
+#include <cstring>
 #include <exception>
+#include <vector>
 
 namespace carla {
 namespace streaming {
@@ -28,43 +32,15 @@ namespace detail {
 namespace tcp {
 
   // ===========================================================================
-  // -- 传入消息 IncomingMessage ------------------------------------------------
+  // -- 接收缓冲区 --------------------------------------------------------------
   // ===========================================================================
 
-  /// 读取传入TCP消息的助手。在单个缓冲区中分配整个消息。
-  class IncomingMessage {
-  public:
+  /// 接收缓冲区的大小，一次读取最多这么多字节。
+  static constexpr size_t read_buffer_size = 64u * 1024u;
 
-    explicit IncomingMessage(Buffer &&buffer) : _message(std::move(buffer)) {}
-
-    // 获取缓冲区的大小
-    boost::asio::mutable_buffer size_as_buffer() {
-      return boost::asio::buffer(&_size, sizeof(_size));
-    }
-
-    // 获取消息的缓冲区
-    boost::asio::mutable_buffer buffer() {
-      DEBUG_ASSERT(_size > 0u);
-      _message.reset(_size);
-      return _message.buffer();
-    }
-
-    auto size() const {
-      return _size;
-    }
-
-    auto pop() {
-      // std::move 将左值转换为右值（转移所有权或启用对象的移动语义）
-      // 移动语义允许开发人员有效地将资源（如内存或文件句柄）从一个对象传输到另一个对象，而无需进行不必要的复制。
-      return std::move(_message);
-    }
-
-  private:
-
-    message_size_type _size = 0u;
-
-    Buffer _message;
-  };
+  /// 不超过这个大小的消息从接收缓冲区拷贝出来，更大的消息直接读取到目标缓冲区中，
+  /// 避免多拷贝一次。
+  static constexpr size_t max_buffered_message_size = 16u * 1024u;
 
   // ===========================================================================
   // -- 客户端 ------------------------------------------------------------------
@@ -81,9 +57,10 @@ namespace tcp {
       _socket(io_context),
       _strand(io_context),
       _connection_timer(io_context),
-      _buffer_pool(std::make_shared<BufferPool>()) {
-    if (!_token.protocol_is_tcp()) {
-      throw_exception(std::invalid_argument("invalid token, only TCP tokens supported"));
+      _buffer_pool(std::make_shared<BufferPool>()),
+      _read_buffer(read_buffer_size) {
+    if (!_token.protocol_is_tcp() && !_token.protocol_is_shm()) {
+      throw_exception(std::invalid_argument("invalid token, only TCP and shared memory tokens supported"));
     }
   }
 
@@ -104,8 +81,17 @@ namespace tcp {
       }
 
       DEBUG_ASSERT(_token.is_valid());
-      DEBUG_ASSERT(_token.protocol_is_tcp());
+      DEBUG_ASSERT(_token.protocol_is_tcp() || _token.protocol_is_shm());
       const auto ep = _token.to_tcp_endpoint();
+      // 只有与服务器在同一主机上时才能使用共享内存。
+      _transport_request = (_token.protocol_is_shm() && ep.address().is_loopback()) ?
+          shm::TransportRequest::shared_memory :
+          shm::TransportRequest::tcp;
+      _shm_base_name.clear();
+      _ring.reset();
+      _read_begin = 0u;
+      _read_end = 0u;
+      _large_message.clear();
 
       auto handle_connect = [this, self, ep](error_code ec) {
         if (!ec) {
@@ -122,19 +108,22 @@ namespace tcp {
           // 以牺牲带宽效率为代价，换取更低的延迟。
           _socket.set_option(boost::asio::ip::tcp::no_delay(true));
           log_debug("streaming client: connected to", ep);
-          // 发送流id以订阅流。
-          const auto &stream_id = _token.get_stream_id();
-          log_debug("streaming client: sending stream id", stream_id);
+          // 发送流id以订阅流，请求共享内存时设置流id的最高位。
+          _handshake_stream_id = _token.get_stream_id();
+          if (_transport_request == shm::TransportRequest::shared_memory) {
+            _handshake_stream_id |= shm::SHARED_MEMORY_REQUEST_FLAG;
+          }
+          log_debug("streaming client: sending stream id", _token.get_stream_id());
           boost::asio::async_write(
               _socket,
-              boost::asio::buffer(&stream_id, sizeof(stream_id)),
+              boost::asio::buffer(&_handshake_stream_id, sizeof(_handshake_stream_id)),
               boost::asio::bind_executor(_strand, [=](error_code ec, size_t DEBUG_ONLY(bytes)) {
                 // 确保在连接停止后停止执行。
                 if (_done) {
                   return;
                 }
                 if (!ec) {
-                  DEBUG_ASSERT_EQ(bytes, sizeof(stream_id));
+                  DEBUG_ASSERT_EQ(bytes, sizeof(_handshake_stream_id));
                   // 如果成功，开始读取数据。
                   ReadData();
                 } else {
@@ -180,57 +169,144 @@ namespace tcp {
   // 读取数据
   void Client::ReadData() {
     auto self = shared_from_this();
+    if (_done) {
+      return;
+    }
+
+    DEBUG_ASSERT(_read_end < _read_buffer.size());
+    auto handle_read = [this, self](boost::system::error_code ec, size_t bytes) {
       if (_done) {
         return;
       }
+      if (!ec) {
+        _read_end += bytes;
+        ProcessReadBuffer();
+      } else {
+        // 像往常一样，如果出了什么问题，就从头再来。
+        log_debug("streaming client: failed to read data:", ec.message());
+        Connect();
+      }
+    };
 
-      // log_debug("streaming client: Client::ReadData");
-
-      auto message = std::make_shared<IncomingMessage>(_buffer_pool->Pop());
+    // 读取套接字中当前可用的所有数据，可能包含多条消息。
+    _socket.async_read_some(
+        boost::asio::buffer(_read_buffer.data() + _read_end, _read_buffer.size() - _read_end),
+        boost::asio::bind_executor(_strand, handle_read));
+  }
 
-      auto handle_read_data = [this, self, message](boost::system::error_code ec, size_t DEBUG_ONLY(bytes)) {
-        DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_data", bytes, "bytes"));
-        if (!ec) {
-          DEBUG_ASSERT_EQ(bytes, message->size());
-          DEBUG_ASSERT_NE(bytes, 0u);
-          // 将缓冲区移动到回调函数并开始读取下一块数据。
-          // log_debug("streaming client: success reading data, calling the callback");
-          self->_callback(message->pop());
-          ReadData();
-        } else {
-          // 像往常一样，如果出了什么问题，就从头再来。
-          log_debug("streaming client: failed to read data:", ec.message());
-          Connect();
+  void Client::ProcessReadBuffer() {
+    CARLA_PROFILE_SCOPE(streaming, client_read);
+    constexpr auto header_size = sizeof(message_size_type);
+    while ((_read_end - _read_begin) >= header_size) {
+      message_size_type size;
+      std::memcpy(&size, _read_buffer.data() + _read_begin, header_size);
+      if (size == 0u) {
+        log_debug("streaming client: failed to read header: empty message");
+        Connect();
+        return;
+      }
+      const size_t available = _read_end - _read_begin - header_size;
+      if (size > max_buffered_message_size) {
+        // 大消息：拷贝已经收到的部分，剩下的直接读取到目标缓冲区中。
+        _read_begin += header_size;
+        const size_t bytes_received = std::min<size_t>(size, available);
+        _large_message = _buffer_pool->Pop(size);
+        std::memcpy(_large_message.data(), _read_buffer.data() + _read_begin, bytes_received);
+        _read_begin += bytes_received;
+        if (bytes_received < size) {
+          ReadLargeMessage(bytes_received);
+          return;
         }
-      };
+        OnMessage(std::move(_large_message));
+      } else if (available >= size) {
+        // 小消息：从接收缓冲区拷贝到缓冲池中的缓冲区，稳定状态下不需要分配内存。
+        auto message = _buffer_pool->Pop(size);
+        std::memcpy(message.data(), _read_buffer.data() + _read_begin + header_size, size);
+        _read_begin += header_size + size;
+        OnMessage(std::move(message));
+      } else {
+        break; // 消息还不完整。
+      }
+      if (_done) {
+        return;
+      }
+    }
+    // 将剩余的不完整消息移动到缓冲区开头，它最多有 header_size + max_buffered_message_size 字节。
+    const size_t remaining = _read_end - _read_begin;
+    if ((remaining > 0u) && (_read_begin > 0u)) {
+      std::memmove(_read_buffer.data(), _read_buffer.data() + _read_begin, remaining);
+    }
+    _read_begin = 0u;
+    _read_end = remaining;
+    ReadData();
+  }
 
-      auto handle_read_header = [this, self, message, handle_read_data](
-          boost::system::error_code ec,
-          size_t DEBUG_ONLY(bytes)) {
-        DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_header", bytes, "bytes"));
-        if (!ec && (message->size() > 0u)) {
-          DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type));
-          if (_done) {
-            return;
-          }
-          // 现在我们知道了即将到来的缓冲区的大小，我们可以分配缓冲区并开始将数据放入其中。
-          boost::asio::async_read(
-              _socket,
-              message->buffer(),
-              boost::asio::bind_executor(_strand, handle_read_data));
-        } else if (!_done) {
-          log_debug("streaming client: failed to read header:", ec.message());
-          DEBUG_ONLY(log_debug("size  = ", message->size()));
-          DEBUG_ONLY(log_debug("bytes = ", bytes));
-          Connect();
-        }
-      };
+  void Client::ReadLargeMessage(const size_t bytes_received) {
+    auto self = shared_from_this();
+    DEBUG_ASSERT_EQ(_read_begin, _read_end);
+    _read_begin = 0u;
+    _read_end = 0u;
+
+    auto handle_read_data = [this, self](boost::system::error_code ec, size_t) {
+      if (_done) {
+        return;
+      }
+      if (!ec) {
+        // 将缓冲区移动到回调函数并开始读取下一块数据。
+        OnMessage(std::move(_large_message));
+        ProcessReadBuffer();
+      } else {
+        log_debug("streaming client: failed to read data:", ec.message());
+        Connect();
+      }
+    };
 
-      // 读取即将到来的缓冲区的大小。
-      boost::asio::async_read(
-          _socket,
-          message->size_as_buffer(),
-          boost::asio::bind_executor(_strand, handle_read_header));
+    boost::asio::async_read(
+        _socket,
+        boost::asio::buffer(_large_message.data() + bytes_received, _large_message.size() - bytes_received),
+        boost::asio::bind_executor(_strand, handle_read_data));
+  }
+
+  void Client::OnMessage(Buffer &&message) {
+    CARLA_PROFILE_SCOPE(streaming, client_on_message);
+    if (_transport_request != shm::TransportRequest::shared_memory) {
+      _callback(std::move(message));
+      return;
+    }
+    if (_shm_base_name.empty()) {
+      // 服务器的回复：实际使用的传输方式，使用共享内存时后面是环形缓冲区的基础名称。
+      const auto transport = static_cast<shm::TransportRequest>(message.data()[0u]);
+      if ((transport != shm::TransportRequest::shared_memory) || (message.size() < 2u)) {
+        log_info("streaming client: shared memory not available, using tcp");
+        _transport_request = shm::TransportRequest::tcp;
+        return;
+      }
+      _shm_base_name.assign(message.begin() + 1u, message.end());
+      log_debug("streaming client: using shared memory", _shm_base_name);
+      return;
+    }
+    if (message.size() != sizeof(shm::Notification)) {
+      log_error("streaming client: invalid shared memory notification");
+      return;
+    }
+    shm::Notification notification;
+    std::memcpy(&notification, message.data(), sizeof(notification));
+    if ((_ring == nullptr) || (_ring_generation != notification.generation)) {
+      _ring = shm::SharedMemoryRing::Open(
+          shm::SharedMemoryRing::MakeName(_shm_base_name, notification.generation));
+      if (_ring == nullptr) {
+        log_error("streaming client: failed to open shared memory");
+        return;
+      }
+      _ring_generation = notification.generation;
+    }
+    auto data = _buffer_pool->Pop(notification.size);
+    if (_ring->Read(notification.sequence, data)) {
+      _callback(std::move(data));
+    } else {
+      // 客户端太慢，槽位已被新数据覆盖。
+      log_debug("streaming client: shared memory slot overwritten, message discarded");
+    }
   }
 
 } // namespace tcp
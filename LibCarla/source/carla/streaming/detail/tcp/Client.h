@@ -12,6 +12,7 @@
 #include "carla/profiler/LifetimeProfiled.h"/// \include 包含用于性能分析的生命周期跟踪类定义。
 #include "carla/streaming/detail/Token.h"/// \include 包含流处理中的令牌类定义。
 #include "carla/streaming/detail/Types.h"/// \include 包含流处理中使用的类型别名和常量定义。
+#include "carla/streaming/detail/shm/SharedMemoryRing.h"
 
 #include <boost/asio/deadline_timer.hpp>/// \include 包含Boost.Asio的定时器类定义，用于处理超时事件。
 #include <boost/asio/io_context.hpp>/// \include 包含Boost.Asio的I/O上下文类定义，是异步操作的核心。
@@ -20,6 +21,7 @@
 
 #include <atomic>/// \include 包含C++标准库中的原子操作支持，用于实现线程安全的计数器等。
 #include <functional>/// \include 包含C++标准库中的函数对象支持，用于定义回调和可调用对象。
+#include <string>
 #include <memory>/// \include 包含C++标准库中的智能指针支持，用于管理动态分配的内存。
 
 namespace carla {
@@ -77,8 +79,19 @@ namespace tcp {
     void Reconnect();
     /// @brief 从流中读取数据。
 ///
-/// 此方法从已连接的流中读取数据，并处理这些数据。
+/// 一次读取套接字中所有可用的数据到接收缓冲区，然后交给 ProcessReadBuffer 解析。
     void ReadData();
+    /// @brief 从接收缓冲区中解析出所有完整的消息。
+///
+/// 小消息从接收缓冲区拷贝到缓冲池中的缓冲区，大消息直接读取到目标缓冲区中。
+    void ProcessReadBuffer();
+    /// @brief 将大消息的剩余部分直接读取到 _large_message 中。
+    void ReadLargeMessage(size_t bytes_received);
+    /// @brief 处理一条完整的消息。
+///
+/// 使用共享内存传输时，第一条消息是环形缓冲区的基础名称，之后的消息都是
+/// 通知，数据从环形缓冲区中拷贝出来后再交给回调函数。
+    void OnMessage(Buffer &&message);
     /// @brief 存储流的唯一标识令牌。
 ///
 /// 这是一个常量，用于在客户端的整个生命周期内唯一标识流。
@@ -107,6 +120,24 @@ namespace tcp {
 ///
 /// 这是一个原子布尔值，用于在线程之间安全地表示客户端是否已完成其工作。初始值为false，表示客户端仍在运行。
     std::atomic_bool _done{false};
+    /// @brief 使用的传输方式。请求共享内存后由服务器的回复决定是否改为TCP。
+    shm::TransportRequest _transport_request = shm::TransportRequest::tcp;
+    /// @brief 握手时发送的流ID，请求共享内存时设置了 shm::SHARED_MEMORY_REQUEST_FLAG。
+    stream_id_type _handshake_stream_id = 0u;
+    /// @brief 服务器发送的共享内存环形缓冲区的基础名称。
+    std::string _shm_base_name;
+    /// @brief 当前打开的共享内存环形缓冲区。
+    std::unique_ptr<shm::SharedMemoryRing> _ring;
+    /// @brief 当前打开的环形缓冲区的代数。
+    uint32_t _ring_generation = 0u;
+    /// @brief 接收缓冲区，一次读取可以包含多条带长度前缀的消息。
+    Buffer _read_buffer;
+    /// @brief 接收缓冲区中尚未解析的数据的起始位置。
+    size_t _read_begin = 0u;
+    /// @brief 接收缓冲区中已接收数据的结束位置。
+    size_t _read_end = 0u;
+    /// @brief 正在直接从套接字读取的大消息。
+    Buffer _large_message;
   };
 
 } // namespace tcp
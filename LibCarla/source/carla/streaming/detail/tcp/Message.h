@@ -108,6 +108,12 @@ namespace tcp {
       return MakeListView(begin, begin + _number_of_buffers + 1u);
     }
 
+    /// @brief 获取不包含消息大小头部的缓冲区序列，用于共享内存传输。
+    auto GetPayloadBufferSequence() const {
+      auto begin = _buffer_views.begin();
+      return MakeListView(begin + 1u, begin + _number_of_buffers + 1u);
+    }
+
   private:
       /// @brief 缓冲区数量（不包括_total_size的缓冲区）。
     message_size_type _number_of_buffers = 0u;
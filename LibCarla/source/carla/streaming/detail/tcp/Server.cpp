@@ -29,7 +29,8 @@ namespace tcp {
       ServerSession::callback_function_type on_closed) { // 会话关闭时的回调函数
     using boost::system::error_code; // 使用boost库中的错误代码类型
 
-    auto session = std::make_shared<ServerSession>(_io_context, timeout, *this); // 创建一个新的会话实例，与io_context和超时时间相关联
+    auto session = std::make_shared<ServerSession>(
+        _io_context, timeout, *this, GetSendQueueSettings()); // 创建一个新的会话实例，与io_context和超时时间相关联
 
     auto handle_query = [on_opened, on_closed, session](const error_code &ec) { // 定义一个lambda函数，用于处理异步接受连接的结果
       if (!ec) {
@@ -14,6 +14,7 @@
 #include <boost/asio/ip/tcp.hpp> // 引入Boost库的asio模块中的ip/tcp协议支持类
 #include <boost/asio/post.hpp> // 引入Boost库的asio模块中的post函数，用于在io_context上安排函数执行
 
+#include <mutex>
 #include <atomic> // 引入C++标准库中的原子操作模板，用于线程安全的共享变量操作
 
 namespace carla {
@@ -40,6 +41,17 @@ namespace tcp {
       _timeout = timeout;
     }
 
+    /// 设置会话发送队列的配置，仅对新创建的会话有效。
+    void SetSendQueueSettings(SendQueueSettings settings) {
+      std::lock_guard<std::mutex> lock(_send_queue_mutex);
+      _send_queue = std::move(settings);
+    }
+
+    SendQueueSettings GetSendQueueSettings() const {
+      std::lock_guard<std::mutex> lock(_send_queue_mutex);
+      return _send_queue;
+    }
+
     // 开始监听连接，为每个新连接设置打开和关闭时的回调函数
     //
     template <typename FunctorT1, typename FunctorT2>
@@ -60,6 +72,15 @@ namespace tcp {
       return _synchronous;
     }
 
+    /// 设置是否为同一主机上的客户端提供共享内存传输，仅对新创建的会话有效
+    void SetSharedMemoryEnabled(bool enable) {
+      _shared_memory = enable;
+    }
+
+    bool IsSharedMemoryEnabled() const {
+      return _shared_memory;
+    }
+
   private:
 
     void OpenSession( // 私有方法，用于打开新的会话
@@ -74,6 +95,12 @@ namespace tcp {
     std::atomic<time_duration> _timeout; // 原子操作的超时时间，用于线程安全的超时时间设置
 
     bool _synchronous; // 布尔值，表示服务器是否运行在同步模式
+
+    std::atomic_bool _shared_memory{false}; // 是否提供共享内存传输
+
+    mutable std::mutex _send_queue_mutex; // 保护发送队列配置
+
+    SendQueueSettings _send_queue; // 新会话使用的发送队列配置
   };
 
 } // namespace tcp
@@ -9,14 +9,16 @@
 
 #include "carla/Debug.h"
 #include "carla/Logging.h"
+#include "carla/profiler/Profiler.h"
 
 #include <boost/asio/read.hpp>
 #include <boost/asio/write.hpp>
 #include <boost/asio/bind_executor.hpp>
 #include <boost/asio/post.hpp>
 
+#include <algorithm>
 #include <atomic>
-#include <thread>
+#include <chrono>
 
 namespace carla {
 namespace streaming {
@@ -31,7 +33,8 @@ namespace tcp {
   ServerSession::ServerSession(
       boost::asio::io_context &io_context,
       const time_duration timeout,
-      Server &server)
+      Server &server,
+      SendQueueSettings send_queue)
     : LIBCARLA_INITIALIZE_LIFETIME_PROFILER(
           std::string("tcp server session ") + std::to_string(SESSION_COUNTER)),
       _server(server),
@@ -39,7 +42,10 @@ namespace tcp {
       _socket(io_context),
       _timeout(timeout),
       _deadline(io_context),
-      _strand(io_context) {}
+      _strand(io_context),
+      _send_queue(std::move(send_queue)) {
+    DEBUG_ASSERT(_send_queue.max_size > 0u);
+  }
 // 打开会话的函数
   // @param on_opened 会话打开成功的回调函数
   // @param on_closed 会话关闭的回调函数
@@ -66,10 +72,18 @@ namespace tcp {
         if (!ec) {
         	// 断言接收到的字节数等于流ID的大小
           DEBUG_ASSERT_EQ(bytes_received, sizeof(_stream_id));
+          // 客户端通过流ID的最高位请求共享内存传输
+          const bool shared_memory_requested =
+              (_stream_id & shm::SHARED_MEMORY_REQUEST_FLAG) != 0u;
+          _stream_id &= ~shm::SHARED_MEMORY_REQUEST_FLAG;
           // 打印调试信息，表示会话已启动
           log_debug("session", _session_id, "for stream", _stream_id, " started");
-          // 在strand的上下文环境中执行回调函数
-          boost::asio::post(_strand.context(), [=]() { callback(self); });
+          if (shared_memory_requested) {
+            ReplyTransport(callback);
+          } else {
+            // 在strand的上下文环境中执行回调函数
+            boost::asio::post(_strand.context(), [=]() { callback(self); });
+          }
         } else {
         	// 打印错误信息，表示获取流ID时出错
           log_error("session", _session_id, ": error retrieving stream id :", ec.message());
@@ -87,52 +101,226 @@ namespace tcp {
           boost::asio::bind_executor(_strand, handle_query));
     });
   }
+  void ServerSession::ReplyTransport(callback_function_type on_opened) {
+    // 是否使用共享内存由服务器当前的设置决定，令牌中的协议只表示客户端的请求
+    _transport = _server.IsSharedMemoryEnabled() ?
+        shm::TransportRequest::shared_memory :
+        shm::TransportRequest::tcp;
+    std::string reply(1u, static_cast<char>(_transport));
+    if (UsesSharedMemory()) {
+      // 名称在同一主机上必须唯一，加入时间戳以区分不同的服务器进程
+      const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+      _shm_base_name =
+          "carla-stream-" + std::to_string(now) + "-" + std::to_string(_session_id);
+      log_debug("session", _session_id, ": using shared memory", _shm_base_name);
+      reply += _shm_base_name;
+    }
+    auto self = shared_from_this();
+    auto message = MakeMessage(BufferView::CreateFrom(Buffer(reply)));
+    boost::asio::async_write(_socket, message->GetBufferSequence(),
+        boost::asio::bind_executor(_strand, [this, self, message, on_opened](
+            const boost::system::error_code &ec,
+            size_t) {
+          if (ec) {
+            log_error("session", _session_id, ": error sending transport reply :", ec.message());
+            CloseNow(ec);
+            return;
+          }
+          boost::asio::post(_strand.context(), [=]() { on_opened(self); });
+        }));
+  }
+
+  // 共享内存的通知消息，持有它引用的环形缓冲区。环形缓冲区被更大的替换后，
+  // 队列中尚未发送的旧通知仍然可以读到数据
+  struct SharedMemoryNotification {
+    std::shared_ptr<const Message> message;
+    std::shared_ptr<shm::SharedMemoryRing> ring;
+  };
+
+  ServerSession::message_type ServerSession::WriteToSharedMemory(const Message &message) {
+    if ((_ring == nullptr) || (_ring->slot_capacity() < message.size())) {
+      // 槽位容量不足，创建一个更大的环形缓冲区，客户端通过代数发现新的环形缓冲区。
+      // 预留 25% 的余量以避免激光雷达等大小变化的数据频繁重建。
+      constexpr size_t page_size = 4096u;
+      const size_t capacity =
+          ((message.size() + message.size() / 4u + page_size - 1u) / page_size) * page_size;
+      // 队列中和正在发送的通知各最多 max_size 个，另外预留一个正在写入的槽位
+      const size_t slot_count = 2u * _send_queue.max_size + 2u;
+      ++_ring_generation;
+      _ring = shm::SharedMemoryRing::Create(
+          shm::SharedMemoryRing::MakeName(_shm_base_name, _ring_generation),
+          static_cast<uint32_t>(slot_count),
+          static_cast<uint32_t>(std::min<size_t>(capacity, Buffer::max_size())));
+      if (_ring == nullptr) {
+        log_error("session", _session_id, ": failed to write to shared memory");
+        return nullptr;
+      }
+    }
+    shm::Notification notification;
+    notification.generation = _ring_generation;
+    notification.sequence = _ring->Write(message.GetPayloadBufferSequence());
+    notification.size = static_cast<uint32_t>(message.size());
+    auto result = std::make_shared<SharedMemoryNotification>();
+    result->message = MakeMessage(BufferView::CreateFrom(
+        Buffer(boost::asio::buffer(&notification, sizeof(notification)))));
+    result->ring = _ring;
+    return message_type(result, result->message.get());
+  }
+
 // 向客户端写入消息的函数
   // @param message 要写入的消息指针
   void ServerSession::Write(std::shared_ptr<const Message> message) {
   	// 断言消息不为空且消息内容不为空
     DEBUG_ASSERT(message != nullptr);
     DEBUG_ASSERT(!message->empty());
-    auto self = shared_from_this();
-      if (!_socket.is_open()) {
-        return;
-      }
-      if (_is_writing) {
-        if (_server.IsSynchronousMode()) {
-          // 等待上一条消息发送完毕
-          while (_is_writing) {
-            std::this_thread::yield();
+    CARLA_PROFILE_SCOPE(streaming, session_write);
+    std::unique_lock<std::mutex> lock(_queue_mutex);
+    if (_is_closed || !_socket.is_open()) {
+      return;
+    }
+    if (_queue.size() >= _send_queue.max_size) {
+      // 同步模式下不能丢弃数据，阻塞直到上一批消息发送完毕。
+      const auto policy = _server.IsSynchronousMode() ?
+          SendQueuePolicy::Block :
+          _send_queue.policy;
+      const auto timeout = _server.IsSynchronousMode() ?
+          _timeout :
+          _send_queue.block_timeout;
+      bool drop_message = false;
+      switch (policy) {
+        case SendQueuePolicy::DropOldest: {
+          const auto oldest = std::move(_queue.front());
+          _queue.pop_front();
+          ++_messages_dropped;
+          _bytes_dropped += sizeof(message_size_type) + oldest->size();
+          log_debug("session", _session_id, ": connection too slow: oldest message discarded");
+          break;
+        }
+        case SendQueuePolicy::Block: {
+          drop_message = !_queue_cv.wait_for(lock, timeout.to_chrono(), [this]() {
+            return _is_closed || (_queue.size() < _send_queue.max_size);
+          });
+          if (_is_closed) {
+            return;
           }
-        } else {
-          // 忽略该消息
-          log_debug("session", _session_id, ": connection too slow: message discarded");
-          return;
+          break;
         }
+        default:
+          drop_message = true;
+          break;
+      }
+      if (drop_message) {
+        ++_messages_dropped;
+        _bytes_dropped += sizeof(message_size_type) + message->size();
+        log_debug("session", _session_id, ": connection too slow: message discarded");
+        return;
       }
+    }
+    if (UsesSharedMemory()) {
+      // 确定消息不会被丢弃之后才写入共享内存，TCP连接只发送通知
+      message = WriteToSharedMemory(*message);
+      if (message == nullptr) {
+        return;
+      }
+    }
+    const size_t bytes = sizeof(message_size_type) + message->size();
+    _queue.emplace_back(std::move(message));
+    ++_messages_queued;
+    _bytes_queued += bytes;
+    if (!_is_writing) {
       _is_writing = true;
-// 定义消息发送完成后的回调函数
-      auto handle_sent = [this, self, message](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
-        _is_writing = false;
-        if (ec) {
-        	// 如果发送出错，打印错误信息并立即关闭会话
-          log_info("session", _session_id, ": error sending data :", ec.message());
-          CloseNow(ec);
-        } else {
-        	// 如果发送成功，打印调试信息（可选）并断言发送的字节数正确
-          DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
-          DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type) + message->size());
+      StartWrite(lock);
+    }
+  }
+
+  void ServerSession::StartWrite(std::unique_lock<std::mutex> &lock) {
+    DEBUG_ASSERT(lock.owns_lock());
+    DEBUG_ASSERT(_is_writing);
+    DEBUG_ASSERT(!_queue.empty());
+    DEBUG_ASSERT(_in_flight.empty());
+    // 把队列中所有待发送的消息合并到一次写入中。
+    _gather_buffers.clear();
+    while (!_queue.empty()) {
+      auto &message = _queue.front();
+      for (auto &&buffer : message->GetBufferSequence()) {
+        _gather_buffers.emplace_back(buffer);
+      }
+      _in_flight.emplace_back(std::move(message));
+      _queue.pop_front();
+    }
+    // 队列腾出了空位，唤醒等待中的写入者。
+    _queue_cv.notify_all();
+    log_debug("session", _session_id, ": sending", _in_flight.size(), "messages");
+    // 设置消息发送的截止时间
+    _deadline.expires_from_now(_timeout);
+    // 异步写入消息
+    boost::asio::async_write(_socket, _gather_buffers,
+      boost::asio::bind_executor(_strand,
+          [this, self=shared_from_this()](const boost::system::error_code &ec, size_t bytes) {
+            HandleSent(ec, bytes);
+          }));
+  }
+
+  void ServerSession::HandleSent(const boost::system::error_code &ec, size_t bytes) {
+    CARLA_PROFILE_SCOPE(streaming, session_sent);
+    std::unique_lock<std::mutex> lock(_queue_mutex);
+    if (ec) {
+      // 如果发送出错，丢弃所有待发送的消息并立即关闭会话
+      log_info("session", _session_id, ": error sending data :", ec.message());
+      auto drop_all = [this](const auto &messages) {
+        for (auto &&message : messages) {
+          ++_messages_dropped;
+          _bytes_dropped += sizeof(message_size_type) + message->size();
         }
       };
-// 打印调试信息，表示要发送的消息大小
-      log_debug("session", _session_id, ": sending message of", message->size(), "bytes");
-// 设置消息发送的截止时间
-      _deadline.expires_from_now(_timeout);
-      // 异步写入消息
-      boost::asio::async_write(_socket, message->GetBufferSequence(), 
-        boost::asio::bind_executor(_strand, handle_sent));
+      drop_all(_in_flight);
+      drop_all(_queue);
+      _in_flight.clear();
+      _queue.clear();
+      _is_writing = false;
+      _is_closed = true;
+      _queue_cv.notify_all();
+      lock.unlock();
+      CloseNow(ec);
+      return;
+    }
+    DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
+    _messages_sent += _in_flight.size();
+    _bytes_sent += bytes;
+    _in_flight.clear();
+    if (!_queue.empty()) {
+      StartWrite(lock);
+    } else {
+      _is_writing = false;
+    }
+  }
+
+  SessionStatistics ServerSession::GetStatistics() const {
+    SessionStatistics stats;
+    stats.messages_queued = _messages_queued;
+    stats.messages_dropped = _messages_dropped;
+    stats.messages_sent = _messages_sent;
+    stats.bytes_queued = _bytes_queued;
+    stats.bytes_dropped = _bytes_dropped;
+    stats.bytes_sent = _bytes_sent;
+    return stats;
   }
+
 // 关闭会话的函数
   void ServerSession::Close() {
+    std::unique_lock<std::mutex> lock(_queue_mutex);
+    // 立即拒绝之后的写入。
+    _is_closed = true;
+    _queue_cv.notify_all();
+    if (_strand.context().stopped()) {
+      // 服务器正在销毁，CloseNow 不会再执行。流可能比服务器存活得更久并持有
+      // 这个会话，现在就释放套接字和定时器，之后销毁会话时不再访问 io_context。
+      _deadline.cancel();
+      boost::system::error_code ec;
+      _socket.close(ec);
+      return;
+    }
+    lock.unlock();
     boost::asio::post(_strand, [self=shared_from_this()]() { self->CloseNow(); });
   }
  // 启动定时器的函数，如果定时器已过期则关闭会话，否则设置异步等待定时器到期的回调函数
@@ -153,6 +341,13 @@ namespace tcp {
 // 立即关闭会话的函数，取消定时器，关闭套接字并执行关闭回调函数
   void ServerSession::CloseNow(boost::system::error_code ec) {
     _deadline.cancel();
+    {
+      // 唤醒所有阻塞在发送队列上的写入者，关闭后的消息都会被丢弃。
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      _is_closed = true;
+      _queue.clear();
+    }
+    _queue_cv.notify_all();
     if (!ec)
     {
       if (_socket.is_open()) {
@@ -49,6 +49,7 @@
        * 此类用于表示TCP通信中传输的消息，包括消息头和消息体。
        */
 #include "carla/streaming/detail/tcp/Message.h"
+#include "carla/streaming/detail/shm/SharedMemoryRing.h"
        /**
         * @brief Clang编译器的警告控制区域开始。
         *
@@ -102,6 +103,11 @@
                * 该头文件提供了智能指针、动态内存分配和对象生命周期管理等功能。
                */
 #include <memory>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
                /**
                 * @namespace carla::streaming::detail::tcp
                 * @brief 包含Carla流处理模块中TCP通信的详细实现。
@@ -118,6 +124,33 @@ namespace tcp {
  */
   class Server;
 
+  /// @brief 会话发送队列已满时对新消息的处理策略。
+  enum class SendQueuePolicy : uint8_t {
+    DropOldest, ///< 丢弃队列中最旧的待发送消息，为新消息腾出位置。
+    DropNewest, ///< 丢弃新到达的消息。
+    Block       ///< 阻塞调用线程直到队列有空位，超时后丢弃新消息。
+  };
+
+  /// @brief 会话发送队列的配置。
+  struct SendQueueSettings {
+    /// 队列中最多等待发送的消息数量（不包括正在发送的消息）。
+    size_t max_size = 2u;
+    /// 队列已满时的处理策略。同步模式下总是使用 Block。
+    SendQueuePolicy policy = SendQueuePolicy::DropOldest;
+    /// Block 策略下的最长等待时间。
+    time_duration block_timeout = time_duration::seconds(1u);
+  };
+
+  /// @brief 会话发送统计信息的快照。
+  struct SessionStatistics {
+    size_t messages_queued = 0u;
+    size_t messages_dropped = 0u;
+    size_t messages_sent = 0u;
+    size_t bytes_queued = 0u;
+    size_t bytes_dropped = 0u;
+    size_t bytes_sent = 0u;
+  };
+
   /**
  * @class ServerSession
  * @brief TCP服务器会话类。
@@ -148,11 +181,13 @@ namespace tcp {
      * @param io_context I/O上下文，用于异步操作。
      * @param timeout 不活动超时时间。
      * @param server 对Server对象的引用。
+     * @param send_queue 发送队列的配置。
      */
     explicit ServerSession(
         boost::asio::io_context &io_context,
         time_duration timeout,
-        Server &server);
+        Server &server,
+        SendQueueSettings send_queue = SendQueueSettings());
 
     /**
      * @brief 启动会话。
@@ -196,7 +231,9 @@ namespace tcp {
 
     /// @brief 向套接字写入一些数据。
 /// 
-/// 该函数将一个包含数据的消息对象写入到套接字中。
+/// 该函数将消息放入会话的发送队列。如果当前没有正在进行的写入，
+/// 则立即把队列中所有待发送的消息合并为一次 async_write 发出；
+/// 队列已满时按照 SendQueueSettings::policy 处理。
     void Write(std::shared_ptr<const Message> message);
 
     /// @brief 向套接字写入一些数据（模板函数）。
@@ -212,10 +249,36 @@ namespace tcp {
 
     /// @brief 发布一个关闭会话的任务。
 /// 
-/// 该函数安排一个任务来关闭当前会话，但不会立即关闭。
+/// 该函数安排一个任务来关闭当前会话，但不会立即关闭。之后的写入会被立即丢弃。
     void Close();
 
+    /// @brief 获取发送队列的统计信息，可以从任意线程调用。
+    SessionStatistics GetStatistics() const;
+
   private:
+    using message_type = std::shared_ptr<const Message>;
+
+    /// @brief 回复请求共享内存的客户端实际使用的传输方式，使用共享内存时附带环形缓冲区的基础名称。
+    void ReplyTransport(callback_function_type on_opened);
+
+    /// @brief 客户端是否通过共享内存接收数据。
+    bool UsesSharedMemory() const {
+      return _transport == shm::TransportRequest::shared_memory;
+    }
+
+    /// @brief 将消息写入共享内存环形缓冲区，返回需要通过TCP发送的通知消息。
+    ///
+    /// @warning 调用时必须持有 @a _queue_mutex。
+    /// @return 写入失败时返回 nullptr。
+    message_type WriteToSharedMemory(const Message &message);
+
+    /// @brief 将 @a _queue 中的所有消息移入 @a _in_flight 并发起一次合并写入。
+    ///
+    /// @warning 调用时必须持有 @a _queue_mutex，且 @a _is_writing 必须为 true。
+    void StartWrite(std::unique_lock<std::mutex> &lock);
+    /// @brief 写入完成后的处理，更新统计信息并继续发送队列中的消息。
+    void HandleSent(const boost::system::error_code &ec, size_t bytes);
+
       /// @brief 启动定时器。
 /// 
 /// 该函数用于启动一个定时器，该定时器在会话空闲时间超过指定时长后触发关闭操作。
@@ -243,8 +306,37 @@ namespace tcp {
     boost::asio::io_context::strand _strand;
     /// @brief 会话关闭时的回调函数。
     callback_function_type _on_closed;
+    /// @brief 发送队列的配置。
+    const SendQueueSettings _send_queue;
+    /// @brief 会话使用的传输方式。
+    shm::TransportRequest _transport = shm::TransportRequest::tcp;
+    /// @brief 共享内存环形缓冲区的基础名称。
+    std::string _shm_base_name;
+    /// @brief 当前使用的共享内存环形缓冲区，尚未发送的通知消息也持有它。
+    std::shared_ptr<shm::SharedMemoryRing> _ring;
+    /// @brief 环形缓冲区的代数，每次重新创建时递增。
+    uint32_t _ring_generation = 0u;
+    /// @brief 保护发送队列及写入状态的互斥锁。
+    mutable std::mutex _queue_mutex;
+    /// @brief Block 策略下等待队列空位的条件变量。
+    std::condition_variable _queue_cv;
+    /// @brief 等待发送的消息。
+    std::deque<message_type> _queue;
+    /// @brief 正在通过 async_write 发送的消息，写入完成前保持其缓冲区存活。
+    std::vector<message_type> _in_flight;
+    /// @brief 合并写入所使用的缓冲区序列，在多次写入之间复用。
+    std::vector<boost::asio::const_buffer> _gather_buffers;
     /// @brief 表示当前是否正在进行写入操作的标志。
     bool _is_writing = false;
+    /// @brief 会话是否已关闭，关闭后不再接受新消息。
+    bool _is_closed = false;
+
+    std::atomic_size_t _messages_queued{0u};
+    std::atomic_size_t _messages_dropped{0u};
+    std::atomic_size_t _messages_sent{0u};
+    std::atomic_size_t _bytes_queued{0u};
+    std::atomic_size_t _bytes_dropped{0u};
+    std::atomic_size_t _bytes_sent{0u};
   };
 
 } // namespace tcp
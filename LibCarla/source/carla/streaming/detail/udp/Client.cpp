@@ -0,0 +1,165 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/udp/Client.h"
+
+#include "carla/BufferPool.h"
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/ip/multicast.hpp>
+
+#include <cstring>
+#include <exception>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace udp {
+
+  Client::Client(
+      boost::asio::io_context &io_context,
+      const token_type &token,
+      callback_function_type callback)
+    : LIBCARLA_INITIALIZE_LIFETIME_PROFILER(
+          std::string("udp client ") + std::to_string(token.get_stream_id())),
+      _token(token),
+      _callback(std::move(callback)),
+      _socket(io_context),
+      _strand(io_context),
+      _buffer_pool(std::make_shared<BufferPool>()) {
+    if (!_token.protocol_is_udp()) {
+      throw_exception(std::invalid_argument("invalid token, only UDP tokens supported"));
+    }
+  }
+
+  Client::~Client() = default;
+
+  void Client::Connect() {
+    if (_done) {
+      return;
+    }
+    DEBUG_ASSERT(_token.is_valid());
+    const auto group = _token.to_udp_endpoint();
+    // 绑定到组播端口的任意地址，同一主机上的多个客户端可以共享端口。
+    const endpoint listen_ep(
+        group.address().is_v6() ?
+            boost::asio::ip::address(boost::asio::ip::address_v6::any()) :
+            boost::asio::ip::address(boost::asio::ip::address_v4::any()),
+        group.port());
+    _socket.open(listen_ep.protocol());
+    _socket.set_option(boost::asio::ip::udp::socket::reuse_address(true));
+    _socket.set_option(boost::asio::socket_base::receive_buffer_size(8 * 1024 * 1024));
+    _socket.bind(listen_ep);
+    _socket.set_option(boost::asio::ip::multicast::join_group(group.address()));
+    log_debug("streaming client: joined multicast group", group);
+    ReadDatagram();
+  }
+
+  void Client::Stop() {
+    _done = true;
+    auto self = shared_from_this();
+    boost::asio::post(_strand, [this, self]() {
+      if (_socket.is_open()) {
+        boost::system::error_code ec;
+        _socket.close(ec);
+      }
+    });
+  }
+
+  MulticastStatistics Client::GetStatistics() const {
+    MulticastStatistics stats;
+    stats.messages_received = _messages_received;
+    stats.messages_lost = _messages_lost;
+    stats.fragments_received = _number_of_fragments;
+    stats.bytes_received = _bytes_received;
+    return stats;
+  }
+
+  void Client::ReadDatagram() {
+    if (_done) {
+      return;
+    }
+    auto self = shared_from_this();
+    _socket.async_receive_from(
+        boost::asio::buffer(_datagram),
+        _sender,
+        boost::asio::bind_executor(_strand, [this, self](boost::system::error_code ec, size_t bytes) {
+          if (_done) {
+            return;
+          }
+          if (!ec) {
+            HandleDatagram(bytes);
+          } else {
+            log_debug("streaming client: failed to receive datagram:", ec.message());
+          }
+          ReadDatagram();
+        }));
+  }
+
+  void Client::DropPartialMessage() {
+    if (_fragments_pending > 0u) {
+      ++_messages_lost;
+      _fragments_pending = 0u;
+    }
+  }
+
+  void Client::HandleDatagram(const size_t bytes) {
+    if (bytes < sizeof(FragmentHeader)) {
+      return;
+    }
+    FragmentHeader header;
+    std::memcpy(&header, _datagram.data(), sizeof(header));
+    if (header.stream_id != _token.get_stream_id()) {
+      return;
+    }
+    const size_t payload_size = bytes - sizeof(FragmentHeader);
+    if ((header.fragment_count == 0u) ||
+        (header.fragment_index >= header.fragment_count) ||
+        (header.message_size > MAX_MULTICAST_MESSAGE_SIZE) ||
+        (static_cast<size_t>(header.fragment_offset) + payload_size > header.message_size)) {
+      log_debug("streaming client: invalid multicast fragment");
+      return;
+    }
+    ++_number_of_fragments;
+    _bytes_received += bytes;
+
+    // 序列号比当前更新：开始组装新消息，之前未完成的消息以及中间跳过的消息都计为丢失。
+    if (header.sequence != _message_sequence) {
+      if ((_message_sequence != 0u) &&
+          (static_cast<int32_t>(header.sequence - _message_sequence) < 0)) {
+        return; // 过期的分片。
+      }
+      DropPartialMessage();
+      if (_message_sequence != 0u) {
+        _messages_lost += header.sequence - _message_sequence - 1u;
+      }
+      _message_sequence = header.sequence;
+      _message = _buffer_pool->Pop(header.message_size);
+      _fragments_received.assign(header.fragment_count, false);
+      _fragments_pending = header.fragment_count;
+    }
+    if ((_fragments_received.size() != header.fragment_count) ||
+        _fragments_received[header.fragment_index]) {
+      return;
+    }
+    _fragments_received[header.fragment_index] = true;
+    std::memcpy(
+        _message.data() + header.fragment_offset,
+        _datagram.data() + sizeof(FragmentHeader),
+        payload_size);
+    if (--_fragments_pending == 0u) {
+      ++_messages_received;
+      _callback(std::move(_message));
+    }
+  }
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,117 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/profiler/LifetimeProfiled.h"
+#include "carla/streaming/detail/Token.h"
+#include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/udp/Fragment.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace carla {
+
+  class BufferPool;
+
+namespace streaming {
+namespace detail {
+namespace udp {
+
+  /// 订阅单个组播流的客户端。加入令牌中的组播组，按流ID过滤分片并
+  /// 重新组装消息，不完整或序列号跳过的消息计为丢失。
+  ///
+  /// @warning 在释放共享指针之前，应该先停止这个客户端，否则它将不会被销毁。
+  class Client
+    : public std::enable_shared_from_this<Client>,
+      private profiler::LifetimeProfiled,
+      private NonCopyable {
+  public:
+
+    using endpoint = boost::asio::ip::udp::endpoint;
+
+    using protocol_type = endpoint::protocol_type;
+
+    using callback_function_type = std::function<void (Buffer)>;
+
+    Client(
+        boost::asio::io_context &io_context,
+        const token_type &token,
+        callback_function_type callback);
+
+    ~Client();
+
+    /// 加入组播组并开始接收。
+    void Connect();
+
+    stream_id_type GetStreamId() const {
+      return _token.get_stream_id();
+    }
+
+    void Stop();
+
+    /// 接收统计信息的快照，可以从任意线程调用。
+    MulticastStatistics GetStatistics() const;
+
+  private:
+
+    void ReadDatagram();
+
+    void HandleDatagram(size_t bytes);
+
+    /// 放弃正在组装的消息并计为丢失。
+    void DropPartialMessage();
+
+    const token_type _token;
+
+    callback_function_type _callback;
+
+    boost::asio::ip::udp::socket _socket;
+
+    boost::asio::io_context::strand _strand;
+
+    std::shared_ptr<BufferPool> _buffer_pool;
+
+    /// 接收单个数据报的缓冲区，UDP数据报最大为64KB。
+    std::array<unsigned char, 65536u> _datagram;
+
+    endpoint _sender;
+
+    /// 正在组装的消息。
+    Buffer _message;
+
+    /// 最近一条开始组装的消息的序列号。
+    uint32_t _message_sequence = 0u;
+
+    size_t _fragments_pending = 0u;
+
+    std::vector<bool> _fragments_received;
+
+    std::atomic_size_t _messages_received{0u};
+
+    std::atomic_size_t _messages_lost{0u};
+
+    std::atomic_size_t _number_of_fragments{0u};
+
+    std::atomic_size_t _bytes_received{0u};
+
+    std::atomic_bool _done{false};
+  };
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,80 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/streaming/detail/Types.h"
+
+#include <boost/asio/ip/address.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace udp {
+
+#pragma pack(push, 1)
+  /// 每个UDP数据报开头的分片头。一条消息被拆分为多个分片，客户端按照
+  /// @a fragment_offset 把分片重新组装到同一个缓冲区中。
+  struct FragmentHeader {
+    /// 消息所属的流。同一个组播组中可以有多个流，客户端据此过滤。
+    stream_id_type stream_id = 0u;
+    /// 消息在流中的序列号，从1开始递增，用于统计丢失的消息。
+    uint32_t sequence = 0u;
+    /// 整条消息的大小（字节）。
+    message_size_type message_size = 0u;
+    /// 本分片数据在消息中的偏移量。
+    uint32_t fragment_offset = 0u;
+    /// 本分片的索引。
+    uint16_t fragment_index = 0u;
+    /// 消息的分片总数。
+    uint16_t fragment_count = 0u;
+  };
+#pragma pack(pop)
+
+  static_assert(sizeof(FragmentHeader) == 20u, "Unexpected fragment header size.");
+
+  /// 组播消息的最大大小（字节），客户端拒绝声明更大消息的分片。
+  constexpr size_t MAX_MULTICAST_MESSAGE_SIZE = 256u * 1024u * 1024u;
+
+  /// 组播传输的配置。
+  struct MulticastSettings {
+    /// 第一个组播组的地址。
+    std::string group_address = "239.255.0.1";
+    /// 第一个组播组的端口。
+    uint16_t port = 2004u;
+    /// 可用的组播组数量。每个流使用一个组，地址和端口从 @a group_address
+    /// 和 @a port 开始递增，流的数量超过组数量时循环使用。
+    uint16_t group_count = 256u;
+    /// 组播数据报的生存跳数。
+    int hops = 1;
+    /// 是否在本机回环组播数据（同一主机上的客户端需要开启）。
+    bool loopback = true;
+    /// 单个UDP数据报的最大大小（包括分片头），默认值避免IP分片。
+    size_t max_datagram_size = 1472u;
+    /// 每次连续发送的数据报数量，之后按照 @a max_bytes_per_second 限速。
+    size_t burst_size = 64u;
+    /// 发送速率上限（字节/秒），默认约 1Gbit/s，0 表示不限制。
+    size_t max_bytes_per_second = 125000000u;
+    /// 每个流等待发送的消息数量上限，超出时丢弃这个流最早的消息。
+    size_t max_pending_messages = 8u;
+  };
+
+  /// 组播客户端的接收统计信息。
+  struct MulticastStatistics {
+    size_t messages_received = 0u;
+    size_t messages_lost = 0u;
+    size_t fragments_received = 0u;
+    size_t bytes_received = 0u;
+  };
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
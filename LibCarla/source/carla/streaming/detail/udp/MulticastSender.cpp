@@ -0,0 +1,229 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/udp/MulticastSender.h"
+
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/ip/multicast.hpp>
+#include <boost/asio/post.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace udp {
+
+  /// 把组播地址向后偏移 @a offset 个地址。
+  static boost::asio::ip::address OffsetAddress(
+      const boost::asio::ip::address &address,
+      uint32_t offset) {
+    if (address.is_v4()) {
+      return boost::asio::ip::address_v4(address.to_v4().to_uint() + offset);
+    }
+    auto bytes = address.to_v6().to_bytes();
+    for (auto i = bytes.size(); (offset > 0u) && (i > 0u); --i) {
+      const uint32_t sum = bytes[i - 1u] + (offset & 0xFFu);
+      bytes[i - 1u] = static_cast<unsigned char>(sum);
+      offset = (offset >> 8u) + (sum >> 8u);
+    }
+    return boost::asio::ip::address_v6(bytes);
+  }
+
+  MulticastSender::MulticastSender(
+      boost::asio::io_context &io_context,
+      MulticastSettings settings)
+    : _settings(std::move(settings)),
+      _first_group(boost::asio::ip::make_address(_settings.group_address)),
+      _socket(io_context, endpoint(_first_group, _settings.port).protocol()),
+      _strand(io_context),
+      _timer(io_context) {
+    if (_settings.group_count == 0u) {
+      throw_exception(std::invalid_argument("multicast group count must be positive"));
+    }
+    const uint32_t last = _settings.group_count - 1u;
+    if (!_first_group.is_multicast() || !OffsetAddress(_first_group, last).is_multicast()) {
+      throw_exception(std::invalid_argument(
+          "invalid multicast group address: " + _settings.group_address));
+    }
+    if (_settings.port + last > std::numeric_limits<uint16_t>::max()) {
+      throw_exception(std::invalid_argument("multicast port range out of bounds"));
+    }
+    if (_settings.max_datagram_size <= sizeof(FragmentHeader)) {
+      throw_exception(std::invalid_argument("multicast datagram size too small"));
+    }
+    _socket.set_option(boost::asio::ip::multicast::hops(_settings.hops));
+    _socket.set_option(boost::asio::ip::multicast::enable_loopback(_settings.loopback));
+    _datagram.reserve(4u);
+  }
+
+  void MulticastSender::Close() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _is_closed = true;
+    _pending.clear();
+    _ready_streams.clear();
+  }
+
+  MulticastSender::endpoint MulticastSender::MakeGroupEndpoint() {
+    const uint32_t index = _next_group++ % _settings.group_count;
+    return endpoint(
+        OffsetAddress(_first_group, index),
+        static_cast<uint16_t>(_settings.port + index));
+  }
+
+  void MulticastSender::RemoveStream(const stream_id_type stream_id) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _pending.erase(stream_id);
+    _ready_streams.erase(
+        std::remove(_ready_streams.begin(), _ready_streams.end(), stream_id),
+        _ready_streams.end());
+  }
+
+  size_t MulticastSender::GetNumberOfMessagesDropped(const stream_id_type stream_id) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto search = _pending.find(stream_id);
+    return search != _pending.end() ? search->second.messages_dropped : 0u;
+  }
+
+  void MulticastSender::Enqueue(
+      const stream_id_type stream_id,
+      const uint32_t sequence,
+      PendingMessage pending) {
+    const size_t message_size = boost::asio::buffer_size(pending.payloads);
+    const size_t fragment_size = _settings.max_datagram_size - sizeof(FragmentHeader);
+    const size_t fragment_count = std::max<size_t>(1u, (message_size + fragment_size - 1u) / fragment_size);
+    if ((message_size > MAX_MULTICAST_MESSAGE_SIZE) ||
+        (fragment_count > std::numeric_limits<uint16_t>::max())) {
+      log_error("multicast: message of", message_size, "bytes is too big, discarded");
+      return;
+    }
+    pending.header.stream_id = stream_id;
+    pending.header.sequence = sequence;
+    pending.header.message_size = static_cast<message_size_type>(message_size);
+    pending.header.fragment_count = static_cast<uint16_t>(fragment_count);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_is_closed) {
+      return;
+    }
+    auto &queue = _pending[stream_id];
+    if (queue.messages.empty()) {
+      _ready_streams.emplace_back(stream_id);
+    } else if (queue.messages.size() >= std::max<size_t>(1u, _settings.max_pending_messages)) {
+      queue.messages.pop_front();
+      ++queue.messages_dropped;
+      ++_messages_dropped;
+      log_debug("multicast: too many pending messages (stream", stream_id, "): message discarded");
+    }
+    queue.messages.emplace_back(std::move(pending));
+    if (!_is_sending) {
+      _is_sending = true;
+      auto self = shared_from_this();
+      boost::asio::post(_strand, [this, self]() { SendNextMessage(); });
+    }
+  }
+
+  void MulticastSender::SendNextMessage() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_ready_streams.empty()) {
+        _is_sending = false;
+        _current = PendingMessage();
+        return;
+      }
+      // 每个流发送一条消息后排到队尾，各个流轮流发送。
+      const auto stream_id = _ready_streams.front();
+      _ready_streams.pop_front();
+      auto &queue = _pending[stream_id];
+      DEBUG_ASSERT(!queue.messages.empty());
+      _current = std::move(queue.messages.front());
+      queue.messages.pop_front();
+      if (!queue.messages.empty()) {
+        _ready_streams.emplace_back(stream_id);
+      }
+    }
+    _current.header.fragment_index = 0u;
+    _current_buffer = _current.payloads.begin();
+    _current_offset = 0u;
+    SendNextFragment();
+  }
+
+  void MulticastSender::SendNextFragment() {
+    auto &header = _current.header;
+    if (header.fragment_index == header.fragment_count) {
+      SendNextMessage();
+      return;
+    }
+
+    // 每发送一批数据报，等待到发送速率不超过上限为止。
+    if (_burst_datagrams >= std::max<size_t>(1u, _settings.burst_size)) {
+      const auto now = std::chrono::steady_clock::now();
+      auto next_burst = now;
+      if (_settings.max_bytes_per_second > 0u) {
+        next_burst = _burst_start + std::chrono::microseconds(
+            _burst_bytes * 1000000u / _settings.max_bytes_per_second);
+      }
+      _burst_start = std::max(now, next_burst);
+      _burst_datagrams = 0u;
+      _burst_bytes = 0u;
+      if (next_burst > now) {
+        auto self = shared_from_this();
+        _timer.expires_at(next_burst);
+        _timer.async_wait(boost::asio::bind_executor(_strand, [this, self](boost::system::error_code) {
+          SendNextFragment();
+        }));
+        return;
+      }
+    }
+
+    // 遍历缓冲区序列，每个分片可能跨越多个缓冲区。
+    const size_t message_size = header.message_size;
+    const size_t fragment_size = _settings.max_datagram_size - sizeof(FragmentHeader);
+    header.fragment_offset = static_cast<uint32_t>(header.fragment_index * fragment_size);
+    _datagram.clear();
+    _datagram.emplace_back(boost::asio::buffer(&header, sizeof(header)));
+    size_t remaining = std::min(fragment_size, message_size - header.fragment_offset);
+    while ((remaining > 0u) && (_current_buffer != _current.payloads.end())) {
+      const auto available = boost::asio::buffer_size(*_current_buffer) - _current_offset;
+      const auto size = std::min(available, remaining);
+      _datagram.emplace_back(boost::asio::buffer(*_current_buffer + _current_offset, size));
+      remaining -= size;
+      _current_offset += size;
+      if (_current_offset == boost::asio::buffer_size(*_current_buffer)) {
+        ++_current_buffer;
+        _current_offset = 0u;
+      }
+    }
+
+    auto self = shared_from_this();
+    _socket.async_send_to(
+        _datagram,
+        _current.group,
+        boost::asio::bind_executor(_strand, [this, self](boost::system::error_code ec, size_t bytes) {
+          if (ec) {
+            // 放弃这条消息剩下的分片，客户端会把它计为丢失。
+            log_debug("multicast: failed to send datagram:", ec.message());
+            SendNextMessage();
+            return;
+          }
+          ++_datagrams_sent;
+          ++_burst_datagrams;
+          _burst_bytes += bytes;
+          ++_current.header.fragment_index;
+          SendNextFragment();
+        }));
+  }
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,167 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/udp/Fragment.h"
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace udp {
+
+  /// 把消息拆分为分片并发送到组播组。无论有多少客户端订阅，每条消息
+  /// 只序列化和发送一次。所有组播流共享同一个发送者，但每个流使用各自的
+  /// 组播组和端口，客户端只会收到订阅的流的数据报。
+  ///
+  /// 分片在 io_context 上异步发送，每发送 @a burst_size 个数据报按照
+  /// @a max_bytes_per_second 限速，调用 Write 的线程不会被阻塞。
+  ///
+  /// 每个流有自己的等待队列，队列长度上限为 @a max_pending_messages，超出时
+  /// 只丢弃这个流最早的消息；各个流的消息轮流发送，一个流的突发写入不会
+  /// 挤掉其他流的消息。
+  class MulticastSender
+    : public std::enable_shared_from_this<MulticastSender>,
+      private NonCopyable {
+  public:
+
+    using endpoint = boost::asio::ip::udp::endpoint;
+
+    MulticastSender(boost::asio::io_context &io_context, MulticastSettings settings);
+
+    const MulticastSettings &GetSettings() const {
+      return _settings;
+    }
+
+    /// 停止发送，之后写入的消息都会被丢弃。必须在 io_context 销毁之前调用。
+    void Close();
+
+    /// 为新的流分配一个组播组，可以从任意线程调用。
+    endpoint MakeGroupEndpoint();
+
+    /// 丢弃流 @a stream_id 等待发送的消息和统计信息，在流关闭时调用。
+    void RemoveStream(stream_id_type stream_id);
+
+    /// 把 @a message 排队发送到 @a group，可以从任意线程调用。发送完成之前
+    /// 保持 @a message 存活。
+    template <typename MessageT>
+    void Write(
+        const endpoint &group,
+        stream_id_type stream_id,
+        uint32_t sequence,
+        std::shared_ptr<const MessageT> message) {
+      PendingMessage pending;
+      pending.group = group;
+      for (auto &&buffer : message->GetPayloadBufferSequence()) {
+        pending.payloads.emplace_back(buffer);
+      }
+      pending.data = std::move(message);
+      Enqueue(stream_id, sequence, std::move(pending));
+    }
+
+    /// 已发送的数据报数量。
+    size_t GetNumberOfDatagramsSent() const {
+      return _datagrams_sent;
+    }
+
+    /// 所有流因为等待发送的消息过多而丢弃的消息数量。
+    size_t GetNumberOfMessagesDropped() const {
+      return _messages_dropped;
+    }
+
+    /// 流 @a stream_id 因为等待发送的消息过多而丢弃的消息数量。
+    size_t GetNumberOfMessagesDropped(stream_id_type stream_id) const;
+
+  private:
+
+    struct PendingMessage {
+      endpoint group;
+      FragmentHeader header;
+      std::vector<boost::asio::const_buffer> payloads;
+      /// 持有 @a payloads 引用的数据。
+      std::shared_ptr<const void> data;
+    };
+
+    /// 一个流等待发送的消息。
+    struct StreamQueue {
+      std::deque<PendingMessage> messages;
+      size_t messages_dropped = 0u;
+    };
+
+    void Enqueue(stream_id_type stream_id, uint32_t sequence, PendingMessage pending);
+
+    /// @pre 只在 @a _strand 中调用，以下同。
+    void SendNextMessage();
+
+    void SendNextFragment();
+
+    const MulticastSettings _settings;
+
+    const boost::asio::ip::address _first_group;
+
+    boost::asio::ip::udp::socket _socket;
+
+    boost::asio::io_context::strand _strand;
+
+    boost::asio::steady_timer _timer;
+
+    std::atomic_uint32_t _next_group{0u};
+
+    mutable std::mutex _mutex;
+
+    /// 每个流等待发送的消息，由 @a _mutex 保护。
+    std::unordered_map<stream_id_type, StreamQueue> _pending;
+
+    /// 有消息等待发送的流，按轮流发送的顺序排列，由 @a _mutex 保护。
+    std::deque<stream_id_type> _ready_streams;
+
+    /// 是否有正在发送的消息，由 @a _mutex 保护。
+    bool _is_sending = false;
+
+    /// 是否已经停止发送，由 @a _mutex 保护。
+    bool _is_closed = false;
+
+    /// 正在发送的消息及其进度。
+    PendingMessage _current;
+
+    std::vector<boost::asio::const_buffer>::const_iterator _current_buffer;
+
+    size_t _current_offset = 0u;
+
+    std::vector<boost::asio::const_buffer> _datagram;
+
+    /// 当前这一批数据报开始发送的时间和已发送的数量。
+    std::chrono::steady_clock::time_point _burst_start;
+
+    size_t _burst_datagrams = 0u;
+
+    size_t _burst_bytes = 0u;
+
+    std::atomic_size_t _datagrams_sent{0u};
+
+    std::atomic_size_t _messages_dropped{0u};
+  };
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -74,6 +74,12 @@ namespace low_level {
       }
     }
 
+    /// 返回订阅 @a token 对应的流的客户端，没有订阅时返回 nullptr。
+    std::shared_ptr<underlying_client> FindClient(const token_type &token) const {
+      auto it = _clients.find(token.get_stream_id());
+      return it != _clients.end() ? it->second : nullptr;
+    }
+
   private:	
 
     boost::asio::ip::address _fallback_address;	// 存储备用的IP地址，在构造函数中进行初始化，可能在流连接出现问题需要使用备用地址时发挥作用
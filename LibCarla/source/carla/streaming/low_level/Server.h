@@ -38,7 +38,8 @@ namespace low_level {
         boost::asio::io_context &io_context, // 输入 IO 上下文引用
         detail::EndPoint<protocol_type, InternalEPType> internal_ep, // 内部端点
         detail::EndPoint<protocol_type, ExternalEPType> external_ep) // 外部端点
-      : _server(io_context, std::move(internal_ep)), // 初始化底层服务器
+      : _io_context(io_context),
+        _server(io_context, std::move(internal_ep)), // 初始化底层服务器
         _dispatcher(std::move(external_ep)) { // 初始化调度器
       StartServer(); // 启动服务器
     }
@@ -48,7 +49,8 @@ namespace low_level {
     explicit Server(
         boost::asio::io_context &io_context, // 输入 IO 上下文引用
         detail::EndPoint<protocol_type, InternalEPType> internal_ep) // 内部端点
-      : _server(io_context, std::move(internal_ep)), // 初始化底层服务器
+      : _io_context(io_context),
+        _server(io_context, std::move(internal_ep)), // 初始化底层服务器
         _dispatcher(make_endpoint<protocol_type>(_server.GetLocalEndpoint().port())) { // 创建调度器
       StartServer(); // 启动服务器
     }
@@ -68,11 +70,25 @@ namespace low_level {
       _server.SetTimeout(timeout); // 设置底层服务器的超时时间
     }
 
+    // 设置会话发送队列的配置
+    template <typename SettingsT>
+    void SetSendQueueSettings(SettingsT &&settings) {
+      _server.SetSendQueueSettings(std::forward<SettingsT>(settings)); // 仅对新会话有效
+    }
     // 创建流
     Stream MakeStream() {
       return _dispatcher.MakeStream(); // 调用调度器创建流
     }
 
+    // 启用UDP组播，之后可以通过 MakeMulticastStream 创建组播流
+    void EnableMulticast(detail::udp::MulticastSettings settings) {
+      _dispatcher.SetMulticastSender(
+          std::make_shared<detail::udp::MulticastSender>(_io_context, std::move(settings)));
+    }
+    // 创建组播流
+    Stream MakeMulticastStream() {
+      return _dispatcher.MakeMulticastStream();
+    }
     // 关闭指定的流
     void CloseStream(carla::streaming::detail::stream_id_type id) {
       return _dispatcher.CloseStream(id); // 调用调度器关闭流
@@ -83,6 +99,11 @@ namespace low_level {
       _server.SetSynchronousMode(is_synchro); // 设置底层服务器的同步模式
     }
 
+    // 为同一主机上的客户端启用共享内存传输，仅影响之后创建的流和会话
+    void SetSharedMemoryEnabled(bool enable) {
+      _server.SetSharedMemoryEnabled(enable);
+      _dispatcher.SetSharedMemoryEnabled(enable);
+    }
     // 获取流的令牌
     token_type GetToken(stream_id sensor_id) {
       return _dispatcher.GetToken(sensor_id); // 从调度器获取流的令牌
@@ -121,6 +142,7 @@ namespace low_level {
       _server.Listen(on_session_opened, on_session_closed); // 开始监听会话
     }
 
+    boost::asio::io_context &_io_context; // IO 上下文，用于创建组播套接字
     underlying_server _server; // 底层服务器实例
 
     detail::Dispatcher _dispatcher; // 调度器实例
@@ -121,6 +121,7 @@ ReadValue<bool>(in_file, this->is_junction); // 从文件中读取是否为交
 
 // road_option
 ReadValue<uint8_t>(in_file, this->road_option); // 从文件中读取道路选项
+  }
 
 void CachedSimpleWaypoint::Read(const std::vector<uint8_t>& content, unsigned long& start) {
     ReadValue<uint64_t>(content, start, this->waypoint_id); // 从字节数组中读取路径点ID
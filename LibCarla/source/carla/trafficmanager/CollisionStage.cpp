@@ -41,19 +41,21 @@ void CollisionStage::Update(const unsigned long index) {
   // 获取当前车辆的ID
   const ActorId ego_actor_id = vehicle_id_list.at(index);
   if (simulation_state.ContainsActor(ego_actor_id)) { // 检查仿真中是否包含此车辆
-    const cg::Location ego_location = simulation_state.GetLocation(ego_actor_id); // 获取车辆当前位置
+    const size_t ego_slot = simulation_state.GetSlot(ego_actor_id); // 获取车辆在仿真状态中的槽位
+    const cg::Location ego_location = simulation_state.GetLocationAt(ego_slot); // 获取车辆当前位置
     const Buffer &ego_buffer = buffer_map.at(ego_actor_id); // 获取车辆的路径缓存
     const unsigned long look_ahead_index = GetTargetWaypoint(ego_buffer, JUNCTION_LOOK_AHEAD).second; // 计算前瞻路径点索引
-    const float velocity = simulation_state.GetVelocity(ego_actor_id).Length(); // 获取车辆速度
+    const float velocity = simulation_state.GetVelocityAt(ego_slot).Length(); // 获取车辆速度
 
     // 获取与当前车辆路径重叠的其他车辆ID
     ActorIdSet overlapping_actors = track_traffic.GetOverlappingVehicles(ego_actor_id);
-    std::vector<ActorId> collision_candidate_ids; // 碰撞候选车辆ID列表
+    // 碰撞候选车辆与自车距离的平方及其ID列表
+    std::vector<std::pair<float, ActorId>> collision_candidates;
     // 根据速度和参数计算碰撞检测的最大半径平方
     const float distance_to_leading = parameters.GetDistanceToLeadingVehicle(ego_actor_id); // 获取前车的安全距离
     float collision_radius_square = SQUARE(COLLISION_RADIUS_RATE * velocity + COLLISION_RADIUS_MIN); // 碰撞半径平方
     if (velocity < 2.0f) { // 如果车辆速度较低
-      const float length = simulation_state.GetDimensions(ego_actor_id).x; // 获取车辆长度
+      const float length = simulation_state.GetDimensionsAt(ego_slot).x; // 获取车辆长度
       const float collision_radius_stop = COLLISION_RADIUS_STOP + length; // 设置静止时的碰撞半径
       collision_radius_square = SQUARE(collision_radius_stop);
     }
@@ -64,29 +66,26 @@ void CollisionStage::Update(const unsigned long index) {
     // 遍历重叠路径上的其他车辆，筛选碰撞候选车辆
     for (ActorId overlapping_actor_id : overlapping_actors) {
       // 如果其他车辆在最大碰撞避免范围内，并且垂直方向有重叠
-      const cg::Location &overlapping_actor_location = simulation_state.GetLocation(overlapping_actor_id); // 获取重叠车辆的位置
+      const cg::Location &overlapping_actor_location = simulation_state.GetLocationAt(simulation_state.GetSlot(overlapping_actor_id)); // 获取重叠车辆的位置
+      const float distance_square = cg::Math::DistanceSquared(overlapping_actor_location, ego_location);
       if (overlapping_actor_id != ego_actor_id // 排除自身
-          && cg::Math::DistanceSquared(overlapping_actor_location, ego_location) < collision_radius_square  // 检测是否在碰撞半径范围内
+          && distance_square < collision_radius_square  // 检测是否在碰撞半径范围内
           && std::abs(ego_location.z - overlapping_actor_location.z) < VERTICAL_OVERLAP_THRESHOLD) { // 检测垂直方向的重叠
-        collision_candidate_ids.push_back(overlapping_actor_id); // 添加到碰撞候选列表
+        collision_candidates.emplace_back(distance_square, overlapping_actor_id); // 添加到碰撞候选列表
       }
     }
 
-    // 按与自车的距离对潜在碰撞对象进行升序排序
-    std::sort(collision_candidate_ids.begin(), collision_candidate_ids.end(),
-              [this, &ego_location](const ActorId &a_id_1, const ActorId &a_id_2) {
-                const cg::Location &e_loc = ego_location; // 自车位置
-                const cg::Location &loc_1 = simulation_state.GetLocation(a_id_1); // 对象1的位置
-                const cg::Location &loc_2 = simulation_state.GetLocation(a_id_2); // 对象2的位置
-                // 按距离平方排序，避免使用平方根计算，提升性能
-                return (cg::Math::DistanceSquared(e_loc, loc_1) < cg::Math::DistanceSquared(e_loc, loc_2));
+    // 按与自车的距离对潜在碰撞对象进行升序排序，距离已在筛选时算好，排序时不再查询位置
+    std::sort(collision_candidates.begin(), collision_candidates.end(),
+              [](const std::pair<float, ActorId> &a, const std::pair<float, ActorId> &b) {
+                return a.first < b.first;
               });
 
     // 遍历排序后的对象，检查每个对象是否构成碰撞威胁
-    for (auto iter = collision_candidate_ids.begin();
-         iter != collision_candidate_ids.end() && !collision_hazard;
+    for (auto iter = collision_candidates.begin();
+         iter != collision_candidates.end() && !collision_hazard;
          ++iter) {
-      const ActorId other_actor_id = *iter; // 当前检查的对象ID
+      const ActorId other_actor_id = iter->second; // 当前检查的对象ID
       const ActorType other_actor_type = simulation_state.GetType(other_actor_id); // 对象的类型（车辆/行人）
       // 检查碰撞检测条件是否满足
       if (parameters.GetCollisionDetection(ego_actor_id, other_actor_id) // 检查自车与目标车之间的碰撞检测设置
@@ -99,9 +98,9 @@ void CollisionStage::Update(const unsigned long index) {
         if (negotiation_result.first) { // 如果存在碰撞威胁
           // 根据对象类型和随机概率，决定是否忽略此威胁
           if ((other_actor_type == ActorType::Vehicle
-               && parameters.GetPercentageIgnoreVehicles(ego_actor_id) <= random_device.next())
+               && parameters.GetPercentageIgnoreVehicles(ego_actor_id) <= NextRandom())
               || (other_actor_type == ActorType::Pedestrian
-                  && parameters.GetPercentageIgnoreWalkers(ego_actor_id) <= random_device.next())) {
+                  && parameters.GetPercentageIgnoreWalkers(ego_actor_id) <= NextRandom())) {
             collision_hazard = true;      // 标记碰撞威胁
             obstacle_id = other_actor_id; // 记录威胁对象ID
             available_distance_margin = negotiation_result.second; // 记录距离裕度
@@ -120,24 +119,37 @@ void CollisionStage::Update(const unsigned long index) {
 
 void CollisionStage::RemoveActor(const ActorId actor_id) {
   // 移除特定对象的碰撞锁定
+  std::lock_guard<std::mutex> lock(collision_locks_mutex);
   collision_locks.erase(actor_id);
 }
 
 void CollisionStage::Reset() {
   // 清空所有碰撞锁定
+  std::lock_guard<std::mutex> lock(collision_locks_mutex);
   collision_locks.clear();
+  collision_locks_snapshot.clear();
+  pairs_tested.store(0u);
+  pairs_pruned.store(0u);
+}
+
+double CollisionStage::NextRandom() {
+  std::lock_guard<std::mutex> lock(random_device_mutex);
+  return random_device.next();
 }
 
 float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id) {
   // 根据速度计算对象的碰撞边界延伸
-  const float velocity = cg::Math::Dot(simulation_state.GetVelocity(actor_id), simulation_state.GetHeading(actor_id)); // 计算对象的速度
+  const size_t slot = simulation_state.GetSlot(actor_id);
+  const float velocity = cg::Math::Dot(simulation_state.GetVelocityAt(slot), simulation_state.GetHeadingAt(slot)); // 计算对象的速度
   float bbox_extension;
   // 使用函数来计算边界长度
   float velocity_extension = VEL_EXT_FACTOR * velocity; // 根据速度计算延伸因子
   bbox_extension = BOUNDARY_EXTENSION_MINIMUM + velocity_extension * velocity_extension; // 基础边界延伸
-  // 如果对象有有效的碰撞锁定，调整边界以保持锁定
-  if (collision_locks.find(actor_id) != collision_locks.end()) {
-    const CollisionLock &lock = collision_locks.at(actor_id);
+  // 如果对象有有效的碰撞锁定，调整边界以保持锁定。读取周期开始时的快照，
+  // 其他车辆在本周期内更新的碰撞锁不影响结果
+  const auto search = collision_locks_snapshot.find(actor_id);
+  if (search != collision_locks_snapshot.end()) {
+    const CollisionLock &lock = search->second;
     float lock_boundary_length = static_cast<float>(lock.distance_to_lead_vehicle + LOCKING_DISTANCE_PADDING);
     // 仅当前车辆距离未超过速度相关延伸的最大值时，才延伸边界跟踪车辆
     if ((lock_boundary_length - lock.initial_lock_distance) < MAX_LOCKING_EXTENSION) {
@@ -149,16 +161,17 @@ float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id) {
 }
 
 LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
-  const ActorType actor_type = simulation_state.GetType(actor_id); // 获取实体类型
-  const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id); // 获取实体的朝向向量
+  const size_t slot = simulation_state.GetSlot(actor_id); // 获取实体在仿真状态中的槽位
+  const ActorType actor_type = simulation_state.GetTypeAt(slot); // 获取实体类型
+  const cg::Vector3D heading_vector = simulation_state.GetHeadingAt(slot); // 获取实体的朝向向量
 
   float forward_extension = 0.0f; // 用于扩展边界框的向前长度
   if (actor_type == ActorType::Pedestrian) {
     // 扩展行人的边界框，用于预测行人未来的位置，从而避免碰撞
-    forward_extension = simulation_state.GetVelocity(actor_id).Length() * WALKER_TIME_EXTENSION; // 根据速度扩展
+    forward_extension = simulation_state.GetVelocityAt(slot).Length() * WALKER_TIME_EXTENSION; // 根据速度扩展
   }
 
-  cg::Vector3D dimensions = simulation_state.GetDimensions(actor_id); // 获取实体的尺寸
+  cg::Vector3D dimensions = simulation_state.GetDimensionsAt(slot); // 获取实体的尺寸
 
   float bbox_x = dimensions.x; // 边界框的x轴长度（前后方向）
   float bbox_y = dimensions.y; // 边界框的y轴长度（左右方向）
@@ -168,7 +181,7 @@ LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
   const cg::Vector3D y_boundary_vector = perpendicular_vector * (bbox_y + forward_extension); // 计算y方向的边界向量
 
   // 四个顶点，按照顺时针顺序（左手坐标系下的顶视图）
-  const cg::Location location = simulation_state.GetLocation(actor_id); // 获取实体位置
+  const cg::Location location = simulation_state.GetLocationAt(slot); // 获取实体位置
   LocationVector bbox_boundary = {
       location + cg::Location(x_boundary_vector - y_boundary_vector), // 左前角
       location + cg::Location(-1.0f * x_boundary_vector - y_boundary_vector), // 左后角
@@ -182,72 +195,65 @@ LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
 LocationVector CollisionStage::GetGeodesicBoundary(const ActorId actor_id) {
   LocationVector geodesic_boundary;
 
-  if (geodesic_boundary_map.find(actor_id) != geodesic_boundary_map.end()) {
-    // 如果地理边界已经缓存，则直接获取
-    geodesic_boundary = geodesic_boundary_map.at(actor_id);
-  } else {
-    const LocationVector bbox = GetBoundary(actor_id); //获取边界框
-
-    if (buffer_map.find(actor_id) != buffer_map.end()) {
-      float bbox_extension = GetBoundingBoxExtention(actor_id); // 获取边界框扩展值
-      const float specific_lead_distance = parameters.GetDistanceToLeadingVehicle(actor_id); // 获取特定的前车距离
-      bbox_extension = std::max(specific_lead_distance, bbox_extension); // 扩展边界框，使用更大的距离
-      const float bbox_extension_square = SQUARE(bbox_extension); // 计算扩展距离的平方
-
-      LocationVector left_boundary; // 左边界点集合
-      LocationVector right_boundary; // 右边界点集合
-      cg::Vector3D dimensions = simulation_state.GetDimensions(actor_id); // 获取实体的尺寸
-      const float width = dimensions.y; // 宽度
-      const float length = dimensions.x; // 长度
-
-      const Buffer &waypoint_buffer = buffer_map.at(actor_id); // 获取路径缓冲区
-      const TargetWPInfo target_wp_info = GetTargetWaypoint(waypoint_buffer, length); // 获取目标路径点和起点索引
-      const SimpleWaypointPtr boundary_start = target_wp_info.first; // 边界起始路径点
-      const uint64_t boundary_start_index = target_wp_info.second; // 边界起始索引
-
-      // 在无信号交叉口，我们扩展边界穿过交叉口
-      // 在所有其他情况下，边界长度与速度相关
-      SimpleWaypointPtr boundary_end = nullptr;
-      SimpleWaypointPtr current_point = waypoint_buffer.at(boundary_start_index);
-      bool reached_distance = false;
-      for (uint64_t j = boundary_start_index; !reached_distance && (j < waypoint_buffer.size()); ++j) {
-        if (boundary_start->DistanceSquared(current_point) > bbox_extension_square || j == waypoint_buffer.size() - 1) {
-          reached_distance = true;
-        }
-        if (boundary_end == nullptr
-            || cg::Math::Dot(boundary_end->GetForwardVector(), current_point->GetForwardVector()) < COS_10_DEGREES
-            || reached_distance) {
-
-          const cg::Vector3D heading_vector = current_point->GetForwardVector();
-          const cg::Location location = current_point->GetLocation();
-          cg::Vector3D perpendicular_vector = cg::Vector3D(-heading_vector.y, heading_vector.x, 0.0f);
-          perpendicular_vector = perpendicular_vector.MakeSafeUnitVector(EPSILON);
-          // 方向根据左手坐标系确定
-          const cg::Vector3D scaled_perpendicular = perpendicular_vector * width;
-          left_boundary.push_back(location + cg::Location(scaled_perpendicular));
-          right_boundary.push_back(location + cg::Location(-1.0f * scaled_perpendicular));
-
-          boundary_end = current_point;
-        }
-
-        current_point = waypoint_buffer.at(j);
+  const LocationVector bbox = GetBoundary(actor_id); //获取边界框
+
+  if (buffer_map.find(actor_id) != buffer_map.end()) {
+    float bbox_extension = GetBoundingBoxExtention(actor_id); // 获取边界框扩展值
+    const float specific_lead_distance = parameters.GetDistanceToLeadingVehicle(actor_id); // 获取特定的前车距离
+    bbox_extension = std::max(specific_lead_distance, bbox_extension); // 扩展边界框，使用更大的距离
+    const float bbox_extension_square = SQUARE(bbox_extension); // 计算扩展距离的平方
+
+    LocationVector left_boundary; // 左边界点集合
+    LocationVector right_boundary; // 右边界点集合
+    cg::Vector3D dimensions = simulation_state.GetDimensions(actor_id); // 获取实体的尺寸
+    const float width = dimensions.y; // 宽度
+    const float length = dimensions.x; // 长度
+
+    const Buffer &waypoint_buffer = buffer_map.at(actor_id); // 获取路径缓冲区
+    const TargetWPInfo target_wp_info = GetTargetWaypoint(waypoint_buffer, length); // 获取目标路径点和起点索引
+    const SimpleWaypointPtr boundary_start = target_wp_info.first; // 边界起始路径点
+    const uint64_t boundary_start_index = target_wp_info.second; // 边界起始索引
+
+    // 在无信号交叉口，我们扩展边界穿过交叉口
+    // 在所有其他情况下，边界长度与速度相关
+    SimpleWaypointPtr boundary_end = nullptr;
+    SimpleWaypointPtr current_point = waypoint_buffer.at(boundary_start_index);
+    bool reached_distance = false;
+    for (uint64_t j = boundary_start_index; !reached_distance && (j < waypoint_buffer.size()); ++j) {
+      if (boundary_start->DistanceSquared(current_point) > bbox_extension_square || j == waypoint_buffer.size() - 1) {
+        reached_distance = true;
+      }
+      if (boundary_end == nullptr
+          || cg::Math::Dot(boundary_end->GetForwardVector(), current_point->GetForwardVector()) < COS_10_DEGREES
+          || reached_distance) {
+
+        const cg::Vector3D heading_vector = current_point->GetForwardVector();
+        const cg::Location location = current_point->GetLocation();
+        cg::Vector3D perpendicular_vector = cg::Vector3D(-heading_vector.y, heading_vector.x, 0.0f);
+        perpendicular_vector = perpendicular_vector.MakeSafeUnitVector(EPSILON);
+        // 方向根据左手坐标系确定
+        const cg::Vector3D scaled_perpendicular = perpendicular_vector * width;
+        left_boundary.push_back(location + cg::Location(scaled_perpendicular));
+        right_boundary.push_back(location + cg::Location(-1.0f * scaled_perpendicular));
+
+        boundary_end = current_point;
       }
 
-      // 反向右边界以构建顺时针（左手坐标系）
-      // 边界。这是因为左边界和右边界向量都有
-      // 在右边界的起始索引处与车辆的最近点
-      // 边界
-      // 我们希望从最远的点开始，以获得顺时针轨迹
-      std::reverse(right_boundary.begin(), right_boundary.end());
-      geodesic_boundary.insert(geodesic_boundary.end(), right_boundary.begin(), right_boundary.end());
-      geodesic_boundary.insert(geodesic_boundary.end(), bbox.begin(), bbox.end());
-      geodesic_boundary.insert(geodesic_boundary.end(), left_boundary.begin(), left_boundary.end());
-    } else {
-
-      geodesic_boundary = bbox;
+      current_point = waypoint_buffer.at(j);
     }
 
-    geodesic_boundary_map.insert({actor_id, geodesic_boundary});
+    // 反向右边界以构建顺时针（左手坐标系）
+    // 边界。这是因为左边界和右边界向量都有
+    // 在右边界的起始索引处与车辆的最近点
+    // 边界
+    // 我们希望从最远的点开始，以获得顺时针轨迹
+    std::reverse(right_boundary.begin(), right_boundary.end());
+    geodesic_boundary.insert(geodesic_boundary.end(), right_boundary.begin(), right_boundary.end());
+    geodesic_boundary.insert(geodesic_boundary.end(), bbox.begin(), bbox.end());
+    geodesic_boundary.insert(geodesic_boundary.end(), left_boundary.begin(), left_boundary.end());
+  } else {
+
+    geodesic_boundary = bbox;
   }
 
   return geodesic_boundary;
@@ -266,6 +272,53 @@ Polygon CollisionStage::GetPolygon(const LocationVector &boundary) {
   return boundary_polygon; // 返回多边形
 }
 
+std::shared_ptr<const ActorGeometry> CollisionStage::GetActorGeometry(const ActorId actor_id) {
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    const auto it = actor_geometry_cache.find(actor_id);
+    if (it != actor_geometry_cache.end()) {
+      // 如果几何信息已经缓存，则直接获取
+      return it->second;
+    }
+  }
+
+  // 计算在锁外进行，并发的线程可能重复计算同一实体的几何信息，以先写入缓存的结果为准
+  const LocationVector geodesic_boundary = GetGeodesicBoundary(actor_id);
+  auto geometry = std::make_shared<ActorGeometry>();
+  geometry->bbox_polygon = GetPolygon(GetBoundary(actor_id));
+  geometry->geodesic_polygon = GetPolygon(geodesic_boundary);
+  BoundingBox2D &bounds = geometry->geodesic_bounds;
+  bounds = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+            std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+  for (const cg::Location &location : geodesic_boundary) {
+    bounds.min_x = std::min(bounds.min_x, location.x);
+    bounds.min_y = std::min(bounds.min_y, location.y);
+    bounds.max_x = std::max(bounds.max_x, location.x);
+    bounds.max_y = std::max(bounds.max_y, location.y);
+  }
+
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  return actor_geometry_cache.insert({actor_id, std::move(geometry)}).first->second;
+}
+
+bool CollisionStage::BroadPhaseOverlap(const ActorId reference_vehicle_id, const ActorId other_actor_id) {
+  const auto reference_geometry = GetActorGeometry(reference_vehicle_id);
+  const auto other_geometry = GetActorGeometry(other_actor_id);
+  const BoundingBox2D &a = reference_geometry->geodesic_bounds;
+  const BoundingBox2D &b = other_geometry->geodesic_bounds;
+  // 只有两个测地边界多边形的距离小于 OVERLAP_THRESHOLD 时才可能存在碰撞威胁。
+  // 包围盒之间的间隔是多边形距离的下界，间隔不小于阈值时精确计算的结果
+  // 一定是没有威胁，可以直接跳过。
+  const bool overlap = (a.min_x - b.max_x) < OVERLAP_THRESHOLD
+                    && (b.min_x - a.max_x) < OVERLAP_THRESHOLD
+                    && (a.min_y - b.max_y) < OVERLAP_THRESHOLD
+                    && (b.min_y - a.max_y) < OVERLAP_THRESHOLD;
+  if (!overlap) {
+    ++pairs_pruned;
+  }
+  return overlap;
+}
+
 GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId reference_vehicle_id,
                                                             const ActorId other_actor_id) {
 
@@ -285,22 +338,31 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
 
   GeometryComparison comparision_result{-1.0, -1.0, -1.0, -1.0}; // 默认比较结果，初始化为-1.0
 
-  if (geometry_cache.find(actor_id_key) != geometry_cache.end()) {
+  bool cached = false;
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    const auto it = geometry_cache.find(actor_id_key);
+    if (it != geometry_cache.end()) {
+      comparision_result = it->second;
+      cached = true;
+    }
+  }
+
+  if (cached) {
     // 如果几何关系已缓存，则直接获取
-    comparision_result = geometry_cache.at(actor_id_key);
     double mref_veh_other = comparision_result.reference_vehicle_to_other_geodesic;
     // 交换参考车辆到其他车辆的距离和相反方向的距离
     comparision_result.reference_vehicle_to_other_geodesic = comparision_result.other_vehicle_to_reference_geodesic;
     comparision_result.other_vehicle_to_reference_geodesic = mref_veh_other;
   } else {
-    // 获取参考车辆的边界多边形
-    const Polygon reference_polygon = GetPolygon(GetBoundary(reference_vehicle_id));
-    // 获取其他实体的边界多边形
-    const Polygon other_polygon = GetPolygon(GetBoundary(other_actor_id));
-    // 获取参考车辆的地理边界多边形
-    const Polygon reference_geodesic_polygon = GetPolygon(GetGeodesicBoundary(reference_vehicle_id));
-    //获取其他实体的地理边界多边形
-    const Polygon other_geodesic_polygon = GetPolygon(GetGeodesicBoundary(other_actor_id));
+    ++pairs_tested;
+    // 获取两个实体在当前周期内缓存的边界多边形和地理边界多边形
+    const auto reference_geometry = GetActorGeometry(reference_vehicle_id);
+    const auto other_geometry = GetActorGeometry(other_actor_id);
+    const Polygon &reference_polygon = reference_geometry->bbox_polygon;
+    const Polygon &other_polygon = other_geometry->bbox_polygon;
+    const Polygon &reference_geodesic_polygon = reference_geometry->geodesic_polygon;
+    const Polygon &other_geodesic_polygon = other_geometry->geodesic_polygon;
     // 计算参考车辆到其他实体地理边界的距离
     const double reference_vehicle_to_other_geodesic = bg::distance(reference_polygon, other_geodesic_polygon);
     // 计算其他实体到参考车辆地理边界的距离
@@ -315,6 +377,7 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
               inter_geodesic_distance,
               inter_bbox_distance};
     // 将结果缓存
+    std::lock_guard<std::mutex> lock(cache_mutex);
     geometry_cache.insert({actor_id_key, comparision_result});
   }
 
@@ -328,23 +391,25 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
   bool hazard = false;
   float available_distance_margin = std::numeric_limits<float>::infinity();
 
-  const cg::Location reference_location = simulation_state.GetLocation(reference_vehicle_id);
-  const cg::Location other_location = simulation_state.GetLocation(other_actor_id);
+  const size_t reference_slot = simulation_state.GetSlot(reference_vehicle_id);
+  const size_t other_slot = simulation_state.GetSlot(other_actor_id);
+  const cg::Location reference_location = simulation_state.GetLocationAt(reference_slot);
+  const cg::Location other_location = simulation_state.GetLocationAt(other_slot);
 
   // 自我和其他车辆的方向
-  const cg::Vector3D reference_heading = simulation_state.GetHeading(reference_vehicle_id);
+  const cg::Vector3D reference_heading = simulation_state.GetHeadingAt(reference_slot);
   // 从自车位置到其他车辆位置的向量
   cg::Vector3D reference_to_other = other_location - reference_location;
   reference_to_other = reference_to_other.MakeSafeUnitVector(EPSILON);
 
   // 其他车辆的方向
-  const cg::Vector3D other_heading = simulation_state.GetHeading(other_actor_id);
+  const cg::Vector3D other_heading = simulation_state.GetHeadingAt(other_slot);
   // 从其他车辆位置到自我位置的向量
   cg::Vector3D other_to_reference = reference_location - other_location;
   other_to_reference = other_to_reference.MakeSafeUnitVector(EPSILON);
 
-  float reference_vehicle_length = simulation_state.GetDimensions(reference_vehicle_id).x * SQUARE_ROOT_OF_TWO;
-  float other_vehicle_length = simulation_state.GetDimensions(other_actor_id).x * SQUARE_ROOT_OF_TWO;
+  float reference_vehicle_length = simulation_state.GetDimensionsAt(reference_slot).x * SQUARE_ROOT_OF_TWO;
+  float other_vehicle_length = simulation_state.GetDimensionsAt(other_slot).x * SQUARE_ROOT_OF_TWO;
 
   float inter_vehicle_distance = cg::Math::DistanceSquared(reference_location, other_location);
   float ego_bounding_box_extension = GetBoundingBoxExtention(reference_vehicle_id);
@@ -362,7 +427,7 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
   const Buffer &reference_vehicle_buffer = buffer_map.at(reference_vehicle_id);
   SimpleWaypointPtr closest_point = reference_vehicle_buffer.front();
   bool ego_inside_junction = closest_point->CheckJunction();
-  TrafficLightState reference_tl_state = simulation_state.GetTLS(reference_vehicle_id);
+  const TrafficLightState &reference_tl_state = simulation_state.GetTLSAt(reference_slot);
   bool ego_at_traffic_light = reference_tl_state.at_traffic_light;
   bool ego_stopped_by_light = reference_tl_state.tl_state != TLS::Green && reference_tl_state.tl_state != TLS::Off;
   SimpleWaypointPtr look_ahead_point = reference_vehicle_buffer.at(reference_junction_look_ahead_index);
@@ -371,7 +436,8 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
   // 考虑碰撞谈判的条件
   if (!(ego_at_junction_entrance && ego_at_traffic_light && ego_stopped_by_light)
       && ((ego_inside_junction && other_vehicles_in_cross_detection_range)
-          || (!ego_inside_junction && other_vehicle_in_front && other_vehicle_in_ego_range))) {
+          || (!ego_inside_junction && other_vehicle_in_front && other_vehicle_in_ego_range))
+      && BroadPhaseOverlap(reference_vehicle_id, other_actor_id)) {
     GeometryComparison geometry_comparison = GetGeometryBetweenActors(reference_vehicle_id, other_actor_id);
 
     // 碰撞谈判的条件
@@ -404,6 +470,7 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
       // 这使得我们能够平稳地接近前车
 
       // 当发现可能的碰撞时，检查是否存在碰撞锁的条目
+      std::lock_guard<std::mutex> guard(collision_locks_mutex);
       if (collision_locks.find(reference_vehicle_id) != collision_locks.end()) {
         CollisionLock &lock = collision_locks.at(reference_vehicle_id);
         // 检查同一车辆是否处于锁定状态
@@ -431,17 +498,31 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
   }
 
   // 如果没有检测到碰撞危险，则清除车辆持有的碰撞锁定
-  if (!hazard && collision_locks.find(reference_vehicle_id) != collision_locks.end()) {
+  if (!hazard) {
+    std::lock_guard<std::mutex> guard(collision_locks_mutex);
     collision_locks.erase(reference_vehicle_id);
   }
 
   return {hazard, available_distance_margin};
 }
 
+void CollisionStage::SnapshotCollisionLocks() {
+  std::lock_guard<std::mutex> lock(collision_locks_mutex);
+  collision_locks_snapshot = collision_locks;
+}
+
 void CollisionStage::ClearCycleCache() {
-  geodesic_boundary_map.clear();
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  actor_geometry_cache.clear();
   geometry_cache.clear();
 }
 
+CollisionStatistics CollisionStage::GetStatistics() const {
+  CollisionStatistics statistics;
+  statistics.pairs_tested = pairs_tested.load();
+  statistics.pairs_pruned = pairs_pruned.load();
+  return statistics;
+}
+
 } // namespace traffic_manager
 } // namespace carla
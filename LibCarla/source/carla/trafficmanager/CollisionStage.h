@@ -1,7 +1,9 @@
 
 #pragma once // 防止头文件重复包含
 
+#include <atomic> // 引入原子操作，用于统计计数
 #include <memory> // 引入智能指针的支持
+#include <mutex> // 引入互斥锁，用于并行更新时保护共享状态
 
 #if defined(__clang__) // 如果使用 clang 编译器
 #  pragma clang diagnostic push // 保存当前警告状态
@@ -38,17 +40,42 @@ struct CollisionLock { // 定义碰撞锁结构
 };
 using CollisionLockMap = std::unordered_map<ActorId, CollisionLock>; // 定义碰撞锁映射表
 
+struct BoundingBox2D { // 定义二维轴对齐包围盒结构
+  float min_x; // x 的最小值
+  float min_y; // y 的最小值
+  float max_x; // x 的最大值
+  float max_y; // y 的最大值
+};
+
+/// 碰撞检测阶段的统计信息，从上一次 Reset 开始累计。
+struct CollisionStatistics {
+  /// 进行了精确多边形距离计算的车辆对数量。
+  uint64_t pairs_tested = 0u;
+  /// 因包围盒不相交而跳过精确计算的车辆对数量。
+  uint64_t pairs_pruned = 0u;
+};
+
 namespace cc = carla::client; // 简化 carla::client 的命名空间
 namespace bg = boost::geometry; // 简化 boost::geometry 的命名空间
 
 using Buffer = std::deque<std::shared_ptr<SimpleWaypoint>>; // 定义 waypoint 缓冲区
 using BufferMap = std::unordered_map<carla::ActorId, Buffer>; // 定义缓冲区映射表
 using LocationVector = std::vector<cg::Location>; // 定义位置向量
-using GeodesicBoundaryMap = std::unordered_map<ActorId, LocationVector>; // 定义测地边界映射表
 using GeometryComparisonMap = std::unordered_map<uint64_t, GeometryComparison>; // 定义几何比较映射表
 using Polygon = bg::model::polygon<bg::model::d2::point_xy<double>>; // 定义多边形类型
 
+/// 一个实体在当前更新周期内的几何信息，在所有与它有关的车辆对之间共享。
+struct ActorGeometry {
+  Polygon bbox_polygon; // 边界框多边形
+  Polygon geodesic_polygon; // 测地边界多边形
+  BoundingBox2D geodesic_bounds; // 测地边界的包围盒
+};
+using ActorGeometryMap = std::unordered_map<ActorId, std::shared_ptr<const ActorGeometry>>; // 定义实体几何信息映射表
+
 /// 该类具有检测与附近演员潜在碰撞的功能。
+/// 不同车辆的 Update 可以在多个线程上并发调用，碰撞锁、几何缓存和随机数
+/// 生成器都由互斥锁保护。实体的几何信息只依赖 SnapshotCollisionLocks 保存的
+/// 碰撞锁，与其他车辆在同一周期内的更新顺序无关。
 class CollisionStage : Stage { // 定义 CollisionStage 类，继承自 Stage
 private:
   const std::vector<ActorId> &vehicle_id_list; // 车辆 ID 列表
@@ -58,9 +85,18 @@ private:
   const Parameters &parameters; // 参数
   CollisionFrame &output_array; // 输出数组
   CollisionLockMap collision_locks; // 存储阻塞的前方车辆信息
+  CollisionLockMap collision_locks_snapshot; // 本周期开始时的碰撞锁，更新期间只读，用于计算几何信息
   GeometryComparisonMap geometry_cache; // 存储车辆边界的几何比较结果
-  GeodesicBoundaryMap geodesic_boundary_map; // 存储车辆的测地边界
+  ActorGeometryMap actor_geometry_cache; // 存储当前更新周期内实体的几何信息
   RandomGenerator &random_device; // 随机数生成器
+  std::mutex collision_locks_mutex; // 保护 collision_locks
+  std::mutex cache_mutex; // 保护 geometry_cache 和 actor_geometry_cache
+  std::mutex random_device_mutex; // 保护 random_device
+  std::atomic<uint64_t> pairs_tested{0u}; // 进行了精确计算的车辆对数量
+  std::atomic<uint64_t> pairs_pruned{0u}; // 被包围盒剔除的车辆对数量
+
+  // 方法：在加锁的情况下抽取下一个随机数
+  double NextRandom();
 
   // 方法：确定车辆是否与另一辆车处于碰撞路径
   std::pair<bool, float> NegotiateCollision(const ActorId reference_vehicle_id,
@@ -78,10 +114,16 @@ private:
 
   Polygon GetPolygon(const LocationVector &boundary); // 获取多边形对象
 
+  // 方法：获取实体在当前更新周期内的几何信息，第一次访问时计算并缓存
+  std::shared_ptr<const ActorGeometry> GetActorGeometry(const ActorId actor_id);
+
   // 方法：比较路径边界、车辆的边界框，并缓存当前更新周期的结果
   GeometryComparison GetGeometryBetweenActors(const ActorId reference_vehicle_id,
                                               const ActorId other_actor_id);
 
+  // 方法：宽相位检测，两个实体的测地边界包围盒足够接近时返回 true
+  bool BroadPhaseOverlap(const ActorId reference_vehicle_id, const ActorId other_actor_id);
+
   // 方法：绘制路径边界
   void DrawBoundary(const LocationVector &boundary);
 
@@ -101,8 +143,14 @@ public:
 
   void Reset() override; // 重置方法
 
+  // 方法：保存碰撞锁的快照，必须在本周期的第一次 Update 之前调用
+  void SnapshotCollisionLocks();
+
   // 方法：清除当前更新周期的缓存
   void ClearCycleCache();
+
+  // 方法：获取宽相位剔除的统计信息
+  CollisionStatistics GetStatistics() const;
 };
 
 } // namespace traffic_manager
@@ -8,7 +8,12 @@
 
 #include "carla/trafficmanager/Constants.h"
 #include "carla/trafficmanager/InMemoryMap.h"
+#include "carla/trafficmanager/InMemoryMapCache.h"
 #include <boost/geometry/geometries/box.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstring>
 // 定义在carla命名空间下的traffic_manager命名空间
 namespace carla {
 namespace traffic_manager {
@@ -99,31 +104,243 @@ namespace traffic_manager {
       return;
     }
 
-    // 将所有记录的总数写入文件中
-    uint32_t total = static_cast<uint32_t>(dense_topology.size());
-    out_file.write(reinterpret_cast<const char *>(&total), sizeof(uint32_t));
-
-    // 创建或记录一些基本的导航点
-    std::unordered_set<uint64_t> used_ids;
-    for (auto& wp: dense_topology) {
-      if (used_ids.find(wp->GetId()) != used_ids.end()) {
-        log_error("Could not generate the binary file. There are repeated waypoints");
+    // 路点到其在 dense_topology 中下标的映射，连接关系按下标保存
+    const uint32_t total = static_cast<uint32_t>(dense_topology.size());
+    std::unordered_map<const SimpleWaypoint *, uint32_t> indices;
+    indices.reserve(total);
+    for (uint32_t i = 0u; i < total; ++i) {
+      indices.insert({dense_topology[i].get(), i});
+    }
+    auto index_of = [&indices](const SimpleWaypointPtr &swp) {
+      if (swp == nullptr) {
+        return cache::INVALID_INDEX;
       }
-      CachedSimpleWaypoint cached_wp(wp);
-      cached_wp.Write(out_file);
+      auto it = indices.find(swp.get());
+      return it == indices.end() ? cache::INVALID_INDEX : it->second;
+    };
 
-      used_ids.insert(wp->GetId());
+    std::vector<cache::WaypointRecord> records(total);
+    std::vector<uint32_t> next_offsets{0u};
+    std::vector<uint32_t> next_indices;
+    std::vector<uint32_t> previous_offsets{0u};
+    std::vector<uint32_t> previous_indices;
+    next_offsets.reserve(total + 1u);
+    previous_offsets.reserve(total + 1u);
+    for (uint32_t i = 0u; i < total; ++i) {
+      const SimpleWaypointPtr &swp = dense_topology[i];
+      const WaypointPtr waypoint = swp->GetWaypoint();
+      const cg::Location location = swp->GetLocation();
+
+      cache::WaypointRecord &record = records[i];
+      record.x = location.x;
+      record.y = location.y;
+      record.z = location.z;
+      record.s = static_cast<float>(waypoint->GetDistance());
+      record.road_id = waypoint->GetRoadId();
+      record.section_id = waypoint->GetSectionId();
+      record.lane_id = waypoint->GetLaneId();
+      record.geodesic_grid_id = swp->GetGeodesicGridId();
+      record.left_index = index_of(swp->GetLeftWaypoint());
+      record.right_index = index_of(swp->GetRightWaypoint());
+      record.is_junction = swp->CheckJunction() ? 1u : 0u;
+      record.road_option = static_cast<uint8_t>(swp->GetRoadOption());
+      record.padding[0] = record.padding[1] = 0u;
+
+      for (auto &next : swp->GetNextWaypoint()) {
+        const uint32_t index = index_of(next);
+        if (index != cache::INVALID_INDEX) {
+          next_indices.push_back(index);
+        }
+      }
+      next_offsets.push_back(static_cast<uint32_t>(next_indices.size()));
+      for (auto &previous : swp->GetPreviousWaypoint()) {
+        const uint32_t index = index_of(previous);
+        if (index != cache::INVALID_INDEX) {
+          previous_indices.push_back(index);
+        }
+      }
+      previous_offsets.push_back(static_cast<uint32_t>(previous_indices.size()));
     }
 
+    cache::Header header;
+    std::memcpy(header.magic, cache::MAGIC, sizeof(header.magic));
+    header.version = cache::VERSION;
+    header.header_size = sizeof(cache::Header);
+    header.record_size = sizeof(cache::WaypointRecord);
+    header.number_of_waypoints = total;
+    header.number_of_next_links = static_cast<uint32_t>(next_indices.size());
+    header.number_of_previous_links = static_cast<uint32_t>(previous_indices.size());
+    header.map_checksum = cache::Checksum(_world_map->GetOpenDrive());
+
+    // 依次写入各个数组，每个数组之前先补齐到对齐位置
+    size_t offset = 0u;
+    auto write_block = [&](const void *block, size_t size) {
+      static constexpr char zeros[cache::ALIGNMENT] = {};
+      const size_t aligned = cache::Align(offset);
+      out_file.write(zeros, static_cast<std::streamsize>(aligned - offset));
+      out_file.write(reinterpret_cast<const char *>(block), static_cast<std::streamsize>(size));
+      offset = aligned + size;
+    };
+    write_block(&header, sizeof(header));
+    write_block(records.data(), records.size() * sizeof(cache::WaypointRecord));
+    write_block(next_offsets.data(), next_offsets.size() * sizeof(uint32_t));
+    write_block(next_indices.data(), next_indices.size() * sizeof(uint32_t));
+    write_block(previous_offsets.data(), previous_offsets.size() * sizeof(uint32_t));
+    write_block(previous_indices.data(), previous_indices.size() * sizeof(uint32_t));
+
     out_file.close();
-    return;
+  }
+
+  bool InMemoryMap::Load(const std::string& filename) {
+    namespace bip = boost::interprocess;
+    try {
+      // 映射只在加载期间存在，构建完路点后即可释放
+      bip::file_mapping file(filename.c_str(), bip::read_only);
+      bip::mapped_region region(file, bip::read_only);
+      return Load(static_cast<const uint8_t *>(region.get_address()), region.get_size());
+    } catch (const bip::interprocess_exception &e) {
+      log_warning("Could not map InMemoryMap cache", filename, ":", e.what());
+      return false;
+    }
   }
 
   bool InMemoryMap::Load(const std::vector<uint8_t>& content) {
+    return Load(content.data(), content.size());
+  }
+
+  bool InMemoryMap::Load(const uint8_t *data, size_t size) {
+    if (size >= sizeof(cache::Header) &&
+        std::memcmp(data, cache::MAGIC, sizeof(cache::MAGIC)) == 0) {
+      return LoadFlatCache(data, size);
+    }
+    return LoadLegacyCache(std::vector<uint8_t>(data, data + size));
+  }
+
+  bool InMemoryMap::LoadFlatCache(const uint8_t *data, size_t size) {
+    cache::Header header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != cache::VERSION ||
+        header.header_size != sizeof(cache::Header) ||
+        header.record_size != sizeof(cache::WaypointRecord)) {
+      log_warning("InMemoryMap cache has an unsupported format version", header.version);
+      return false;
+    }
+    assert(_world_map != nullptr && "No map reference found.");
+    if (header.map_checksum != 0u &&
+        header.map_checksum != cache::Checksum(_world_map->GetOpenDrive())) {
+      log_warning("InMemoryMap cache was generated for a different OpenDRIVE file");
+      return false;
+    }
+
+    // 定位各个数组，越界说明文件被截断
+    const size_t total = header.number_of_waypoints;
+    size_t offset = sizeof(cache::Header);
+    auto locate = [&](size_t bytes) -> const uint8_t * {
+      offset = cache::Align(offset);
+      if (offset > size || bytes > size - offset) {
+        return nullptr;
+      }
+      const uint8_t *block = data + offset;
+      offset += bytes;
+      return block;
+    };
+    const auto *records = reinterpret_cast<const cache::WaypointRecord *>(
+        locate(total * sizeof(cache::WaypointRecord)));
+    const auto *next_offsets = reinterpret_cast<const uint32_t *>(
+        locate((total + 1u) * sizeof(uint32_t)));
+    const auto *next_indices = reinterpret_cast<const uint32_t *>(
+        locate(header.number_of_next_links * sizeof(uint32_t)));
+    const auto *previous_offsets = reinterpret_cast<const uint32_t *>(
+        locate((total + 1u) * sizeof(uint32_t)));
+    const auto *previous_indices = reinterpret_cast<const uint32_t *>(
+        locate(header.number_of_previous_links * sizeof(uint32_t)));
+    if (records == nullptr || next_offsets == nullptr || next_indices == nullptr ||
+        previous_offsets == nullptr || previous_indices == nullptr) {
+      log_warning("InMemoryMap cache is truncated");
+      return false;
+    }
+
+    // 检查所有下标都在范围内，之后就可以放心地直接使用
+    auto valid_links = [total](const uint32_t *offsets, const uint32_t *indices, uint32_t links) {
+      if (offsets[0] != 0u || offsets[total] != links) {
+        return false;
+      }
+      for (size_t i = 0u; i < total; ++i) {
+        if (offsets[i] > offsets[i + 1u]) {
+          return false;
+        }
+      }
+      for (uint32_t k = 0u; k < links; ++k) {
+        if (indices[k] >= total) {
+          return false;
+        }
+      }
+      return true;
+    };
+    if (!valid_links(next_offsets, next_indices, header.number_of_next_links) ||
+        !valid_links(previous_offsets, previous_indices, header.number_of_previous_links)) {
+      log_warning("InMemoryMap cache is corrupted");
+      return false;
+    }
+
+    // 创建路点，位置直接从缓存中读取，构建空间树时不需要再计算路点的变换
+    NodeList topology;
+    topology.reserve(total);
+    std::vector<SpatialTreeEntry> entries;
+    entries.reserve(total);
+    for (size_t i = 0u; i < total; ++i) {
+      const cache::WaypointRecord &record = records[i];
+      WaypointPtr waypoint_ptr = _world_map->GetWaypointXODR(record.road_id, record.lane_id, record.s);
+      if (waypoint_ptr == nullptr) {
+        log_warning("InMemoryMap cache does not match the current map");
+        return false;
+      }
+      SimpleWaypointPtr wp = std::make_shared<SimpleWaypoint>(waypoint_ptr);
+      wp->SetGeodesicGridId(record.geodesic_grid_id);
+      wp->SetIsJunction(record.is_junction != 0u);
+      wp->SetRoadOption(static_cast<RoadOption>(record.road_option));
+      entries.emplace_back(Point3D(record.x, record.y, record.z), wp);
+      topology.push_back(std::move(wp));
+    }
+
+    // 按下标连接路点
+    NodeList links;
+    for (size_t i = 0u; i < total; ++i) {
+      const SimpleWaypointPtr &wp = topology[i];
+      links.clear();
+      for (uint32_t k = next_offsets[i]; k < next_offsets[i + 1u]; ++k) {
+        links.push_back(topology[next_indices[k]]);
+      }
+      wp->SetNextWaypoint(links);
+      links.clear();
+      for (uint32_t k = previous_offsets[i]; k < previous_offsets[i + 1u]; ++k) {
+        links.push_back(topology[previous_indices[k]]);
+      }
+      wp->SetPreviousWaypoint(links);
+      const cache::WaypointRecord &record = records[i];
+      if (record.left_index < total) {
+        wp->SetLeftWaypoint(topology[record.left_index]);
+      }
+      if (record.right_index < total) {
+        wp->SetRightWaypoint(topology[record.right_index]);
+      }
+    }
+
+    dense_topology = std::move(topology);
+    BuildSpatialTree(entries);
+    return true;
+  }
+
+  bool InMemoryMap::LoadLegacyCache(const std::vector<uint8_t>& content) {
     unsigned long pos = 0;
     std::vector<CachedSimpleWaypoint> cached_waypoints;
     std::unordered_map<uint64_t, uint32_t> id2index;
 
+    if (content.size() < sizeof(uint32_t)) {
+      log_warning("InMemoryMap cache is empty");
+      return false;
+    }
+
     // 读取总记录数
     uint32_t total;
     memcpy(&total, &content[pos], sizeof(total));
@@ -376,13 +593,21 @@ namespace traffic_manager {
   }
 
   void InMemoryMap::SetUpSpatialTree() {
+    std::vector<SpatialTreeEntry> entries;
+    entries.reserve(dense_topology.size());
     for (auto &simple_waypoint: dense_topology) {
       if (simple_waypoint != nullptr) {
         const cg::Location loc = simple_waypoint->GetLocation();
         Point3D point(loc.x, loc.y, loc.z);
-        rtree.insert(std::make_pair(point, simple_waypoint));
+        entries.emplace_back(point, simple_waypoint);
       }
     }
+    BuildSpatialTree(entries);
+  }
+
+  void InMemoryMap::BuildSpatialTree(const std::vector<SpatialTreeEntry> &entries) {
+    // 使用范围构造函数时 R 树会用打包算法批量构建，节点填充更满，查询也更快
+    rtree = Rtree(entries.begin(), entries.end());
   }
 
   void InMemoryMap::SetUpRoadOption() {
@@ -77,8 +77,12 @@ public:
 
     static void Cook(WorldMap world_map, const std::string& path);  // 静态方法，用于处理地图并保存到指定路径
 
-    //bool Load(const std::string& filename);  // 加载地图的方法（未实现）
+    /// 将缓存文件映射到内存并加载地图，文件不存在、已过期或损坏时返回 false，
+    /// 此时需要调用 SetUp() 重新构建本地地图。
+    bool Load(const std::string& filename);
     bool Load(const std::vector<uint8_t>& content);  // 从字节内容加载地图的方法
+    /// 从内存中的缓存内容加载地图，同时支持当前格式和旧格式。
+    bool Load(const uint8_t *data, size_t size);
 
     /// 此方法以采样分辨率构建本地地图。
     void SetUp();
@@ -101,6 +105,13 @@ private:
 
     void SetUpDenseTopology();  // 设置稠密拓扑
     void SetUpSpatialTree();  // 设置空间树
+    /// 用打包（批量加载）算法一次性构建空间树，比逐个插入快得多。
+    void BuildSpatialTree(const std::vector<SpatialTreeEntry> &entries);
+
+    /// 加载带文件头的扁平格式缓存。
+    bool LoadFlatCache(const uint8_t *data, size_t size);
+    /// 加载没有文件头的旧格式缓存。
+    bool LoadLegacyCache(const std::vector<uint8_t> &content);
     void SetUpRoadOption();  // 设置道路选项
 
     /// 此方法用于查找和链接车道变更连接。
@@ -0,0 +1,93 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/road/MapCache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace carla {
+namespace traffic_manager {
+namespace cache {
+
+  /// InMemoryMap 二进制缓存的文件格式。
+  ///
+  /// 文件由一个固定大小的文件头和若干个连续的数组组成，可以整体映射到内存后
+  /// 直接读取，不需要逐条反序列化：
+  ///
+  ///   Header
+  ///   WaypointRecord    records[number_of_waypoints]
+  ///   uint32_t          next_offsets[number_of_waypoints + 1]
+  ///   uint32_t          next_indices[number_of_next_links]
+  ///   uint32_t          previous_offsets[number_of_waypoints + 1]
+  ///   uint32_t          previous_indices[number_of_previous_links]
+  ///
+  /// 路点之间的连接保存为路点在 records 中的下标，第 i 个路点的后继是
+  /// next_indices[next_offsets[i] .. next_offsets[i + 1])，前驱同理。
+  /// 每个数组的起始位置都对齐到 ALIGNMENT 字节。
+
+  /// 文件开头的魔数，用于和旧格式（以路点数量开头）区分。
+  static constexpr char MAGIC[8] = {'C', 'A', 'R', 'L', 'A', 'T', 'M', '\0'};
+
+  /// 格式版本，布局改变时必须增加。
+  static constexpr uint32_t VERSION = 1u;
+
+  /// 各数组起始位置的对齐字节数。
+  static constexpr size_t ALIGNMENT = 8u;
+
+  /// 表示“没有这个路点”的下标。
+  static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    /// sizeof(Header)，用于检测不同平台的结构体布局差异。
+    uint32_t header_size;
+    /// sizeof(WaypointRecord)。
+    uint32_t record_size;
+    uint32_t number_of_waypoints;
+    uint32_t number_of_next_links;
+    uint32_t number_of_previous_links;
+    /// 生成缓存时所用 OpenDRIVE 文件的校验和，为0时不检查。
+    uint64_t map_checksum;
+  };
+  static_assert(sizeof(Header) == 40u, "Unexpected cache header layout");
+
+  struct WaypointRecord {
+    /// 路点位置，用于直接构建空间索引。
+    float x;
+    float y;
+    float z;
+    /// 路点在道路上的距离 s。
+    float s;
+    uint32_t road_id;
+    uint32_t section_id;
+    int32_t lane_id;
+    int32_t geodesic_grid_id;
+    /// 左右变道路点的下标，没有时为 INVALID_INDEX。
+    uint32_t left_index;
+    uint32_t right_index;
+    uint8_t is_junction;
+    uint8_t road_option;
+    uint8_t padding[2];
+  };
+  static_assert(sizeof(WaypointRecord) == 44u, "Unexpected cache record layout");
+
+  /// 将 @a offset 向上对齐到 ALIGNMENT。
+  inline size_t Align(size_t offset) {
+    return (offset + ALIGNMENT - 1u) & ~(ALIGNMENT - 1u);
+  }
+
+  /// OpenDRIVE 内容的校验和，与 road::Map 缓存使用相同的算法。
+  using road::cache::Checksum;
+
+} // namespace cache
+} // namespace traffic_manager
+} // namespace carla
@@ -40,9 +40,10 @@ void LocalizationStage::Update(const unsigned long index) {
 
     // 获取当前车辆的ID和相关信息
   const ActorId actor_id = vehicle_id_list.at(index);
-  const cg::Location vehicle_location = simulation_state.GetLocation(actor_id);
-  const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id);
-  const cg::Vector3D vehicle_velocity_vector = simulation_state.GetVelocity(actor_id);
+  const size_t slot = simulation_state.GetSlot(actor_id);
+  const cg::Location vehicle_location = simulation_state.GetLocationAt(slot);
+  const cg::Vector3D heading_vector = simulation_state.GetHeadingAt(slot);
+  const cg::Vector3D vehicle_velocity_vector = simulation_state.GetVelocityAt(slot);
   const float vehicle_speed = vehicle_velocity_vector.Length();
 
   // 速度相关的航点视野长度
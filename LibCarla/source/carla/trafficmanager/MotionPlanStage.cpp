@@ -63,15 +63,15 @@ MotionPlanStage::MotionPlanStage(
 // 参数 index：一个无符号长整型参数，可能用于在一些容器（比如存储车辆相关信息的数组或向量等）中定位特定车辆对应的索引位置，从而获取该车辆的相关信息进行后续处理
 void MotionPlanStage::Update(const unsigned long index) {    
   const ActorId actor_id = vehicle_id_list.at(index); // 根据传入的索引 index，从 vehicle_id_list 中获取对应的车辆 ID（ActorId 类型，可能是用于唯一标识模拟中的车辆等角色的类型）
-  const cg::Location vehicle_location = simulation_state.GetLocation(actor_id); // 通过 simulation_state 对象，根据获取到的车辆 ID（actor_id）获取车辆当前的位置信息（cg::Location 类型，可能包含了车辆在三维空间中的坐标等位置相关数据）
-    const cg::Location vehicle_location = simulation_state.GetLocation(actor_id);    // 同样通过 simulation_state 对象，依据车辆 ID 获取车辆当前的速度信息（cg::Vector3D 类型，以三维向量形式表示速度的大小和方向）
-  const cg::Vector3D vehicle_velocity = simulation_state.GetVelocity(actor_id); 
+  const size_t slot = simulation_state.GetSlot(actor_id); // 获取车辆在仿真状态中的槽位，以下按槽位读取车辆状态，只做一次哈希查找
+  const cg::Location vehicle_location = simulation_state.GetLocationAt(slot); // 车辆当前的位置信息
+  const cg::Vector3D vehicle_velocity = simulation_state.GetVelocityAt(slot); 
 // 通过 simulation_state 对象，按照车辆 ID 获取车辆当前的旋转状态信息（cg::Rotation 类型，可能涉及车辆在空间中的朝向角度等旋转相关数据）
-  const cg::Rotation vehicle_rotation = simulation_state.GetRotation(actor_id);// 通过 simulation_state 对象，按照车辆 ID 获取车辆当前的旋转状态信息（cg::Rotation 类型，可能涉及车辆在空间中的朝向角度等旋转相关数据）
+  const cg::Rotation vehicle_rotation = simulation_state.GetRotationAt(slot);// 通过 simulation_state 对象，按照车辆 ID 获取车辆当前的旋转状态信息（cg::Rotation 类型，可能涉及车辆在空间中的朝向角度等旋转相关数据）
   const float vehicle_speed = vehicle_velocity.Length();// 计算车辆当前的速度大小（标量值），通过调用 vehicle_velocity 的 Length 函数获取其长度（即速度大小），这里的速度单位可能根据具体模拟场景设定（比如米/秒等）
-  const cg::Vector3D vehicle_heading = simulation_state.GetHeading(actor_id);// 通过 simulation_state 对象，依据车辆 ID 获取车辆当前的行驶方向信息（cg::Vector3D 类型，以三维向量形式表示车辆车头的朝向方向）
-  const bool vehicle_physics_enabled = simulation_state.IsPhysicsEnabled(actor_id); // 通过 simulation_state 对象，根据车辆 ID 判断车辆的物理模拟是否启用（返回布尔值，例如在某些模拟场景中车辆可能处于暂停物理模拟或者只做轨迹演示等情况时物理模拟是关闭的）
-  const float vehicle_speed_limit = simulation_state.GetSpeedLimit(actor_id);    // 通过 simulation_state 对象，按照车辆 ID 获取车辆当前所在位置的速度限制信息（返回浮点数，例如该路段规定的最大行驶速度，单位可能根据模拟场景设定）
+  const cg::Vector3D vehicle_heading = simulation_state.GetHeadingAt(slot);// 通过 simulation_state 对象，依据车辆 ID 获取车辆当前的行驶方向信息（cg::Vector3D 类型，以三维向量形式表示车辆车头的朝向方向）
+  const bool vehicle_physics_enabled = simulation_state.IsPhysicsEnabledAt(slot); // 通过 simulation_state 对象，根据车辆 ID 判断车辆的物理模拟是否启用（返回布尔值，例如在某些模拟场景中车辆可能处于暂停物理模拟或者只做轨迹演示等情况时物理模拟是关闭的）
+  const float vehicle_speed_limit = simulation_state.GetSpeedLimitAt(slot);    // 通过 simulation_state 对象，按照车辆 ID 获取车辆当前所在位置的速度限制信息（返回浮点数，例如该路段规定的最大行驶速度，单位可能根据模拟场景设定）
   const Buffer &waypoint_buffer = buffer_map.at(actor_id); // 根据车辆 ID，从 buffer_map 中获取对应的缓冲区数据（Buffer 类型，具体缓冲区的作用可能与车辆的路径规划、临时存储一些周边环境信息等相关，取决于具体实现）
   const LocalizationData &localization = localization_frame.at(index);    
   // 根据传入的索引 index，从 localization_frame 中获取对应的车辆定位数据（LocalizationData 类型，包含更详细的车辆定位相关信息，比如定位精度、定位方式等补充数据）
@@ -87,7 +87,7 @@ void MotionPlanStage::Update(const unsigned long index) {
   cg::Location hero_location = track_traffic.GetHeroLocation();
   bool is_hero_alive = hero_location != cg::Location(0, 0, 0);
 
-  if (simulation_state.IsDormant(actor_id) && parameters.GetRespawnDormantVehicles() && is_hero_alive) {
+  if (simulation_state.IsDormantAt(slot) && parameters.GetRespawnDormantVehicles() && is_hero_alive) {
     // 冲洗车辆的控制器状态
     current_state = {current_timestamp,
                     0.0f, 0.0f,
@@ -127,7 +127,7 @@ void MotionPlanStage::Update(const unsigned long index) {
     KinematicState kinematic_state{teleportation_transform.location,
                                    teleportation_transform.rotation,
                                    vehicle_velocity, vehicle_speed_limit,
-                                   vehicle_physics_enabled, simulation_state.IsDormant(actor_id),
+                                   vehicle_physics_enabled, simulation_state.IsDormantAt(slot),
                                    teleportation_transform.location};
     simulation_state.UpdateKinematicState(actor_id, kinematic_state);
   }
@@ -156,7 +156,7 @@ void MotionPlanStage::Update(const unsigned long index) {
     // 遇到碰撞或交通灯危险时
     bool emergency_stop = tl_hazard || collision_emergency_stop || !safe_after_junction;
 
-    if (vehicle_physics_enabled && !simulation_state.IsDormant(actor_id)) {// 判断车辆的物理模拟是否启用（vehicle_physics_enabled为true表示启用），并且车辆是否处于休眠状态（!simulation_state.IsDormant(actor_id)表示非休眠状态）
+    if (vehicle_physics_enabled && !simulation_state.IsDormantAt(slot)) {// 判断车辆的物理模拟是否启用（vehicle_physics_enabled为true表示启用），并且车辆是否处于休眠状态（!simulation_state.IsDormant(actor_id)表示非休眠状态）
       ActuationSignal actuation_signal{0.0f, 0.0f, 0.0f};// 创建一个ActuationSignal类型的结构体（或类）对象actuation_signal，并初始化为{0.0f, 0.0f, 0.0f}
 
       const float target_point_distance = std::max(vehicle_speed * TARGET_WAYPOINT_TIME_HORIZON,
@@ -266,7 +266,7 @@ void MotionPlanStage::Update(const unsigned long index) {
       // 在紧急停止的情况下，请保持在同一位置
       // 此外，在异步模式下，每 dt 时间仅传送一次
       } else {
-        teleportation_transform = cg::Transform(vehicle_location, simulation_state.GetRotation(actor_id));
+        teleportation_transform = cg::Transform(vehicle_location, simulation_state.GetRotationAt(slot));
       }
       // 构建执行信号
       output_array.at(index) = carla::rpc::Command::ApplyTransform(actor_id, teleportation_transform);
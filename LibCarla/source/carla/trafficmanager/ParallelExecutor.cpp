@@ -0,0 +1,87 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/ParallelExecutor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <vector>
+
+namespace carla {
+namespace traffic_manager {
+
+/// 每个线程平均领取的块数，块越多负载越均衡，但原子计数器的竞争也越多。
+static constexpr unsigned long CHUNKS_PER_THREAD = 8u;
+
+void ParallelExecutor::SetNumberOfThreads(const size_t new_number_of_threads) {
+  const size_t threads = std::max(new_number_of_threads, static_cast<size_t>(1u));
+  if (threads == number_of_threads) {
+    return;
+  }
+  // 先停止旧的工作线程，再按新的线程数重新创建。
+  thread_pool.reset();
+  number_of_threads = threads;
+  if (number_of_threads > 1u) {
+    thread_pool = std::make_unique<ThreadPool>();
+    // 调用线程也参与执行，所以只需要创建 number_of_threads - 1 个工作线程。
+    thread_pool->AsyncRun(number_of_threads - 1u);
+  }
+}
+
+void ParallelExecutor::ParallelFor(const unsigned long count,
+                                   const std::function<void(unsigned long)> &functor) {
+  if (thread_pool == nullptr || count <= 1u) {
+    for (unsigned long index = 0u; index < count; ++index) {
+      functor(index);
+    }
+    return;
+  }
+
+  const unsigned long chunk_size = std::max(count / (number_of_threads * CHUNKS_PER_THREAD), 1ul);
+  std::atomic<unsigned long> next_index{0u};
+  auto work = [&]() {
+    for (unsigned long begin = next_index.fetch_add(chunk_size);
+         begin < count;
+         begin = next_index.fetch_add(chunk_size)) {
+      const unsigned long end = std::min(begin + chunk_size, count);
+      for (unsigned long index = begin; index < end; ++index) {
+        functor(index);
+      }
+    }
+  };
+
+  std::vector<std::future<void>> results;
+  results.reserve(number_of_threads - 1u);
+  for (size_t i = 1u; i < number_of_threads; ++i) {
+    results.emplace_back(thread_pool->Post(work));
+  }
+
+  std::exception_ptr first_exception;
+  try {
+    work();
+  } catch (...) {
+    first_exception = std::current_exception();
+    // 让其他线程尽快停止领取新的块。
+    next_index.store(count);
+  }
+  // 必须等所有工作线程结束后才能返回，它们引用了本函数栈上的变量。
+  for (auto &result : results) {
+    try {
+      result.get();
+    } catch (...) {
+      if (first_exception == nullptr) {
+        first_exception = std::current_exception();
+      }
+    }
+  }
+  if (first_exception != nullptr) {
+    std::rethrow_exception(first_exception);
+  }
+}
+
+} // namespace traffic_manager
+} // namespace carla
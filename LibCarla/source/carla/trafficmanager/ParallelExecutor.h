@@ -0,0 +1,50 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include "carla/NonCopyable.h"
+#include "carla/ThreadPool.h"
+
+namespace carla {
+namespace traffic_manager {
+
+/// 在一组常驻工作线程上并行执行逐车辆循环的执行器。
+///
+/// 索引被划分为小块，各线程（包括调用线程）通过一个原子计数器
+/// 轮流领取下一块，因此先做完的线程会自动接手剩余的工作，
+/// 不同车辆耗时不均时负载依然均衡。
+class ParallelExecutor : private NonCopyable {
+public:
+
+  ParallelExecutor() = default;
+
+  /// 设置参与执行的线程数（包括调用线程），小于等于1表示串行执行。
+  /// 线程数改变时会重建工作线程，不能在 ParallelFor 执行期间调用。
+  void SetNumberOfThreads(const size_t number_of_threads);
+
+  size_t GetNumberOfThreads() const {
+    return number_of_threads;
+  }
+
+  /// 对 [0, count) 中的每个索引调用一次 @a functor，所有调用完成后返回。
+  /// 不同索引上的调用可能并发执行，@a functor 必须是线程安全的。
+  /// 任一调用抛出的异常会在所有工作结束后被重新抛出。
+  void ParallelFor(const unsigned long count, const std::function<void(unsigned long)> &functor);
+
+private:
+
+  /// 参与执行的线程数，包括调用线程。
+  size_t number_of_threads = 1u;
+  /// 常驻工作线程，串行执行时为空。
+  std::unique_ptr<ThreadPool> thread_pool;
+};
+
+} // namespace traffic_manager
+} // namespace carla
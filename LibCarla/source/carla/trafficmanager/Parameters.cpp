@@ -7,6 +7,9 @@
 #include "carla/trafficmanager/Parameters.h"  // 引入参数头文件
 #include "carla/trafficmanager/Constants.h"  // 引入常量头文件
 
+#include <algorithm>
+#include <thread>
+
 namespace carla {
 namespace traffic_manager {
 
@@ -199,6 +202,13 @@ void Parameters::SetOSMMode(const bool mode_switch) {
     osm_mode.store(mode_switch);
 }
 
+void Parameters::SetParallelStageThreads(const size_t number_of_threads) {
+    // 设置逐车辆阶段的并行线程数，0 与 1 一样表示串行执行。超过硬件线程数
+    // 只会增加调度开销，因此限制在硬件线程数以内
+    const size_t hardware_threads = std::max(static_cast<size_t>(std::thread::hardware_concurrency()), static_cast<size_t>(1u));
+    parallel_stage_threads.store(std::min(std::max(number_of_threads, static_cast<size_t>(1u)), hardware_threads));
+}
+
 void Parameters::SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
     // 设置参与者的自定义路径
     const auto entry = std::make_pair(actor->GetId(), path);
@@ -474,6 +484,11 @@ bool Parameters::GetOSMMode() const {
    return osm_mode.load();
 }
 
+size_t Parameters::GetParallelStageThreads() const {
+    // 返回逐车辆阶段的并行线程数
+   return parallel_stage_threads.load();
+}
+
 bool Parameters::GetUploadPath(const ActorId &actor_id) const {
     // 初始化自定义路径标志
     bool custom_path_bool = false;
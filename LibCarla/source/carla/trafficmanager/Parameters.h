@@ -91,6 +91,8 @@ namespace carla {
             std::atomic<float> hybrid_physics_radius{ 70.0 };
             /// Open Street Map模式参数
             std::atomic<bool> osm_mode{ true };
+            /// 逐车辆阶段并行执行使用的线程数，小于等于1表示串行执行
+            std::atomic<size_t> parallel_stage_threads{ 1u };
             /// 是否导入自定义路径的参数映射
             AtomicMap<ActorId, bool> upload_path;
             /// 存储所有自定义路径的结构
@@ -185,6 +187,9 @@ namespace carla {
             /// 设置Open Street Map模式的方法
             void SetOSMMode(const bool mode_switch);///< 是否启用OSM模式的布尔值
 
+            /// 设置逐车辆阶段并行执行的线程数的方法，多于一个线程时随机数的抽取顺序不固定
+            void SetParallelStageThreads(const size_t number_of_threads);///< 线程数，小于等于1表示串行执行，最多为硬件线程数
+
             /// 设置是否自动重生休眠车辆的方法
             void SetRespawnDormantVehicles(const bool mode_switch); ///< 是否启用的布尔值
 
@@ -280,6 +285,9 @@ namespace carla {
             /// 获取Open Street Map模式的方法
             bool GetOSMMode() const;
 
+            /// 获取逐车辆阶段并行执行的线程数的方法
+            size_t GetParallelStageThreads() const;
+
             /// 获取是否正在上传路径的方法
             bool GetUploadPath(const ActorId& actor_id) const;
 
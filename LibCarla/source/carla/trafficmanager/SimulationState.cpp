@@ -5,101 +5,160 @@ namespace carla {
 namespace traffic_manager {
 // 构造函数，初始化 SimulationState 对象
 SimulationState::SimulationState() {}
+// 将运动状态写入指定槽位
+void SimulationState::SetKinematicState(const size_t slot, const KinematicState &state) {
+  locations[slot] = state.location;
+  rotations[slot] = state.rotation;
+  headings[slot] = state.rotation.GetForwardVector(); // 朝向只在旋转改变时计算一次
+  velocities[slot] = state.velocity;
+  speed_limits[slot] = state.speed_limit;
+  physics_enabled[slot] = state.physics_enabled ? 1u : 0u;
+  dormant[slot] = state.is_dormant ? 1u : 0u;
+  hybrid_end_locations[slot] = state.hybrid_end_location;
+}
 // 向模拟状态中添加一个actor
 void SimulationState::AddActor(ActorId actor_id,
                                KinematicState kinematic_state,
                                StaticAttributes attributes,
                                TrafficLightState tl_state) {
-  actor_set.insert(actor_id);// 将actor的ID 插入到 actor_set 中
-  kinematic_state_map.insert({actor_id, kinematic_state});// 将actor的ID和运动状态插入到 kinematic_state_map 中
-  static_attribute_map.insert({actor_id, attributes});// 将actor的ID和静态属性插入到 static_attribute_map 中
-  tl_state_map.insert({actor_id, tl_state});// 将actor的ID和交通灯状态插入到 tl_state_map 中
+  // 与之前的 insert 行为一致，已存在的actor保持原状态
+  if (ContainsActor(actor_id)) {
+    return;
+  }
+  // 新actor放在最后一个槽位
+  const size_t slot = actor_ids.size();
+  actor_slots.insert({actor_id, slot});
+  actor_ids.push_back(actor_id);
+  locations.emplace_back();
+  rotations.emplace_back();
+  headings.emplace_back();
+  velocities.emplace_back();
+  speed_limits.emplace_back();
+  physics_enabled.emplace_back();
+  dormant.emplace_back();
+  hybrid_end_locations.emplace_back();
+  SetKinematicState(slot, kinematic_state);
+  tl_states.push_back(tl_state);
+  static_attributes.push_back(attributes);
 }
 // 检查模拟状态中是否包含特定的actor的ID
 bool SimulationState::ContainsActor(ActorId actor_id) const {
-// 如果在 actor_set 中找到该actor的ID，则返回 true，否则返回 false
-  return actor_set.find(actor_id) != actor_set.end();
+// 如果在 actor_slots 中找到该actor的ID，则返回 true，否则返回 false
+  return actor_slots.find(actor_id) != actor_slots.end();
 }
 // 从模拟状态中移除一个actor
 void SimulationState::RemoveActor(ActorId actor_id) {
-  actor_set.erase(actor_id); // 从 actor_set 中删除该actor的ID
-  kinematic_state_map.erase(actor_id);// 从 kinematic_state_map 中删除该actor的运动状态
-  static_attribute_map.erase(actor_id);// 从 static_attribute_map 中删除该actor的静态属性
-  tl_state_map.erase(actor_id);// 从 tl_state_map 中删除该actor的交通灯状态
+  const auto it = actor_slots.find(actor_id);
+  if (it == actor_slots.end()) {
+    return;
+  }
+  // 把最后一个槽位的actor移到被移除的槽位上，保持数组连续
+  const size_t slot = it->second;
+  const size_t last = actor_ids.size() - 1u;
+  if (slot != last) {
+    actor_ids[slot] = actor_ids[last];
+    locations[slot] = locations[last];
+    rotations[slot] = rotations[last];
+    headings[slot] = headings[last];
+    velocities[slot] = velocities[last];
+    speed_limits[slot] = speed_limits[last];
+    physics_enabled[slot] = physics_enabled[last];
+    dormant[slot] = dormant[last];
+    hybrid_end_locations[slot] = hybrid_end_locations[last];
+    tl_states[slot] = tl_states[last];
+    static_attributes[slot] = static_attributes[last];
+    actor_slots[actor_ids[slot]] = slot;
+  }
+  actor_slots.erase(it);
+  actor_ids.pop_back();
+  locations.pop_back();
+  rotations.pop_back();
+  headings.pop_back();
+  velocities.pop_back();
+  speed_limits.pop_back();
+  physics_enabled.pop_back();
+  dormant.pop_back();
+  hybrid_end_locations.pop_back();
+  tl_states.pop_back();
+  static_attributes.pop_back();
 }
 // 重置模拟状态，清空所有数据结构
 void SimulationState::Reset() {
-  actor_set.clear();// 清空 actor_set
-  kinematic_state_map.clear();// 清空 kinematic_state_map
-  static_attribute_map.clear();// 清空 static_attribute_map
-  tl_state_map.clear(); // 清空 tl_state_map
+  actor_slots.clear();
+  actor_ids.clear();
+  locations.clear();
+  rotations.clear();
+  headings.clear();
+  velocities.clear();
+  speed_limits.clear();
+  physics_enabled.clear();
+  dormant.clear();
+  hybrid_end_locations.clear();
+  tl_states.clear();
+  static_attributes.clear();
 }
 // 更新特定actor的运动状态
 void SimulationState::UpdateKinematicState(ActorId actor_id, KinematicState state) {
-  kinematic_state_map.at(actor_id) = state;// 使用 at 方法访问并更新特定actor的运动状态
+  SetKinematicState(GetSlot(actor_id), state);
 }
 // 更新特定actor的混合结束位置
 void SimulationState::UpdateKinematicHybridEndLocation(ActorId actor_id, cg::Location location) {
-  kinematic_state_map.at(actor_id).hybrid_end_location = location;// 使用 at 方法访问并更新特定actor的混合结束位置
+  hybrid_end_locations[GetSlot(actor_id)] = location;
 }
 // 更新特定actor的交通灯状态，注意特殊的绿色-黄色状态过渡处理
 void SimulationState::UpdateTrafficLightState(ActorId actor_id, TrafficLightState state) {
   // The green-yellow state transition is not notified to the vehicle. This is done to avoid
   // having vehicles stopped very near the intersection when only the rear part of the vehicle
   // is colliding with the trigger volume of the traffic light.
-  auto previous_tl_state = GetTLS(actor_id);
-  if (previous_tl_state.at_traffic_light && previous_tl_state.tl_state == TLS::Green) {
+  TrafficLightState &tl_state = tl_states[GetSlot(actor_id)];
+  if (tl_state.at_traffic_light && tl_state.tl_state == TLS::Green) {
     state.tl_state = TLS::Green;
   }
-// 使用 at 方法访问并更新特定actor的交通灯状态
-  tl_state_map.at(actor_id) = state;
+  tl_state = state;
 }
-// 获取特定actor的位置
+// 以下按 ID 访问的方法先查找槽位，再按槽位读取
 cg::Location SimulationState::GetLocation(ActorId actor_id) const {
-// 使用 at 方法访问并返回特定actor的位置	
-  return kinematic_state_map.at(actor_id).location;
+  return GetLocationAt(GetSlot(actor_id));
 }
-// 获取特定actor的混合结束位置
+
 cg::Location SimulationState::GetHybridEndLocation(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).hybrid_end_location;// 使用 at 方法访问并返回特定actor的混合结束位置
+  return GetHybridEndLocationAt(GetSlot(actor_id));
 }
-// 获取特定actor的旋转状态
+
 cg::Rotation SimulationState::GetRotation(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).rotation;// 使用 at 方法访问并返回特定actor的旋转状态
+  return GetRotationAt(GetSlot(actor_id));
 }
-// 获取特定actor的前进方向向量
+
 cg::Vector3D SimulationState::GetHeading(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).rotation.GetForwardVector(); // 使用 at 方法访问特定actor的旋转状态，然后获取其前进方向向量并返回
+  return GetHeadingAt(GetSlot(actor_id));
 }
-// 获取特定actor的速度向量
+
 cg::Vector3D SimulationState::GetVelocity(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).velocity;// 使用 at 方法访问并返回特定actor的速度向量
+  return GetVelocityAt(GetSlot(actor_id));
 }
-// 获取特定actor的速度限制
+
 float SimulationState::GetSpeedLimit(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).speed_limit; // 使用 at 方法访问并返回特定actor的速度限制
+  return GetSpeedLimitAt(GetSlot(actor_id));
 }
-// 检查特定actor的物理模拟是否启用
+
 bool SimulationState::IsPhysicsEnabled(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).physics_enabled; // 使用 at 方法访问并返回特定actor的物理模拟启用状态
+  return IsPhysicsEnabledAt(GetSlot(actor_id));
 }
-// 检查特定actor是否处于休眠状态
+
 bool SimulationState::IsDormant(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).is_dormant;// 使用 at 方法访问并返回特定actor的休眠状态
+  return IsDormantAt(GetSlot(actor_id));
 }
-// 获取特定actor的交通灯状态
+
 TrafficLightState SimulationState::GetTLS(ActorId actor_id) const {
-  return tl_state_map.at(actor_id);// 使用 at 方法访问并返回特定actor的交通灯状态
+  return GetTLSAt(GetSlot(actor_id));
 }
-// 获取特定actor的类型
+
 ActorType SimulationState::GetType(ActorId actor_id) const {
-  return static_attribute_map.at(actor_id).actor_type; // 使用 at 方法访问特定actor的静态属性，然后返回actor类型
+  return GetTypeAt(GetSlot(actor_id));
 }
-// 获取特定actor的尺寸
+
 cg::Vector3D SimulationState::GetDimensions(ActorId actor_id) const {
-// 使用 at 方法访问特定actor的静态属性，然后构建并返回actor的尺寸向量	
-  const StaticAttributes &attributes = static_attribute_map.at(actor_id);
-  return cg::Vector3D(attributes.half_length, attributes.half_width, attributes.half_height);
+  return GetDimensionsAt(GetSlot(actor_id));
 }
 
 } // namespace  traffic_manager
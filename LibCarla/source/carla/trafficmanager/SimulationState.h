@@ -1,7 +1,9 @@
 
 #pragma once
 
-#include <unordered_set> // 引入无序集合头文件
+#include <cstdint>
+#include <unordered_map> // 引入无序映射头文件
+#include <vector> // 引入动态数组头文件
 
 #include "carla/trafficmanager/DataStructures.h" // 引入数据结构的头文件
 
@@ -44,17 +46,40 @@ struct StaticAttributes {
 using StaticAttributeMap = std::unordered_map<ActorId, StaticAttributes>; // 定义静态属性映射
 
 /// 该类保持了仿真中所有车辆的状态。
+///
+/// 状态按结构体数组（SoA）的方式存放：每个参与者占用一个槽位，每种属性
+/// 是一个按槽位索引的连续数组。参与者 ID 到槽位的映射只在添加或移除参与者
+/// 时改变，移除时用最后一个槽位填补空位，所以槽位始终是连续的
+/// [0, GetNumberOfActors())。
+/// 阶段在一次 Update 中先用 GetSlot 取得槽位，再通过 *At 方法按槽位读取，
+/// 避免对每个属性都做一次哈希查找。槽位在参与者被移除后可能改变，
+/// 不能跨周期保存。
 class SimulationState {
 
 private:
-  // 存储仿真中所有参与者的ID的结构
-  std::unordered_set<ActorId> actor_set; 
-  // 存储参与者动态运动相关状态的结构
-  KinematicStateMap kinematic_state_map; 
-  // 存储参与者静态属性的结构
-  StaticAttributeMap static_attribute_map; 
-  // 存储参与者动态交通灯相关状态的结构
-  TrafficLightStateMap tl_state_map; 
+  // 参与者 ID 到槽位的映射
+  std::unordered_map<ActorId, size_t> actor_slots;
+  // 每个槽位上的参与者 ID
+  std::vector<ActorId> actor_ids;
+  // 运动状态，按槽位索引
+  std::vector<cg::Location> locations;
+  std::vector<cg::Rotation> rotations;
+  // 由 rotations 预先计算的朝向向量，避免每次查询都做三角函数运算
+  std::vector<cg::Vector3D> headings;
+  std::vector<cg::Vector3D> velocities;
+  std::vector<float> speed_limits;
+  // 使用 uint8_t 而不是按位压缩的 std::vector<bool>，并行阶段写入不同槽位时
+  // 不会竞争同一个字
+  std::vector<uint8_t> physics_enabled;
+  std::vector<uint8_t> dormant;
+  std::vector<cg::Location> hybrid_end_locations;
+  // 交通灯状态，按槽位索引
+  std::vector<TrafficLightState> tl_states;
+  // 静态属性，按槽位索引
+  std::vector<StaticAttributes> static_attributes;
+
+  // 将运动状态写入指定槽位
+  void SetKinematicState(const size_t slot, const KinematicState &state);
 
 public :
   SimulationState(); // 构造函数
@@ -83,6 +108,82 @@ public :
   // 更新交通灯状态的方法
   void UpdateTrafficLightState(ActorId actor_id, TrafficLightState state);
 
+  ////////////////////////////// 按槽位访问 //////////////////////////////
+
+  // 获取参与者所在槽位的方法，参与者不存在时抛出 std::out_of_range
+  size_t GetSlot(const ActorId actor_id) const {
+    return actor_slots.at(actor_id);
+  }
+
+  // 获取参与者数量（即有效槽位数）的方法
+  size_t GetNumberOfActors() const {
+    return actor_ids.size();
+  }
+
+  // 按槽位顺序排列的数组，可以直接线性遍历
+  const std::vector<ActorId> &GetActorIds() const {
+    return actor_ids;
+  }
+
+  const std::vector<cg::Location> &GetLocations() const {
+    return locations;
+  }
+
+  const std::vector<cg::Vector3D> &GetVelocities() const {
+    return velocities;
+  }
+
+  ActorId GetActorIdAt(const size_t slot) const {
+    return actor_ids[slot];
+  }
+
+  const cg::Location &GetLocationAt(const size_t slot) const {
+    return locations[slot];
+  }
+
+  const cg::Location &GetHybridEndLocationAt(const size_t slot) const {
+    return hybrid_end_locations[slot];
+  }
+
+  const cg::Rotation &GetRotationAt(const size_t slot) const {
+    return rotations[slot];
+  }
+
+  const cg::Vector3D &GetHeadingAt(const size_t slot) const {
+    return headings[slot];
+  }
+
+  const cg::Vector3D &GetVelocityAt(const size_t slot) const {
+    return velocities[slot];
+  }
+
+  float GetSpeedLimitAt(const size_t slot) const {
+    return speed_limits[slot];
+  }
+
+  bool IsPhysicsEnabledAt(const size_t slot) const {
+    return physics_enabled[slot] != 0u;
+  }
+
+  bool IsDormantAt(const size_t slot) const {
+    return dormant[slot] != 0u;
+  }
+
+  const TrafficLightState &GetTLSAt(const size_t slot) const {
+    return tl_states[slot];
+  }
+
+  ActorType GetTypeAt(const size_t slot) const {
+    return static_attributes[slot].actor_type;
+  }
+
+  cg::Vector3D GetDimensionsAt(const size_t slot) const {
+    const StaticAttributes &attributes = static_attributes[slot];
+    return cg::Vector3D(attributes.half_length, attributes.half_width, attributes.half_height);
+  }
+
+  ////////////////////////////// 按 ID 访问 //////////////////////////////
+
   // 获取参与者位置的方法
   cg::Location GetLocation(const ActorId actor_id) const;
 
@@ -122,4 +223,4 @@ public :
 };
 
 } // namespace traffic_manager
-} // namespace carla
\ No newline at end of file
+} // namespace carla
@@ -72,6 +72,17 @@ public:
     }
   }
 
+  /// \brief 设置逐车辆阶段（目前为碰撞检测阶段）并行执行的线程数。
+  /// \param number_of_threads 线程数，小于等于1表示串行执行
+  /// \note 碰撞几何只依赖周期开始时的状态，与线程数无关；但多个线程抽取
+  /// 随机数的顺序不固定，使用相同的随机种子也不能逐位复现忽略碰撞的决定。
+  void SetParallelStageThreads(const size_t number_of_threads) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetParallelStageThreads(number_of_threads);
+    }
+  }
+
   /// \brief 设置自定义路径。  
 /// \param actor 对应的Actor指针。  
 /// \param path 要设置的路径。  
@@ -294,6 +294,13 @@ public:
  */
   virtual void SetOSMMode(const bool mode_switch) = 0;
 
+  /**
+ * @brief 设置逐车辆阶段并行执行的线程数。
+ *
+ * @param number_of_threads 线程数，小于等于1表示串行执行。
+ */
+  virtual void SetParallelStageThreads(const size_t number_of_threads) = 0;
+
   /**
    * @brief 设置自定义导入路径。
    *
@@ -290,6 +290,12 @@ public:
     _client->call("set_osm_mode", mode_switch);/// 调用_client的call方法设置Open Street Map模式
   }
 
+  /// 设置逐车辆阶段并行执行的线程数
+  void SetParallelStageThreads(const size_t number_of_threads) {
+    DEBUG_ASSERT(_client != nullptr);
+    _client->call("set_parallel_stage_threads", number_of_threads);
+  }
+
   /// 设置自定义路径
   void SetCustomPath(const carla::rpc::Actor &actor, const Path path, const bool empty_buffer) {
     DEBUG_ASSERT(_client != nullptr);/// 断言_client指针不为空
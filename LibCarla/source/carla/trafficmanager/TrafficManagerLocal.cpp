@@ -7,8 +7,10 @@
 #include <algorithm>
 
 #include "carla/Logging.h"
+#include "carla/profiler/Profiler.h"
 
 #include "carla/client/detail/Simulator.h"
+#include "carla/client/FileTransfer.h"
 
 #include "carla/trafficmanager/TrafficManagerLocal.h"
 // 定义在carla命名空间下的traffic_manager命名空间
@@ -46,13 +48,13 @@ TrafficManagerLocal::TrafficManagerLocal(
                                          localization_frame,
                                          random_device)),
 //用于处理车辆碰撞检测、避免碰撞等相关逻辑
-    collision_stage(CollisionStage(vehicle_id_list,
-                                   simulation_state,
-                                   buffer_map,
-                                   track_traffic,
-                                   parameters,
-                                   collision_frame,
-                                   random_device)),
+    collision_stage(vehicle_id_list,
+                    simulation_state,
+                    buffer_map,
+                    track_traffic,
+                    parameters,
+                    collision_frame,
+                    random_device),
 //用于处理车辆与交通信号灯交互相关逻辑
     traffic_light_stage(TrafficLightStage(vehicle_id_list,
                                           simulation_state,
@@ -120,19 +122,17 @@ void TrafficManagerLocal::SetupLocalMap() {
   const carla::SharedPtr<const cc::Map> world_map = world.GetMap();//获取世界地图的共享指针
   local_map = std::make_shared<InMemoryMap>(world_map);
  // 获取缓存的地图文件
+  // GetRequiredFiles 会把缺少的文件下载到本地缓存中，之后直接映射文件加载
   auto files = episode_proxy.Lock()->GetRequiredFiles("TM");
-  if (!files.empty()) {
-    auto content = episode_proxy.Lock()->GetCacheFile(files[0], true);
-    if (content.size() != 0) {
-      local_map->Load(content);
-    } else {
-      log_warning("No InMemoryMap cache found. Setting up local map. This may take a while...");
-      local_map->SetUp();
+  if (!files.empty() && cc::FileTransfer::FileExists(files[0])) {
+    if (local_map->Load(cc::FileTransfer::GetFullPath(files[0]))) {
+      return;
     }
-  } else {
-    log_warning("No InMemoryMap cache found. Setting up local map. This may take a while...");
-    local_map->SetUp();
+    // 缓存已过期或损坏，丢弃可能已部分加载的内容
+    local_map = std::make_shared<InMemoryMap>(world_map);
   }
+  log_warning("No valid InMemoryMap cache found. Setting up local map. This may take a while...");
+  local_map->SetUp();
 }
 // 启动交通管理器的工作线程
 void TrafficManagerLocal::Start() {
@@ -181,9 +181,13 @@ void TrafficManagerLocal::Run() {
       last_frame = timestamp.frame;
     }
 
+    CARLA_PROFILE_SCOPE(traffic_manager, cycle);
     std::unique_lock<std::mutex> registration_lock(registration_mutex);
     // 更新模拟状态、角色生命周期并执行必要的清理
-    alsm.Update();
+    {
+      CARLA_PROFILE_SCOPE(traffic_manager, alsm);
+      alsm.Update();
+    }
 
     // 基于已注册车辆数量变化的阶段间通信帧重新分配
     int current_registered_vehicles_state = registered_vehicles.GetState();
@@ -221,23 +225,47 @@ void TrafficManagerLocal::Run() {
     control_frame.resize(number_of_vehicles);
 
     // 运行核心操作阶段
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      localization_stage.Update(index);
+    // 定位阶段串行执行，变道时它会修改 TrackTraffic 和其它车辆的路径缓冲区
+    {
+      CARLA_PROFILE_SCOPE(traffic_manager, localization_stage);
+      for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+        localization_stage.Update(index);
+      }
     }
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      collision_stage.Update(index);
+    // 碰撞检测只读取定位阶段的结果，各车辆之间互不依赖，可以并行执行。
+    // 几何信息使用周期开始时的碰撞锁，结果与线程数和执行顺序无关
+    {
+      CARLA_PROFILE_SCOPE(traffic_manager, collision_stage);
+      collision_stage.SnapshotCollisionLocks();
+      parallel_executor.SetNumberOfThreads(parameters.GetParallelStageThreads());
+      parallel_executor.ParallelFor(vehicle_id_list.size(), [this](unsigned long index) {
+        collision_stage.Update(index);
+      });
+      collision_stage.ClearCycleCache();
     }
-    collision_stage.ClearCycleCache();
     vehicle_light_stage.UpdateWorldInfo();
+    // 这三个阶段仍然串行执行：交通灯阶段按车辆顺序分配路口通行权，运动规划阶段
+    // 写入 SimulationState 和 TrackTraffic，车灯阶段向 control_frame 追加命令。
+    // 这三个阶段按车辆交替执行，分别统计每次调用的耗时
     for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      traffic_light_stage.Update(index);
-      motion_plan_stage.Update(index);
-      vehicle_light_stage.Update(index);
+      {
+        CARLA_PROFILE_SCOPE(traffic_manager, traffic_light_stage);
+        traffic_light_stage.Update(index);
+      }
+      {
+        CARLA_PROFILE_SCOPE(traffic_manager, motion_plan_stage);
+        motion_plan_stage.Update(index);
+      }
+      {
+        CARLA_PROFILE_SCOPE(traffic_manager, vehicle_light_stage);
+        vehicle_light_stage.Update(index);
+      }
     }
 
     registration_lock.unlock();
 
     // 将当前周期的批处理命令发送给模拟器
+    CARLA_PROFILE_SCOPE(traffic_manager, apply_batch);
     if (synchronous_mode) {
       episode_proxy.Lock()->ApplyBatchSync(control_frame, false);
       step_end.store(true);
@@ -413,6 +441,10 @@ void TrafficManagerLocal::SetHybridPhysicsRadius(const float radius) {
 void TrafficManagerLocal::SetOSMMode(const bool mode_switch) {
   parameters.SetOSMMode(mode_switch);
 }
+// 设置逐车辆阶段并行执行的线程数
+void TrafficManagerLocal::SetParallelStageThreads(const size_t number_of_threads) {
+  parameters.SetParallelStageThreads(number_of_threads);
+}
 // 设置自定义路径给车辆
 void TrafficManagerLocal::SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
   parameters.SetCustomPath(actor, path, empty_buffer);
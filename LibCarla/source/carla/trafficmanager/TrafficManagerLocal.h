@@ -20,6 +20,7 @@
 
 #include "carla/trafficmanager/AtomicActorSet.h"///@brief 包含交通管理器中的原子参与者集合类，用于管理仿真中的参与者（如车辆、行人）
 #include "carla/trafficmanager/InMemoryMap.h"///@brief 包含交通管理器的内存地图类，用于在内存中存储地图数据
+#include "carla/trafficmanager/ParallelExecutor.h"///@brief 包含逐车辆阶段的并行执行器，用于在多个线程上分担每辆车的计算
 #include "carla/trafficmanager/Parameters.h"///@brief 包含交通管理器的参数配置类，用于配置交通管理器的各种参数
 #include "carla/trafficmanager/RandomGenerator.h"///@brief 包含交通管理器的随机数生成器类，用于生成随机数或随机序列
 #include "carla/trafficmanager/SimulationState.h"///@brief 包含交通管理器的仿真状态类，用于管理仿真的全局状态
@@ -168,6 +169,9 @@ private:
   /// @brief 用于顺序执行子组件的单个工作线程  
   /// 使用std::unique_ptr<std::thread>管理线程的生命周期，确保线程在不再需要时能够被正确销毁
   std::unique_ptr<std::thread> worker_thread;
+  /// @brief 逐车辆阶段的并行执行器
+  /// 线程数由 Parameters::GetParallelStageThreads 决定，只在工作线程中使用
+  ParallelExecutor parallel_executor;
   /// @brief 随机化种子  
   /// 使用当前时间作为随机化种子，确保每次程序运行时都能产生不同的随机序列
   uint64_t seed {static_cast<uint64_t>(time(NULL))};
@@ -382,6 +386,11 @@ public:
 /// @param mode_switch 是否启用Open Street Map模式。如果为true，则启用；如果为false，则禁用.
   void SetOSMMode(const bool mode_switch);
 
+  /// @brief 设置逐车辆阶段并行执行的线程数。
+///
+/// @param number_of_threads 线程数，小于等于1表示串行执行。
+  void SetParallelStageThreads(const size_t number_of_threads);
+
   /// @brief 设置自定义路径。  
 ///   
 /// @param actor 要设置路径的车辆指针。  
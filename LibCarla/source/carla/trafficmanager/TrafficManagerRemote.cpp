@@ -287,6 +287,11 @@ void TrafficManagerRemote::SetOSMMode(const bool mode_switch) {
 // 通过客户端设置 OSM 模式开关
 }
 
+void TrafficManagerRemote::SetParallelStageThreads(const size_t number_of_threads) {
+  client.SetParallelStageThreads(number_of_threads);
+// 通过客户端设置逐车辆阶段的并行线程数
+}
+
 void TrafficManagerRemote::SetCustomPath(const ActorPtr &_actor, const Path path, const bool empty_buffer) {
   carla::rpc::Actor actor(_actor->Serialize());
 // 将输入的车辆转换为 rpc 格式的车辆
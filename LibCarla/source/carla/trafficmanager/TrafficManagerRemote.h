@@ -293,6 +293,13 @@ public:
  */
   void SetOSMMode(const bool mode_switch);
 
+  /**
+ * @brief 设置逐车辆阶段并行执行的线程数。
+ *
+ * @param number_of_threads 线程数，小于等于1表示串行执行。
+ */
+  void SetParallelStageThreads(const size_t number_of_threads);
+
   /**
  * @brief 设置自定义路径。
  *
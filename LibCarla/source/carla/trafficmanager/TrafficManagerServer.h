@@ -299,6 +299,12 @@ public:
         tm->SetOSMMode(mode_switch);
       });
 
+      /// 设置逐车辆阶段并行执行的线程数的方法
+      /// @param number_of_threads 线程数，小于等于1表示串行执行
+      server->bind("set_parallel_stage_threads", [=](const size_t number_of_threads) {
+        tm->SetParallelStageThreads(number_of_threads);
+      });
+
       /// 设置自定义路径的方法  
       /// @param actor CARLA中的Actor对象  
       /// @param path 自定义的路径  
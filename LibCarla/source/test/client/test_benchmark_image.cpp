@@ -0,0 +1,83 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StopWatch.h>
+#include <carla/image/ImageConverter.h>
+#include <carla/image/ImageView.h>
+
+#include <cstring>
+#include <iomanip>
+#include <vector>
+
+using namespace carla::image;
+
+// 4K 图像
+static constexpr size_t IMAGE_WIDTH = 3840u;
+static constexpr size_t IMAGE_HEIGHT = 2160u;
+
+// 每个转换测量的遍数
+static constexpr size_t NUMBER_OF_PASSES = 5u;
+
+static boost::gil::bgra8_view_t MakeView(std::vector<uint8_t> &buffer) {
+  return boost::gil::interleaved_view(
+      IMAGE_WIDTH,
+      IMAGE_HEIGHT,
+      reinterpret_cast<boost::gil::bgra8_pixel_t *>(buffer.data()),
+      static_cast<long>(4u * IMAGE_WIDTH));
+}
+
+// 用通用的 Boost.GIL 颜色转换视图原地转换，与优化之前的 ImageConverter 相同
+template <typename ColorConverter>
+static void ConvertWithGil(boost::gil::bgra8_view_t &view, ColorConverter converter) {
+  ImageConverter::CopyPixels(
+      ImageView::MakeColorConvertedView<boost::gil::bgra8_view_t, boost::gil::bgra8_pixel_t>(view, converter),
+      view);
+}
+
+template <typename ColorConverter>
+static void BenchmarkConverter(const char *name, const std::vector<uint8_t> &source) {
+  std::vector<uint8_t> expected(source.size());
+  std::vector<uint8_t> result(source.size());
+  auto expected_view = MakeView(expected);
+  auto result_view = MakeView(result);
+
+  double gil_ms = 0.0;
+  double raw_ms = 0.0;
+  for (size_t pass = 0u; pass < NUMBER_OF_PASSES; ++pass) {
+    std::memcpy(expected.data(), source.data(), source.size());
+    carla::StopWatch gil_watch;
+    ConvertWithGil(expected_view, ColorConverter());
+    gil_watch.Stop();
+    gil_ms += static_cast<double>(gil_watch.GetElapsedTime<std::chrono::microseconds>()) / 1e3;
+
+    std::memcpy(result.data(), source.data(), source.size());
+    carla::StopWatch raw_watch;
+    ImageConverter::ConvertInPlace(result_view, ColorConverter());
+    raw_watch.Stop();
+    raw_ms += static_cast<double>(raw_watch.GetElapsedTime<std::chrono::microseconds>()) / 1e3;
+
+    ASSERT_TRUE(expected == result) << name;
+  }
+  std::cout << std::setw(20) << name << ": "
+            << gil_ms / NUMBER_OF_PASSES << " ms (Boost.GIL) vs "
+            << raw_ms / NUMBER_OF_PASSES << " ms per "
+            << IMAGE_WIDTH << "x" << IMAGE_HEIGHT << " image" << std::endl;
+}
+
+TEST(benchmark_image, color_converters) {
+  // 随机的 BGRA 像素，覆盖深度的所有字节和所有语义标签
+  std::vector<uint8_t> source(4u * IMAGE_WIDTH * IMAGE_HEIGHT);
+  uint32_t state = 12345u;
+  for (auto &byte : source) {
+    state = state * 1664525u + 1013904223u;
+    byte = static_cast<uint8_t>(state >> 24u);
+  }
+  BenchmarkConverter<ColorConverter::Depth>("Depth", source);
+  BenchmarkConverter<ColorConverter::LogarithmicDepth>("LogarithmicDepth", source);
+  BenchmarkConverter<ColorConverter::CityScapesPalette>("CityScapesPalette", source);
+}
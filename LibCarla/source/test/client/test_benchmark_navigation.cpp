@@ -0,0 +1,361 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "Random.h"
+
+#include <carla/StopWatch.h>
+#include <carla/nav/Navigation.h>
+#include <carla/nav/PathPlanner.h>
+
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <iomanip>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using namespace carla::nav;
+
+// 测试用导航网格的格子数和每个格子的边长（米）
+static constexpr int GRID_CELLS = 100;
+static constexpr float GRID_CELL_SIZE = 4.0f;
+// 每种行人数量测量的周期数
+static constexpr size_t NUMBER_OF_TICKS = 20u;
+
+// Navigation::Load 读取的导航网格文件格式：文件头之后是每个瓦片的头和数据
+#pragma pack(push, 1)
+struct NavMeshSetHeader {
+  int magic;
+  int version;
+  int num_tiles;
+  dtNavMeshParams params;
+};
+struct NavMeshTileHeader {
+  dtTileRef tile_ref;
+  int data_size;
+};
+#pragma pack(pop)
+
+// 生成一个平坦的正方形人行道导航网格，按 Navigation::Load 读取的格式序列化
+static std::vector<uint8_t> MakeGridNavMesh() {
+  const float cs = 0.5f;
+  const float ch = 0.2f;
+  const float extent = GRID_CELLS * GRID_CELL_SIZE;
+  const unsigned short step = static_cast<unsigned short>(GRID_CELL_SIZE / cs);
+  const int side = GRID_CELLS + 1;
+
+  // 顶点坐标以格子为单位，y 对应高度 0
+  std::vector<unsigned short> verts;
+  for (int i = 0; i < side; ++i) {
+    for (int j = 0; j < side; ++j) {
+      verts.push_back(static_cast<unsigned short>(i * step));
+      verts.push_back(static_cast<unsigned short>(1.0f / ch));
+      verts.push_back(static_cast<unsigned short>(j * step));
+    }
+  }
+
+  // 每个多边形是一个四边形，前一半是顶点下标，后一半是每条边相邻的多边形
+  const unsigned short border = 0x800f;
+  auto vertex = [side](int i, int j) { return static_cast<unsigned short>(i * side + j); };
+  auto poly = [](int i, int j) { return static_cast<unsigned short>(i * GRID_CELLS + j); };
+  std::vector<unsigned short> polys;
+  for (int i = 0; i < GRID_CELLS; ++i) {
+    for (int j = 0; j < GRID_CELLS; ++j) {
+      polys.push_back(vertex(i, j));
+      polys.push_back(vertex(i, j + 1));
+      polys.push_back(vertex(i + 1, j + 1));
+      polys.push_back(vertex(i + 1, j));
+      polys.push_back(i > 0 ? poly(i - 1, j) : border);
+      polys.push_back(j + 1 < GRID_CELLS ? poly(i, j + 1) : border);
+      polys.push_back(i + 1 < GRID_CELLS ? poly(i + 1, j) : border);
+      polys.push_back(j > 0 ? poly(i, j - 1) : border);
+    }
+  }
+  const int number_of_polys = GRID_CELLS * GRID_CELLS;
+  std::vector<unsigned short> flags(number_of_polys, CARLA_TYPE_SIDEWALK);
+  std::vector<unsigned char> areas(number_of_polys, CARLA_AREA_SIDEWALK);
+
+  dtNavMeshCreateParams params;
+  std::memset(&params, 0, sizeof(params));
+  params.verts = verts.data();
+  params.vertCount = side * side;
+  params.polys = polys.data();
+  params.polyFlags = flags.data();
+  params.polyAreas = areas.data();
+  params.polyCount = number_of_polys;
+  params.nvp = 4;
+  params.walkableHeight = 1.8f;
+  params.walkableRadius = 0.3f;
+  params.walkableClimb = 0.9f;
+  params.bmin[0] = 0.0f;
+  params.bmin[1] = -1.0f;
+  params.bmin[2] = 0.0f;
+  params.bmax[0] = extent;
+  params.bmax[1] = 1.0f;
+  params.bmax[2] = extent;
+  params.cs = cs;
+  params.ch = ch;
+  params.buildBvTree = true;
+
+  unsigned char *data = nullptr;
+  int data_size = 0;
+  if (!dtCreateNavMeshData(&params, &data, &data_size)) {
+    return {};
+  }
+
+  dtNavMeshParams mesh_params;
+  std::memset(&mesh_params, 0, sizeof(mesh_params));
+  dtVcopy(mesh_params.orig, params.bmin);
+  mesh_params.tileWidth = extent;
+  mesh_params.tileHeight = extent;
+  mesh_params.maxTiles = 1;
+  mesh_params.maxPolys = number_of_polys;
+
+  // 用临时的导航网格计算第一个瓦片的引用
+  dtTileRef tile_ref = 0u;
+  dtNavMesh *mesh = dtAllocNavMesh();
+  if (mesh != nullptr && !dtStatusFailed(mesh->init(&mesh_params))) {
+    tile_ref = mesh->encodePolyId(1u, 0u, 0u);
+  }
+  dtFreeNavMesh(mesh);
+
+  NavMeshSetHeader header;
+  NavMeshTileHeader tile_header;
+  header.magic = 'M' << 24 | 'S' << 16 | 'E' << 8 | 'T';
+  header.version = 1;
+  header.num_tiles = 1;
+  header.params = mesh_params;
+  tile_header.tile_ref = tile_ref;
+  tile_header.data_size = data_size;
+
+  std::vector<uint8_t> content(sizeof(header) + sizeof(tile_header) + static_cast<size_t>(data_size));
+  std::memcpy(content.data(), &header, sizeof(header));
+  std::memcpy(content.data() + sizeof(header), &tile_header, sizeof(tile_header));
+  std::memcpy(content.data() + sizeof(header) + sizeof(tile_header), data, static_cast<size_t>(data_size));
+  dtFree(data);
+  return content;
+}
+
+// 从 MakeGridNavMesh 生成的单个瓦片直接创建导航网格，用于单独测试 PathPlanner
+static dtNavMesh *LoadGridNavMesh(const std::vector<uint8_t> &content) {
+  NavMeshSetHeader header;
+  NavMeshTileHeader tile_header;
+  std::memcpy(&header, content.data(), sizeof(header));
+  std::memcpy(&tile_header, content.data() + sizeof(header), sizeof(tile_header));
+  dtNavMesh *mesh = dtAllocNavMesh();
+  if (mesh == nullptr || dtStatusFailed(mesh->init(&header.params))) {
+    dtFreeNavMesh(mesh);
+    return nullptr;
+  }
+  unsigned char *data = static_cast<unsigned char *>(dtAlloc(static_cast<size_t>(tile_header.data_size), DT_ALLOC_PERM));
+  std::memcpy(data, content.data() + sizeof(header) + sizeof(tile_header), static_cast<size_t>(tile_header.data_size));
+  mesh->addTile(data, tile_header.data_size, DT_TILE_FREE_DATA, tile_header.tile_ref, 0);
+  return mesh;
+}
+
+// 网格内的随机位置，离边界留出一个格子
+static carla::geom::Location RandomLocationOnGrid() {
+  const double max = GRID_CELLS * GRID_CELL_SIZE - GRID_CELL_SIZE;
+  return {
+      static_cast<float>(util::Random::Uniform(GRID_CELL_SIZE, max)),
+      static_cast<float>(util::Random::Uniform(GRID_CELL_SIZE, max)),
+      0.9f};
+}
+
+TEST(benchmark_navigation, crowd_update) {
+  const auto content = MakeGridNavMesh();
+  ASSERT_FALSE(content.empty());
+
+  for (const size_t number_of_walkers : {500u, 2000u, 5000u}) {
+    Navigation nav;
+    ASSERT_TRUE(nav.Load(content));
+    nav.SetSeed(42u);
+
+    std::vector<carla::rpc::ActorId> ids;
+    for (size_t i = 0u; i < number_of_walkers; ++i) {
+      const auto id = static_cast<carla::rpc::ActorId>(i + 1u);
+      ASSERT_TRUE(nav.AddWalker(id, RandomLocationOnGrid()));
+      ASSERT_TRUE(nav.SetWalkerDirectTarget(id, RandomLocationOnGrid()));
+      ids.push_back(id);
+    }
+
+    // 每个周期更新一次人群，然后读取所有行人的状态
+    double checksum = 0.0;
+    size_t number_of_reads = 0u;
+    size_t update_ns = 0u;
+    size_t read_ns = 0u;
+    size_t bulk_ns = 0u;
+    WalkerStates states;
+    for (size_t tick = 0u; tick < NUMBER_OF_TICKS; ++tick) {
+      carla::StopWatch update_watch;
+      nav.UpdateCrowd(0.05);
+      update_watch.Stop();
+      update_ns += update_watch.GetElapsedTime<std::chrono::nanoseconds>();
+
+      carla::StopWatch read_watch;
+      for (const auto id : ids) {
+        carla::geom::Transform transform;
+        float speed = 0.0f;
+        if (nav.GetWalkerTransform(id, transform) && nav.GetWalkerSpeed(id, speed)) {
+          checksum += transform.location.x + transform.location.y + speed;
+          ++number_of_reads;
+        }
+      }
+      read_watch.Stop();
+      read_ns += read_watch.GetElapsedTime<std::chrono::nanoseconds>();
+
+      // 一次性读取所有行人，结果必须和逐个读取相同
+      carla::StopWatch bulk_watch;
+      nav.GetWalkerStates(states);
+      bulk_watch.Stop();
+      bulk_ns += bulk_watch.GetElapsedTime<std::chrono::nanoseconds>();
+      ASSERT_EQ(states.size(), ids.size());
+      for (size_t i = 0u; i < states.size(); ++i) {
+        carla::geom::Transform transform;
+        ASSERT_TRUE(nav.GetWalkerTransform(states.ids[i], transform));
+        EXPECT_EQ(states.transforms[i].location, transform.location);
+        EXPECT_EQ(states.transforms[i].rotation.yaw, transform.rotation.yaw);
+        EXPECT_EQ(states.speeds[i], nav.GetWalkerSpeed(states.ids[i]));
+      }
+    }
+
+    // 行人必须留在导航网格上
+    for (const auto id : ids) {
+      carla::geom::Location location;
+      ASSERT_TRUE(nav.GetWalkerPosition(id, location));
+      EXPECT_GE(location.x, -1.0f);
+      EXPECT_GE(location.y, -1.0f);
+      EXPECT_LE(location.x, GRID_CELLS * GRID_CELL_SIZE + 1.0f);
+      EXPECT_LE(location.y, GRID_CELLS * GRID_CELL_SIZE + 1.0f);
+    }
+    EXPECT_EQ(number_of_reads, NUMBER_OF_TICKS * number_of_walkers);
+    EXPECT_TRUE(std::isfinite(checksum));
+
+    std::cout << std::setw(6) << number_of_walkers << " walkers: "
+              << static_cast<double>(update_ns) / (1e3 * NUMBER_OF_TICKS)
+              << " us per crowd update, "
+              << static_cast<double>(read_ns) / (1e3 * NUMBER_OF_TICKS)
+              << " us reading walkers one by one, "
+              << static_cast<double>(bulk_ns) / (1e3 * NUMBER_OF_TICKS)
+              << " us reading all walkers at once per tick" << std::endl;
+  }
+}
+
+TEST(benchmark_navigation, path_planning) {
+  constexpr size_t number_of_pairs = 200u;
+  constexpr size_t number_of_queries = 10u * number_of_pairs;
+
+  Navigation nav;
+  ASSERT_TRUE(nav.Load(MakeGridNavMesh()));
+
+  // 重复的起点和终点，模拟大量行人在相同的地点之间重新规划路线
+  std::vector<std::pair<carla::geom::Location, carla::geom::Location>> pairs;
+  for (size_t i = 0u; i < number_of_pairs; ++i) {
+    pairs.emplace_back(RandomLocationOnGrid(), RandomLocationOnGrid());
+  }
+  std::vector<size_t> queries(number_of_queries);
+  for (size_t i = 0u; i < number_of_queries; ++i) {
+    queries[i] = i % number_of_pairs;
+  }
+  util::Random::Shuffle(queries);
+
+  // 在调用线程上逐个规划
+  std::vector<NavPath> sync_paths(number_of_queries);
+  size_t number_found = 0u;
+  carla::StopWatch sync_watch;
+  for (size_t i = 0u; i < number_of_queries; ++i) {
+    const auto &pair = pairs[queries[i]];
+    if (nav.GetPath(pair.first, pair.second, nullptr, sync_paths[i].path, sync_paths[i].area)) {
+      ++number_found;
+    }
+  }
+  sync_watch.Stop();
+  EXPECT_EQ(number_found, number_of_queries);
+
+  // 提交到线程池，结果必须和同步规划相同
+  std::vector<std::future<boost::optional<NavPath>>> futures;
+  futures.reserve(number_of_queries);
+  carla::StopWatch async_watch;
+  for (size_t i = 0u; i < number_of_queries; ++i) {
+    const auto &pair = pairs[queries[i]];
+    futures.emplace_back(nav.GetPathAsync(pair.first, pair.second));
+  }
+  std::vector<boost::optional<NavPath>> async_paths;
+  async_paths.reserve(number_of_queries);
+  for (auto &future : futures) {
+    async_paths.emplace_back(future.get());
+  }
+  async_watch.Stop();
+
+  for (size_t i = 0u; i < number_of_queries; ++i) {
+    ASSERT_TRUE(async_paths[i] != boost::none);
+    EXPECT_EQ(async_paths[i]->path, sync_paths[i].path);
+    EXPECT_EQ(async_paths[i]->area, sync_paths[i].area);
+  }
+
+  std::cout << number_of_queries << " path queries over " << number_of_pairs << " pairs: "
+            << static_cast<double>(sync_watch.GetElapsedTime<std::chrono::microseconds>()) / number_of_queries
+            << " us per synchronous query, "
+            << static_cast<double>(async_watch.GetElapsedTime<std::chrono::microseconds>()) / number_of_queries
+            << " us per query on the planner pool" << std::endl;
+}
+
+TEST(benchmark_navigation, path_planning_cache) {
+  constexpr size_t number_of_pairs = 200u;
+  constexpr size_t number_of_queries = 10u * number_of_pairs;
+
+  const auto content = MakeGridNavMesh();
+  ASSERT_FALSE(content.empty());
+  std::unique_ptr<dtNavMesh, decltype(&dtFreeNavMesh)> mesh(LoadGridNavMesh(content), &dtFreeNavMesh);
+  ASSERT_TRUE(mesh != nullptr);
+
+  std::vector<std::pair<carla::geom::Location, carla::geom::Location>> pairs;
+  for (size_t i = 0u; i < number_of_pairs; ++i) {
+    pairs.emplace_back(RandomLocationOnGrid(), RandomLocationOnGrid());
+  }
+  std::vector<size_t> queries(number_of_queries);
+  for (size_t i = 0u; i < number_of_queries; ++i) {
+    queries[i] = i % number_of_pairs;
+  }
+  util::Random::Shuffle(queries);
+
+  dtQueryFilter filter;
+  filter.setIncludeFlags(CARLA_TYPE_WALKABLE);
+  filter.setExcludeFlags(CARLA_TYPE_NONE);
+
+  // 每次都调用 findPath 的规划器和缓存多边形通道的规划器，都在调用线程上执行
+  PathPlanner uncached(*mesh, 2048, 0u, 0u);
+  PathPlanner cached(*mesh, 2048, 0u);
+  auto run = [&](PathPlanner &planner, std::vector<NavPath> &paths) {
+    paths.resize(number_of_queries);
+    carla::StopWatch watch;
+    for (size_t i = 0u; i < number_of_queries; ++i) {
+      const auto &pair = pairs[queries[i]];
+      EXPECT_TRUE(planner.FindPath(pair.first, pair.second, filter, paths[i]));
+    }
+    watch.Stop();
+    return static_cast<double>(watch.GetElapsedTime<std::chrono::microseconds>()) / number_of_queries;
+  };
+  std::vector<NavPath> uncached_paths;
+  std::vector<NavPath> cached_paths;
+  const double uncached_us = run(uncached, uncached_paths);
+  const double cached_us = run(cached, cached_paths);
+
+  // 端点完全相同的查询，缓存的通道必须给出和重新搜索相同的路径
+  for (size_t i = 0u; i < number_of_queries; ++i) {
+    EXPECT_EQ(cached_paths[i].path, uncached_paths[i].path);
+    EXPECT_EQ(cached_paths[i].area, uncached_paths[i].area);
+  }
+  EXPECT_EQ(uncached.GetCacheHits(), 0u);
+  EXPECT_EQ(cached.GetCacheMisses(), number_of_pairs);
+  EXPECT_EQ(cached.GetCacheHits(), number_of_queries - number_of_pairs);
+
+  std::cout << number_of_queries << " path queries over " << number_of_pairs << " pairs: "
+            << uncached_us << " us per query with findPath, "
+            << cached_us << " us per query with the corridor cache" << std::endl;
+}
@@ -0,0 +1,376 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+#include "Random.h"
+
+#include <carla/StopWatch.h>
+#include <carla/opendrive/OpenDriveParser.h>
+#include <carla/road/element/RoadInfoElevation.h>
+#include <carla/road/element/RoadInfoGeometry.h>
+#include <carla/road/element/RoadInfoLaneOffset.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <tuple>
+
+using namespace carla::road;
+using namespace carla::road::element;
+
+// 每个查询测量的遍数
+static constexpr size_t NUMBER_OF_PASSES = 5u;
+
+// 返回 @a watch 测得的每次查询平均耗时（纳秒）
+static double NanosecondsPerQuery(const carla::StopWatch &watch, size_t number_of_queries) {
+  return static_cast<double>(watch.GetElapsedTime<std::chrono::nanoseconds>()) /
+      static_cast<double>(std::max<size_t>(number_of_queries, 1u));
+}
+
+TEST(benchmark_road, waypoint_queries) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = carla::opendrive::OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    const Map &map = *m;
+    const auto waypoints = map.GenerateWaypoints(1.0);
+
+    // ComputeTransform 会查询几何、车道偏移和高程信息，GetLaneWidth 查询车道宽度信息
+    double checksum = 0.0;
+    carla::StopWatch transform_watch;
+    for (size_t pass = 0u; pass < NUMBER_OF_PASSES; ++pass) {
+      for (const auto &waypoint : waypoints) {
+        const auto transform = map.ComputeTransform(waypoint);
+        checksum += transform.location.x + map.GetLaneWidth(waypoint);
+      }
+    }
+    transform_watch.Stop();
+
+    // 直接按类型查询道路上的信息
+    size_t number_of_lookups = 0u;
+    carla::StopWatch info_watch;
+    for (size_t pass = 0u; pass < NUMBER_OF_PASSES; ++pass) {
+      for (const auto &waypoint : waypoints) {
+        const Road &road = *map.GetLane(waypoint).GetRoad();
+        const auto geometry = road.GetInfo<RoadInfoGeometry>(waypoint.s);
+        const auto elevation = road.GetInfo<RoadInfoElevation>(waypoint.s);
+        const auto lane_offsets = road.GetInfos<RoadInfoLaneOffset>();
+        checksum += (geometry != nullptr ? geometry->GetDistance() : 0.0) +
+                    (elevation != nullptr ? elevation->GetDistance() : 0.0) +
+                    static_cast<double>(lane_offsets.size());
+        number_of_lookups += 3u;
+      }
+    }
+    info_watch.Stop();
+
+    EXPECT_TRUE(std::isfinite(checksum));
+    std::cout << std::setw(24) << file << ": " << waypoints.size() << " waypoints, "
+              << NanosecondsPerQuery(transform_watch, NUMBER_OF_PASSES * waypoints.size())
+              << " ns per transform + width query, "
+              << NanosecondsPerQuery(info_watch, number_of_lookups)
+              << " ns per info lookup" << std::endl;
+  }
+}
+
+TEST(benchmark_road, batched_waypoint_queries) {
+  using util::Random;
+  constexpr size_t number_of_queries = 20'000u;
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = carla::opendrive::OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    const Map &map = *m;
+    const auto waypoints = map.GenerateWaypoints(1.0);
+    ASSERT_FALSE(waypoints.empty());
+
+    // 在道路附近随机取点，既有车道内也有车道外的位置
+    std::vector<carla::geom::Location> locations;
+    locations.reserve(number_of_queries);
+    for (size_t i = 0u; i < number_of_queries; ++i) {
+      const auto &waypoint = waypoints[i % waypoints.size()];
+      locations.emplace_back(map.ComputeTransform(waypoint).location + Random::Location(-5.0f, 5.0f));
+    }
+    Random::Shuffle(locations);
+
+    std::vector<boost::optional<Waypoint>> scalar_result;
+    carla::StopWatch scalar_watch;
+    for (const auto &location : locations) {
+      scalar_result.emplace_back(map.GetWaypoint(location));
+    }
+    scalar_watch.Stop();
+
+    carla::StopWatch single_thread_watch;
+    const auto single_thread_result = map.GetWaypoints(locations, static_cast<int32_t>(Lane::LaneType::Driving), 1u);
+    single_thread_watch.Stop();
+
+    carla::StopWatch batch_watch;
+    const auto batch_result = map.GetWaypoints(locations);
+    batch_watch.Stop();
+
+    ASSERT_EQ(batch_result.size(), scalar_result.size());
+    ASSERT_EQ(single_thread_result.size(), scalar_result.size());
+    for (size_t i = 0u; i < scalar_result.size(); ++i) {
+      ASSERT_EQ(batch_result[i], scalar_result[i]);
+      ASSERT_EQ(single_thread_result[i], scalar_result[i]);
+    }
+
+    // 投影到道路时每个位置都应该有结果
+    const auto projected = map.GetClosestWaypointsOnRoad(locations);
+    for (size_t i = 0u; i < locations.size(); i += 97u) {
+      ASSERT_EQ(projected[i], map.GetClosestWaypointOnRoad(locations[i]));
+    }
+
+    std::cout << std::setw(24) << file << ": "
+              << NanosecondsPerQuery(scalar_watch, locations.size()) << " ns per scalar query, "
+              << NanosecondsPerQuery(single_thread_watch, locations.size()) << " ns per sorted batch query, "
+              << NanosecondsPerQuery(batch_watch, locations.size()) << " ns per parallel batch query"
+              << std::endl;
+  }
+}
+
+// 不使用车道连接图、逐条车道查找的 GetNext，作为对照
+static std::vector<Waypoint> ReferenceGetNext(const Map &map, Waypoint waypoint, double distance) {
+  constexpr double epsilon = 10.0 * std::numeric_limits<double>::epsilon();
+  if (distance <= epsilon) {
+    return {waypoint};
+  }
+  const auto &lane = map.GetLane(waypoint);
+  const bool forward = (waypoint.lane_id <= 0);
+  const double relative_s = waypoint.s - lane.GetDistance();
+  const double remaining_lane_length = forward ? lane.GetLength() - relative_s : relative_s;
+  if (distance <= remaining_lane_length) {
+    waypoint.s += forward ? distance : -distance;
+    waypoint.s += forward ? -epsilon : epsilon;
+    return {waypoint};
+  }
+  std::vector<Waypoint> result;
+  for (const auto *next_lane : lane.GetNextLanes()) {
+    const double s = next_lane->GetId() <= 0 ?
+        next_lane->GetDistance() + 10.0 * epsilon :
+        next_lane->GetDistance() + next_lane->GetLength() - 10.0 * epsilon;
+    const Waypoint successor{next_lane->GetRoad()->GetId(), next_lane->GetLaneSection()->GetId(), next_lane->GetId(), s};
+    const auto next = ReferenceGetNext(map, successor, distance - remaining_lane_length);
+    result.insert(result.end(), next.begin(), next.end());
+  }
+  return result;
+}
+
+static std::vector<Waypoint> Sorted(std::vector<Waypoint> waypoints) {
+  std::sort(waypoints.begin(), waypoints.end(), [](const Waypoint &lhs, const Waypoint &rhs) {
+    return std::tie(lhs.road_id, lhs.section_id, lhs.lane_id, lhs.s) <
+           std::tie(rhs.road_id, rhs.section_id, rhs.lane_id, rhs.s);
+  });
+  return waypoints;
+}
+
+TEST(benchmark_road, lane_graph_next_waypoints) {
+  const double distances[] = {2.0, 10.0, 50.0};
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = carla::opendrive::OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    Map &map = *m;
+    const auto waypoints = map.GenerateWaypoints(2.0);
+    const size_t number_of_queries = waypoints.size() * (sizeof(distances) / sizeof(distances[0]));
+
+    size_t checksum = 0u;
+    carla::StopWatch reference_watch;
+    for (const auto &waypoint : waypoints) {
+      for (const double distance : distances) {
+        checksum += ReferenceGetNext(map, waypoint, distance).size();
+      }
+    }
+    reference_watch.Stop();
+
+    map.SetPathCacheCapacity(0u);
+    carla::StopWatch graph_watch;
+    for (const auto &waypoint : waypoints) {
+      for (const double distance : distances) {
+        checksum -= map.GetNext(waypoint, distance).size();
+      }
+    }
+    graph_watch.Stop();
+    EXPECT_EQ(checksum, 0u);
+
+    // 重复查询同一批路点，第二遍全部命中缓存
+    map.SetPathCacheCapacity(number_of_queries);
+    for (const auto &waypoint : waypoints) {
+      for (const double distance : distances) {
+        map.GetNext(waypoint, distance);
+      }
+    }
+    carla::StopWatch cached_watch;
+    for (const auto &waypoint : waypoints) {
+      for (const double distance : distances) {
+        checksum += map.GetNext(waypoint, distance).size();
+      }
+    }
+    cached_watch.Stop();
+
+    for (size_t i = 0u; i < waypoints.size(); i += 7u) {
+      for (const double distance : distances) {
+        const auto expected = Sorted(ReferenceGetNext(map, waypoints[i], distance));
+        const auto actual = Sorted(map.GetNext(waypoints[i], distance));
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t j = 0u; j < expected.size(); ++j) {
+          ASSERT_EQ(actual[j].road_id, expected[j].road_id);
+          ASSERT_EQ(actual[j].section_id, expected[j].section_id);
+          ASSERT_EQ(actual[j].lane_id, expected[j].lane_id);
+          ASSERT_DOUBLE_EQ(actual[j].s, expected[j].s);
+        }
+      }
+    }
+
+    std::cout << std::setw(24) << file << ": "
+              << NanosecondsPerQuery(reference_watch, number_of_queries) << " ns per lane walk, "
+              << NanosecondsPerQuery(graph_watch, number_of_queries) << " ns per lane graph walk, "
+              << NanosecondsPerQuery(cached_watch, number_of_queries) << " ns per cached query"
+              << std::endl;
+  }
+}
+
+TEST(benchmark_road, chunked_mesh_generation) {
+  carla::rpc::OpendriveGenerationParameters params;
+  // FilterRoadsByPosition 要求 minpos.y > y > maxpos.y
+  const carla::geom::Vector3D min_position(-1.0e6f, 1.0e6f, 0.0f);
+  const carla::geom::Vector3D max_position(1.0e6f, -1.0e6f, 0.0f);
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = carla::opendrive::OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    const Map &map = *m;
+
+    carla::StopWatch chunked_watch;
+    const auto chunks = map.GenerateChunkedMesh(params);
+    chunked_watch.Stop();
+    size_t number_of_vertices = 0u;
+    for (const auto &chunk : chunks) {
+      number_of_vertices += chunk->GetVertices().size();
+    }
+    EXPECT_GT(number_of_vertices, 0u);
+
+    carla::StopWatch ordered_watch;
+    const auto ordered = map.GenerateOrderedChunkedMeshInLocations(params, min_position, max_position);
+    ordered_watch.Stop();
+    size_t number_of_ordered_meshes = 0u;
+    for (const auto &pair : ordered) {
+      number_of_ordered_meshes += pair.second.size();
+    }
+
+    std::cout << std::setw(24) << file << ": "
+              << chunked_watch.GetElapsedTime() << " ms for " << chunks.size() << " chunks, "
+              << ordered_watch.GetElapsedTime() << " ms for " << number_of_ordered_meshes
+              << " ordered meshes" << std::endl;
+  }
+}
+
+// 将进程的内存峰值重置为当前常驻内存（Linux 4.0 以上支持）
+static void ResetPeakMemory() {
+  std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+// 读取 /proc/self/status 中的一项（单位 kB），不支持时返回 0
+static size_t ReadProcessStatus(const std::string &key) {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0u, key.size(), key) == 0) {
+      return std::stoul(line.substr(key.size() + 1u));
+    }
+  }
+  return 0u;
+}
+
+TEST(benchmark_road, streaming_opendrive_parser) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const std::string opendrive = util::OpenDrive::Load(file);
+
+    ResetPeakMemory();
+    const size_t dom_baseline = ReadProcessStatus("VmRSS");
+    carla::StopWatch dom_watch;
+    auto dom_map = carla::opendrive::OpenDriveParser::Load(opendrive);
+    dom_watch.Stop();
+    const size_t dom_peak = ReadProcessStatus("VmHWM");
+    ASSERT_TRUE(dom_map.has_value());
+
+    std::istringstream stream(opendrive);
+    ResetPeakMemory();
+    const size_t streaming_baseline = ReadProcessStatus("VmRSS");
+    carla::StopWatch streaming_watch;
+    auto streaming_map = carla::opendrive::OpenDriveParser::Load(stream);
+    streaming_watch.Stop();
+    const size_t streaming_peak = ReadProcessStatus("VmHWM");
+    ASSERT_TRUE(streaming_map.has_value());
+
+    // 两种方式应生成相同的地图
+    ASSERT_EQ(streaming_map->GetMap().GetRoads().size(), dom_map->GetMap().GetRoads().size());
+    ASSERT_EQ(streaming_map->GetMap().GetJunctions().size(), dom_map->GetMap().GetJunctions().size());
+    const auto expected = Sorted(dom_map->GenerateWaypoints(2.0));
+    const auto actual = Sorted(streaming_map->GenerateWaypoints(2.0));
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0u; i < expected.size(); ++i) {
+      ASSERT_EQ(actual[i], expected[i]);
+      const auto lhs = streaming_map->ComputeTransform(actual[i]).location;
+      const auto rhs = dom_map->ComputeTransform(expected[i]).location;
+      ASSERT_NEAR(lhs.Distance(rhs), 0.0, 1e-4);
+    }
+
+    std::cout << std::setw(24) << file << ": DOM "
+              << dom_watch.GetElapsedTime() << " ms, "
+              << (dom_peak > dom_baseline ? dom_peak - dom_baseline : 0u) << " kB peak; streaming "
+              << streaming_watch.GetElapsedTime() << " ms, "
+              << (streaming_peak > streaming_baseline ? streaming_peak - streaming_baseline : 0u)
+              << " kB peak" << std::endl;
+  }
+}
+
+TEST(benchmark_road, road_map_cache) {
+  using util::Random;
+  const std::string cache_filename = "benchmark_road_map.roadcache";
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const std::string opendrive = util::OpenDrive::Load(file);
+    std::remove(cache_filename.c_str());
+
+    carla::StopWatch xml_watch;
+    auto expected = carla::opendrive::OpenDriveParser::Load(opendrive);
+    xml_watch.Stop();
+    ASSERT_TRUE(expected.has_value());
+
+    // 第一次加载生成并写入缓存，第二次从缓存读取R树
+    carla::StopWatch write_watch;
+    auto written = carla::opendrive::OpenDriveParser::Load(opendrive, cache_filename);
+    write_watch.Stop();
+    ASSERT_TRUE(written.has_value());
+    ASSERT_TRUE(std::ifstream(cache_filename).good());
+
+    carla::StopWatch cached_watch;
+    auto cached = carla::opendrive::OpenDriveParser::Load(opendrive, cache_filename);
+    cached_watch.Stop();
+    ASSERT_TRUE(cached.has_value());
+
+    const auto waypoints = expected->GenerateWaypoints(5.0);
+    ASSERT_FALSE(waypoints.empty());
+    for (size_t i = 0u; i < waypoints.size(); i += 3u) {
+      const auto location = expected->ComputeTransform(waypoints[i]).location + Random::Location(-2.0f, 2.0f);
+      ASSERT_EQ(cached->GetClosestWaypointOnRoad(location), expected->GetClosestWaypointOnRoad(location));
+      ASSERT_EQ(cached->GetWaypoint(location), expected->GetWaypoint(location));
+    }
+
+    // 为其他 OpenDRIVE 内容生成的缓存不能被使用
+    auto stale = carla::opendrive::OpenDriveParser::Load(opendrive + " ", cache_filename);
+    ASSERT_TRUE(stale.has_value());
+    const auto location = expected->ComputeTransform(waypoints.front()).location;
+    ASSERT_EQ(stale->GetClosestWaypointOnRoad(location), expected->GetClosestWaypointOnRoad(location));
+
+    std::cout << std::setw(24) << file << ": "
+              << xml_watch.GetElapsedTime() << " ms from XML, "
+              << write_watch.GetElapsedTime() << " ms writing the cache, "
+              << cached_watch.GetElapsedTime() << " ms with the cached R-tree" << std::endl;
+  }
+  std::remove(cache_filename.c_str());
+}
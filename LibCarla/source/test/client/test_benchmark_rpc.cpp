@@ -0,0 +1,108 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/MsgPackAdaptors.h>
+#include <carla/StopWatch.h>
+#include <carla/ThreadGroup.h>
+#include <carla/rpc/CallBatch.h>
+#include <carla/rpc/Client.h>
+#include <carla/rpc/Response.h>
+#include <carla/rpc/Server.h>
+
+#include <future>
+#include <vector>
+
+using namespace carla::rpc;
+using namespace std::chrono_literals;
+
+static constexpr size_t NUMBER_OF_CALLS = 1000u;
+
+// 模拟服务器上的几种典型函数：按编号查询、设置变换、查询列表
+static void BindFunctions(Server &server) {
+  server.BindSync("get_actor_id", [](uint32_t id) -> Response<uint32_t> {
+    return id;
+  });
+  server.BindSync("set_actor_transform", [](uint32_t, std::vector<float>) -> Response<void> {
+    return Response<void>::Success();
+  });
+  server.BindSync("get_light_states", [](uint32_t id) -> Response<std::vector<uint32_t>> {
+    return std::vector<uint32_t>(8u, id);
+  });
+}
+
+static const char *FunctionName(size_t i) {
+  switch (i % 3u) {
+    case 0u:  return "get_actor_id";
+    case 1u:  return "set_actor_transform";
+    default:  return "get_light_states";
+  }
+}
+
+// 逐个同步调用
+static double RunSequential(Client &client) {
+  carla::StopWatch watch;
+  for (size_t i = 0u; i < NUMBER_OF_CALLS; ++i) {
+    const auto id = static_cast<uint32_t>(i);
+    if (i % 3u == 1u) {
+      client.call(FunctionName(i), id, std::vector<float>(6u, 1.0f));
+    } else {
+      client.call(FunctionName(i), id);
+    }
+  }
+  watch.Stop();
+  return static_cast<double>(watch.GetElapsedTime<std::chrono::microseconds>()) / 1e3;
+}
+
+// 所有调用放在一个批量请求中
+static double RunBatched(Client &client) {
+  carla::StopWatch watch;
+  CallBatch batch;
+  std::vector<std::future<clmdep_msgpack::object_handle>> results;
+  results.reserve(NUMBER_OF_CALLS);
+  for (size_t i = 0u; i < NUMBER_OF_CALLS; ++i) {
+    const auto id = static_cast<uint32_t>(i);
+    if (i % 3u == 1u) {
+      results.emplace_back(batch.Add(FunctionName(i), id, std::vector<float>(6u, 1.0f)));
+    } else {
+      results.emplace_back(batch.Add(FunctionName(i), id));
+    }
+  }
+  client.call_batch(batch);
+  for (size_t i = 0u; i < NUMBER_OF_CALLS; i += 3u) {
+    EXPECT_EQ(results[i].get().as<Response<uint32_t>>().Get(), i);
+  }
+  watch.Stop();
+  return static_cast<double>(watch.GetElapsedTime<std::chrono::microseconds>()) / 1e3;
+}
+
+TEST(benchmark_rpc, sequential_vs_batched) {
+  const uint16_t port = (TESTING_PORT != 0u ? TESTING_PORT : 2017u);
+  Server server(port);
+  BindFunctions(server);
+  server.AsyncRun(1u);
+
+  double sequential_ms = 0.0;
+  double batched_ms = 0.0;
+  std::atomic_bool done{false};
+  carla::ThreadGroup threads;
+  threads.CreateThread([&]() {
+    Client client("localhost", port);
+    sequential_ms = RunSequential(client);
+    batched_ms = RunBatched(client);
+    done = true;
+  });
+  // 主线程模拟游戏线程，同步函数在这里执行
+  for (auto i = 0u; (i < 1'000'000u) && !done; ++i) {
+    server.SyncRunFor(2ms);
+  }
+  threads.JoinAll();
+  ASSERT_TRUE(done);
+  std::cout << NUMBER_OF_CALLS << " mixed calls: "
+            << sequential_ms << " ms sequential vs "
+            << batched_ms << " ms batched" << std::endl;
+}
@@ -0,0 +1,247 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StopWatch.h>
+#include <carla/ThreadGroup.h>
+#include <carla/sensor/FrameSynchronizer.h>
+
+#include <condition_variable>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using carla::sensor::FrameSynchronizer;
+using carla::sensor::SensorBundle;
+using carla::sensor::SensorData;
+using namespace std::chrono_literals;
+
+static constexpr size_t NUMBER_OF_CAMERAS = 8u;
+static constexpr size_t NUMBER_OF_LIDARS = 2u;
+static constexpr size_t NUMBER_OF_SENSORS = NUMBER_OF_CAMERAS + NUMBER_OF_LIDARS;
+static constexpr size_t NUMBER_OF_FRAMES = 300u;
+
+/// 每次在持有 GIL 时调用 Python 回调的大致开销（转换参数、执行回调、放入队列）
+static constexpr auto PYTHON_CALLBACK_COST = std::chrono::microseconds(10);
+
+namespace {
+
+  using Payload = std::shared_ptr<const std::vector<unsigned char>>;
+
+  /// 模拟一个传感器数据。数据内容在各帧之间共享（类似流的缓冲池），
+  /// 测量的是同步本身的开销，而不是分配和清零内存的开销。
+  class FakeMeasurement : public SensorData {
+  public:
+
+    FakeMeasurement(size_t frame, Payload payload)
+      : SensorData(frame, 0.0, carla::rpc::Transform{}),
+        _payload(std::move(payload)) {}
+
+  private:
+
+    Payload _payload;
+  };
+
+  /// 模拟同步模式：每次 Tick 所有传感器各在自己的线程上产生一个数据，
+  /// 等待这一帧的数据全部被处理之后再进入下一帧
+  class FakeSimulation {
+  public:
+
+    using Consumer = std::function<void(size_t, carla::SharedPtr<SensorData>)>;
+
+    explicit FakeSimulation(Consumer consumer) : _consumer(std::move(consumer)) {
+      for (size_t sensor = 0u; sensor < NUMBER_OF_SENSORS; ++sensor) {
+        _threads.CreateThread([this, sensor]() { Produce(sensor); });
+      }
+    }
+
+    ~FakeSimulation() {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+      }
+      _tick.notify_all();
+      _threads.JoinAll();
+    }
+
+    void Tick(size_t frame) {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _frame = frame;
+      }
+      _tick.notify_all();
+    }
+
+    void FrameDone() {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_frames_done;
+      }
+      _done.notify_all();
+    }
+
+    void WaitForFrame(size_t frame) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _done.wait(lock, [&]() { return _frames_done >= frame; });
+    }
+
+  private:
+
+    void Produce(size_t sensor) {
+      // 相机为 800x600 BGRA，激光雷达为 100000 个点
+      const size_t size = sensor < NUMBER_OF_CAMERAS ? 800u * 600u * 4u : 100000u * 16u;
+      const auto payload = std::make_shared<const std::vector<unsigned char>>(size, 0u);
+      size_t frame = 0u;
+      for (;;) {
+        {
+          std::unique_lock<std::mutex> lock(_mutex);
+          _tick.wait(lock, [&]() { return _stop || _frame > frame; });
+          if (_stop) {
+            return;
+          }
+          frame = _frame;
+        }
+        _consumer(sensor, carla::SharedPtr<SensorData>(new FakeMeasurement(frame, payload)));
+      }
+    }
+
+    Consumer _consumer;
+
+    std::mutex _mutex;
+
+    std::condition_variable _tick;
+
+    std::condition_variable _done;
+
+    size_t _frame = 0u;
+
+    size_t _frames_done = 0u;
+
+    bool _stop = false;
+
+    carla::ThreadGroup _threads;
+  };
+
+  struct BenchmarkResult {
+    double wall_ms = 0.0;
+    double cpu_ms = 0.0;
+    size_t gil_acquisitions = 0u;
+    double mean_latency_us = 0.0;
+  };
+
+} // namespace
+
+// 持有 “GIL” 时模拟执行一次 Python 回调
+static void SimulatePythonCallback() {
+  const auto end = std::chrono::steady_clock::now() + PYTHON_CALLBACK_COST;
+  while (std::chrono::steady_clock::now() < end);
+}
+
+static double CpuMilliseconds(std::clock_t start) {
+  return 1e3 * static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+}
+
+// 每个传感器分别注册回调，回调中获取 “GIL” 并按帧放入队列，收齐一帧后处理
+static BenchmarkResult RunPerSensorCallbacks() {
+  BenchmarkResult result;
+  std::mutex gil;
+  std::map<size_t, std::vector<carla::SharedPtr<SensorData>>> queue;
+  double total_latency_us = 0.0;
+  FakeSimulation *simulation_ptr = nullptr;
+  const auto cpu_start = std::clock();
+  carla::StopWatch watch;
+  {
+    FakeSimulation simulation([&](size_t, carla::SharedPtr<SensorData> data) {
+      const auto arrival = std::chrono::steady_clock::now();
+      std::lock_guard<std::mutex> lock(gil);
+      const auto start = std::chrono::steady_clock::now();
+      ++result.gil_acquisitions;
+      SimulatePythonCallback();
+      auto &frame = queue[data->GetFrame()];
+      frame.emplace_back(std::move(data));
+      if (frame.size() == NUMBER_OF_SENSORS) {
+        queue.erase(frame.front()->GetFrame());
+        // 与 FrameSynchronizer 一致，从最后一个数据到达算到开始处理这一帧
+        total_latency_us += 1e-3 * static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(start - arrival).count());
+        simulation_ptr->FrameDone();
+      }
+    });
+    simulation_ptr = &simulation;
+    for (size_t frame = 1u; frame <= NUMBER_OF_FRAMES; ++frame) {
+      simulation.Tick(frame);
+      simulation.WaitForFrame(frame);
+    }
+  }
+  watch.Stop();
+  result.wall_ms = 1e-3 * static_cast<double>(watch.GetElapsedTime<std::chrono::microseconds>());
+  result.cpu_ms = CpuMilliseconds(cpu_start);
+  result.mean_latency_us = total_latency_us / NUMBER_OF_FRAMES;
+  return result;
+}
+
+// 使用 FrameSynchronizer，每帧只在交付时获取一次 “GIL”
+static BenchmarkResult RunSynchronized() {
+  BenchmarkResult result;
+  std::mutex gil;
+  FakeSimulation *simulation_ptr = nullptr;
+  size_t complete_bundles = 0u;
+  const auto cpu_start = std::clock();
+  carla::StopWatch watch;
+  {
+    FrameSynchronizer synchronizer(
+        NUMBER_OF_SENSORS,
+        1s,
+        FrameSynchronizer::PartialBundlePolicy::Deliver,
+        [&](SensorBundle bundle) {
+          std::lock_guard<std::mutex> lock(gil);
+          ++result.gil_acquisitions;
+          SimulatePythonCallback();
+          complete_bundles += bundle.IsComplete() ? 1u : 0u;
+          simulation_ptr->FrameDone();
+        });
+    {
+      FakeSimulation simulation([&](size_t sensor, carla::SharedPtr<SensorData> data) {
+        synchronizer.Push(sensor, std::move(data));
+      });
+      simulation_ptr = &simulation;
+      for (size_t frame = 1u; frame <= NUMBER_OF_FRAMES; ++frame) {
+        simulation.Tick(frame);
+        simulation.WaitForFrame(frame);
+      }
+    }
+    const auto metrics = synchronizer.GetMetrics();
+    EXPECT_EQ(metrics.complete_bundles, NUMBER_OF_FRAMES);
+    result.mean_latency_us = 1e6 * metrics.total_latency_seconds / NUMBER_OF_FRAMES;
+  }
+  watch.Stop();
+  EXPECT_EQ(complete_bundles, NUMBER_OF_FRAMES);
+  result.wall_ms = 1e-3 * static_cast<double>(watch.GetElapsedTime<std::chrono::microseconds>());
+  result.cpu_ms = CpuMilliseconds(cpu_start);
+  return result;
+}
+
+static void Print(const char *name, const BenchmarkResult &result) {
+  std::cout << name << ": " << result.wall_ms << " ms wall, "
+            << result.cpu_ms << " ms cpu, "
+            << result.gil_acquisitions << " GIL acquisitions, "
+            << result.mean_latency_us << " us mean delivery latency" << std::endl;
+}
+
+TEST(benchmark_sensor_synchronizer, cameras_and_lidars) {
+  std::cout << NUMBER_OF_CAMERAS << " cameras + " << NUMBER_OF_LIDARS << " lidars, "
+            << NUMBER_OF_FRAMES << " frames" << std::endl;
+  const auto synchronized = RunSynchronized();
+  const auto per_sensor = RunPerSensorCallbacks();
+  Print("per-sensor callbacks", per_sensor);
+  Print("sensor synchronizer", synchronized);
+  ASSERT_EQ(per_sensor.gil_acquisitions, NUMBER_OF_SENSORS * NUMBER_OF_FRAMES);
+  ASSERT_EQ(synchronized.gil_acquisitions, NUMBER_OF_FRAMES);
+}
@@ -0,0 +1,324 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+
+#include <carla/Logging.h>
+#include <carla/Memory.h>
+#include <carla/StopWatch.h>
+#include <carla/client/Map.h>
+#include <carla/trafficmanager/CollisionStage.h>
+#include <carla/trafficmanager/InMemoryMap.h>
+#include <carla/trafficmanager/ParallelExecutor.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <memory>
+
+using namespace carla::traffic_manager;
+
+// 每辆车路径缓冲区中的路点数
+static constexpr size_t BUFFER_SIZE = 40u;
+// 每种配置测量的周期数
+static constexpr size_t NUMBER_OF_TICKS = 20u;
+
+// 在本地地图上摆放车辆并运行碰撞检测阶段的测试场景
+class CollisionScenario {
+public:
+
+  CollisionScenario(const InMemoryMap &local_map, const size_t number_of_vehicles)
+    : random_device(42u),
+      collision_stage(vehicle_id_list,
+                      simulation_state,
+                      buffer_map,
+                      track_traffic,
+                      parameters,
+                      collision_frame,
+                      random_device) {
+    const NodeList topology = local_map.GetDenseTopology();
+    const size_t step = std::max<size_t>(topology.size() / number_of_vehicles, 1u);
+    for (size_t i = 0u; i < topology.size() && vehicle_id_list.size() < number_of_vehicles; i += step) {
+      const ActorId actor_id = static_cast<ActorId>(vehicle_id_list.size() + 1u);
+      // 沿着道路向前填充路径缓冲区
+      Buffer buffer;
+      SimpleWaypointPtr waypoint = topology[i];
+      while (waypoint != nullptr && buffer.size() < BUFFER_SIZE) {
+        buffer.push_back(waypoint);
+        const auto next = waypoint->GetNextWaypoint();
+        waypoint = next.empty() ? nullptr : next.front();
+      }
+      const carla::geom::Transform transform = topology[i]->GetWaypoint()->GetTransform();
+      const KinematicState kinematic_state{
+          transform.location,
+          transform.rotation,
+          transform.GetForwardVector() * 10.0f,
+          30.0f,
+          true,
+          false,
+          transform.location};
+      simulation_state.AddActor(actor_id,
+                                kinematic_state,
+                                StaticAttributes{ActorType::Vehicle, 2.5f, 1.0f, 0.8f},
+                                TrafficLightState{carla::rpc::TrafficLightState::Green, false});
+      track_traffic.UpdateGridPosition(actor_id, buffer);
+      buffer_map.insert({actor_id, std::move(buffer)});
+      vehicle_id_list.push_back(actor_id);
+    }
+    collision_frame.resize(vehicle_id_list.size());
+  }
+
+  size_t Size() const {
+    return vehicle_id_list.size();
+  }
+
+  /// 运行一个周期的碰撞检测阶段。
+  void Tick(ParallelExecutor &executor) {
+    executor.ParallelFor(vehicle_id_list.size(), [this](unsigned long index) {
+      collision_stage.Update(index);
+    });
+    collision_stage.ClearCycleCache();
+  }
+
+  CollisionStatistics GetStatistics() const {
+    return collision_stage.GetStatistics();
+  }
+
+  size_t CountHazards() const {
+    return static_cast<size_t>(std::count_if(collision_frame.begin(), collision_frame.end(),
+        [](const CollisionHazardData &data) { return data.hazard; }));
+  }
+
+private:
+
+  std::vector<ActorId> vehicle_id_list;
+  SimulationState simulation_state;
+  BufferMap buffer_map;
+  TrackTraffic track_traffic;
+  Parameters parameters;
+  CollisionFrame collision_frame;
+  RandomGenerator random_device;
+  CollisionStage collision_stage;
+};
+
+// 加载道路最多的测试地图，车辆可以摆放得更密集
+static carla::SharedPtr<carla::client::Map> LoadLargestWorldMap(std::string &map_name) {
+  auto files = util::OpenDrive::GetAvailableFiles();
+  if (files.empty()) {
+    carla::log_warning("no OpenDrive files available, skipping traffic manager benchmark");
+    return nullptr;
+  }
+  map_name = files.front();
+  std::string xodr = util::OpenDrive::Load(map_name);
+  for (const auto &file : files) {
+    auto content = util::OpenDrive::Load(file);
+    if (content.size() > xodr.size()) {
+      map_name = file;
+      xodr = std::move(content);
+    }
+  }
+  return carla::MakeShared<carla::client::Map>(map_name, xodr);
+}
+
+// 加载道路最多的测试地图并构建本地地图
+static std::unique_ptr<InMemoryMap> LoadLargestMap(std::string &map_name) {
+  auto world_map = LoadLargestWorldMap(map_name);
+  if (world_map == nullptr) {
+    return nullptr;
+  }
+  auto local_map = std::make_unique<InMemoryMap>(world_map);
+  local_map->SetUp();
+  return local_map;
+}
+
+TEST(benchmark_trafficmanager, collision_stage_parallel) {
+  std::string map_name;
+  const auto local_map_ptr = LoadLargestMap(map_name);
+  if (local_map_ptr == nullptr) {
+    return;
+  }
+  const InMemoryMap &local_map = *local_map_ptr;
+
+  for (const size_t number_of_vehicles : {100u, 250u, 500u, 1000u}) {
+    CollisionScenario scenario(local_map, number_of_vehicles);
+    if (scenario.Size() < number_of_vehicles) {
+      break;
+    }
+    for (const size_t number_of_threads : {1u, 4u, 16u}) {
+      ParallelExecutor executor;
+      executor.SetNumberOfThreads(number_of_threads);
+      scenario.Tick(executor); // 预热
+      carla::StopWatch stop_watch;
+      for (size_t i = 0u; i < NUMBER_OF_TICKS; ++i) {
+        scenario.Tick(executor);
+      }
+      stop_watch.Stop();
+      const double ms_per_tick =
+          static_cast<double>(stop_watch.GetElapsedTime<std::chrono::microseconds>()) * 1e-3 / NUMBER_OF_TICKS;
+      std::cout << map_name << ": " << std::setw(4) << number_of_vehicles << " vehicles, "
+                << std::setw(2) << number_of_threads << " threads: "
+                << ms_per_tick << " ms/tick, "
+                << scenario.CountHazards() << " hazards" << std::endl;
+    }
+  }
+}
+
+TEST(benchmark_trafficmanager, collision_stage_broad_phase) {
+  std::string map_name;
+  const auto local_map_ptr = LoadLargestMap(map_name);
+  if (local_map_ptr == nullptr) {
+    return;
+  }
+
+  for (const size_t number_of_vehicles : {200u, 500u, 1000u}) {
+    CollisionScenario scenario(*local_map_ptr, number_of_vehicles);
+    if (scenario.Size() < number_of_vehicles) {
+      break;
+    }
+    ParallelExecutor executor;
+    scenario.Tick(executor); // 预热
+    const CollisionStatistics before = scenario.GetStatistics();
+    carla::StopWatch stop_watch;
+    for (size_t i = 0u; i < NUMBER_OF_TICKS; ++i) {
+      scenario.Tick(executor);
+    }
+    stop_watch.Stop();
+    const CollisionStatistics after = scenario.GetStatistics();
+    const double ms_per_tick =
+        static_cast<double>(stop_watch.GetElapsedTime<std::chrono::microseconds>()) * 1e-3 / NUMBER_OF_TICKS;
+    const uint64_t tested = (after.pairs_tested - before.pairs_tested) / NUMBER_OF_TICKS;
+    const uint64_t pruned = (after.pairs_pruned - before.pairs_pruned) / NUMBER_OF_TICKS;
+    std::cout << map_name << ": " << std::setw(4) << number_of_vehicles << " vehicles: "
+              << ms_per_tick << " ms/tick, "
+              << tested << " pairs tested, "
+              << pruned << " pairs pruned per tick" << std::endl;
+  }
+}
+
+TEST(benchmark_trafficmanager, simulation_state_access) {
+  constexpr size_t number_of_passes = 200u;
+  for (const size_t number_of_actors : {500u, 2000u, 10000u}) {
+    // 旧的存储方式：按参与者 ID 的哈希表
+    KinematicStateMap kinematic_state_map;
+    SimulationState simulation_state;
+    std::vector<ActorId> actor_ids;
+    for (size_t i = 0u; i < number_of_actors; ++i) {
+      const ActorId actor_id = static_cast<ActorId>(i * 7u + 1u);
+      const float offset = static_cast<float>(i);
+      const KinematicState kinematic_state{
+          cg::Location(offset, -offset, 0.0f),
+          cg::Rotation(0.0f, offset, 0.0f),
+          cg::Vector3D(1.0f, offset, 0.0f),
+          30.0f,
+          true,
+          false,
+          cg::Location(offset, -offset, 0.0f)};
+      kinematic_state_map.insert({actor_id, kinematic_state});
+      simulation_state.AddActor(actor_id,
+                                kinematic_state,
+                                StaticAttributes{ActorType::Vehicle, 2.5f, 1.0f, 0.8f},
+                                TrafficLightState{carla::rpc::TrafficLightState::Green, false});
+      actor_ids.push_back(actor_id);
+    }
+
+    // 每个参与者读取位置、速度和朝向，与各阶段每个周期的访问模式相同。
+    float map_checksum = 0.0f;
+    carla::StopWatch map_watch;
+    for (size_t pass = 0u; pass < number_of_passes; ++pass) {
+      for (const ActorId actor_id : actor_ids) {
+        const cg::Location location = kinematic_state_map.at(actor_id).location;
+        const cg::Vector3D velocity = kinematic_state_map.at(actor_id).velocity;
+        const cg::Vector3D heading = kinematic_state_map.at(actor_id).rotation.GetForwardVector();
+        map_checksum += location.x + velocity.y + heading.x;
+      }
+    }
+    map_watch.Stop();
+
+    float slot_checksum = 0.0f;
+    carla::StopWatch slot_watch;
+    for (size_t pass = 0u; pass < number_of_passes; ++pass) {
+      for (const ActorId actor_id : actor_ids) {
+        const size_t slot = simulation_state.GetSlot(actor_id);
+        slot_checksum += simulation_state.GetLocationAt(slot).x
+                       + simulation_state.GetVelocityAt(slot).y
+                       + simulation_state.GetHeadingAt(slot).x;
+      }
+    }
+    slot_watch.Stop();
+
+    float linear_checksum = 0.0f;
+    carla::StopWatch linear_watch;
+    for (size_t pass = 0u; pass < number_of_passes; ++pass) {
+      for (size_t slot = 0u; slot < simulation_state.GetNumberOfActors(); ++slot) {
+        linear_checksum += simulation_state.GetLocationAt(slot).x
+                         + simulation_state.GetVelocityAt(slot).y
+                         + simulation_state.GetHeadingAt(slot).x;
+      }
+    }
+    linear_watch.Stop();
+
+    // 三种方式读到的是同样的数据，只是求和顺序可能不同。
+    EXPECT_NEAR(map_checksum, slot_checksum, std::abs(map_checksum) * 1e-3f + 1.0f);
+    EXPECT_NEAR(map_checksum, linear_checksum, std::abs(map_checksum) * 1e-3f + 1.0f);
+
+    const auto us_per_pass = [](const carla::StopWatch &watch) {
+      return static_cast<double>(watch.GetElapsedTime<std::chrono::microseconds>()) / number_of_passes;
+    };
+    std::cout << std::setw(5) << number_of_actors << " actors: "
+              << us_per_pass(map_watch) << " us/pass by id (map), "
+              << us_per_pass(slot_watch) << " us/pass by slot, "
+              << us_per_pass(linear_watch) << " us/pass linear" << std::endl;
+  }
+}
+
+TEST(benchmark_trafficmanager, in_memory_map_cache) {
+  std::string map_name;
+  const auto world_map = LoadLargestWorldMap(map_name);
+  if (world_map == nullptr) {
+    return;
+  }
+  const std::string cache_file = "test_in_memory_map_cache.bin";
+
+  carla::StopWatch setup_watch;
+  InMemoryMap built_map(world_map);
+  built_map.SetUp();
+  setup_watch.Stop();
+
+  InMemoryMap::Cook(world_map, cache_file);
+
+  carla::StopWatch load_watch;
+  InMemoryMap loaded_map(world_map);
+  ASSERT_TRUE(loaded_map.Load(cache_file));
+  load_watch.Stop();
+  std::remove(cache_file.c_str());
+
+  const NodeList built = built_map.GetDenseTopology();
+  const NodeList loaded = loaded_map.GetDenseTopology();
+  ASSERT_EQ(built.size(), loaded.size());
+  for (size_t i = 0u; i < built.size(); ++i) {
+    ASSERT_EQ(built[i]->GetNextWaypoint().size(), loaded[i]->GetNextWaypoint().size());
+    ASSERT_EQ(built[i]->GetPreviousWaypoint().size(), loaded[i]->GetPreviousWaypoint().size());
+    ASSERT_EQ(built[i]->GetRoadOption(), loaded[i]->GetRoadOption());
+  }
+
+  // 两个地图的空间树返回的最近路点应该在同一位置
+  for (size_t i = 0u; i < built.size(); i += std::max<size_t>(built.size() / 100u, 1u)) {
+    const carla::geom::Location location = built[i]->GetLocation();
+    EXPECT_LT(built_map.GetWaypoint(location)->DistanceSquared(loaded_map.GetWaypoint(location)), 0.01f);
+  }
+
+  // 版本不对或损坏的缓存应该被拒绝，而不是产生错误的地图
+  std::vector<uint8_t> truncated{'C', 'A', 'R', 'L', 'A', 'T', 'M', '\0'};
+  truncated.resize(64u, 0u);
+  InMemoryMap rejected_map(world_map);
+  EXPECT_FALSE(rejected_map.Load(truncated));
+
+  std::cout << map_name << ": " << built.size() << " waypoints, SetUp "
+            << setup_watch.GetElapsedTime() << " ms, cache load "
+            << load_watch.GetElapsedTime() << " ms" << std::endl;
+}
@@ -0,0 +1,122 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/pointcloud/PointCloudIO.h>
+#include <carla/sensor/DataWriter.h>
+#include <carla/sensor/data/LidarData.h>
+
+#include <atomic>
+#include <cstring>
+#include <future>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using carla::sensor::DataWriter;
+
+// 等待工作线程取走队列中的所有任务
+static void WaitUntilQueueIsEmpty(const DataWriter &writer) {
+  while (writer.GetMetrics().queued > 0u) {
+    std::this_thread::yield();
+  }
+}
+
+TEST(data_writer, writes_every_job) {
+  constexpr size_t number_of_jobs = 500u;
+  std::atomic_size_t count{0u};
+  DataWriter writer(4u, 8u, DataWriter::OverflowPolicy::Block);
+  for (size_t i = 0u; i < number_of_jobs; ++i) {
+    ASSERT_TRUE(writer.Submit([&count]() { ++count; }));
+  }
+  writer.Flush();
+  ASSERT_EQ(count, number_of_jobs);
+  const auto metrics = writer.GetMetrics();
+  ASSERT_EQ(metrics.submitted, number_of_jobs);
+  ASSERT_EQ(metrics.written, number_of_jobs);
+  ASSERT_EQ(metrics.dropped, 0u);
+  ASSERT_EQ(metrics.failed, 0u);
+  ASSERT_EQ(metrics.queued, 0u);
+  ASSERT_LE(metrics.max_queued, writer.GetQueueCapacity());
+}
+
+TEST(data_writer, overflow_policies) {
+  for (auto policy : {DataWriter::OverflowPolicy::DropNewest, DataWriter::OverflowPolicy::DropOldest}) {
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::vector<int> written;
+    std::mutex mutex;
+    auto job = [&](int id) {
+      return [&, id]() {
+        released.wait();
+        std::lock_guard<std::mutex> lock(mutex);
+        written.push_back(id);
+      };
+    };
+    {
+      DataWriter writer(1u, 2u, policy);
+      // 第一个任务被工作线程取走后阻塞，后面两个填满队列
+      ASSERT_TRUE(writer.Submit(job(0)));
+      WaitUntilQueueIsEmpty(writer);
+      ASSERT_TRUE(writer.Submit(job(1)));
+      ASSERT_TRUE(writer.Submit(job(2)));
+      const bool accepted = writer.Submit(job(3));
+      ASSERT_EQ(accepted, policy == DataWriter::OverflowPolicy::DropOldest);
+      release.set_value();
+      writer.Flush();
+      const auto metrics = writer.GetMetrics();
+      ASSERT_EQ(metrics.dropped, 1u);
+      ASSERT_EQ(metrics.written, 3u);
+    }
+    if (policy == DataWriter::OverflowPolicy::DropNewest) {
+      ASSERT_EQ(written, (std::vector<int>{0, 1, 2}));
+    } else {
+      ASSERT_EQ(written, (std::vector<int>{0, 2, 3}));
+    }
+  }
+}
+
+TEST(data_writer, failed_jobs) {
+  DataWriter writer(2u, 4u);
+  writer.Submit([]() { throw std::runtime_error("disk full"); });
+  writer.Submit([]() {});
+  writer.Flush();
+  const auto metrics = writer.GetMetrics();
+  ASSERT_EQ(metrics.failed, 1u);
+  ASSERT_EQ(metrics.written, 1u);
+}
+
+TEST(data_writer, binary_ply) {
+  using carla::pointcloud::PointCloudIO;
+  using carla::sensor::data::LidarDetection;
+  std::vector<LidarDetection> points;
+  for (int i = 0; i < 100; ++i) {
+    points.emplace_back(0.5f * i, -1.0f * i, 2.0f, 0.01f * i);
+  }
+  std::stringstream out;
+  PointCloudIO::DumpBinary(out, points.data(), points.data() + points.size());
+  const std::string file = out.str();
+
+  const std::string end_of_header = "end_header\n";
+  const auto header_size = file.find(end_of_header);
+  ASSERT_NE(header_size, std::string::npos);
+  const std::string header = file.substr(0u, header_size);
+  ASSERT_NE(header.find("format binary_little_endian 1.0\n"), std::string::npos);
+  ASSERT_NE(header.find("element vertex 100\n"), std::string::npos);
+
+  const auto data_begin = header_size + end_of_header.size();
+  ASSERT_EQ(file.size() - data_begin, points.size() * 4u * sizeof(float));
+  for (size_t i = 0u; i < points.size(); ++i) {
+    float values[4u];
+    std::memcpy(values, file.data() + data_begin + i * sizeof(values), sizeof(values));
+    ASSERT_EQ(values[0u], points[i].point.x);
+    ASSERT_EQ(values[1u], points[i].point.y);
+    ASSERT_EQ(values[2u], points[i].point.z);
+    ASSERT_EQ(values[3u], points[i].intensity);
+  }
+}
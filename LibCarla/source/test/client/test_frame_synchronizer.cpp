@@ -0,0 +1,225 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/ThreadGroup.h>
+#include <carla/sensor/FrameSynchronizer.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using carla::sensor::FrameSynchronizer;
+using carla::sensor::SensorBundle;
+using carla::sensor::SensorData;
+using namespace std::chrono_literals;
+
+namespace {
+
+  class FakeData : public SensorData {
+  public:
+
+    explicit FakeData(size_t frame) : SensorData(frame, 0.0, carla::rpc::Transform{}) {}
+  };
+
+  /// 收集交付的数据包
+  class BundleCollector {
+  public:
+
+    FrameSynchronizer::Callback MakeCallback() {
+      return [this](SensorBundle bundle) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _bundles.emplace_back(std::move(bundle));
+        _condition.notify_all();
+      };
+    }
+
+    std::vector<SensorBundle> WaitFor(size_t count, std::chrono::milliseconds timeout = 5s) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _condition.wait_for(lock, timeout, [&]() { return _bundles.size() >= count; });
+      return _bundles;
+    }
+
+  private:
+
+    std::mutex _mutex;
+
+    std::condition_variable _condition;
+
+    std::vector<SensorBundle> _bundles;
+  };
+
+} // namespace
+
+static auto MakeData(size_t frame) {
+  return carla::SharedPtr<SensorData>(new FakeData(frame));
+}
+
+TEST(frame_synchronizer, complete_bundles) {
+  constexpr size_t number_of_sources = 4u;
+  constexpr size_t number_of_frames = 200u;
+  BundleCollector collector;
+  // 各线程的进度可能相差很多帧，不限制等待中的帧数
+  FrameSynchronizer synchronizer(
+      number_of_sources,
+      10s,
+      FrameSynchronizer::PartialBundlePolicy::Deliver,
+      collector.MakeCallback(),
+      number_of_frames);
+  {
+    carla::ThreadGroup threads;
+    for (size_t source = 0u; source < number_of_sources; ++source) {
+      threads.CreateThread([&synchronizer, source]() {
+        for (size_t frame = 1u; frame <= number_of_frames; ++frame) {
+          synchronizer.Push(source, MakeData(frame));
+        }
+      });
+    }
+  }
+  const auto bundles = collector.WaitFor(number_of_frames);
+  ASSERT_EQ(bundles.size(), number_of_frames);
+  for (size_t i = 0u; i < bundles.size(); ++i) {
+    ASSERT_EQ(bundles[i].frame, i + 1u);
+    ASSERT_TRUE(bundles[i].IsComplete());
+    ASSERT_EQ(bundles[i].data.size(), number_of_sources);
+    for (auto &&data : bundles[i].data) {
+      ASSERT_NE(data, nullptr);
+      ASSERT_EQ(data->GetFrame(), i + 1u);
+    }
+  }
+  const auto metrics = synchronizer.GetMetrics();
+  ASSERT_EQ(metrics.complete_bundles, number_of_frames);
+  ASSERT_EQ(metrics.partial_bundles, 0u);
+  ASSERT_EQ(metrics.dropped_bundles, 0u);
+  ASSERT_EQ(metrics.pending_frames, 0u);
+}
+
+TEST(frame_synchronizer, skipped_frames) {
+  // 数据源 1 跳过了第 1 帧，第 2 帧收齐时第 1 帧作为不完整的数据包处理
+  for (auto policy : {FrameSynchronizer::PartialBundlePolicy::Deliver, FrameSynchronizer::PartialBundlePolicy::Drop}) {
+    BundleCollector collector;
+    FrameSynchronizer synchronizer(2u, 10s, policy, collector.MakeCallback());
+    synchronizer.Push(0u, MakeData(1u));
+    synchronizer.Push(0u, MakeData(2u));
+    synchronizer.Push(1u, MakeData(2u));
+    // 已经处理过的帧的数据视为迟到
+    synchronizer.Push(1u, MakeData(1u));
+    if (policy == FrameSynchronizer::PartialBundlePolicy::Deliver) {
+      const auto bundles = collector.WaitFor(2u);
+      ASSERT_EQ(bundles.size(), 2u);
+      ASSERT_EQ(bundles[0u].frame, 1u);
+      ASSERT_FALSE(bundles[0u].IsComplete());
+      ASSERT_EQ(bundles[0u].missing, 1u);
+      ASSERT_NE(bundles[0u].data[0u], nullptr);
+      ASSERT_EQ(bundles[0u].data[1u], nullptr);
+      ASSERT_EQ(bundles[1u].frame, 2u);
+      ASSERT_TRUE(bundles[1u].IsComplete());
+    } else {
+      const auto bundles = collector.WaitFor(1u);
+      ASSERT_EQ(bundles.size(), 1u);
+      ASSERT_EQ(bundles[0u].frame, 2u);
+      ASSERT_EQ(synchronizer.GetMetrics().dropped_bundles, 1u);
+    }
+    ASSERT_EQ(synchronizer.GetMetrics().late_measurements, 1u);
+  }
+}
+
+TEST(frame_synchronizer, timeout) {
+  BundleCollector collector;
+  FrameSynchronizer synchronizer(
+      2u,
+      50ms,
+      FrameSynchronizer::PartialBundlePolicy::Deliver,
+      collector.MakeCallback());
+  const auto start = std::chrono::steady_clock::now();
+  synchronizer.Push(0u, MakeData(1u));
+  const auto bundles = collector.WaitFor(1u);
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  ASSERT_EQ(bundles.size(), 1u);
+  ASSERT_EQ(bundles[0u].missing, 1u);
+  ASSERT_GE(elapsed, 50ms);
+  ASSERT_EQ(synchronizer.GetMetrics().partial_bundles, 1u);
+}
+
+TEST(frame_synchronizer, max_pending_frames) {
+  BundleCollector collector;
+  FrameSynchronizer synchronizer(
+      2u,
+      10s,
+      FrameSynchronizer::PartialBundlePolicy::Deliver,
+      collector.MakeCallback(),
+      2u);
+  for (size_t frame = 1u; frame <= 5u; ++frame) {
+    synchronizer.Push(0u, MakeData(frame));
+  }
+  const auto bundles = collector.WaitFor(3u);
+  ASSERT_EQ(bundles.size(), 3u);
+  for (size_t i = 0u; i < bundles.size(); ++i) {
+    ASSERT_EQ(bundles[i].frame, i + 1u);
+  }
+  ASSERT_EQ(synchronizer.GetMetrics().pending_frames, 2u);
+}
+
+TEST(frame_synchronizer, stop_in_callback) {
+  std::mutex mutex;
+  std::condition_variable condition;
+  size_t count = 0u;
+  std::unique_ptr<FrameSynchronizer> synchronizer;
+  synchronizer = std::make_unique<FrameSynchronizer>(
+      1u,
+      10s,
+      FrameSynchronizer::PartialBundlePolicy::Deliver,
+      [&](SensorBundle) {
+        synchronizer->Stop();
+        std::lock_guard<std::mutex> lock(mutex);
+        ++count;
+        condition.notify_all();
+      });
+  synchronizer->Push(0u, MakeData(1u));
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(condition.wait_for(lock, 5s, [&]() { return count > 0u; }));
+  }
+  // 停止之后的数据被忽略
+  synchronizer->Push(0u, MakeData(2u));
+  synchronizer.reset();
+  ASSERT_EQ(count, 1u);
+}
+
+TEST(frame_synchronizer, destroy_in_callback) {
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool pushed = false;
+  size_t count = 0u;
+  std::unique_ptr<FrameSynchronizer> synchronizer;
+  synchronizer = std::make_unique<FrameSynchronizer>(
+      1u,
+      10s,
+      FrameSynchronizer::PartialBundlePolicy::Deliver,
+      [&](SensorBundle) {
+        std::unique_lock<std::mutex> lock(mutex);
+        // 等所有数据都加入之后才销毁，之后交付线程仍然排着第二帧
+        condition.wait(lock, [&]() { return pushed; });
+        synchronizer.reset();
+        ++count;
+        condition.notify_all();
+      });
+  synchronizer->Push(0u, MakeData(1u));
+  synchronizer->Push(0u, MakeData(2u));
+  std::unique_lock<std::mutex> lock(mutex);
+  pushed = true;
+  condition.notify_all();
+  ASSERT_TRUE(condition.wait_for(lock, 5s, [&]() { return count > 0u; }));
+  ASSERT_EQ(synchronizer, nullptr);
+  // 销毁之后不再交付
+  lock.unlock();
+  std::this_thread::sleep_for(100ms);
+  lock.lock();
+  ASSERT_EQ(count, 1u);
+}
@@ -13,6 +13,7 @@
 #include <carla/geom/Location.h>/// @brief 包含地理位置相关的类，如点、向量等。
 #include <carla/geom/Math.h>/// @brief 包含几何数学运算相关的函数和类。
 #include <carla/opendrive/OpenDriveParser.h>/// @brief 包含OpenDrive解析器类，用于解析OpenDrive格式的地图文件。
+#include <carla/opendrive/parser/TopLevelElementReader.h>/// @brief 包含按顶层元素流式切分OpenDRIVE的读取器。
 #include <carla/road/MapBuilder.h>/// @brief 包含CARLA的路网构建器类，用于构建路网。
 #include <carla/road/element/RoadInfoElevation.h>/// @brief 包含道路高程信息相关的类。
 #include <carla/road/element/RoadInfoGeometry.h>/// @brief 包含道路几何信息相关的类。
@@ -22,6 +23,7 @@
 #include <pugixml/pugixml.hpp>/// @brief 包含pugixml库的头文件，用于XML解析和生成。
 
 #include <fstream>/// @brief 包含C++标准库的文件流类，用于文件读写。
+#include <sstream>/// @brief 包含C++标准库的字符串流类。
 #include <string>/// @brief 包含C++标准库的字符串类。
 
 using namespace carla::road;/// 导入CARLA的路面相关命名空间，包括道路定义和元素。
@@ -277,6 +279,48 @@ TEST(road, parse_files) {
   }
 }
 
+// 流式读取器应跳过注释、CDATA 和处理指令，包括以重复的 ']' 结尾的 CDATA
+TEST(road, top_level_element_reader_skips_markup) {
+  std::istringstream input(
+      "<?xml version=\"1.0\"?>\n"
+      "<!-- comment - with dashes -->\n"
+      "<OpenDRIVE>\n"
+      "  <header name=\"a>b\"/>\n"
+      "  <![CDATA[ <road id=\"0\"/> ]]]>\n"
+      "  <?pi a?b ?>\n"
+      "  <road id=\"1\"><lane/></road>\n"
+      "</OpenDRIVE>\n");
+  parser::TopLevelElementReader reader(input);
+  std::string name;
+  std::string element;
+  ASSERT_TRUE(reader.Next(name, element));
+  ASSERT_EQ(name, "header");
+  ASSERT_EQ(element, "<header name=\"a>b\"/>");
+  ASSERT_TRUE(reader.Next(name, element));
+  ASSERT_EQ(name, "road");
+  ASSERT_EQ(element, "<road id=\"1\"><lane/></road>");
+  ASSERT_FALSE(reader.Next(name, element));
+  ASSERT_FALSE(reader.HasError());
+}
+
+// 格式错误或提前结束的输入不抛出异常，Next 返回 false 并报告错误
+TEST(road, top_level_element_reader_reports_malformed_input) {
+  const char *inputs[] = {
+      "<OpenDRIVE><road id=\"1\"><lane/>",
+      "<OpenDRIVE><header name=\"unterminated/></OpenDRIVE>",
+      "<OpenDRIVE><!-- unterminated comment",
+      "<NotOpenDRIVE/>"};
+  for (const char *text : inputs) {
+    std::istringstream input(text);
+    parser::TopLevelElementReader reader(input);
+    std::string name;
+    std::string element;
+    ASSERT_FALSE(reader.Next(name, element)) << text;
+    ASSERT_TRUE(reader.HasError()) << text;
+    ASSERT_FALSE(reader.Next(name, element)) << text;
+  }
+}
+
 TEST(road, parse_road_links) {
   for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
     // std::cerr << file << std::endl;
@@ -11,11 +11,15 @@
 #include <carla/ThreadGroup.h>//同样是从"carla"项目中引入头文件，此头文件大概率是关于线程组（ThreadGroup）的相关定义。
 // 例如可能包含创建、管理线程组的类，或者操作线程组的函数等，方便在代码中进行多线程相关的编程操作。
 #include <carla/rpc/Actor.h>//
+#include <carla/rpc/CallBatch.h>
 #include <carla/rpc/Client.h>
 #include <carla/rpc/Response.h>
 #include <carla/rpc/Server.h>
 
+#include <future>
+#include <numeric>
 #include <thread>
+#include <vector>
 
 using namespace carla::rpc;
 using namespace std::chrono_literals;
@@ -80,3 +84,85 @@ TEST(rpc, server_bind_sync_run_on_game_thread) {
   // 断言任务已完成
   ASSERT_TRUE(done);
 }
+
+// 测试批量调用：按顺序在游戏线程上执行，单个调用的错误不影响其他调用
+TEST(rpc, call_batch) {
+  const auto main_thread_id = std::this_thread::get_id();
+  const uint16_t port = (TESTING_PORT != 0u ? TESTING_PORT : 2017u);
+  Server server(port);
+  std::vector<int> calls;
+  server.BindSync("push", [&](int x) -> int {
+    EXPECT_EQ(std::this_thread::get_id(), main_thread_id);
+    calls.push_back(x);
+    return x * 2;
+  });
+  server.BindAsync("concat", [](const std::string &a, const std::string &b) {
+    return a + b;
+  });
+  server.BindSync("nothing", []() {});
+  server.AsyncRun(1u);
+
+  std::atomic_bool done{false};
+  carla::ThreadGroup threads;
+  threads.CreateThread([&]() {
+    Client client("localhost", port);
+    CallBatch batch;
+    std::vector<std::future<clmdep_msgpack::object_handle>> results;
+    for (auto i = 0; i < 100; ++i) {
+      results.emplace_back(batch.Add("push", i));
+    }
+    auto concat = batch.Add("concat", std::string("foo"), std::string("bar"));
+    auto missing = batch.Add("missing_function", 1);
+    auto wrong_arguments = batch.Add("push", std::string("not a number"));
+    auto nothing = batch.Add("nothing");
+    EXPECT_EQ(batch.size(), 104u);
+    client.call_batch(batch);
+    EXPECT_TRUE(batch.empty());
+    for (auto i = 0; i < 100; ++i) {
+      EXPECT_EQ(results[i].get().as<int>(), 2 * i);
+    }
+    EXPECT_EQ(concat.get().as<std::string>(), "foobar");
+    EXPECT_THROW(missing.get(), std::runtime_error);
+    EXPECT_THROW(wrong_arguments.get(), std::runtime_error);
+    nothing.get();
+    done = true;
+  });
+  for (auto i = 0u; (i < 1'000'000u) && !done; ++i) {
+    server.SyncRunFor(2ms);
+  }
+  ASSERT_TRUE(done);
+  std::vector<int> expected(100u);
+  std::iota(expected.begin(), expected.end(), 0);
+  ASSERT_EQ(calls, expected);
+}
+
+// 参数个数不匹配时在调用之前就返回错误，禁用异常时也不会使整个批量请求失败
+TEST(rpc, call_batch_argument_count) {
+  Server server(TESTING_PORT);
+  size_t number_of_calls = 0u;
+  server.BindSync("add", [&](int a, int b) -> int {
+    ++number_of_calls;
+    return a + b;
+  });
+  CallBatch batch;
+  auto too_few = batch.Add("add", 1);
+  auto too_many = batch.Add("add", 1, 2, 3);
+  auto good = batch.Add("add", 1, 2);
+  std::vector<BatchCall> calls = batch.TakeCalls();
+  // 参数不是数组
+  clmdep_msgpack::sbuffer not_an_array;
+  clmdep_msgpack::pack(not_an_array, 42);
+  calls.push_back(BatchCall{"add", std::vector<char>(not_an_array.data(), not_an_array.data() + not_an_array.size())});
+
+  const auto results = server.DispatchBatch(calls);
+  ASSERT_EQ(results.size(), 4u);
+  ASSERT_TRUE(results[0].error.has_value());
+  ASSERT_TRUE(results[1].error.has_value());
+  ASSERT_FALSE(results[2].error.has_value());
+  ASSERT_TRUE(results[3].error.has_value());
+  ASSERT_EQ(number_of_calls, 1u);
+  batch.SetResults(results);
+  EXPECT_THROW(too_few.get(), std::runtime_error);
+  EXPECT_THROW(too_many.get(), std::runtime_error);
+  EXPECT_EQ(good.get().as<int>(), 3);
+}
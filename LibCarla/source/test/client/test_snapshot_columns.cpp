@@ -0,0 +1,49 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/ActorSnapshotColumns.h>
+#include <carla/client/detail/EpisodeState.h>
+
+using namespace carla::client;
+
+TEST(snapshot_columns, layout) {
+  ActorSnapshot snapshot;
+  snapshot.id = 42u;
+  snapshot.actor_state = carla::rpc::ActorState::Active;
+  snapshot.transform = carla::geom::Transform(
+      carla::geom::Location(1.0f, 2.0f, 3.0f),
+      carla::geom::Rotation(4.0f, 5.0f, 6.0f));
+  snapshot.velocity = {7.0f, 8.0f, 9.0f};
+  snapshot.angular_velocity = {10.0f, 11.0f, 12.0f};
+  snapshot.acceleration = {13.0f, 14.0f, 15.0f};
+
+  ActorSnapshotColumns columns;
+  columns.Append(snapshot);
+  columns.AppendMissing(7u);
+  ASSERT_EQ(columns.size(), 2u);
+  ASSERT_EQ(columns.ids, (std::vector<carla::ActorId>{42u, 7u}));
+  ASSERT_EQ(columns.transforms,
+      (std::vector<float>{1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f}));
+  ASSERT_EQ(columns.velocities, (std::vector<float>{7.0f, 8.0f, 9.0f, 0.0f, 0.0f, 0.0f}));
+  ASSERT_EQ(columns.angular_velocities, (std::vector<float>{10.0f, 11.0f, 12.0f, 0.0f, 0.0f, 0.0f}));
+  ASSERT_EQ(columns.accelerations, (std::vector<float>{13.0f, 14.0f, 15.0f, 0.0f, 0.0f, 0.0f}));
+  ASSERT_EQ(columns.actor_states, (std::vector<uint8_t>{
+      static_cast<uint8_t>(carla::rpc::ActorState::Active),
+      static_cast<uint8_t>(carla::rpc::ActorState::Invalid)}));
+}
+
+TEST(snapshot_columns, missing_actors) {
+  detail::EpisodeState state(1u);
+  ASSERT_EQ(state.GetActorSnapshotColumns().size(), 0u);
+  const auto columns = state.GetActorSnapshotColumns({3u, 1u, 2u});
+  ASSERT_EQ(columns.ids, (std::vector<carla::ActorId>{3u, 1u, 2u}));
+  ASSERT_EQ(columns.transforms.size(), 3u * ActorSnapshotColumns::TRANSFORM_SIZE);
+  for (auto actor_state : columns.actor_states) {
+    ASSERT_EQ(actor_state, static_cast<uint8_t>(carla::rpc::ActorState::Invalid));
+  }
+}
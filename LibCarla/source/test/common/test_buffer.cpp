@@ -176,3 +176,60 @@ TEST(buffer, buffer_pool) {
   // 现在清空缓存池来测试缓存里面的弱引用
   pool.reset();
 }
+
+// 测试缓冲区池按尺寸等级分配缓冲区
+// 大缓冲区和小缓冲区放回同一个池后，按大小弹出时应该各自重用容量合适的缓冲区
+TEST(buffer, buffer_pool_size_classes) {
+  auto pool = std::make_shared<carla::BufferPool>();
+  const unsigned char *small_data = nullptr;
+  const unsigned char *large_data = nullptr;
+  {
+    auto small = pool->Pop(40u);
+    auto large = pool->Pop(4000000u);
+    small_data = small.data();
+    large_data = large.data();
+  }
+  auto stats = pool->GetStatistics();
+  ASSERT_EQ(stats.misses, 2u);
+  ASSERT_EQ(stats.pooled_bytes, 4000040u);
+  {
+    auto large = pool->Pop(3900000u);
+    auto small = pool->Pop(36u);
+    ASSERT_EQ(large.data(), large_data);
+    ASSERT_EQ(large.size(), 3900000u);
+    ASSERT_EQ(small.data(), small_data);
+    ASSERT_EQ(small.size(), 36u);
+  }
+  stats = pool->GetStatistics();
+  ASSERT_EQ(stats.hits, 2u);
+  ASSERT_EQ(stats.reallocations, 0u);
+  {
+    // 没有足够大的缓冲区，分配新的内存而不是重用小缓冲区
+    auto buffer = pool->Pop(8000000u);
+    ASSERT_NE(buffer.data(), large_data);
+    auto small = pool->Pop();
+    small.reset(1000u);
+  }
+  stats = pool->GetStatistics();
+  ASSERT_EQ(stats.misses, 3u);
+  ASSERT_EQ(stats.reallocations, 1u);
+}
+
+// 测试缓冲区池的内存上限，超出上限时应该释放最大的缓冲区
+TEST(buffer, buffer_pool_memory_cap) {
+  auto pool = std::make_shared<carla::BufferPool>(1000000u);
+  {
+    auto small = pool->Pop(1000u);
+    auto large = pool->Pop(900000u);
+    auto larger = pool->Pop(950000u);
+  }
+  auto stats = pool->GetStatistics();
+  ASSERT_LE(stats.pooled_bytes, 1000000u);
+  ASSERT_GE(stats.buffers_trimmed, 1u);
+  pool->SetMaxPooledBytes(0u);
+  stats = pool->GetStatistics();
+  ASSERT_EQ(stats.pooled_bytes, 0u);
+  // 超过上限的缓冲区不会被放回池中
+  { auto buffer = pool->Pop(10u); }
+  ASSERT_EQ(pool->GetStatistics().pooled_bytes, 0u);
+}
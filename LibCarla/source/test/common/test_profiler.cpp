@@ -0,0 +1,212 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StopWatch.h>
+#include <carla/ThreadGroup.h>
+#include <carla/profiler/LatencyHistogram.h>
+
+#include <sstream>
+#include <thread>
+
+using namespace carla::profiler;
+
+static const ScopeStatistics *FindStatistics(
+    const std::vector<ScopeStatistics> &statistics,
+    const std::string &name) {
+  for (auto &&stats : statistics) {
+    if (stats.name == name) {
+      return &stats;
+    }
+  }
+  return nullptr;
+}
+
+static void BusyWait(std::chrono::microseconds duration) {
+  const auto end = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < end) {
+    std::this_thread::yield();
+  }
+}
+
+TEST(profiler, histogram_buckets) {
+  // 每个值都落在自己的桶的范围内，并且桶的宽度不超过值的 1/32。
+  for (uint64_t value : {0ull, 1ull, 31ull, 32ull, 33ull, 63ull, 64ull, 1000ull, 123456789ull, 1ull << 40u}) {
+    const auto index = LatencyHistogram::BucketIndex(value);
+    ASSERT_LE(LatencyHistogram::BucketLowerBound(index), value);
+    ASSERT_GE(LatencyHistogram::BucketUpperBound(index), value);
+    const auto width = LatencyHistogram::BucketUpperBound(index) - LatencyHistogram::BucketLowerBound(index);
+    ASSERT_LE(width * 32u, value);
+  }
+  ASSERT_EQ(LatencyHistogram::BucketIndex(~uint64_t(0u)) + 1u, size_t(LatencyHistogram::NUMBER_OF_BUCKETS));
+}
+
+TEST(profiler, histogram_percentiles) {
+  LatencyHistogram histogram;
+  for (uint64_t i = 1u; i <= 10000u; ++i) {
+    histogram.Record(i * 1000u);
+  }
+  ASSERT_EQ(histogram.count(), 10000u);
+  ASSERT_EQ(histogram.min(), 1000u);
+  ASSERT_EQ(histogram.max(), 10000000u);
+  auto near = [](uint64_t value, uint64_t expected) {
+    return std::abs(static_cast<double>(value) - static_cast<double>(expected)) <=
+        static_cast<double>(expected) / 32.0;
+  };
+  ASSERT_TRUE(near(histogram.Percentile(0.5), 5000000u)) << histogram.Percentile(0.5);
+  ASSERT_TRUE(near(histogram.Percentile(0.99), 9900000u)) << histogram.Percentile(0.99);
+  ASSERT_TRUE(near(histogram.Percentile(0.999), 9990000u)) << histogram.Percentile(0.999);
+  ASSERT_EQ(histogram.Percentile(1.0), histogram.max());
+
+  LatencyHistogram other;
+  other.Record(7u);
+  histogram.Merge(other);
+  ASSERT_EQ(histogram.count(), 10001u);
+  ASSERT_EQ(histogram.min(), 7u);
+  ASSERT_EQ(histogram.Percentile(0.0), 7u);
+}
+
+TEST(profiler, nested_scopes) {
+  Registry::Reset();
+  const auto outer_id = Registry::RegisterScope("test.nested_scopes.outer");
+  const auto inner_id = Registry::RegisterScope("test.nested_scopes.inner");
+  for (int i = 0; i < 10; ++i) {
+    detail::ScopedProfiler outer(outer_id);
+    BusyWait(std::chrono::microseconds(200));
+    {
+      detail::ScopedProfiler inner(inner_id);
+      BusyWait(std::chrono::microseconds(800));
+    }
+  }
+  const auto statistics = Registry::GetStatistics();
+  const auto *outer = FindStatistics(statistics, "test.nested_scopes.outer");
+  const auto *inner = FindStatistics(statistics, "test.nested_scopes.inner");
+  ASSERT_NE(outer, nullptr);
+  ASSERT_NE(inner, nullptr);
+  ASSERT_EQ(outer->histogram.count(), 10u);
+  ASSERT_EQ(inner->histogram.count(), 10u);
+  ASSERT_EQ(inner->self_nanoseconds, inner->histogram.sum());
+  // 外层作用域的自身时间不包括内层作用域。
+  ASSERT_EQ(outer->self_nanoseconds + inner->histogram.sum(), outer->histogram.sum());
+  ASSERT_GE(outer->self_nanoseconds, 10u * 200000u);
+  ASSERT_LT(outer->self_nanoseconds, inner->self_nanoseconds);
+}
+
+TEST(profiler, aggregates_threads) {
+  Registry::Reset();
+  constexpr size_t number_of_threads = 4u;
+  constexpr size_t iterations = 1000u;
+  const auto id = Registry::RegisterScope("test.aggregates_threads.scope");
+  {
+    carla::ThreadGroup threads;
+    threads.CreateThreads(number_of_threads, [id]() {
+      for (size_t i = 0u; i < iterations; ++i) {
+        detail::ScopedProfiler profiler(id);
+      }
+    });
+    // 线程还在运行时也可以查询。
+    Registry::GetStatistics();
+  }
+  // 线程退出后数据合并到注册表中。
+  const auto statistics = Registry::GetStatistics();
+  const auto *stats = FindStatistics(statistics, "test.aggregates_threads.scope");
+  ASSERT_NE(stats, nullptr);
+  ASSERT_EQ(stats->histogram.count(), number_of_threads * iterations);
+
+  Registry::Reset();
+  ASSERT_EQ(FindStatistics(Registry::GetStatistics(), "test.aggregates_threads.scope"), nullptr);
+}
+
+TEST(profiler, dynamic_scopes) {
+  Registry::Reset();
+  for (auto &&name : {"a", "b", "a"}) {
+    CARLA_PROFILE_DYNAMIC_SCOPE(rpc, std::string(name));
+  }
+  const auto statistics = Registry::GetStatistics();
+  const auto *a = FindStatistics(statistics, "rpc.a");
+  const auto *b = FindStatistics(statistics, "rpc.b");
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  ASSERT_EQ(a->histogram.count(), 2u);
+  ASSERT_EQ(b->histogram.count(), 1u);
+}
+
+TEST(profiler, disabled) {
+  Registry::Reset();
+  Registry::SetEnabled(false);
+  for (int i = 0; i < 10; ++i) {
+    CARLA_PROFILE_SCOPE(test, disabled);
+  }
+  Registry::SetEnabled(true);
+  ASSERT_TRUE(Registry::GetStatistics().empty());
+}
+
+TEST(profiler, chrome_trace) {
+  Registry::Reset();
+  const auto outer_id = Registry::RegisterScope("test.chrome_trace.\"outer\"");
+  const auto inner_id = Registry::RegisterScope("test.chrome_trace.inner");
+  Registry::StartTrace(4u);
+  ASSERT_TRUE(Registry::IsTracing());
+  {
+    detail::ScopedProfiler outer(outer_id);
+    detail::ScopedProfiler inner(inner_id);
+  }
+  std::thread([inner_id]() {
+    detail::ScopedProfiler inner(inner_id);
+  }).join();
+  Registry::StopTrace();
+  {
+    // 停止后不再记录。
+    detail::ScopedProfiler outer(outer_id);
+  }
+  std::stringstream out;
+  Registry::WriteChromeTrace(out);
+  const auto json = out.str();
+  auto count = [&json](const std::string &str) {
+    size_t result = 0u;
+    for (auto pos = json.find(str); pos != std::string::npos; pos = json.find(str, pos + 1u)) {
+      ++result;
+    }
+    return result;
+  };
+  ASSERT_EQ(count("\"ph\":\"X\""), 3u) << json;
+  ASSERT_EQ(count("\"name\":\"test.chrome_trace.\\\"outer\\\"\""), 1u) << json;
+  ASSERT_EQ(count("\"name\":\"test.chrome_trace.inner\""), 2u) << json;
+  ASSERT_EQ(json.front(), '{');
+  ASSERT_EQ(json.find("]}"), json.size() - 3u);
+
+  // 环形缓冲区只保留最近的事件。
+  Registry::StartTrace(4u);
+  for (int i = 0; i < 10; ++i) {
+    detail::ScopedProfiler inner(inner_id);
+  }
+  Registry::StopTrace();
+  out.str("");
+  Registry::WriteChromeTrace(out);
+  ASSERT_EQ(out.str().find("outer"), std::string::npos);
+  size_t events = 0u;
+  for (auto pos = out.str().find("\"ph\""); pos != std::string::npos; pos = out.str().find("\"ph\"", pos + 1u)) {
+    ++events;
+  }
+  ASSERT_EQ(events, 4u);
+}
+
+TEST(profiler, overhead) {
+  Registry::Reset();
+  constexpr size_t iterations = 1000000u;
+  const auto id = Registry::RegisterScope("test.overhead.scope");
+  carla::StopWatch watch;
+  for (size_t i = 0u; i < iterations; ++i) {
+    detail::ScopedProfiler profiler(id);
+  }
+  watch.Stop();
+  const auto ns_per_scope =
+      1e3 * static_cast<double>(watch.GetElapsedTime<std::chrono::microseconds>()) / iterations;
+  std::cout << "profiler overhead: " << ns_per_scope << " ns per scope" << std::endl;
+  // 宽松的上限，避免在负载较高的机器上误报。
+  ASSERT_LT(ns_per_scope, 5000.0);
+}
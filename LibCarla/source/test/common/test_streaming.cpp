@@ -22,7 +22,13 @@
 // 包含Carla流媒体底层服务器相关的头文件，涉及更底层的服务器功能实现，同样可能侧重于基础的协议处理等方面
 #include <carla/streaming/low_level/Server.h>
 
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
 #include <atomic>
+#include <cstring>
+#include <future>
+#include <vector>
 // 使用 std::chrono_literals 命名空间，这样可以方便地使用时间字面量
 using namespace std::chrono_literals;
 
@@ -359,3 +365,272 @@ TEST(streaming, multi_stream) {
     }
   }
 }
+
+// 服务器启用共享内存之前和之后创建的令牌都能收到数据；服务器关闭共享内存后，
+// 请求共享内存的客户端改用TCP
+TEST(streaming, shared_memory_handshake) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t number_of_messages = 20u;
+  const std::string message = "Hello shared memory!";
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(2u);
+  auto tcp_stream = srv.MakeStream();
+  srv.SetSharedMemoryEnabled(true);
+  auto shm_stream = srv.MakeStream();
+
+  auto subscribe = [&](Client &client, const auto &token, std::atomic_size_t &counter) {
+    client.Subscribe(token, [&](carla::Buffer buffer) {
+      ASSERT_EQ(as_string(buffer), message);
+      ++counter;
+    });
+  };
+
+  std::atomic_size_t tcp_received{0u};
+  std::atomic_size_t shm_received{0u};
+  std::atomic_size_t fallback_received{0u};
+  Client c0;
+  c0.AsyncRun(1u);
+  subscribe(c0, tcp_stream.token(), tcp_received);
+  subscribe(c0, shm_stream.token(), shm_received);
+  std::this_thread::sleep_for(100ms);
+  srv.SetSharedMemoryEnabled(false);
+  Client c1;
+  c1.AsyncRun(1u);
+  subscribe(c1, shm_stream.token(), fallback_received);
+  std::this_thread::sleep_for(100ms);
+
+  carla::Buffer Buf(boost::asio::buffer(message.c_str(), message.size()));
+  carla::SharedBufferView BufView = carla::BufferView::CreateFrom(std::move(Buf));
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    carla::SharedBufferView View0 = BufView;
+    tcp_stream.Write(View0);
+    carla::SharedBufferView View1 = BufView;
+    shm_stream.Write(View1);
+    std::this_thread::sleep_for(6ms);
+  }
+  std::this_thread::sleep_for(50ms);
+
+  ASSERT_GE(tcp_received, number_of_messages - 3u);
+  ASSERT_GE(shm_received, number_of_messages - 3u);
+  ASSERT_GE(fallback_received, number_of_messages - 3u);
+}
+
+// 测试多个客户端通过UDP组播订阅同一个流，消息需要分片和重组
+// 没有组播路由时（例如没有网络的容器中）无法测试组播
+static bool HasMulticastRoute(const std::string &group_address) {
+  boost::asio::io_context io;
+  boost::asio::ip::udp::socket socket(io, boost::asio::ip::udp::v4());
+  boost::system::error_code ec;
+  socket.connect({boost::asio::ip::make_address(group_address), 9u}, ec);
+  return !ec;
+}
+
+TEST(streaming, multicast_stream) {
+  using namespace carla::streaming;
+  constexpr size_t number_of_messages = 20u;
+  constexpr size_t number_of_clients = 3u;
+  constexpr size_t message_size = 100000u; // 需要多个分片
+
+  detail::udp::MulticastSettings settings;
+  settings.port = 24004u;
+  settings.max_pending_messages = 2u * number_of_messages;
+  // 限速，避免客户端的接收缓冲区溢出
+  settings.max_bytes_per_second = 10u * 1024u * 1024u;
+  if (!HasMulticastRoute(settings.group_address)) {
+    carla::log_warning("no multicast route available, skipping multicast test");
+    return;
+  }
+  Server srv(TESTING_PORT);
+  srv.EnableMulticast(settings);
+  srv.AsyncRun(1u);
+  auto stream = srv.MakeMulticastStream();
+  // 另一个组播流使用不同的组播组
+  auto other_stream = srv.MakeMulticastStream();
+
+  std::vector<std::pair<std::atomic_size_t, std::unique_ptr<Client>>> v(number_of_clients);
+  for (auto &pair : v) {
+    pair.first = 0u;
+    pair.second = std::make_unique<Client>();
+    pair.second->AsyncRun(1u);
+    pair.second->Subscribe(stream.token(), [&](carla::Buffer buffer) {
+      ASSERT_EQ(buffer.size(), message_size);
+      ASSERT_EQ(buffer.data()[message_size - 1u], 42u);
+      ++pair.first;
+    });
+  }
+
+  std::vector<unsigned char> data(message_size, 42u);
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    stream.Write(carla::BufferView::CreateFrom(carla::Buffer(data)));
+    other_stream.Write(carla::BufferView::CreateFrom(carla::Buffer(data)));
+  }
+
+  // 等待所有消息到达或超时
+  const auto deadline = std::chrono::steady_clock::now() + 5s;
+  auto all_received = [&]() {
+    for (auto &pair : v) {
+      if (pair.first < number_of_messages) {
+        return false;
+      }
+    }
+    return true;
+  };
+  while (!all_received() && (std::chrono::steady_clock::now() < deadline)) {
+    std::this_thread::sleep_for(10ms);
+  }
+
+  for (auto &pair : v) {
+    // UDP 不保证送达，允许少量丢失
+    ASSERT_GE(pair.first, number_of_messages - 3u);
+    const auto statistics = pair.second->GetMulticastStatistics(stream.token());
+    ASSERT_EQ(statistics.messages_received, pair.first);
+  }
+}
+
+// 每个组播流有自己的等待队列，一个流的突发写入只会丢弃它自己的消息
+TEST(streaming, multicast_pending_per_stream) {
+  namespace csd = carla::streaming::detail;
+  csd::udp::MulticastSettings settings;
+  settings.max_pending_messages = 1u;
+  // io_context 没有运行，写入的消息都停留在等待队列中
+  boost::asio::io_context io;
+  auto sender = std::make_shared<csd::udp::MulticastSender>(io, settings);
+  const auto group = sender->MakeGroupEndpoint();
+  auto make_message = []() {
+    return csd::tcp::ServerSession::MakeMessage(
+        carla::BufferView::CreateFrom(carla::Buffer(std::vector<unsigned char>(16u, 42u))));
+  };
+  constexpr csd::stream_id_type burst_stream = 1u;
+  constexpr csd::stream_id_type other_stream = 2u;
+  sender->Write(group, other_stream, 1u, make_message());
+  for (auto i = 1u; i <= 3u; ++i) {
+    sender->Write(group, burst_stream, i, make_message());
+  }
+  ASSERT_EQ(sender->GetNumberOfMessagesDropped(burst_stream), 2u);
+  ASSERT_EQ(sender->GetNumberOfMessagesDropped(other_stream), 0u);
+  ASSERT_EQ(sender->GetNumberOfMessagesDropped(), 2u);
+  sender->RemoveStream(burst_stream);
+  ASSERT_EQ(sender->GetNumberOfMessagesDropped(burst_stream), 0u);
+  // 关闭后执行排队的发送任务，它会直接结束并释放 sender
+  sender->Close();
+  io.poll();
+}
+
+// 向一个不读取数据的客户端发送 number_of_messages 个消息。第一个消息很大，
+// 会一直处于发送中，之后的消息进入发送队列。客户端在 reader_delay 之后
+// 开始读取，返回收到的消息的序号
+static std::vector<uint32_t> SendToStalledReader(
+    const carla::streaming::detail::tcp::SendQueueSettings &settings,
+    uint32_t number_of_messages,
+    size_t expected_messages,
+    std::chrono::milliseconds reader_delay,
+    carla::streaming::detail::tcp::SessionStatistics &statistics) {
+  namespace csd = carla::streaming::detail;
+  using boost::asio::ip::tcp;
+  constexpr size_t payload_size = 16u * 1024u * 1024u;
+
+  io_context_running io;
+  tcp::endpoint ep(tcp::v4(), TESTING_PORT);
+  csd::tcp::Server srv(io.service, ep);
+  srv.SetTimeout(10s);
+  srv.SetSendQueueSettings(settings);
+  std::promise<std::shared_ptr<csd::tcp::ServerSession>> opened;
+  srv.Listen(
+      [&](std::shared_ptr<csd::tcp::ServerSession> session) { opened.set_value(session); },
+      [](std::shared_ptr<csd::tcp::ServerSession>) {});
+
+  // 很小的接收缓冲区，保证第一个消息无法一次发送完
+  boost::asio::io_context client_io;
+  tcp::socket socket(client_io);
+  socket.open(tcp::v4());
+  socket.set_option(boost::asio::socket_base::receive_buffer_size(4096));
+  socket.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), srv.GetLocalEndpoint().port()));
+  const csd::stream_id_type stream_id = 1u;
+  boost::asio::write(socket, boost::asio::buffer(&stream_id, sizeof(stream_id)));
+  auto future = opened.get_future();
+  EXPECT_EQ(future.wait_for(5s), std::future_status::ready);
+  auto session = future.get();
+
+  std::vector<uint32_t> received;
+  carla::ThreadGroup reader;
+  reader.CreateThread([&]() {
+    std::this_thread::sleep_for(reader_delay);
+    std::vector<unsigned char> body;
+    for (auto i = 0u; i < expected_messages; ++i) {
+      csd::message_size_type size = 0u;
+      boost::asio::read(socket, boost::asio::buffer(&size, sizeof(size)));
+      body.resize(size);
+      boost::asio::read(socket, boost::asio::buffer(body));
+      uint32_t index = 0u;
+      std::memcpy(&index, body.data(), sizeof(index));
+      received.push_back(index);
+    }
+  });
+
+  auto payload = carla::BufferView::CreateFrom(carla::Buffer(payload_size));
+  for (uint32_t i = 0u; i < number_of_messages; ++i) {
+    auto index = carla::BufferView::CreateFrom(carla::Buffer(boost::asio::buffer(&i, sizeof(i))));
+    session->Write(index, payload);
+  }
+  reader.JoinAll();
+  statistics = session->GetStatistics();
+  io.service.stop();
+  return received;
+}
+
+// 队列满时丢弃最旧的消息，正在发送的消息不受影响
+TEST(streaming, send_queue_drop_oldest) {
+  using namespace carla::streaming::detail;
+  tcp::SendQueueSettings settings;
+  settings.max_size = 2u;
+  settings.policy = tcp::SendQueuePolicy::DropOldest;
+  tcp::SessionStatistics statistics;
+  const auto received = SendToStalledReader(settings, 5u, 3u, 200ms, statistics);
+  ASSERT_EQ(received, (std::vector<uint32_t>{0u, 3u, 4u}));
+  ASSERT_EQ(statistics.messages_queued, 5u);
+  ASSERT_EQ(statistics.messages_dropped, 2u);
+  ASSERT_GT(statistics.bytes_dropped, 2u * 16u * 1024u * 1024u);
+}
+
+// 队列满时丢弃新到达的消息
+TEST(streaming, send_queue_drop_newest) {
+  using namespace carla::streaming::detail;
+  tcp::SendQueueSettings settings;
+  settings.max_size = 2u;
+  settings.policy = tcp::SendQueuePolicy::DropNewest;
+  tcp::SessionStatistics statistics;
+  const auto received = SendToStalledReader(settings, 5u, 3u, 200ms, statistics);
+  ASSERT_EQ(received, (std::vector<uint32_t>{0u, 1u, 2u}));
+  ASSERT_EQ(statistics.messages_queued, 3u);
+  ASSERT_EQ(statistics.messages_dropped, 2u);
+}
+
+// 阻塞超时后丢弃新到达的消息
+TEST(streaming, send_queue_block_timeout) {
+  using namespace carla::streaming::detail;
+  tcp::SendQueueSettings settings;
+  settings.max_size = 2u;
+  settings.policy = tcp::SendQueuePolicy::Block;
+  settings.block_timeout = carla::time_duration::milliseconds(50);
+  tcp::SessionStatistics statistics;
+  const auto received = SendToStalledReader(settings, 5u, 3u, 1000ms, statistics);
+  ASSERT_EQ(received, (std::vector<uint32_t>{0u, 1u, 2u}));
+  ASSERT_EQ(statistics.messages_queued, 3u);
+  ASSERT_EQ(statistics.messages_dropped, 2u);
+}
+
+// 客户端开始读取后，阻塞的写入者继续发送，没有消息被丢弃
+TEST(streaming, send_queue_block_until_drained) {
+  using namespace carla::streaming::detail;
+  tcp::SendQueueSettings settings;
+  settings.max_size = 2u;
+  settings.policy = tcp::SendQueuePolicy::Block;
+  settings.block_timeout = carla::time_duration::seconds(10);
+  tcp::SessionStatistics statistics;
+  const auto received = SendToStalledReader(settings, 5u, 5u, 200ms, statistics);
+  ASSERT_EQ(received, (std::vector<uint32_t>{0u, 1u, 2u, 3u, 4u}));
+  ASSERT_EQ(statistics.messages_queued, 5u);
+  ASSERT_EQ(statistics.messages_dropped, 0u);
+}
@@ -8,12 +8,15 @@
 //包含名为test.h的自定义头文件，可能包含项目特定的定义、函数声明等。
 #include <carla/Buffer.h>
 #include <carla/BufferView.h>
+#include <carla/StopWatch.h>
 #include <carla/streaming/Client.h>
 #include <carla/streaming/Server.h>
 //包含名为test.h的自定义头文件，可能包含项目特定的定义、函数声明等。
 #include <boost/asio/post.hpp>
 //是包含boost库中的asio模块的post.hpp头文件，boost::asio常用于异步输入/输出操作，这里的post可能与将任务提交到执行队列相关。
 #include <algorithm>
+#include <condition_variable>
+#include <mutex>
 //包含了许多通用算法，如排序、查找等算法的模板函数声明。
 using namespace carla::streaming;//前者使得可以直接使用carla::streaming命名空间下的类型和函数而无需每次都写完整的命名空间前缀
 using namespace std::chrono_literals;//使得可以直接使用std::chrono库中的字面值（例如1s表示1秒的时间字面值等）。
@@ -179,3 +182,122 @@ TEST(benchmark_streaming, image_800x600_mt) {
 TEST(benchmark_streaming, image_1920x1080_mt) {
   benchmark_image(1920u * 1080u, get_max_concurrency(), 0.9);
 }
+
+// 比较本机回环TCP与共享内存传输的吞吐量和延迟，每次等待客户端收到上一条消息后再发送下一条
+static void benchmark_transport(
+    const char *name,
+    const size_t message_size,
+    const bool shared_memory) {
+  constexpr auto number_of_messages = 50u;
+  std::mutex mutex;
+  std::condition_variable cv;
+  size_t received = 0u;
+
+  Server server(TESTING_PORT);
+  server.SetSharedMemoryEnabled(shared_memory);
+  server.AsyncRun(2u);
+  auto stream = server.MakeStream();
+  const auto message = make_special_message(message_size);
+
+  Client client;
+  client.AsyncRun(2u);
+  client.Subscribe(stream.token(), [&](carla::Buffer msg) {
+    EXPECT_EQ(msg.size(), message_size);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++received;
+    }
+    cv.notify_one();
+  });
+  std::this_thread::sleep_for(1s); // 等待客户端连接
+
+  carla::StopWatch stop_watch;
+  for (auto i = 1u; i <= number_of_messages; ++i) {
+    stream.Write(message);
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(cv.wait_for(lock, 5s, [&]() { return received >= i; }))
+        << "message " << i << " not received";
+  }
+  stop_watch.Stop();
+
+  const auto elapsed_us = std::max<size_t>(
+      1u, stop_watch.GetElapsedTime<std::chrono::microseconds>());
+  const double megabytes = static_cast<double>(message_size * number_of_messages) / (1024.0 * 1024.0);
+  std::cout << (shared_memory ? "shm " : "tcp ") << name << ": "
+            << megabytes / (static_cast<double>(elapsed_us) * 1e-6) << " MB/s, "
+            << static_cast<double>(elapsed_us) / (1e3 * number_of_messages) << " ms per message"
+            << std::endl;
+}
+
+TEST(benchmark_streaming, transport_image_1920x1080) {
+  benchmark_transport("image 1920x1080", 4u * 1920u * 1080u, false);
+  benchmark_transport("image 1920x1080", 4u * 1920u * 1080u, true);
+}
+
+TEST(benchmark_streaming, transport_image_3840x2160) {
+  benchmark_transport("image 3840x2160", 4u * 3840u * 2160u, false);
+  benchmark_transport("image 3840x2160", 4u * 3840u * 2160u, true);
+}
+
+TEST(benchmark_streaming, transport_lidar_128_channels) {
+  // 128线，每线2048个点，每个点4个float（x, y, z, intensity）
+  benchmark_transport("lidar 128 channels", 128u * 2048u * 4u * sizeof(float), false);
+  benchmark_transport("lidar 128 channels", 128u * 2048u * 4u * sizeof(float), true);
+}
+
+// 测量客户端接收路径每秒能处理的消息数量。服务器使用阻塞的发送队列，
+// 保证没有消息被丢弃，发送端尽可能快地写入，统计客户端收到全部消息所用的时间
+static void benchmark_receive_rate(
+    const char *name,
+    const size_t message_size,
+    const size_t number_of_messages) {
+  std::mutex mutex;
+  std::condition_variable cv;
+  size_t received = 0u;
+
+  Server server(TESTING_PORT);
+  detail::tcp::SendQueueSettings queue_settings;
+  queue_settings.max_size = 256u;
+  queue_settings.policy = detail::tcp::SendQueuePolicy::Block;
+  queue_settings.block_timeout = 10s;
+  server.SetSendQueueSettings(queue_settings);
+  server.AsyncRun(2u);
+  auto stream = server.MakeStream();
+
+  Client client;
+  client.AsyncRun(1u);
+  client.Subscribe(stream.token(), [&](carla::Buffer msg) {
+    EXPECT_EQ(msg.size(), message_size);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (++received == number_of_messages) {
+      cv.notify_one();
+    }
+  });
+  std::this_thread::sleep_for(1s); // 等待客户端连接
+
+  std::vector<unsigned char> data(message_size, 42u);
+  carla::StopWatch stop_watch;
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    stream.Write(carla::BufferView::CreateFrom(carla::Buffer(data)));
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(cv.wait_for(lock, 60s, [&]() { return received >= number_of_messages; }))
+        << "received only " << received << " of " << number_of_messages << " messages";
+  }
+  stop_watch.Stop();
+
+  const auto elapsed_us = std::max<size_t>(
+      1u, stop_watch.GetElapsedTime<std::chrono::microseconds>());
+  std::cout << "receive " << name << ": "
+            << static_cast<double>(number_of_messages) / (static_cast<double>(elapsed_us) * 1e-6)
+            << " messages/s" << std::endl;
+}
+
+TEST(benchmark_streaming, receive_rate_64_bytes) {
+  benchmark_receive_rate("64 B", 64u, 200000u);
+}
+
+TEST(benchmark_streaming, receive_rate_8_megabytes) {
+  benchmark_receive_rate("8 MB", 8u * 1024u * 1024u, 100u);
+}
@@ -70,6 +70,7 @@ def get_libcarla_extensions():
                 os.path.join(pwd, 'dependencies/lib/libosm2odr.a'),
                 os.path.join(pwd, 'dependencies/lib/libxerces-c.a')]
             extra_link_args += ['-lz']#编译参数列表
+            extra_link_args += ['-lrt'] # 共享内存传输使用 shm_open
             extra_compile_args = [
                 '-isystem', os.path.join(pwd, 'dependencies/include/system'), '-fPIC', '-std=c++14',#指定额外的系统文件搜索路径
                 '-Werror',#将警告当作错误处理
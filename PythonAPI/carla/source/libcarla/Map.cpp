@@ -16,7 +16,9 @@
 #include <carla/client/Landmark.h>
 #include <carla/road/SignalType.h>
 
+#include <cstring>
 #include <ostream>
+#include <stdexcept>
 #include <fstream>
 
 //定义两个重载的输出流运算符（operator<<），用于将 Map 和 Waypoint 类型的对象以文本形式输出到标准输出流
@@ -109,6 +111,127 @@ static carla::geom::GeoLocation ToGeolocation(
   return self.GetGeoReference().Transform(location);
 }
 
+// 将 carla.Location 序列或 N x 3 的数组（如 numpy.ndarray）转换为位置列表
+static std::vector<carla::geom::Location> ToLocationVector(boost::python::object locations) {
+  namespace py = boost::python;
+  std::vector<carla::geom::Location> result;
+  // 由 carla.Location 组成的序列
+  if (py::len(locations) > 0 && py::extract<carla::geom::Location>(locations[0]).check()) {
+    result.assign(
+        py::stl_input_iterator<carla::geom::Location>(locations),
+        py::stl_input_iterator<carla::geom::Location>());
+    return result;
+  }
+  // 其余情况按 N x 3 的 float32 数组读取，通过缓冲区协议直接访问数据
+  py::object numpy = py::import("numpy");
+  py::object array = numpy.attr("ascontiguousarray")(locations, "float32").attr("reshape")(-1, 3);
+  Py_buffer view;
+  if (PyObject_GetBuffer(array.ptr(), &view, PyBUF_C_CONTIGUOUS) != 0) {
+    py::throw_error_already_set();
+  }
+  const auto *data = static_cast<const float *>(view.buf);
+  const size_t size = static_cast<size_t>(view.len) / (3u * sizeof(float));
+  result.reserve(size);
+  for (size_t i = 0u; i < size; ++i) {
+    result.emplace_back(data[3u * i], data[3u * i + 1u], data[3u * i + 2u]);
+  }
+  PyBuffer_Release(&view);
+  return result;
+}
+
+// 批量获取路点，返回 carla.Waypoint 列表，找不到路点的位置为 None
+static auto GetWaypoints(
+    const carla::client::Map &self,
+    boost::python::object locations,
+    bool project_to_road,
+    int32_t lane_type) {
+  namespace py = boost::python;
+  const auto points = ToLocationVector(locations);
+  std::vector<carla::SharedPtr<carla::client::Waypoint>> waypoints;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    waypoints = self.GetWaypoints(points, project_to_road, lane_type);
+  }
+  py::list result;
+  for (auto &waypoint : waypoints) {
+    result.append(waypoint);
+  }
+  return result;
+}
+
+// get_waypoints_array 返回的结构化数组中每个元素的内存布局
+#pragma pack(push, 1)
+struct WaypointArrayElement {
+  bool valid;
+  uint32_t road_id;
+  uint32_t section_id;
+  int32_t lane_id;
+  double s;
+  float x, y, z;
+  float pitch, yaw, roll;
+};
+#pragma pack(pop)
+
+// 批量获取路点，结果以 numpy 结构化数组返回，不为每个路点创建 Python 对象
+static boost::python::object GetWaypointsArray(
+    const carla::client::Map &self,
+    boost::python::object locations,
+    bool project_to_road,
+    int32_t lane_type) {
+  namespace py = boost::python;
+  const auto points = ToLocationVector(locations);
+  std::vector<WaypointArrayElement> elements(points.size());
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    const carla::road::Map &map = self.GetMap();
+    const auto waypoints = project_to_road ?
+        map.GetClosestWaypointsOnRoad(points, lane_type) :
+        map.GetWaypoints(points, lane_type);
+    for (size_t i = 0u; i < waypoints.size(); ++i) {
+      auto &element = elements[i];
+      if (!waypoints[i].has_value()) {
+        continue;
+      }
+      const auto &waypoint = *waypoints[i];
+      const auto transform = map.ComputeTransform(waypoint);
+      element.valid = true;
+      element.road_id = waypoint.road_id;
+      element.section_id = waypoint.section_id;
+      element.lane_id = waypoint.lane_id;
+      element.s = waypoint.s;
+      element.x = transform.location.x;
+      element.y = transform.location.y;
+      element.z = transform.location.z;
+      element.pitch = transform.rotation.pitch;
+      element.yaw = transform.rotation.yaw;
+      element.roll = transform.rotation.roll;
+    }
+  }
+
+  py::object numpy = py::import("numpy");
+  py::list fields;
+  fields.append(py::make_tuple("valid", "?"));
+  fields.append(py::make_tuple("road_id", "u4"));
+  fields.append(py::make_tuple("section_id", "u4"));
+  fields.append(py::make_tuple("lane_id", "i4"));
+  fields.append(py::make_tuple("s", "f8"));
+  for (const char *name : {"x", "y", "z", "pitch", "yaw", "roll"}) {
+    fields.append(py::make_tuple(name, "f4"));
+  }
+  py::object result = numpy.attr("zeros")(elements.size(), numpy.attr("dtype")(fields));
+  Py_buffer view;
+  if (PyObject_GetBuffer(result.ptr(), &view, PyBUF_C_CONTIGUOUS | PyBUF_WRITABLE) != 0) {
+    py::throw_error_already_set();
+  }
+  if (static_cast<size_t>(view.len) != sizeof(WaypointArrayElement) * elements.size()) {
+    PyBuffer_Release(&view);
+    throw std::runtime_error("unexpected waypoint array layout");
+  }
+  std::memcpy(view.buf, elements.data(), sizeof(WaypointArrayElement) * elements.size());
+  PyBuffer_Release(&view);
+  return result;
+}
+
 void export_map() {
   using namespace boost::python;
   namespace cc = carla::client;
@@ -209,6 +332,10 @@ class_<cc::Map, boost::noncopyable, boost::shared_ptr<cc::Map>>("Map", no_init)
    .def("get_spawn_points", CALL_RETURNING_LIST(cc::Map, GetRecommendedSpawnPoints))
     // 根据位置获取路点，可指定是否投影到道路以及车道类型（默认是驾驶车道）
    .def("get_waypoint", &cc::Map::GetWaypoint, (arg("location"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
+    // 批量获取路点，locations 可以是 carla.Location 列表或 N x 3 的数组
+   .def("get_waypoints", &GetWaypoints, (arg("locations"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
+    // 批量获取路点，以 numpy 结构化数组返回
+   .def("get_waypoints_array", &GetWaypointsArray, (arg("locations"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
     // 根据道路ID、车道ID和距离获取路点（基于OpenDRIVE格式相关参数）
    .def("get_waypoint_xodr", &cc::Map::GetWaypointXODR, (arg("road_id"), arg("lane_id"), arg("s")))
     // 获取地图拓扑结构的相关方法（这里具体函数未给出完整定义，可能在别处实现）
@@ -7,8 +7,35 @@
 #include <carla/client/ClientSideSensor.h>
 #include <carla/client/LaneInvasionSensor.h>
 #include <carla/client/Sensor.h>
+#include <carla/client/SensorSynchronizer.h>
 #include <carla/client/ServerSideSensor.h>
 
+#include <boost/python/stl_iterator.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+
+  std::ostream &operator<<(std::ostream &out, const SensorBundle &bundle) {
+    out << "SensorBundle(frame=" << std::to_string(bundle.frame)
+        << ", size=" << std::to_string(bundle.data.size())
+        << ", missing=" << std::to_string(bundle.missing) << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const FrameSynchronizerMetrics &metrics) {
+    out << "SensorSynchronizerMetrics(complete_bundles=" << std::to_string(metrics.complete_bundles)
+        << ", partial_bundles=" << std::to_string(metrics.partial_bundles)
+        << ", dropped_bundles=" << std::to_string(metrics.dropped_bundles)
+        << ", late_measurements=" << std::to_string(metrics.late_measurements) << ')';
+    return out;
+  }
+
+} // namespace sensor
+} // namespace carla
+
 // 定义一个静态函数 SubscribeToStream，用于让传感器订阅流并执行回调函数
 static void SubscribeToStream(carla::client::Sensor &self, boost::python::object callback) {
     // 通过 MakeCallback 函数将传入的 Python 对象转换为合适的回调函数，并调用传感器的 Listen 方法进行订阅
@@ -23,6 +50,37 @@ static void SubscribeToGBuffer(
     self.ListenToGBuffer(GBufferId, MakeCallback(std::move(callback)));
 }
 
+// 由任意可迭代的传感器序列创建 SensorSynchronizer。销毁时释放 GIL，
+// 因为需要等待交付线程结束，而它可能正在等待 GIL 执行回调
+static boost::shared_ptr<carla::client::SensorSynchronizer> MakeSensorSynchronizer(
+    boost::python::object sensors,
+    double timeout,
+    carla::client::SensorSynchronizer::PartialBundlePolicy policy,
+    size_t max_pending_frames) {
+  namespace py = boost::python;
+  namespace cc = carla::client;
+  std::vector<carla::SharedPtr<cc::Sensor>> list{
+      py::stl_input_iterator<carla::SharedPtr<cc::Sensor>>(sensors),
+      py::stl_input_iterator<carla::SharedPtr<cc::Sensor>>()};
+  return boost::shared_ptr<cc::SensorSynchronizer>{
+      new cc::SensorSynchronizer(std::move(list), TimeDurationFromSeconds(timeout), policy, max_pending_frames),
+      carla::PythonUtil::ReleaseGILDeleter()};
+}
+
+// 每帧只获取一次 GIL，以 carla.SensorBundle 调用回调
+static void SubscribeToSynchronizer(carla::client::SensorSynchronizer &self, boost::python::object callback) {
+  auto cb = MakeCallback(std::move(callback));
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.Listen(std::move(cb));
+}
+
+static carla::SharedPtr<carla::sensor::SensorData> GetBundleItem(const carla::sensor::SensorBundle &self, size_t index) {
+  if (index >= self.data.size()) {
+    throw std::out_of_range("index out of range");
+  }
+  return self.data[index];
+}
+
 // 定义一个名为 export_sensor 的函数，用于将 C++ 中的传感器类暴露给 Python
 void export_sensor() {
     using namespace boost::python;
@@ -49,6 +107,55 @@ void export_sensor() {
         .def(self_ns::str(self_ns::self))
     ;
 
+    // 同一帧内多个传感器的数据，没有收到的数据为 None
+    class_<carla::sensor::SensorBundle>("SensorBundle", no_init)
+        .def_readonly("frame", &carla::sensor::SensorBundle::frame)
+        .def_readonly("missing", &carla::sensor::SensorBundle::missing)
+        .add_property("is_complete", &carla::sensor::SensorBundle::IsComplete)
+        .def("__len__", +[](const carla::sensor::SensorBundle &self) { return self.data.size(); })
+        .def("__getitem__", &GetBundleItem)
+        .def(self_ns::str(self_ns::self))
+    ;
+
+    enum_<cc::SensorSynchronizer::PartialBundlePolicy>("SensorBundlePolicy")
+        .value("Deliver", cc::SensorSynchronizer::PartialBundlePolicy::Deliver)
+        .value("Drop", cc::SensorSynchronizer::PartialBundlePolicy::Drop)
+    ;
+
+    class_<carla::sensor::FrameSynchronizerMetrics>("SensorSynchronizerMetrics", no_init)
+        .def_readonly("complete_bundles", &carla::sensor::FrameSynchronizerMetrics::complete_bundles)
+        .def_readonly("partial_bundles", &carla::sensor::FrameSynchronizerMetrics::partial_bundles)
+        .def_readonly("dropped_bundles", &carla::sensor::FrameSynchronizerMetrics::dropped_bundles)
+        .def_readonly("late_measurements", &carla::sensor::FrameSynchronizerMetrics::late_measurements)
+        .def_readonly("pending_frames", &carla::sensor::FrameSynchronizerMetrics::pending_frames)
+        .def_readonly("total_latency_seconds", &carla::sensor::FrameSynchronizerMetrics::total_latency_seconds)
+        .def_readonly("max_latency_seconds", &carla::sensor::FrameSynchronizerMetrics::max_latency_seconds)
+        .def_readonly("callback_seconds", &carla::sensor::FrameSynchronizerMetrics::callback_seconds)
+        .def(self_ns::str(self_ns::self))
+    ;
+
+    // 按帧合并多个传感器的数据，每帧调用一次回调
+    class_<cc::SensorSynchronizer, boost::noncopyable, boost::shared_ptr<cc::SensorSynchronizer>>("SensorSynchronizer", no_init)
+        .def("__init__", make_constructor(
+            &MakeSensorSynchronizer,
+            default_call_policies(),
+            (arg("sensors"),
+             arg("timeout")=1.0,
+             arg("partial_bundle_policy")=cc::SensorSynchronizer::PartialBundlePolicy::Deliver,
+             arg("max_pending_frames")=8u)))
+        .add_property("sensors", +[](const cc::SensorSynchronizer &self) {
+          boost::python::list result;
+          for (auto &&sensor : self.GetSensors()) {
+            result.append(sensor);
+          }
+          return result;
+        })
+        .def("listen", &SubscribeToSynchronizer, (arg("callback")))
+        .def("is_listening", &cc::SensorSynchronizer::IsListening)
+        .def("stop", CALL_WITHOUT_GIL(cc::SensorSynchronizer, Stop))
+        .def("get_metrics", &cc::SensorSynchronizer::GetMetrics)
+    ;
+
     // 定义一个名为 ClientSideSensor 的 Python 类，继承自 cc::Sensor，并设置为不可复制，使用智能指针管理
     class_<cc::ClientSideSensor, bases<cc::Sensor>, boost::noncopyable, boost::shared_ptr<cc::ClientSideSensor>>
         ("ClientSideSensor", no_init)
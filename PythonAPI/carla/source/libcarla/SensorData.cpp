@@ -9,6 +9,7 @@
 #include <carla/image/ImageIO.h>
 #include <carla/image/ImageView.h>
 #include <carla/pointcloud/PointCloudIO.h>
+#include <carla/sensor/DataWriter.h>
 #include <carla/sensor/SensorData.h>
 #include <carla/sensor/data/CollisionEvent.h>
 #include <carla/sensor/data/IMUMeasurement.h>
@@ -32,6 +33,7 @@
 #include <iostream>
 #include <cmath>
 #include <vector>
+#include <initializer_list>
 #include <algorithm>
 #include <thread>
 
@@ -237,6 +239,25 @@ std::ostream &operator<<(std::ostream &out, const CustomV2XData &data) {
 } // namespace s11n  
 } // namespace sensor  
 } // namespace carla  
+
+namespace carla {
+namespace sensor {
+
+  std::ostream &operator<<(std::ostream &out, const DataWriterMetrics &metrics) {
+    out << "SensorDataWriterMetrics(submitted=" << std::to_string(metrics.submitted)
+        << ", written=" << std::to_string(metrics.written)
+        << ", failed=" << std::to_string(metrics.failed)
+        << ", dropped=" << std::to_string(metrics.dropped)
+        << ", queued=" << std::to_string(metrics.queued)
+        << ", max_queued=" << std::to_string(metrics.max_queued)
+        << ", blocked_seconds=" << std::to_string(metrics.blocked_seconds)
+        << ", write_seconds=" << std::to_string(metrics.write_seconds)
+        << ')';
+    return out;
+  }
+
+} // namespace sensor
+} // namespace carla
   
 // 定义一个枚举类EColorConverter，用于表示不同的颜色转换器类型  
 enum class EColorConverter {  
@@ -422,11 +443,9 @@ static FakeImage ColorCodedFlow(
   }
   return result;
 }
-// 定义一个保存图像到磁盘的模板函数
+// 将图像（可选地经过颜色转换）编码写入磁盘，不修改图像本身，可以在后台线程上执行
 template <typename T>
-static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc) {
-  // 释放 Python GIL（全局解释器锁），以便在 C++ 中执行多线程操作
-  carla::PythonUtil::ReleaseGIL unlock;
+static std::string WriteImage(const T &self, std::string path, EColorConverter cc, int png_compression_level) {
   using namespace carla::image;
   // 将图像数据转换为图像视图
   auto view = ImageView::MakeView(self);
@@ -435,29 +454,242 @@ static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc
     case EColorConverter::Raw:
       return ImageIO::WriteView(
           std::move(path),
-          view);
+          view,
+          png_compression_level);
     case EColorConverter::Depth:
       return ImageIO::WriteView(
           std::move(path),
-          ImageView::MakeColorConvertedView(view, ColorConverter::Depth()));
+          ImageView::MakeColorConvertedView(view, ColorConverter::Depth()),
+          png_compression_level);
     case EColorConverter::LogarithmicDepth:
       return ImageIO::WriteView(
           std::move(path),
-          ImageView::MakeColorConvertedView(view, ColorConverter::LogarithmicDepth()));
+          ImageView::MakeColorConvertedView(view, ColorConverter::LogarithmicDepth()),
+          png_compression_level);
     case EColorConverter::CityScapesPalette:
       return ImageIO::WriteView(
           std::move(path),
-          ImageView::MakeColorConvertedView(view, ColorConverter::CityScapesPalette()));
+          ImageView::MakeColorConvertedView(view, ColorConverter::CityScapesPalette()),
+          png_compression_level);
     default:
       throw std::invalid_argument("invalid color converter!");
   }
 }
 
+// 定义一个保存图像到磁盘的模板函数
+template <typename T>
+static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc, int png_compression_level) {
+  // 释放 Python GIL（全局解释器锁），以便在 C++ 中执行多线程操作
+  carla::PythonUtil::ReleaseGIL unlock;
+  return WriteImage(static_cast<const T &>(self), std::move(path), cc, png_compression_level);
+}
+
+static carla::pointcloud::PointCloudIO::PlyFormat GetPlyFormat(bool binary) {
+  using PlyFormat = carla::pointcloud::PointCloudIO::PlyFormat;
+  return binary ? PlyFormat::BinaryLittleEndian : PlyFormat::Ascii;
+}
+
 template <typename T>
 // 定义一个静态函数 SavePointCloudToDisk，用于将点云数据保存到磁盘
-static std::string SavePointCloudToDisk(T &self, std::string path) {
+static std::string SavePointCloudToDisk(T &self, std::string path, bool binary) {
   carla::PythonUtil::ReleaseGIL unlock;
-  return carla::pointcloud::PointCloudIO::SaveToDisk(std::move(path), self.begin(), self.end());
+  return carla::pointcloud::PointCloudIO::SaveToDisk(std::move(path), self.begin(), self.end(), GetPlyFormat(binary));
+}
+
+// 获取传感器数据的共享指针，写任务持有它直到写完。不能使用从 Python 对象
+// 转换来的共享指针，它在销毁时需要 GIL
+template <typename T>
+static boost::shared_ptr<const T> GetSharedSensorData(const T &self) {
+  return boost::static_pointer_cast<const T>(self.shared_from_this());
+}
+
+// 提交后台写图像的任务，颜色转换和编码都在工作线程上进行
+static bool SubmitImage(
+    carla::sensor::DataWriter &self,
+    const carla::sensor::data::Image &image,
+    std::string path,
+    EColorConverter cc,
+    int png_compression_level) {
+  auto data = GetSharedSensorData(image);
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.Submit([data, path, cc, png_compression_level]() {
+    WriteImage(*data, path, cc, png_compression_level);
+  });
+}
+
+// 提交后台写点云的任务
+template <typename T>
+static bool SubmitPointCloud(carla::sensor::DataWriter &self, const T &measurement, std::string path, bool binary) {
+  auto data = GetSharedSensorData(measurement);
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.Submit([data, path, binary]() {
+    carla::pointcloud::PointCloudIO::SaveToDisk(path, data->begin(), data->end(), GetPlyFormat(binary));
+  });
+}
+
+static void FlushDataWriter(carla::sensor::DataWriter &self) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.Flush();
+}
+
+// ============================================================================
+// -- numpy 视图 ---------------------------------------------------------------
+// ============================================================================
+
+// numpy 数组接口中多字节类型的字节序前缀
+static char NumpyByteOrder() {
+  const uint16_t probe = 1u;
+  return (*reinterpret_cast<const uint8_t *>(&probe) == 1u) ? '<' : '>';
+}
+
+// numpy 数组接口的类型字符串，例如 "<f4"、"|u1"
+static std::string NumpyType(char kind, size_t size) {
+  return std::string(1u, size == 1u ? '|' : NumpyByteOrder()) + kind + std::to_string(size);
+}
+
+// 描述传感器数据在 numpy 中的形状和类型，descr 为空时使用 typestr
+struct NumpyLayout {
+  boost::python::tuple shape;
+  std::string typestr;
+  boost::python::list descr;
+};
+
+// 结构化数组的布局，每个元素按 fields 的顺序紧密排列，没有填充
+static NumpyLayout MakeStructuredLayout(
+    size_t count,
+    size_t item_size,
+    std::initializer_list<std::pair<const char *, std::string>> fields) {
+  NumpyLayout layout;
+  layout.shape = boost::python::make_tuple(count);
+  layout.typestr = "|V" + std::to_string(item_size);
+  for (auto &&field : fields) {
+    layout.descr.append(boost::python::make_tuple(field.first, field.second));
+  }
+  return layout;
+}
+
+// 图像为 (height, width, 4) 的 uint8 数组，通道顺序为 BGRA
+static NumpyLayout GetNumpyLayout(const carla::sensor::data::Image &self) {
+  static_assert(sizeof(carla::sensor::data::Color) == 4u, "Invalid Color size");
+  return {
+      boost::python::make_tuple(self.GetHeight(), self.GetWidth(), 4u),
+      NumpyType('u', 1u),
+      {}};
+}
+
+// 光流图像为 (height, width, 2) 的 float32 数组
+static NumpyLayout GetNumpyLayout(const carla::sensor::data::OpticalFlowImage &self) {
+  static_assert(sizeof(carla::sensor::data::OpticalFlowPixel) == 2u * sizeof(float), "Invalid OpticalFlowPixel size");
+  return {
+      boost::python::make_tuple(self.GetHeight(), self.GetWidth(), 2u),
+      NumpyType('f', sizeof(float)),
+      {}};
+}
+
+static NumpyLayout GetNumpyLayout(const carla::sensor::data::LidarMeasurement &self) {
+  static_assert(sizeof(carla::sensor::data::LidarDetection) == 4u * sizeof(float), "Invalid LidarDetection size");
+  const auto f4 = NumpyType('f', 4u);
+  return MakeStructuredLayout(
+      self.size(),
+      sizeof(carla::sensor::data::LidarDetection),
+      {{"x", f4}, {"y", f4}, {"z", f4}, {"intensity", f4}});
+}
+
+static NumpyLayout GetNumpyLayout(const carla::sensor::data::SemanticLidarMeasurement &self) {
+  static_assert(sizeof(carla::sensor::data::SemanticLidarDetection) == 6u * sizeof(uint32_t), "Invalid SemanticLidarDetection size");
+  const auto f4 = NumpyType('f', 4u);
+  const auto u4 = NumpyType('u', 4u);
+  return MakeStructuredLayout(
+      self.size(),
+      sizeof(carla::sensor::data::SemanticLidarDetection),
+      {{"x", f4}, {"y", f4}, {"z", f4}, {"cos_inc_angle", f4}, {"object_idx", u4}, {"object_tag", u4}});
+}
+
+static NumpyLayout GetNumpyLayout(const carla::sensor::data::RadarMeasurement &self) {
+  const auto f4 = NumpyType('f', 4u);
+  return MakeStructuredLayout(
+      self.size(),
+      sizeof(carla::sensor::data::RadarDetection),
+      {{"velocity", f4}, {"azimuth", f4}, {"altitude", f4}, {"depth", f4}});
+}
+
+// DVS 事件按 1 字节对齐，每个事件 13 字节
+static NumpyLayout GetNumpyLayout(const carla::sensor::data::DVSEventArray &self) {
+  static_assert(sizeof(carla::sensor::data::DVSEvent) == 13u, "Invalid DVSEvent size");
+  return MakeStructuredLayout(
+      self.size(),
+      sizeof(carla::sensor::data::DVSEvent),
+      {{"x", NumpyType('u', 2u)}, {"y", NumpyType('u', 2u)}, {"t", NumpyType('i', 8u)}, {"pol", NumpyType('b', 1u)}});
+}
+
+// 实现 numpy 的 __array_interface__，直接引用传感器数据所在的缓冲区。
+// numpy.asarray 创建的数组以传感器数据的 Python 对象作为 base，因此数组
+// 存在期间缓冲区不会被释放
+template <typename T>
+static boost::python::dict GetArrayInterface(const T &self) {
+  namespace py = boost::python;
+  const auto layout = GetNumpyLayout(self);
+  py::dict result;
+  result["version"] = 3;
+  result["shape"] = layout.shape;
+  result["typestr"] = layout.typestr;
+  if (py::len(layout.descr) > 0) {
+    result["descr"] = layout.descr;
+  }
+  const auto address = reinterpret_cast<uintptr_t>(self.data());
+  result["data"] = py::make_tuple(address, false);
+  return result;
+}
+
+// 返回不复制数据的 numpy 数组，修改数组会修改传感器数据
+static boost::python::object SensorDataToNumpy(boost::python::object self) {
+  return boost::python::import("numpy").attr("asarray")(self);
+}
+
+// DVS 事件的极性，转换为 -1 和 1
+static boost::python::object DVSPolarityToNumpy(boost::python::object self) {
+  boost::python::object events = SensorDataToNumpy(self);
+  return events["pol"].attr("astype")("int16") * 2 - 1;
+}
+
+// DVS 事件转换为 N x 4 的 int64 数组，每行为 [x, y, t, pol]
+static boost::python::object DVSEventsToNumpyArray(boost::python::object self) {
+  namespace py = boost::python;
+  py::object events = SensorDataToNumpy(self);
+  return py::import("numpy").attr("column_stack")(py::make_tuple(
+      events["x"].attr("astype")("int64"),
+      events["y"].attr("astype")("int64"),
+      events["t"],
+      DVSPolarityToNumpy(self)));
+}
+
+// DVS 事件绘制为 (height, width, 4) 的 BGRA 图像，正事件为蓝色，负事件为红色
+static boost::python::object DVSEventsToNumpyImage(boost::python::object self) {
+  namespace py = boost::python;
+  const auto &events = py::extract<const carla::sensor::data::DVSEventArray &>(self)();
+  const size_t width = events.GetWidth();
+  const size_t height = events.GetHeight();
+  py::object result = py::import("numpy").attr("zeros")(py::make_tuple(height, width, 4u), "uint8");
+  Py_buffer view;
+  if (PyObject_GetBuffer(result.ptr(), &view, PyBUF_C_CONTIGUOUS | PyBUF_WRITABLE) != 0) {
+    py::throw_error_already_set();
+  }
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    auto *image = reinterpret_cast<carla::sensor::data::Color *>(view.buf);
+    for (const auto &event : events) {
+      if ((event.x < width) && (event.y < height)) {
+        auto &pixel = image[(width * event.y) + event.x];
+        if (event.pol) {
+          pixel.b = 255u;
+        } else {
+          pixel.r = 255u;
+        }
+      }
+    }
+  }
+  PyBuffer_Release(&view);
+  return result;
 }
 
 static boost::python::dict GetCAMData(const carla::sensor::data::CAMData message)
@@ -547,8 +779,10 @@ void export_sensor_data() {
     .add_property("height", &csd::Image::GetHeight)
     .add_property("fov", &csd::Image::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::Image>)
+    .add_property("__array_interface__", &GetArrayInterface<csd::Image>)
+    .def("to_numpy", &SensorDataToNumpy)
     .def("convert", &ConvertImage<csd::Image>, (arg("color_converter")))
-    .def("save_to_disk", &SaveImageToDisk<csd::Image>, (arg("path"), arg("color_converter")=EColorConverter::Raw))
+    .def("save_to_disk", &SaveImageToDisk<csd::Image>, (arg("path"), arg("color_converter")=EColorConverter::Raw, arg("png_compression_level")=-1))
     .def("__len__", &csd::Image::size)
     .def("__iter__", iterator<csd::Image>())
     .def("__getitem__", +[](const csd::Image &self, size_t pos) -> csd::Color {
@@ -565,6 +799,8 @@ void export_sensor_data() {
     .add_property("height", &csd::OpticalFlowImage::GetHeight)
     .add_property("fov", &csd::OpticalFlowImage::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::OpticalFlowImage>)
+    .add_property("__array_interface__", &GetArrayInterface<csd::OpticalFlowImage>)
+    .def("to_numpy", &SensorDataToNumpy)
     .def("get_color_coded_flow", &ColorCodedFlow)
     .def("__len__", &csd::OpticalFlowImage::size)
     .def("__iter__", iterator<csd::OpticalFlowImage>())
@@ -581,8 +817,10 @@ void export_sensor_data() {
     .add_property("horizontal_angle", &csd::LidarMeasurement::GetHorizontalAngle)
     .add_property("channels", &csd::LidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::LidarMeasurement>)
+    .add_property("__array_interface__", &GetArrayInterface<csd::LidarMeasurement>)
+    .def("to_numpy", &SensorDataToNumpy)
     .def("get_point_count", &csd::LidarMeasurement::GetPointCount, (arg("channel")))
-    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path")))
+    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path"), arg("binary")=false))
     .def("__len__", &csd::LidarMeasurement::size)
     .def("__iter__", iterator<csd::LidarMeasurement>())
     .def("__getitem__", +[](const csd::LidarMeasurement &self, size_t pos) -> csd::LidarDetection {
@@ -598,8 +836,10 @@ void export_sensor_data() {
     .add_property("horizontal_angle", &csd::SemanticLidarMeasurement::GetHorizontalAngle)
     .add_property("channels", &csd::SemanticLidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::SemanticLidarMeasurement>)
+    .add_property("__array_interface__", &GetArrayInterface<csd::SemanticLidarMeasurement>)
+    .def("to_numpy", &SensorDataToNumpy)
     .def("get_point_count", &csd::SemanticLidarMeasurement::GetPointCount, (arg("channel")))
-    .def("save_to_disk", &SavePointCloudToDisk<csd::SemanticLidarMeasurement>, (arg("path")))
+    .def("save_to_disk", &SavePointCloudToDisk<csd::SemanticLidarMeasurement>, (arg("path"), arg("binary")=false))
     .def("__len__", &csd::SemanticLidarMeasurement::size)
     .def("__iter__", iterator<csd::SemanticLidarMeasurement>())
     .def("__getitem__", +[](const csd::SemanticLidarMeasurement &self, size_t pos) -> csd::SemanticLidarDetection {
@@ -647,6 +887,8 @@ void export_sensor_data() {
 
   class_<csd::RadarMeasurement, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::RadarMeasurement>>("RadarMeasurement", no_init)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::RadarMeasurement>)
+    .add_property("__array_interface__", &GetArrayInterface<csd::RadarMeasurement>)
+    .def("to_numpy", &SensorDataToNumpy)
     .def("get_detection_count", &csd::RadarMeasurement::GetDetectionAmount)
     .def("__len__", &csd::RadarMeasurement::size)
     .def("__iter__", iterator<csd::RadarMeasurement>())
@@ -694,6 +936,8 @@ void export_sensor_data() {
     .add_property("height", &csd::DVSEventArray::GetHeight)
     .add_property("fov", &csd::DVSEventArray::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::DVSEventArray>)
+    .add_property("__array_interface__", &GetArrayInterface<csd::DVSEventArray>)
+    .def("to_numpy", &SensorDataToNumpy)
     .def("__len__", &csd::DVSEventArray::size)
     .def("__iter__", iterator<csd::DVSEventArray>())
     .def("__getitem__", +[](const csd::DVSEventArray &self, size_t pos) -> csd::DVSEvent {
@@ -702,12 +946,12 @@ void export_sensor_data() {
     .def("__setitem__", +[](csd::DVSEventArray &self, size_t pos, csd::DVSEvent event) {
       self.at(pos) = event;
     })
-    .def("to_image", CALL_RETURNING_LIST(csd::DVSEventArray, ToImage))
-    .def("to_array", CALL_RETURNING_LIST(csd::DVSEventArray, ToArray))
-    .def("to_array_x", CALL_RETURNING_LIST(csd::DVSEventArray, ToArrayX))
-    .def("to_array_y", CALL_RETURNING_LIST(csd::DVSEventArray, ToArrayY))
-    .def("to_array_t", CALL_RETURNING_LIST(csd::DVSEventArray, ToArrayT))
-    .def("to_array_pol", CALL_RETURNING_LIST(csd::DVSEventArray, ToArrayPol))
+    .def("to_image", &DVSEventsToNumpyImage)
+    .def("to_array", &DVSEventsToNumpyArray)
+    .def("to_array_x", +[](object self) -> object { return SensorDataToNumpy(self)["x"]; })
+    .def("to_array_y", +[](object self) -> object { return SensorDataToNumpy(self)["y"]; })
+    .def("to_array_t", +[](object self) -> object { return SensorDataToNumpy(self)["t"]; })
+    .def("to_array_pol", &DVSPolarityToNumpy)
     .def(self_ns::str(self_ns::self))
   ;
 
@@ -740,4 +984,36 @@ void export_sensor_data() {
       return self.at(pos);
     })
   ;
+
+  enum_<cs::DataWriter::OverflowPolicy>("SensorDataWriterOverflowPolicy")
+    .value("Block", cs::DataWriter::OverflowPolicy::Block)
+    .value("DropNewest", cs::DataWriter::OverflowPolicy::DropNewest)
+    .value("DropOldest", cs::DataWriter::OverflowPolicy::DropOldest)
+  ;
+
+  class_<cs::DataWriterMetrics>("SensorDataWriterMetrics", no_init)
+    .def_readonly("submitted", &cs::DataWriterMetrics::submitted)
+    .def_readonly("written", &cs::DataWriterMetrics::written)
+    .def_readonly("failed", &cs::DataWriterMetrics::failed)
+    .def_readonly("dropped", &cs::DataWriterMetrics::dropped)
+    .def_readonly("queued", &cs::DataWriterMetrics::queued)
+    .def_readonly("max_queued", &cs::DataWriterMetrics::max_queued)
+    .def_readonly("blocked_seconds", &cs::DataWriterMetrics::blocked_seconds)
+    .def_readonly("write_seconds", &cs::DataWriterMetrics::write_seconds)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  // 在后台线程上把传感器数据写入磁盘，传感器回调只需要提交任务
+  class_<cs::DataWriter, boost::noncopyable, boost::shared_ptr<cs::DataWriter>>("SensorDataWriter",
+      init<size_t, size_t, cs::DataWriter::OverflowPolicy>(
+          (arg("workers")=2u, arg("queue_size")=64u, arg("overflow_policy")=cs::DataWriter::OverflowPolicy::Block)))
+    .add_property("workers", &cs::DataWriter::GetNumberOfWorkers)
+    .add_property("queue_size", &cs::DataWriter::GetQueueCapacity)
+    .add_property("overflow_policy", &cs::DataWriter::GetOverflowPolicy)
+    .def("save_image", &SubmitImage, (arg("image"), arg("path"), arg("color_converter")=EColorConverter::Raw, arg("png_compression_level")=-1))
+    .def("save_point_cloud", &SubmitPointCloud<csd::LidarMeasurement>, (arg("measurement"), arg("path"), arg("binary")=true))
+    .def("save_point_cloud", &SubmitPointCloud<csd::SemanticLidarMeasurement>, (arg("measurement"), arg("path"), arg("binary")=true))
+    .def("flush", &FlushDataWriter)
+    .def("get_metrics", &cs::DataWriter::GetMetrics)
+  ;
 }
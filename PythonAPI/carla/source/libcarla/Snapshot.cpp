@@ -10,6 +10,10 @@
 #include <carla/client/World.h>
 
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
 // 命名空间 carla 和 carla::client
 namespace carla {
 namespace client {
@@ -27,6 +31,57 @@ namespace client {
 } // namespace client
 } // namespace carla
 
+// 创建形状为 shape 的 numpy 数组，并把 data 中的数据复制进去
+template <typename T>
+static boost::python::object MakeColumnArray(
+    const boost::python::object &numpy,
+    const std::vector<T> &data,
+    const boost::python::tuple &shape,
+    const char *dtype) {
+  namespace py = boost::python;
+  py::object result = numpy.attr("empty")(shape, dtype);
+  Py_buffer view;
+  if (PyObject_GetBuffer(result.ptr(), &view, PyBUF_C_CONTIGUOUS | PyBUF_WRITABLE) != 0) {
+    py::throw_error_already_set();
+  }
+  if (static_cast<size_t>(view.len) != sizeof(T) * data.size()) {
+    PyBuffer_Release(&view);
+    throw std::runtime_error("unexpected actor array layout");
+  }
+  if (!data.empty()) {
+    std::memcpy(view.buf, data.data(), sizeof(T) * data.size());
+  }
+  PyBuffer_Release(&view);
+  return result;
+}
+
+// 把按列保存的参与者快照转换为由 numpy 数组组成的字典，每个数组的第一维是参与者
+static boost::python::dict ActorSnapshotColumnsToNumpy(const carla::client::ActorSnapshotColumns &columns) {
+  namespace py = boost::python;
+  using Columns = carla::client::ActorSnapshotColumns;
+  py::object numpy = py::import("numpy");
+  const size_t size = columns.size();
+  const auto vector_shape = py::make_tuple(size, size_t(Columns::VECTOR_SIZE));
+  py::dict result;
+  result["id"] = MakeColumnArray(numpy, columns.ids, py::make_tuple(size), "uint32");
+  result["transform"] = MakeColumnArray(numpy, columns.transforms, py::make_tuple(size, size_t(Columns::TRANSFORM_SIZE)), "float32");
+  result["velocity"] = MakeColumnArray(numpy, columns.velocities, vector_shape, "float32");
+  result["angular_velocity"] = MakeColumnArray(numpy, columns.angular_velocities, vector_shape, "float32");
+  result["acceleration"] = MakeColumnArray(numpy, columns.accelerations, vector_shape, "float32");
+  result["actor_state"] = MakeColumnArray(numpy, columns.actor_states, py::make_tuple(size), "uint8");
+  return result;
+}
+
+// 一次导出快照中所有参与者的状态，复制时释放 GIL
+static boost::python::dict GetActorArrays(const carla::client::WorldSnapshot &self) {
+  carla::client::ActorSnapshotColumns columns;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    columns = self.GetActorSnapshotColumns();
+  }
+  return ActorSnapshotColumnsToNumpy(columns);
+}
+
 void export_snapshot() {
   using namespace boost::python;
   namespace cc = carla::client;
@@ -56,9 +111,11 @@ void export_snapshot() {
     /// @}
     .def("has_actor", &cc::WorldSnapshot::Contains, (arg("actor_id")))
     .def("find", CALL_RETURNING_OPTIONAL_1(cc::WorldSnapshot, Find, carla::ActorId), (arg("actor_id")))
+    .def("get_actor_arrays", &GetActorArrays)
     .def("__len__", &cc::WorldSnapshot::size)// 定义方法 __len__，返回 WorldSnapshot 中的元素数量
     .def("__iter__", range(&cc::WorldSnapshot::begin, &cc::WorldSnapshot::end)) // 定义方法 __iter__，用于迭代 WorldSnapshot 的元素
     .def("__eq__", &cc::WorldSnapshot::operator==)// 定义方法 __eq__，用于比较两个 WorldSnapshot 对象是否相等
     .def("__ne__", &cc::WorldSnapshot::operator!=)// 定义方法 __ne__，用于比较两个 WorldSnapshot 对象是否不相等
     .def(self_ns::str(self_ns::self))// 定义用于将 WorldSnapshot 对象转换为字符串的方法
+  ;
 }
@@ -180,6 +180,15 @@ void export_world() {
     .def("find", &cc::ActorList::Find, (arg("id")))
     // 绑定Filter方法到Python类的"filter"方法，参数是"wildcard_pattern"
     .def("filter", &cc::ActorList::Filter, (arg("wildcard_pattern")))
+    // 按列导出列表中参与者在当前帧的状态，返回由 numpy 数组组成的字典
+    .def("get_actor_arrays", +[](const cc::ActorList &self) {
+      cc::ActorSnapshotColumns columns;
+      {
+        carla::PythonUtil::ReleaseGIL unlock;
+        columns = self.GetSnapshotColumns();
+      }
+      return ActorSnapshotColumnsToNumpy(columns);
+    })
     // 绑定at方法，使Python类支持通过索引访问，对应Python的"__getitem__"操作
     .def("__getitem__", &cc::ActorList::at)
     // 绑定size方法，让Python中可用len获取其长度，对应Python的"__len__"操作
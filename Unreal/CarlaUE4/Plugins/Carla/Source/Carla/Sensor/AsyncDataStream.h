@@ -51,6 +51,12 @@ public:
     return Stream.MakeBuffer();
   }
 
+  /// 从池中弹出大小为 @a Size 的缓冲区，池会优先返回容量合适的缓冲区，避免重新分配内存。
+  carla::Buffer PopBufferFromPool(uint32 Size)
+  {
+    return Stream.MakeBuffer(Size);
+  }
+
   /// 向下游发送一些数据。
   template <typename SensorT, typename... ArgsT>
   void Send(SensorT &Sensor, ArgsT &&... Args);
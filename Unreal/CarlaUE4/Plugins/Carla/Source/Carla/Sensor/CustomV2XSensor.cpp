@@ -197,7 +197,8 @@ void ACustomV2XSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float De
     if (mV2XData.GetMessageCount() > 0)
     {
         auto DataStream = GetDataStream(*this);
-        DataStream.SerializeAndSend(*this, mV2XData, DataStream.PopBufferFromPool());
+        DataStream.SerializeAndSend(*this, mV2XData, DataStream.PopBufferFromPool(
+            carla::sensor::s11n::CustomV2XDataSerializer::GetSerializedSize(mV2XData)));
     }
     mV2XData.Reset();
 }
@@ -163,7 +163,9 @@ void ADVSCamera::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTim
   ADVSCamera::DVSEventArray events = this->Simulation(DeltaTime);
 
   auto Stream = GetDataStream(*this);       // 获得数据流
-  auto Buff = Stream.PopBufferFromPool();   // 从内存池中获取一个内存缓冲，用于存数据
+  // 从内存池中获取一个足够存放所有事件的内存缓冲
+  auto Buff = Stream.PopBufferFromPool(
+      carla::sensor::s11n::DVSEventArraySerializer::GetSerializedSize(events));
 
   // 序列化数据：将动态视觉传感器仿真器中的时间 移动到 缓冲区中（std::move 本身并不移动任何东西;它只是将其参数转换为右值引用）
   carla::Buffer BufferReady(carla::sensor::SensorRegistry::Serialize(*this, events, std::move(Buff)));
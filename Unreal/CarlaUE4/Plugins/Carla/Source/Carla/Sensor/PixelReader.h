@@ -130,7 +130,7 @@ void FPixelReader::SendPixelsInRenderThread(TSensor &Sensor, bool use16BitFormat
 
             auto Stream = Sensor.GetDataStream(Sensor);
             Stream.SetFrameNumber(Frame);
-            auto Buffer = Stream.PopBufferFromPool();
+            auto Buffer = Stream.PopBufferFromPool(Offset + Size);
 
             uint32 CurrentRowBytes = ExpectedRowBytes;
 
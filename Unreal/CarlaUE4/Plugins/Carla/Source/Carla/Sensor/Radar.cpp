@@ -101,7 +101,8 @@ void ARadar::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime)
 
   {
     TRACE_CPUPROFILER_EVENT_SCOPE_STR("Send Stream");
-    DataStream.SerializeAndSend(*this, RadarData, DataStream.PopBufferFromPool());
+    DataStream.SerializeAndSend(*this, RadarData, DataStream.PopBufferFromPool(
+        carla::sensor::s11n::RadarSerializer::GetSerializedSize(RadarData)));
   }
 }
 
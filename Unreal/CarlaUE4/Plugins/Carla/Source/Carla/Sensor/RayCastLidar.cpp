@@ -65,7 +65,8 @@ void ARayCastLidar::PostPhysTick(UWorld *World, ELevelTick TickType, float Delta
 
   {
     TRACE_CPUPROFILER_EVENT_SCOPE_STR("Send Stream");
-    DataStream.SerializeAndSend(*this, LidarData, DataStream.PopBufferFromPool());
+    DataStream.SerializeAndSend(*this, LidarData, DataStream.PopBufferFromPool(
+        carla::sensor::s11n::LidarSerializer::GetSerializedSize(LidarData)));
   }
   // ROS2
   #if defined(WITH_ROS2)
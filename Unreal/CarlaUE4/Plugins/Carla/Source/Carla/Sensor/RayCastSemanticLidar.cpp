@@ -74,7 +74,8 @@ void ARayCastSemanticLidar::PostPhysTick(UWorld *World, ELevelTick TickType, flo
   auto SensorTransform = DataStream.GetSensorTransform();
   {
     TRACE_CPUPROFILER_EVENT_SCOPE_STR("Send Stream");
-    DataStream.SerializeAndSend(*this, SemanticLidarData, DataStream.PopBufferFromPool());
+    DataStream.SerializeAndSend(*this, SemanticLidarData, DataStream.PopBufferFromPool(
+        carla::sensor::s11n::SemanticLidarSerializer::GetSerializedSize(SemanticLidarData)));
   }
   // ROS2
   #if defined(WITH_ROS2)
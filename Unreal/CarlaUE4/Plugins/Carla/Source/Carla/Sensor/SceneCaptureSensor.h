@@ -512,7 +512,9 @@ private:
           Pixel = PixelType::Black;
       }
       auto GBufferStream = CameraGBuffer.GetDataStream(Self);
-      auto Buffer = GBufferStream.PopBufferFromPool();
+      auto Buffer = GBufferStream.PopBufferFromPool(
+        carla::sensor::SensorRegistry::get<CameraGBufferT*>::type::header_offset +
+        Pixels.Num() * sizeof(PixelType));
       Buffer.copy_from(
         carla::sensor::SensorRegistry::get<CameraGBufferT*>::type::header_offset,
         Pixels);
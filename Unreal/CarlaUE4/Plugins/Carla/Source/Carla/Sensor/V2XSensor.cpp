@@ -216,7 +216,8 @@ void AV2XSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTim
         if (mV2XData.GetMessageCount() > 0)
         {
             auto DataStream = GetDataStream(*this);
-            DataStream.SerializeAndSend(*this, mV2XData, DataStream.PopBufferFromPool());
+            DataStream.SerializeAndSend(*this, mV2XData, DataStream.PopBufferFromPool(
+                carla::sensor::s11n::CAMDataSerializer::GetSerializedSize(mV2XData)));
         }
         mV2XData.Reset();
     }
@@ -265,6 +265,15 @@ static carla::geom::Vector3D FWorldObserver_GetAcceleration(
   return {Acceleration.X, Acceleration.Y, Acceleration.Z};
 }
 
+/// 序列化 @a Episode 的状态所需的字节数。
+static uint32 FWorldObserver_GetSerializedSize(const UCarlaEpisode &Episode)
+{
+  using Serializer = carla::sensor::s11n::EpisodeStateSerializer;
+  using ActorDynamicState = carla::sensor::data::ActorDynamicState;
+  return static_cast<uint32>(
+      sizeof(Serializer::Header) + sizeof(ActorDynamicState) * Episode.GetActorRegistry().Num());
+}
+
 static carla::Buffer FWorldObserver_Serialize(
     carla::Buffer &&buffer,
     const UCarlaEpisode &Episode,
@@ -280,7 +289,7 @@ static carla::Buffer FWorldObserver_Serialize(
 
   const FActorRegistry &Registry = Episode.GetActorRegistry();
 
-  auto total_size = sizeof(Serializer::Header) + sizeof(ActorDynamicState) * Registry.Num();
+  auto total_size = FWorldObserver_GetSerializedSize(Episode);
   auto current_size = 0;
   // Set up buffer for writing.
   buffer.reset(total_size);
@@ -378,7 +387,7 @@ void FWorldObserver::BroadcastTick(
   auto AsyncStream = Stream.MakeAsyncDataStream(*this, Episode.GetElapsedGameTime());
 
   carla::Buffer buffer = FWorldObserver_Serialize(
-      AsyncStream.PopBufferFromPool(),
+      AsyncStream.PopBufferFromPool(FWorldObserver_GetSerializedSize(Episode)),
       Episode,
       DeltaSecond,
       MapChange,